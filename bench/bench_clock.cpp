@@ -0,0 +1,102 @@
+#include "benchmain.h"
+#include "../src/audio/playbackclock.h"
+#include <QRandomGenerator>
+
+// PlaybackClock 漂移测试：用模拟时间重放“播放器位置通知”（间隔抖动、到达滞后），
+// 每 16 ms（一帧）比较时钟给出的位置、只用最近一次通知的位置与真实位置之差
+class ClockBench : public QObject
+{
+    Q_OBJECT
+
+private:
+    struct Drift
+    {
+        double clockMean = 0;
+        double clockMax = 0;
+        double heldMean = 0;
+    };
+
+    static Drift simulate(int tickMs, int jitterMs, int lagMs, double rate, qint64 latencyMs)
+    {
+        QRandomGenerator random(42);
+        PlaybackClock clock;
+        clock.setOutputLatency(latencyMs);
+        clock.setRate(rate, 0);
+        clock.setPlaying(true, 0);
+        clock.reset(0, 0);
+
+        Drift drift;
+        int frames = 0;
+        qint64 held = 0;
+        double nextTick = tickMs;
+        const qint64 durationMs = 10 * 60 * 1000;
+        for (qint64 wall = 0; wall < durationMs; ++wall) {
+            const qint64 nowNs = wall * 1000000;
+            // 播放器报告的是送入输出的位置，真正听到的要晚 latencyMs
+            const double decoded = wall * rate;
+            if (wall >= nextTick) {
+                held = qint64(decoded - random.bounded(lagMs + 1) * rate);
+                clock.update(held, nowNs);
+                nextTick += tickMs + random.bounded(2 * jitterMs + 1) - jitterMs;
+            }
+            if (wall % 16 == 0 && wall > 1000) {
+                const double audible = decoded - latencyMs * rate;
+                const double error = std::abs(clock.position(nowNs) - audible);
+                drift.clockMean += error;
+                drift.clockMax = qMax(drift.clockMax, error);
+                drift.heldMean += std::abs(held - audible);
+                ++frames;
+            }
+        }
+        drift.clockMean /= frames;
+        drift.heldMean /= frames;
+        return drift;
+    }
+
+private slots:
+    void drift_data()
+    {
+        QTest::addColumn<int>("tickMs");
+        QTest::addColumn<int>("jitterMs");
+        QTest::addColumn<int>("lagMs");
+        QTest::addColumn<double>("rate");
+        QTest::addColumn<int>("latencyMs");
+        QTest::newRow("50ms-tick") << 50 << 15 << 30 << 1.0 << 0;
+        QTest::newRow("250ms-tick") << 250 << 40 << 30 << 1.0 << 0;
+        QTest::newRow("rate-1.5") << 50 << 15 << 30 << 1.5 << 0;
+        QTest::newRow("latency-80ms") << 50 << 15 << 30 << 1.0 << 80;
+    }
+
+    // 时钟的平均误差应明显小于直接使用通知位置，且不超过通知滞后本身
+    void drift()
+    {
+        QFETCH(int, tickMs);
+        QFETCH(int, jitterMs);
+        QFETCH(int, lagMs);
+        QFETCH(double, rate);
+        QFETCH(int, latencyMs);
+        Drift result;
+        QBENCHMARK_ONCE {
+            result = simulate(tickMs, jitterMs, lagMs, rate, latencyMs);
+        }
+        qInfo("drift ms: clock mean %.1f max %.1f, held mean %.1f", result.clockMean, result.clockMax, result.heldMean);
+        QVERIFY(result.clockMean < result.heldMean);
+        QVERIFY(result.clockMean <= lagMs * rate);
+    }
+
+    // 每帧取样的开销
+    void sample()
+    {
+        PlaybackClock clock;
+        clock.setPlaying(true);
+        clock.update(1000);
+        qint64 position = 0;
+        QBENCHMARK {
+            position += clock.position();
+        }
+        QVERIFY(position >= 0);
+    }
+};
+
+XC_BENCH_MAIN(ClockBench)
+#include "bench_clock.moc"
@@ -0,0 +1,118 @@
+#include "benchmain.h"
+#include "../src/audio/timestretch.h"
+#include "../src/audio/equalizer.h"
+#include <cmath>
+
+// 音频处理阶段的开销：每次迭代处理 1 秒 44.1 kHz 音频（默认立体声），
+// 结果即为“每实时秒的 CPU 时间”
+class DspBench : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int SampleRate = 44100;
+    static constexpr int Channels = 2;
+    static constexpr int BlockFrames = 1024;
+
+    // 440 Hz 与 1364 Hz 叠加的测试信号，按块切好
+    static QVector<AudioBlock> makeSecond(int channels = Channels)
+    {
+        QVector<AudioBlock> blocks;
+        double phase = 0;
+        const double step = 2 * 3.14159265358979323846 * 440 / SampleRate;
+        for (int done = 0; done < SampleRate; done += BlockFrames) {
+            AudioBlock block;
+            block.channels = channels;
+            block.samples.resize(size_t(BlockFrames) * channels);
+            for (int i = 0; i < BlockFrames; ++i) {
+                const float value = float(0.5 * std::sin(phase) + 0.2 * std::sin(phase * 3.1));
+                block.samples[i * channels] = value;
+                for (int c = 1; c < channels; ++c)
+                    block.samples[i * channels + c] = value * 0.8f;
+                phase += step;
+            }
+            blocks.append(block);
+        }
+        return blocks;
+    }
+
+private slots:
+    void timeStretch_data()
+    {
+        QTest::addColumn<float>("rate");
+        QTest::newRow("0.5x") << 0.5f;
+        QTest::newRow("1.0x-active") << 1.0f;
+        QTest::newRow("1.5x") << 1.5f;
+        QTest::newRow("2.0x") << 2.0f;
+    }
+
+    void timeStretch()
+    {
+        QFETCH(float, rate);
+        const QVector<AudioBlock> second = makeSecond();
+        TimeStretch stretch;
+        stretch.prepare(SampleRate, Channels);
+        // 先变一次速，1 倍速时也走 WSOLA 而不是透传
+        stretch.setRate(rate == 1.0f ? 1.5f : rate);
+        stretch.reset();
+        stretch.setRate(rate);
+
+        AudioBlock block;
+        qint64 outputFrames = 0;
+        QBENCHMARK {
+            outputFrames = 0;
+            for (const AudioBlock &input : second) {
+                block.channels = input.channels;
+                block.samples.assign(input.samples.cbegin(), input.samples.cend());
+                stretch.process(block);
+                outputFrames += block.frames();
+            }
+        }
+        // 输出长度应接近 输入 / 速率（内部缓冲最多差几段）
+        QVERIFY(qAbs(outputFrames - qint64(SampleRate / rate)) < stretch.hopFrames() * 8 + stretch.searchFrames() * 2);
+    }
+
+    // 10 段均衡器；flat 为全部 0 dB（应直接旁路）
+    void equalizer_data()
+    {
+        QTest::addColumn<int>("channels");
+        QTest::addColumn<bool>("flat");
+        QTest::newRow("flat-bypass") << Channels << true;
+        QTest::newRow("mono-10band") << 1 << false;
+        QTest::newRow("stereo-10band") << Channels << false;
+    }
+
+    void equalizer()
+    {
+        QFETCH(int, channels);
+        QFETCH(bool, flat);
+        const QVector<AudioBlock> second = makeSecond(channels);
+        Equalizer equalizer;
+        equalizer.prepare(SampleRate, channels);
+        if (!flat) {
+            Equalizer::Gains gains;
+            for (int i = 0; i < Equalizer::BandCount; ++i)
+                gains[i] = (i % 2 ? -4.0f : 5.0f);
+            equalizer.setGains(gains);
+        }
+
+        // 先处理一秒，让增益过渡结束，只测稳态
+        AudioBlock block;
+        for (const AudioBlock &input : second) {
+            block = input;
+            equalizer.process(block);
+        }
+        QCOMPARE(equalizer.isBypassed(), flat);
+
+        QBENCHMARK {
+            for (const AudioBlock &input : second) {
+                block.channels = input.channels;
+                block.samples.assign(input.samples.cbegin(), input.samples.cend());
+                equalizer.process(block);
+            }
+        }
+    }
+};
+
+XC_BENCH_MAIN(DspBench)
+#include "bench_dsp.moc"
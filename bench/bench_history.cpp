@@ -0,0 +1,89 @@
+#include "benchmain.h"
+#include "../src/library/playhistory.h"
+
+// PlayHistory 的追加、打开（检查点 + 重放）和前 k 名查询
+class HistoryBench : public QObject
+{
+    Q_OBJECT
+
+private:
+    static PlayEvent makeEvent(int i, int tracks)
+    {
+        // 少数歌曲播放得多，接近真实分布
+        const int track = (i % 7 == 0) ? i % 50 : (i * 2654435761u) % tracks;
+        PlayEvent event;
+        event.filePath = "/music/artist" + QString::number(track % 500) + "/track" + QString::number(track) + ".mp3";
+        event.timestamp = 1700000000000LL + i * 1000LL;
+        event.listenedMs = 180000;
+        event.durationMs = 200000;
+        event.skipped = i % 5 == 0;
+        return event;
+    }
+
+    static void fill(const QString &directory, int count)
+    {
+        PlayHistory history;
+        QVERIFY(history.open(directory));
+        for (int i = 0; i < count; ++i)
+            history.append(makeEvent(i, 20000));
+    }
+
+    static void scaleRows()
+    {
+        QTest::addColumn<int>("count");
+        QTest::newRow("100000") << 100000;
+        QTest::newRow("1000000") << 1000000;
+    }
+
+private slots:
+    void append()
+    {
+        QTemporaryDir dir;
+        PlayHistory history;
+        QVERIFY(history.open(dir.path()));
+        int i = 0;
+        QBENCHMARK {
+            history.append(makeEvent(i++, 20000));
+        }
+    }
+
+    void open_data() { scaleRows(); }
+    void open()
+    {
+        QFETCH(int, count);
+        QTemporaryDir dir;
+        fill(dir.path(), count);
+        QBENCHMARK {
+            PlayHistory history;
+            QVERIFY(history.open(dir.path()));
+            QCOMPARE(history.eventCount(), qint64(count));
+        }
+    }
+
+    void topK_data() { scaleRows(); }
+    void topK()
+    {
+        QFETCH(int, count);
+        QTemporaryDir dir;
+        fill(dir.path(), count);
+        PlayHistory history;
+        QVERIFY(history.open(dir.path()));
+        QBENCHMARK {
+            history.mostPlayed(20);
+            history.recentlyPlayed(20);
+            history.mostSkipped(20);
+        }
+
+        // 最常跳过按跳过率排序，播放次数太少的不参与
+        const QVector<PlayStats> skipped = history.mostSkipped(20);
+        QVERIFY(!skipped.isEmpty());
+        for (int i = 0; i < skipped.size(); ++i) {
+            QVERIFY(skipped[i].plays >= PlayHistory::MinPlaysForSkipRate);
+            if (i > 0)
+                QVERIFY(skipped[i - 1].skipRate() >= skipped[i].skipRate());
+        }
+    }
+};
+
+XC_BENCH_MAIN(HistoryBench)
+#include "bench_history.moc"
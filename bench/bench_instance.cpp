@@ -0,0 +1,125 @@
+#include "benchmain.h"
+#include "../src/core/singleinstance.h"
+#include <QSignalSpy>
+#include <QThread>
+#include <QUuid>
+
+// 单实例转发：消息编解码，以及第二次启动从 forward() 到已运行实例收到命令的往返耗时
+namespace {
+InstanceMessage makeMessage(int files)
+{
+    InstanceMessage message;
+    message.command = InstanceMessage::Play;
+    for (int i = 0; i < files; ++i)
+        message.paths << QString("/home/user/Music/歌手%1/专辑%2/%3 - 曲目名称.flac").arg(i % 50).arg(i % 7).arg(i, 4, 10, QChar('0'));
+    return message;
+}
+
+QString uniqueName()
+{
+    return "xc-bench-" + QUuid::createUuid().toString(QUuid::Id128).left(12);
+}
+}
+
+class InstanceBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void encodeDecode_data()
+    {
+        QTest::addColumn<int>("files");
+        QTest::newRow("1") << 1;
+        QTest::newRow("1000") << 1000;
+    }
+
+    void encodeDecode()
+    {
+        QFETCH(int, files);
+        const InstanceMessage message = makeMessage(files);
+        InstanceMessage decoded;
+        QBENCHMARK {
+            QByteArray buffer = message.encode();
+            QVERIFY(InstanceMessage::decode(&buffer, &decoded));
+            QVERIFY(buffer.isEmpty());
+        }
+        QCOMPARE(decoded.command, message.command);
+        QCOMPARE(decoded.paths, message.paths);
+
+        // 分两段到达：前一段不够一条消息时保留，凑齐后再取出
+        const QByteArray frame = message.encode();
+        QByteArray buffer = frame.left(frame.size() / 2);
+        bool error = true;
+        QVERIFY(!InstanceMessage::decode(&buffer, &decoded, &error));
+        QVERIFY(!error);
+        buffer += frame.mid(frame.size() / 2);
+        QVERIFY(InstanceMessage::decode(&buffer, &decoded, &error));
+        QCOMPARE(decoded.paths.size(), files);
+
+        // 不是本程序的数据
+        QByteArray garbage("\0\0\0\x08GET / HT", 12);
+        QVERIFY(!InstanceMessage::decode(&garbage, &decoded, &error));
+        QVERIFY(error);
+    }
+
+    // 第二次启动：连接、发送整批文件、断开，直到已运行的实例发出 messageReceived
+    void forward_data()
+    {
+        QTest::addColumn<int>("files");
+        QTest::newRow("activate") << 0;
+        QTest::newRow("1") << 1;
+        QTest::newRow("1000") << 1000;
+    }
+
+    void forward()
+    {
+        QFETCH(int, files);
+        const QString name = uniqueName();
+        SingleInstance instance(name);
+        QVERIFY(instance.listen());
+        QSignalSpy received(&instance, &SingleInstance::messageReceived);
+        const InstanceMessage message = makeMessage(files);
+
+        int forwarded = 0;
+        QBENCHMARK {
+            // forward() 是阻塞调用，放到另一个线程里，本线程的事件循环负责接收
+            bool ok = false;
+            QThread *client = QThread::create([&] { ok = SingleInstance::forward(message, name); });
+            client->start();
+            QVERIFY(received.wait(5000));
+            client->wait();
+            delete client;
+            QVERIFY(ok);
+            ++forwarded;
+        }
+        // 每次启动正好一条消息，内容完整
+        QCOMPARE(received.count(), forwarded);
+        const InstanceMessage last = received.last().at(0).value<InstanceMessage>();
+        QCOMPARE(last.paths, message.paths);
+    }
+
+    // 服务名冲突：另一个实例在运行时 listen() 失败（交由调用方转发），崩溃留下的套接字文件被清理
+    void listenConflicts()
+    {
+        QBENCHMARK_ONCE {
+            const QString name = uniqueName();
+            SingleInstance first(name);
+            QVERIFY(first.listen());
+            SingleInstance second(name);
+            QVERIFY(!second.listen());
+            QVERIFY(SingleInstance::forward(InstanceMessage(), name));
+        }
+#ifdef Q_OS_UNIX
+        const QString name = uniqueName();
+        QFile stale(QDir::tempPath() + "/" + name);
+        QVERIFY(stale.open(QIODevice::WriteOnly));
+        stale.close();
+        SingleInstance instance(name);
+        QVERIFY(instance.listen());
+#endif
+        QVERIFY(!SingleInstance::forward(InstanceMessage(), uniqueName()));
+    }
+};
+
+XC_BENCH_MAIN(InstanceBench)
+#include "bench_instance.moc"
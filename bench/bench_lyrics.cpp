@@ -0,0 +1,263 @@
+#include "benchmain.h"
+#include "../src/lyrics/lrcwidget.h"
+#include "../src/lyrics/lyricview.h"
+#include "../src/lyrics/encodingdetector.h"
+#include "../src/lyrics/lyricresolver.h"
+#include <QPainter>
+#include <QTextStream>
+
+// 暴露受保护的模糊函数供基准测试调用
+class LyricsProbe : public lrcwidget
+{
+public:
+    using lrcwidget::applyBlurToImage;
+};
+
+class LyricsBench : public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+
+    // 生成 lines 行、每行间隔 2 秒的歌词文件
+    QString makeLyricsFile(int lines)
+    {
+        const QString path = m_dir.filePath(QString("bench_%1.lrc").arg(lines));
+        if (QFile::exists(path))
+            return path;
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+            return QString();
+        QTextStream out(&file);
+        for (int i = 0; i < lines; ++i) {
+            int totalSeconds = i * 2;
+            out << QString::asprintf("[%02d:%02d:%02d]", totalSeconds / 60 % 100, totalSeconds % 60, i % 100)
+                << "第" << i << "行歌词 lyric line " << i << "\n";
+        }
+        return path;
+    }
+
+    // 增强 LRC：每行 8 个词，每个词 250 ms
+    QString makeKaraokeText(int lines)
+    {
+        QString text;
+        QTextStream out(&text);
+        for (int i = 0; i < lines; ++i) {
+            const int lineStart = i * 2000;
+            out << QString::asprintf("[%02d:%02d.%02d]", lineStart / 60000, lineStart / 1000 % 60, lineStart / 10 % 100);
+            for (int word = 0; word <= 8; ++word) {
+                const int start = lineStart + word * 250;
+                out << QString::asprintf("<%02d:%02d.%02d>", start / 60000, start / 1000 % 60, start / 10 % 100);
+                if (word < 8)
+                    out << "词" << word << " ";
+            }
+            out << "\n";
+        }
+        out.flush();
+        return text;
+    }
+
+private slots:
+    void parseLyrics_data()
+    {
+        QTest::addColumn<int>("lines");
+        QTest::newRow("60") << 60;
+        QTest::newRow("1000") << 1000;
+        QTest::newRow("3000") << 3000;
+    }
+
+    void parseLyrics()
+    {
+        QFETCH(int, lines);
+        const QString path = makeLyricsFile(lines);
+        LyricsProbe widget;
+        QMap<QTime, QString> result;
+        QBENCHMARK {
+            result = widget.parseLyrics(path);
+        }
+        QVERIFY(!result.isEmpty());
+    }
+
+    void updateLyrics_data()
+    {
+        QTest::addColumn<int>("lines");
+        QTest::newRow("60") << 60;
+        QTest::newRow("1000") << 1000;
+    }
+
+    // 模拟播放过程中逐次刷新：每 250 ms 调用一次，覆盖整首歌
+    void updateLyrics()
+    {
+        QFETCH(int, lines);
+        LyricsProbe widget;
+        widget.resize(757, 600);
+        widget.loadLyrics(makeLyricsFile(lines));
+        const qint64 total = qint64(lines) * 2000;
+        QBENCHMARK {
+            for (qint64 position = 0; position < total; position += 250)
+                widget.updateLyrics(position);
+        }
+    }
+
+    void parseWordTimings_data()
+    {
+        QTest::addColumn<int>("lines");
+        QTest::newRow("60") << 60;
+        QTest::newRow("1000") << 1000;
+    }
+
+    void parseWordTimings()
+    {
+        QFETCH(int, lines);
+        const QString text = makeKaraokeText(lines);
+        QVector<LyricLine> result;
+        QBENCHMARK {
+            result = LrcParser::parseLines(text);
+        }
+        QCOMPARE(result.size(), lines);
+        QCOMPARE(result.constFirst().words.size(), 8);
+    }
+
+    void detectEncoding_data()
+    {
+        QTest::addColumn<QByteArray>("data");
+        QTest::addColumn<int>("expected");
+
+        // 约 100 KB：时间标签加中文歌词，GBK 部分直接构造 GB2312 常用汉字区的字节
+        QByteArray utf8;
+        QByteArray gbk;
+        for (int i = 0; i < 2000; ++i) {
+            const QByteArray tag = QString::asprintf("[%02d:%02d.%02d]", i / 60 % 100, i % 60, i % 100).toLatin1();
+            utf8 += tag + QString("第%1行歌词，天在将黑未黑时最美\n").arg(i).toUtf8();
+            gbk += tag;
+            for (int k = 0; k < 14; ++k) {
+                gbk += char(0xB0 + (i + k) % 40);
+                gbk += char(0xA1 + (i * 7 + k) % 94);
+            }
+            gbk += '\n';
+        }
+        QTest::newRow("utf8") << utf8 << int(EncodingDetector::Utf8);
+        QTest::newRow("gbk") << gbk << int(EncodingDetector::Gbk);
+    }
+
+    void detectEncoding()
+    {
+        QFETCH(QByteArray, data);
+        QFETCH(int, expected);
+        EncodingDetector::Encoding encoding = EncodingDetector::Utf8;
+        QBENCHMARK {
+            encoding = EncodingDetector::detect(data);
+        }
+        QCOMPARE(int(encoding), expected);
+    }
+
+    void resolveLyrics_data()
+    {
+        QTest::addColumn<bool>("withLyrics");
+        QTest::newRow("sidecar") << true;
+        QTest::newRow("missing") << false;
+    }
+
+    // 重复播放同一首：第一次探测各个来源，之后应只检查歌曲文件本身
+    void resolveLyrics()
+    {
+        QFETCH(bool, withLyrics);
+        const QString audioPath = m_dir.filePath(withLyrics ? "resolve_hit.mp3" : "resolve_miss.mp3");
+        QFile audio(audioPath);
+        QVERIFY(audio.open(QIODevice::WriteOnly));
+        audio.write(QByteArray(64 * 1024, '\0'));
+        audio.close();
+        if (withLyrics)
+            QVERIFY(QFile::copy(makeLyricsFile(60), m_dir.filePath("resolve_hit.lrc")));
+
+        LyricResolver resolver;
+        resolver.setLyricsDirectory(m_dir.filePath("lyrics"));
+        ResolvedLyrics lyrics;
+        QBENCHMARK {
+            lyrics = resolver.resolve(audioPath);
+        }
+        QCOMPARE(lyrics.isEmpty(), !withLyrics);
+        QCOMPARE(resolver.cacheMisses(), 1);
+
+        // 找不到歌词的结果同样有上限，随机播放大曲库时不会一直增长
+        if (!withLyrics) {
+            for (int i = 0; i < LyricResolver::MissCacheSize + 100; ++i)
+                resolver.resolve(m_dir.filePath(QString("missing_%1.mp3").arg(i)));
+            QCOMPARE(resolver.cachedMissing(), LyricResolver::MissCacheSize);
+        }
+    }
+
+    void karaokeFrame_data()
+    {
+        QTest::addColumn<int>("lines");
+        QTest::newRow("60") << 60;
+        QTest::newRow("3000") << 3000;
+    }
+
+    // 一帧的开销：推进 1/60 秒并绘制当前行，应与歌词行数无关
+    void karaokeFrame()
+    {
+        QFETCH(int, lines);
+        LyricView view;
+        view.resize(301, 251);
+        view.setLines(LrcParser::parseLines(makeKaraokeText(lines)));
+        QImage frame(view.size(), QImage::Format_ARGB32_Premultiplied);
+        qint64 position = qint64(lines) * 1000;
+        QBENCHMARK {
+            position += 16;
+            view.setPosition(position);
+            QPainter painter(&frame);
+            view.render(&painter);
+        }
+        QVERIFY(view.currentLine() >= 0);
+    }
+
+    // 普通行（没有逐字时间）：播放器不再报告位置时，也要按播放时钟在下一行开始时切换
+    void plainLineSwitch()
+    {
+        QString text;
+        for (int i = 0; i < 20; ++i)
+            text += QString::asprintf("[00:%02d.%02d]第%d行\n", i * 150 / 1000, i * 150 / 10 % 100, i);
+        LyricView view;
+        view.resize(301, 251);
+        view.setLines(LrcParser::parseLines(text));
+        view.show();
+        PlaybackClock clock;
+        QBENCHMARK_ONCE {
+            clock.reset(0);
+            clock.setPlaying(true);
+            view.setClock(&clock);
+            view.setPlaying(true);
+            QCOMPARE(view.currentLine(), 0);
+            QTRY_VERIFY_WITH_TIMEOUT(view.currentLine() >= 4, 3000);
+        }
+        view.setPlaying(false);
+    }
+
+    void applyBlurToImage_data()
+    {
+        QTest::addColumn<QSize>("size");
+        QTest::newRow("cover-300") << QSize(300, 300);
+        QTest::newRow("window-757x600") << QSize(757, 600);
+        QTest::newRow("source-KK") << QSize();
+    }
+
+    void applyBlurToImage()
+    {
+        QFETCH(QSize, size);
+        LyricsProbe widget;
+        QImage image(":/images/images/KK.jpg");
+        QVERIFY(!image.isNull());
+        if (size.isValid())
+            image = image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        QImage blurred;
+        QBENCHMARK {
+            blurred = widget.applyBlurToImage(image, 10);
+        }
+        QCOMPARE(blurred.size(), image.size());
+    }
+};
+
+XC_BENCH_MAIN(LyricsBench)
+#include "bench_lyrics.moc"
@@ -0,0 +1,177 @@
+#include "benchmain.h"
+#include "../src/playlist/playlist_manager.h"
+#include "../src/playlist/playlist_snapshot.h"
+
+// playlist_manager.c 的大规模增删查和持久化
+class PlaylistBench : public QObject
+{
+    Q_OBJECT
+
+private:
+    static SongInfo *makeSong(int i)
+    {
+        QByteArray title = "Song " + QByteArray::number(i);
+        QByteArray path = "/music/artist" + QByteArray::number(i % 500) + "/track" + QByteArray::number(i) + ".mp3";
+        return create_song_info(title.constData(), "Artist", "Album", path.constData(), "", "", 200 + i % 100);
+    }
+
+    static void fill(Playlist *playlist, int count)
+    {
+        for (int i = 0; i < count; ++i)
+            add_to_playlist(playlist, makeSong(i));
+    }
+
+    // 已知无重复时直接追加，避免准备 25 万条数据时的平方级查重
+    static void append(Playlist *playlist, int count)
+    {
+        for (int i = 0; i < count; ++i)
+            append_to_playlist(playlist, makeSong(i));
+    }
+
+    static void snapshotScaleRows()
+    {
+        QTest::addColumn<int>("count");
+        QTest::newRow("10000") << 10000;
+        QTest::newRow("250000") << 250000;
+    }
+
+    static void addScaleRows()
+    {
+        QTest::addColumn<int>("count");
+        QTest::newRow("1000") << 1000;
+        QTest::newRow("10000") << 10000;
+    }
+
+private slots:
+    void addToPlaylist_data() { addScaleRows(); }
+    void addToPlaylist()
+    {
+        QFETCH(int, count);
+        QTemporaryDir dir;
+        QBENCHMARK {
+            PlaylistManager *manager = playlist_manager_init(dir.path().toUtf8().constData());
+            fill(create_playlist(manager, "bench"), count);
+            playlist_manager_free(manager);
+        }
+    }
+
+    // 同样的歌曲整批加入（哈希去重一次）
+    void addSongsBatch_data() { addScaleRows(); }
+    void addSongsBatch()
+    {
+        QFETCH(int, count);
+        QTemporaryDir dir;
+        QBENCHMARK {
+            PlaylistManager *manager = playlist_manager_init(dir.path().toUtf8().constData());
+            QVector<SongInfo *> songs(count);
+            for (int i = 0; i < count; ++i)
+                songs[i] = makeSong(i);
+            add_songs_to_playlist(create_playlist(manager, "bench"), songs.data(), count);
+            playlist_manager_free(manager);
+        }
+    }
+
+    void moveRange_data() { addScaleRows(); }
+    void moveRange()
+    {
+        QFETCH(int, count);
+        QTemporaryDir dir;
+        PlaylistManager *manager = playlist_manager_init(dir.path().toUtf8().constData());
+        Playlist *playlist = create_playlist(manager, "bench");
+        append(playlist, count);
+        QBENCHMARK {
+            move_playlist_range(playlist, count / 4, count / 2, 0);
+        }
+        playlist_manager_free(manager);
+    }
+
+    void lookup_data() { addScaleRows(); }
+    void lookup()
+    {
+        QFETCH(int, count);
+        QTemporaryDir dir;
+        PlaylistManager *manager = playlist_manager_init(dir.path().toUtf8().constData());
+        fill(get_favorites(manager), count);
+        QByteArray missing = "/music/not-there.mp3";
+        QByteArray last = "/music/artist" + QByteArray::number((count - 1) % 500) + "/track" + QByteArray::number(count - 1) + ".mp3";
+        QBENCHMARK {
+            QVERIFY(is_in_favorites(manager, last.constData()));
+            QVERIFY(!is_in_favorites(manager, missing.constData()));
+        }
+        playlist_manager_free(manager);
+    }
+
+    void save_data() { addScaleRows(); }
+    void save()
+    {
+        QFETCH(int, count);
+        QTemporaryDir dir;
+        PlaylistManager *manager = playlist_manager_init(dir.path().toUtf8().constData());
+        fill(get_favorites(manager), count);
+        fill(create_playlist(manager, "bench"), count);
+        QBENCHMARK {
+            QVERIFY(save_playlists(manager));
+        }
+        playlist_manager_free(manager);
+    }
+
+    void load_data() { addScaleRows(); }
+    void load()
+    {
+        QFETCH(int, count);
+        QTemporaryDir dir;
+        PlaylistManager *writer = playlist_manager_init(dir.path().toUtf8().constData());
+        fill(get_favorites(writer), count);
+        fill(create_playlist(writer, "bench"), count);
+        save_playlists(writer);
+        playlist_manager_free(writer);
+
+        // playlist_manager_init 内部会调用 load_playlists
+        QBENCHMARK {
+            PlaylistManager *manager = playlist_manager_init(dir.path().toUtf8().constData());
+            playlist_manager_free(manager);
+        }
+    }
+
+    // 二进制快照：映射 + 校验，目标是 25 万条在 10 ms 以内
+    void snapshotOpen_data() { snapshotScaleRows(); }
+    void snapshotOpen()
+    {
+        QFETCH(int, count);
+        QTemporaryDir dir;
+        const QString path = dir.filePath("playlists.snapshot");
+        PlaylistManager *writer = playlist_manager_create(dir.path().toUtf8().constData());
+        append(get_favorites(writer), count);
+        QVERIFY(PlaylistSnapshot::write(path, writer));
+        playlist_manager_free(writer);
+
+        QBENCHMARK {
+            PlaylistSnapshot snapshot;
+            QVERIFY(snapshot.open(path));
+            QCOMPARE(snapshot.songCount(0), count);
+        }
+    }
+
+    void snapshotHydrate_data() { snapshotScaleRows(); }
+    void snapshotHydrate()
+    {
+        QFETCH(int, count);
+        QTemporaryDir dir;
+        const QString path = dir.filePath("playlists.snapshot");
+        PlaylistManager *writer = playlist_manager_create(dir.path().toUtf8().constData());
+        append(get_favorites(writer), count);
+        QVERIFY(PlaylistSnapshot::write(path, writer));
+        playlist_manager_free(writer);
+
+        PlaylistSnapshot snapshot;
+        QVERIFY(snapshot.open(path));
+        QBENCHMARK {
+            PlaylistManager *manager = playlist_manager_create(dir.path().toUtf8().constData());
+            QVERIFY(snapshot.hydrate(manager));
+            playlist_manager_free(manager);
+        }
+    }
+};
+
+XC_BENCH_MAIN(PlaylistBench)
+#include "bench_playlist.moc"
@@ -0,0 +1,72 @@
+#include "benchmain.h"
+#include "../src/library/queuesorter.h"
+
+// 播放队列排序：首次（计算排序键）与缓存命中后的重排
+class QueueBench : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QVector<QueueSorter::Entry> makeEntries(int count)
+    {
+        // 中英文混合的标题和艺术家
+        static const QStringList words = {"晴天", "Yesterday", "稻香", "hello", "七里香", "Zebra",
+                                          "夜曲", "apple", "告白气球", "Bohemian", "青花瓷", "东风破"};
+        QVector<QueueSorter::Entry> entries(count);
+        for (int i = 0; i < count; ++i) {
+            QueueSorter::Entry &entry = entries[i];
+            entry.title = words[i % words.size()] + " " + QString::number(i);
+            entry.artist = words[(i / 7) % words.size()];
+            entry.fileName = entry.title + ".mp3";
+            entry.durationMs = 120000 + (i * 7919) % 240000;
+        }
+        return entries;
+    }
+
+    static void scaleRows()
+    {
+        QTest::addColumn<int>("count");
+        QTest::newRow("10000") << 10000;
+        QTest::newRow("100000") << 100000;
+    }
+
+private slots:
+    void sortColdTitle_data() { scaleRows(); }
+    void sortColdTitle()
+    {
+        QFETCH(int, count);
+        const QVector<QueueSorter::Entry> entries = makeEntries(count);
+        QBENCHMARK {
+            QueueSorter sorter;
+            sorter.order(entries, QueueSorter::Title);
+        }
+    }
+
+    void sortCachedTitle_data() { scaleRows(); }
+    void sortCachedTitle()
+    {
+        QFETCH(int, count);
+        const QVector<QueueSorter::Entry> entries = makeEntries(count);
+        QueueSorter sorter;
+        sorter.order(entries, QueueSorter::Title);
+        bool descending = false;
+        QBENCHMARK {
+            descending = !descending;
+            sorter.order(entries, QueueSorter::Title, descending);
+        }
+    }
+
+    void sortDuration_data() { scaleRows(); }
+    void sortDuration()
+    {
+        QFETCH(int, count);
+        const QVector<QueueSorter::Entry> entries = makeEntries(count);
+        QueueSorter sorter;
+        QBENCHMARK {
+            sorter.order(entries, QueueSorter::Duration);
+        }
+    }
+};
+
+XC_BENCH_MAIN(QueueBench)
+#include "bench_queue.moc"
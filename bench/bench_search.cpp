@@ -0,0 +1,190 @@
+#include "benchmain.h"
+#include "../src/search/searchwidget.h"
+#include "../src/search/searchclient.h"
+#include <QElapsedTimer>
+#include <QNetworkAccessManager>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUrlQuery>
+
+namespace {
+// 替身搜索服务器：total 条结果，每个请求延迟 delayMs 后返回所请求的一页；记录请求数和最大并发
+class SearchServer
+{
+public:
+    SearchServer(int total, int delayMs)
+        : m_total(total)
+        , m_delayMs(delayMs)
+    {
+        m_server.listen(QHostAddress::LocalHost);
+        QObject::connect(&m_server, &QTcpServer::newConnection, &m_server, [this] {
+            while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+                QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket] { onData(socket); });
+                QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+    }
+
+    QUrl url() const { return QUrl(QString("http://127.0.0.1:%1/api/v3/search/song").arg(m_server.serverPort())); }
+    int requests() const { return m_requests; }
+    int maxConcurrent() const { return m_maxConcurrent; }
+    QString lastKeyword() const { return m_lastKeyword; }
+
+private:
+    void onData(QTcpSocket *socket)
+    {
+        const QByteArray request = socket->property("request").toByteArray() + socket->readAll();
+        socket->setProperty("request", request);
+        if (!request.contains("\r\n\r\n") || socket->property("answered").toBool())
+            return;
+        socket->setProperty("answered", true);
+
+        const QByteArray target = request.mid(4, request.indexOf(' ', 4) - 4);
+        const QUrlQuery query(QUrl::fromEncoded(target));
+        m_lastKeyword = query.queryItemValue("keyword", QUrl::FullyDecoded);
+        const int page = query.queryItemValue("page").toInt();
+        const int pageSize = query.queryItemValue("pagesize").toInt();
+        ++m_requests;
+        m_maxConcurrent = qMax(m_maxConcurrent, ++m_active);
+
+        QTimer::singleShot(m_delayMs, socket, [this, socket, page, pageSize] {
+            --m_active;
+            QJsonArray info;
+            for (int i = (page - 1) * pageSize; i < qMin(m_total, page * pageSize); ++i) {
+                QJsonObject song;
+                song["songname"] = QString("歌曲%1").arg(i);
+                song["singername"] = QString("歌手%1").arg(i % 50);
+                song["duration"] = 180 + i % 120;
+                song["hash"] = QString("%1").arg(i, 32, 16, QChar('0'));
+                info.append(song);
+            }
+            QJsonObject data;
+            data["total"] = m_total;
+            data["info"] = info;
+            QJsonObject root;
+            root["data"] = data;
+            const QByteArray body = QJsonDocument(root).toJson(QJsonDocument::Compact);
+            socket->write("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: "
+                          + QByteArray::number(body.size()) + "\r\nConnection: close\r\n\r\n" + body);
+            socket->disconnectFromHost();
+        });
+    }
+
+    QTcpServer m_server;
+    int m_total;
+    int m_delayMs;
+    int m_requests = 0;
+    int m_active = 0;
+    int m_maxConcurrent = 0;
+    QString m_lastKeyword;
+};
+}
+
+// 搜索结果表格填充、分页追加，以及对着替身服务器滚动浏览时的加载卡顿
+class SearchBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void displaySearchResults_data()
+    {
+        QTest::addColumn<int>("rows");
+        QTest::newRow("20") << 20;
+        QTest::newRow("200") << 200;
+        QTest::newRow("1000") << 1000;
+    }
+
+    void displaySearchResults()
+    {
+        QFETCH(int, rows);
+        QStringList results;
+        for (int i = 0; i < rows; ++i)
+            results << QString("歌曲%1,歌手%2,%3分%4秒").arg(i).arg(i % 50).arg(i % 6).arg(i % 60);
+
+        searchwidget widget;
+        widget.resize(760, 405);
+        widget.show();
+        QBENCHMARK {
+            widget.displaySearchResults(results);
+            QCoreApplication::processEvents();
+        }
+    }
+
+    // 已有 rows 行时追加一页（30 行）：只插入新行，耗时与已有行数无关
+    void appendPage_data()
+    {
+        QTest::addColumn<int>("rows");
+        QTest::newRow("0") << 0;
+        QTest::newRow("1000") << 1000;
+    }
+
+    void appendPage()
+    {
+        QFETCH(int, rows);
+        QVector<SearchResult> existing(rows);
+        QVector<SearchResult> page(SearchClient::DefaultPageSize);
+        for (int i = 0; i < page.size(); ++i)
+            page[i].title = QString("歌曲%1").arg(i);
+
+        searchwidget widget;
+        widget.resize(760, 405);
+        widget.show();
+        widget.displaySearchResults(existing);
+        QCoreApplication::processEvents();
+        QBENCHMARK {
+            widget.appendSearchResults(page);
+            QCoreApplication::processEvents();
+        }
+    }
+
+    // 以每帧 rowsPerFrame 行的速度滚过 1000 条结果（服务器每个请求延迟 100 ms）：
+    // 第一页到达后，可见末行不应超过已加载的行数；同一页只请求一次，并发不超过上限
+    void scrollThrough_data()
+    {
+        QTest::addColumn<int>("rowsPerFrame");
+        QTest::newRow("1-row/frame") << 1;
+        QTest::newRow("3-rows/frame") << 3;
+    }
+
+    void scrollThrough()
+    {
+        QFETCH(int, rowsPerFrame);
+        const int total = 1000;
+        const int visibleRows = 13;
+        SearchServer server(total, 100);
+        QNetworkAccessManager network;
+        SearchClient client(&network);
+        client.setBaseUrl(server.url());
+
+        int stallFrames = 0;
+        int frames = 0;
+        QBENCHMARK_ONCE {
+            QVERIFY(client.search("周杰伦 & Jay+"));
+            QVERIFY(!client.search("周杰伦 & Jay+"));   // 重复搜索不再请求
+            QTRY_VERIFY_WITH_TIMEOUT(client.loadedRows() > 0, 5000);
+            int row = visibleRows - 1;
+            QElapsedTimer timer;
+            timer.start();
+            while (row < total - 1 && timer.elapsed() < 30000) {
+                QTest::qWait(16);
+                ++frames;
+                if (row >= client.loadedRows()) {
+                    ++stallFrames;
+                    continue;
+                }
+                row = qMin(total - 1, row + rowsPerFrame);
+                client.prefetchFor(row);
+            }
+        }
+        qInfo("frames %d, stall frames %d, requests %d, max concurrent %d",
+              frames, stallFrames, server.requests(), server.maxConcurrent());
+        QCOMPARE(server.lastKeyword(), QString("周杰伦 & Jay+"));
+        QCOMPARE(client.loadedRows(), total);
+        QCOMPARE(server.requests(), (total + SearchClient::DefaultPageSize - 1) / SearchClient::DefaultPageSize);
+        QVERIFY(server.maxConcurrent() <= client.maxConcurrent());
+        QCOMPARE(stallFrames, 0);
+    }
+};
+
+XC_BENCH_MAIN(SearchBench)
+#include "bench_search.moc"
@@ -0,0 +1,255 @@
+#include "benchmain.h"
+#include "../src/search/streamloader.h"
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+// 在线播放加载：本机的替身 HTTP 服务器提供固定内容的夹具文件，
+// 测量开始播放前的等待（冷启动）、缓存命中，并校验回环地址供数和磁盘缓存的内容与淘汰
+namespace {
+const int FixtureBytes = 4 * 1024 * 1024 + 12345;  // 不是整块，末块不满
+
+QByteArray makeFixture()
+{
+    QByteArray content(FixtureBytes, Qt::Uninitialized);
+    quint32 state = 12345;
+    for (char &c : content) {
+        state = state * 1664525u + 1013904223u;
+        c = char(state >> 24);
+    }
+    return content;
+}
+
+// 替身服务器：每个连接处理一个请求；ranges 为 false 时忽略 Range，总是返回整个文件
+class FixtureServer
+{
+public:
+    FixtureServer(const QByteArray &content, bool ranges)
+        : m_content(content)
+        , m_ranges(ranges)
+    {
+        m_server.listen(QHostAddress::LocalHost);
+        QObject::connect(&m_server, &QTcpServer::newConnection, &m_server, [this] {
+            while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+                QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket] { onData(socket); });
+                QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+    }
+
+    QUrl url() const { return QUrl(QString("http://127.0.0.1:%1/fixture.mp3").arg(m_server.serverPort())); }
+    int requests() const { return m_requests; }
+
+private:
+    void onData(QTcpSocket *socket)
+    {
+        const QByteArray request = socket->property("request").toByteArray() + socket->readAll();
+        socket->setProperty("request", request);
+        if (!request.contains("\r\n\r\n") || socket->property("answered").toBool())
+            return;
+        socket->setProperty("answered", true);
+        ++m_requests;
+
+        qint64 first = 0;
+        qint64 last = m_content.size() - 1;
+        QByteArray status = "200 OK";
+        QByteArray extra;
+        const int at = request.toLower().indexOf("range: bytes=");
+        if (m_ranges && at >= 0) {
+            const int start = at + 13;
+            const QList<QByteArray> bounds = request.mid(start, request.indexOf("\r\n", start) - start).split('-');
+            first = bounds.value(0).toLongLong();
+            if (!bounds.value(1).isEmpty())
+                last = qMin(last, bounds.value(1).toLongLong());
+            if (first > last) {
+                socket->write("HTTP/1.1 416 Range Not Satisfiable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+                socket->disconnectFromHost();
+                return;
+            }
+            status = "206 Partial Content";
+            extra = "Content-Range: bytes " + QByteArray::number(first) + "-" + QByteArray::number(last) + "/"
+                    + QByteArray::number(m_content.size()) + "\r\n";
+        }
+        socket->write("HTTP/1.1 " + status + "\r\nContent-Type: audio/mpeg\r\nContent-Length: "
+                      + QByteArray::number(last - first + 1) + "\r\n" + extra + "Connection: close\r\n\r\n");
+        socket->write(m_content.mid(first, last - first + 1));
+        socket->disconnectFromHost();
+    }
+
+    QTcpServer m_server;
+    QByteArray m_content;
+    bool m_ranges;
+    int m_requests = 0;
+};
+
+QByteArray readAll(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+QByteArray httpGet(QNetworkAccessManager &network, const QUrl &url, const QByteArray &range = QByteArray())
+{
+    QNetworkRequest request(url);
+    if (!range.isEmpty())
+        request.setRawHeader("Range", range);
+    QNetworkReply *reply = network.get(request);
+    QSignalSpy done(reply, &QNetworkReply::finished);
+    if (!reply->isFinished())
+        done.wait(10000);
+    const QByteArray data = reply->readAll();
+    reply->deleteLater();
+    return data;
+}
+}
+
+class StreamBench : public QObject
+{
+    Q_OBJECT
+
+private:
+    const QByteArray m_fixture = makeFixture();
+
+private slots:
+    // 从 load() 到 ready()（预缓冲 256 KB）；服务器不支持 Range 时整首一次返回
+    void coldStart_data()
+    {
+        QTest::addColumn<bool>("ranges");
+        QTest::newRow("range") << true;
+        QTest::newRow("no-range") << false;
+    }
+
+    void coldStart()
+    {
+        QFETCH(bool, ranges);
+        FixtureServer server(m_fixture, ranges);
+        QTemporaryDir dir;
+        StreamCache cache(dir.path(), 64 * 1024 * 1024);
+        StreamLoader loader(&cache);
+        QSignalSpy ready(&loader, &StreamLoader::ready);
+        QSignalSpy finished(&loader, &StreamLoader::finished);
+
+        int iteration = 0;
+        QBENCHMARK {
+            loader.load(QString("cold-%1").arg(iteration++), server.url());
+            QVERIFY(ready.wait(5000));
+        }
+
+        // 完整下载一首后，缓存文件应与夹具完全一致
+        loader.load("complete", server.url());
+        QVERIFY(finished.wait(10000));
+        QCOMPARE(readAll(finished.last().at(0).toString()), m_fixture);
+        QVERIFY(cache.contains("complete"));
+        if (ranges)
+            QVERIFY(server.requests() >= iteration + (FixtureBytes + StreamLoader::ChunkBytes - 1) / StreamLoader::ChunkBytes);
+    }
+
+    // 下载中经回环地址读取：随机 Range 与整首，内容应与夹具一致
+    void proxyRead()
+    {
+        FixtureServer server(m_fixture, true);
+        QTemporaryDir dir;
+        StreamCache cache(dir.path(), 64 * 1024 * 1024);
+        StreamLoader loader(&cache);
+        QSignalSpy ready(&loader, &StreamLoader::ready);
+        QSignalSpy finished(&loader, &StreamLoader::finished);
+        loader.load("proxy", server.url());
+        QVERIFY(ready.wait(5000));
+        const QUrl url = ready.last().at(0).toUrl();
+        QCOMPARE(url.host(), QString("127.0.0.1"));
+
+        QNetworkAccessManager network;
+        QCOMPARE(httpGet(network, url, "bytes=1048000-2097999"), m_fixture.mid(1048000, 1050000));
+        QCOMPARE(httpGet(network, url, "bytes=-1000"), m_fixture.right(1000));
+
+        QByteArray whole;
+        QBENCHMARK {
+            whole = httpGet(network, url);
+        }
+        QCOMPARE(whole, m_fixture);
+
+        // 连接全部断开后转入缓存
+        QVERIFY(finished.count() > 0 || finished.wait(5000));
+        QCOMPARE(readAll(cache.lookup("proxy")), m_fixture);
+    }
+
+    // 再次播放：缓存命中直接返回本地文件
+    void cachedReplay()
+    {
+        FixtureServer server(m_fixture, true);
+        QTemporaryDir dir;
+        StreamCache cache(dir.path(), 64 * 1024 * 1024);
+        StreamLoader loader(&cache);
+        QSignalSpy finished(&loader, &StreamLoader::finished);
+        loader.load("replay", server.url());
+        QVERIFY(finished.wait(10000));
+        const int requests = server.requests();
+
+        QSignalSpy ready(&loader, &StreamLoader::ready);
+        QBENCHMARK {
+            loader.load("replay", server.url());
+        }
+        QVERIFY(ready.count() > 0);
+        QVERIFY(ready.last().at(0).toUrl().isLocalFile());
+        QCOMPARE(server.requests(), requests);
+    }
+
+    // 缓存上限为 10 项时提交 30 项：只保留最近使用的
+    void cacheEviction()
+    {
+        const int entryBytes = 100 * 1024;
+        const QByteArray content(entryBytes, 'x');
+        QBENCHMARK {
+            QTemporaryDir dir;
+            StreamCache cache(dir.path(), qint64(entryBytes) * 10);
+            for (int i = 0; i < 30; ++i) {
+                const QString key = QString("track-%1").arg(i);
+                QFile part(cache.partialPath(key, "mp3"));
+                QVERIFY(part.open(QIODevice::WriteOnly));
+                part.write(content);
+                part.close();
+                QVERIFY(cache.commit(key, "mp3"));
+                // 第 0 首一直在听，不应被淘汰
+                QVERIFY(!cache.lookup("track-0").isEmpty());
+            }
+            QCOMPARE(cache.count(), 10);
+            QVERIFY(cache.totalBytes() <= cache.maxBytes());
+            QVERIFY(cache.contains("track-29"));
+            QVERIFY(!cache.contains("track-1"));
+        }
+    }
+
+    // 连续跳过 30 首没下完的歌：临时文件同样计入上限并按最久未使用淘汰，重启后依然如此
+    void partialEviction()
+    {
+        const int partBytes = 100 * 1024;
+        const QByteArray content(partBytes, 'x');
+        QTemporaryDir dir;
+        QBENCHMARK_ONCE {
+            StreamCache cache(dir.path(), qint64(partBytes) * 10);
+            for (int i = 0; i < 30; ++i) {
+                const QString key = QString("skipped-%1").arg(i);
+                cache.beginPartial(key, "mp3");
+                QFile part(cache.partialPath(key, "mp3"));
+                QVERIFY(part.open(QIODevice::WriteOnly));
+                part.write(content);
+                part.close();
+                cache.endPartial(key, "mp3");
+                QVERIFY(cache.totalBytes() <= cache.maxBytes());
+            }
+            QVERIFY(QFile::exists(cache.partialPath("skipped-29", "mp3")));
+            QVERIFY(!QFile::exists(cache.partialPath("skipped-0", "mp3")));
+        }
+        const QStringList parts = QDir(dir.path()).entryList({ "*.part" }, QDir::Files);
+        QCOMPARE(parts.size(), 10);
+
+        StreamCache reopened(dir.path(), qint64(partBytes) * 5);
+        QVERIFY(reopened.totalBytes() <= reopened.maxBytes());
+        QCOMPARE(QDir(dir.path()).entryList({ "*.part" }, QDir::Files).size(), 5);
+    }
+};
+
+XC_BENCH_MAIN(StreamBench)
+#include "bench_stream.moc"
@@ -0,0 +1,99 @@
+#ifndef BENCHMAIN_H
+#define BENCHMAIN_H
+
+#include <QApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QXmlStreamReader>
+#include <QtTest>
+
+// 基准测试公共入口
+// 1. 默认使用 offscreen 平台插件，可在无显示器的机器上运行
+// 2. 正常输出 QTest 文本结果的同时，把 BenchmarkResult 转成 JSON 写入 --json 指定的文件
+//    （默认 <套件名>.json），方便不同版本之间对比
+namespace XcBench {
+
+inline bool writeJson(const QString &suite, const QString &xmlPath, const QString &jsonPath)
+{
+    QFile xmlFile(xmlPath);
+    if (!xmlFile.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonArray results;
+    QString function;
+    QXmlStreamReader xml(&xmlFile);
+    while (!xml.atEnd()) {
+        if (!xml.readNextStartElement())
+            continue;
+        if (xml.name() == QLatin1String("TestFunction")) {
+            function = xml.attributes().value("name").toString();
+        } else if (xml.name() == QLatin1String("BenchmarkResult")) {
+            const QXmlStreamAttributes attrs = xml.attributes();
+            const double value = attrs.value("value").toDouble();
+            const double iterations = attrs.value("iterations").toDouble();
+            QJsonObject result;
+            result["function"] = function;
+            result["tag"] = attrs.value("tag").toString();
+            result["metric"] = attrs.value("metric").toString();
+            result["value"] = value;
+            result["iterations"] = iterations;
+            result["perIteration"] = iterations > 0 ? value / iterations : value;
+            results.append(result);
+        }
+    }
+
+    QJsonObject root;
+    root["suite"] = suite;
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["qtVersion"] = QString::fromLatin1(qVersion());
+    root["buildAbi"] = QSysInfo::buildAbi();
+    root["results"] = results;
+
+    QFile jsonFile(jsonPath);
+    if (!jsonFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    jsonFile.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+template <typename TestObject>
+int run(int argc, char *argv[], const char *suite)
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    // 取出 --json <文件>，其余参数原样交给 QTest
+    QString jsonPath = QString::fromLatin1(suite) + ".json";
+    QStringList args;
+    const QStringList input = app.arguments();
+    for (int i = 0; i < input.size(); ++i) {
+        if (input[i] == "--json" && i + 1 < input.size())
+            jsonPath = input[++i];
+        else
+            args << input[i];
+    }
+
+    QTemporaryDir tempDir;
+    const QString xmlPath = tempDir.filePath("result.xml");
+    args << "-o" << xmlPath + ",xml" << "-o" << "-,txt";
+
+    TestObject test;
+    const int status = QTest::qExec(&test, args);
+    if (!writeJson(QString::fromLatin1(suite), xmlPath, jsonPath))
+        qWarning("failed to write benchmark JSON to %s", qPrintable(jsonPath));
+    return status;
+}
+
+} // namespace XcBench
+
+#define XC_BENCH_MAIN(TestObject) \
+    int main(int argc, char *argv[]) { return XcBench::run<TestObject>(argc, argv, #TestObject); }
+
+#endif // BENCHMAIN_H
@@ -0,0 +1,20 @@
+#include "audioengine.h"
+#include "mediaplayerengine.h"
+#include "streamengine.h"
+#include <QDebug>
+
+AudioEngine *AudioEngine::create(QObject *parent)
+{
+    const QByteArray engine = qgetenv("XC_AUDIO_ENGINE");
+    if (engine != "stream")
+        return new MediaPlayerEngine(parent);
+
+    // XC_AUDIO_BUFFER_MS 设置输出缓冲区长度，XC_AUDIO_LOW_LATENCY=1 开启低延迟模式
+    StreamEngine *stream = new StreamEngine(parent);
+    if (qEnvironmentVariableIsSet("XC_AUDIO_BUFFER_MS"))
+        stream->setBufferDuration(qEnvironmentVariableIntValue("XC_AUDIO_BUFFER_MS"));
+    stream->setLowLatency(qEnvironmentVariableIntValue("XC_AUDIO_LOW_LATENCY") != 0);
+    qDebug() << "Audio engine: stream, buffer" << stream->bufferDuration() << "ms, low latency"
+             << stream->isLowLatency();
+    return stream;
+}
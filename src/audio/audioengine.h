@@ -0,0 +1,68 @@
+#ifndef AUDIOENGINE_H
+#define AUDIOENGINE_H
+
+#include <QAudioBuffer>
+#include <QMediaMetaData>
+#include <QMediaPlayer>
+#include <QObject>
+#include <QUrl>
+
+class Equalizer;
+
+// 播放引擎接口
+// 与 MainWindow 用到的 QMediaPlayer 接口保持一致（状态和媒体状态沿用 QMediaPlayer 的枚举），
+// 界面只依赖这个接口，不关心底层是 QMediaPlayer 还是自己的解码/处理/输出流水线。
+class AudioEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 按环境变量 XC_AUDIO_ENGINE 选择实现：stream 为 StreamEngine，其他（默认）为 QMediaPlayer
+    static AudioEngine *create(QObject *parent = nullptr);
+
+    explicit AudioEngine(QObject *parent = nullptr) : QObject(parent) {}
+
+    virtual const char *name() const = 0;
+
+    virtual QUrl source() const = 0;
+    virtual void setSource(const QUrl &source) = 0;
+
+    virtual QMediaPlayer::PlaybackState playbackState() const = 0;
+    virtual QMediaPlayer::MediaStatus mediaStatus() const = 0;
+    virtual qint64 position() const = 0;
+    virtual qint64 duration() const = 0;
+    virtual QMediaMetaData metaData() const = 0;
+
+    virtual qreal playbackRate() const = 0;
+    virtual void setPlaybackRate(qreal rate) = 0;
+    // 为 true 时播放中改变速率不会卡顿，调用方无需先暂停
+    virtual bool seamlessRateChange() const { return false; }
+
+    // 线性音量 0 ~ 1
+    virtual float volume() const = 0;
+    virtual void setVolume(float volume) = 0;
+    virtual bool isMuted() const = 0;
+    virtual void setMuted(bool muted) = 0;
+
+    // 不支持均衡器的引擎返回 nullptr
+    virtual Equalizer *equalizer() { return nullptr; }
+
+public slots:
+    virtual void play() = 0;
+    virtual void pause() = 0;
+    virtual void stop() = 0;
+    virtual void setPosition(qint64 position) = 0;
+
+signals:
+    void sourceChanged(const QUrl &media);
+    void positionChanged(qint64 position);
+    void durationChanged(qint64 duration);
+    void playbackStateChanged(QMediaPlayer::PlaybackState newState);
+    void mediaStatusChanged(QMediaPlayer::MediaStatus status);
+    void metaDataChanged();
+    void playbackRateChanged(qreal rate);
+    // 正在输出的音频（可能在音频线程发出，接收方应使用 Qt::DirectConnection 且不得阻塞）
+    void audioBufferReceived(const QAudioBuffer &buffer);
+};
+
+#endif // AUDIOENGINE_H
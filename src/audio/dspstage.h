@@ -0,0 +1,35 @@
+#ifndef DSPSTAGE_H
+#define DSPSTAGE_H
+
+#include <vector>
+
+// 交错排列的浮点音频块，在处理链中依次传递
+// 阶段可以原地修改样本，也可以改变帧数（例如变速）；samples 的容量会被重复使用，稳定后不再分配内存
+struct AudioBlock
+{
+    std::vector<float> samples;
+    int channels = 2;
+
+    int frames() const { return channels > 0 ? int(samples.size()) / channels : 0; }
+};
+
+// 音频处理阶段
+// prepare/reset 在音频线程空闲时（开始播放、切歌、跳转）调用，process 在音频线程中调用，不得阻塞或加锁；
+// 界面线程修改参数时应通过原子变量交给 process 读取。
+class DspStage
+{
+public:
+    virtual ~DspStage() = default;
+
+    virtual const char *name() const = 0;
+
+    // 输入格式确定或变化后调用
+    virtual void prepare(int sampleRate, int channels) = 0;
+
+    // 丢弃内部缓存的样本（跳转后调用）
+    virtual void reset() {}
+
+    virtual void process(AudioBlock &block) = 0;
+};
+
+#endif // DSPSTAGE_H
@@ -0,0 +1,325 @@
+#include "equalizer.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define XC_EQ_SSE2 1
+#endif
+
+namespace {
+const int SmoothFrames = 32;            // 系数过渡的小块长度
+const double SmoothTimeSeconds = 0.010;
+const float FlatGainDb = 0.05f;         // 小于这个增益视为 0
+const float SnapDistance = 1e-5f;       // 离目标足够近时直接对齐
+
+bool isIdentity(float b0, float b1, float b2, float a1, float a2)
+{
+    return b0 == 1.0f && b1 == 0.0f && b2 == 0.0f && a1 == 0.0f && a2 == 0.0f;
+}
+}
+
+const std::array<float, Equalizer::BandCount> &Equalizer::defaultFrequencies()
+{
+    static const std::array<float, BandCount> frequencies = {
+        31.0f, 62.0f, 125.0f, 250.0f, 500.0f, 1000.0f, 2000.0f, 4000.0f, 8000.0f, 16000.0f
+    };
+    return frequencies;
+}
+
+Equalizer::Equalizer()
+{
+    for (int i = 0; i < BandCount; ++i) {
+        m_type[i].store(Peaking, std::memory_order_relaxed);
+        m_frequency[i].store(defaultFrequencies()[i], std::memory_order_relaxed);
+        m_gain[i].store(0.0f, std::memory_order_relaxed);
+        m_q[i].store(1.41f, std::memory_order_relaxed);
+    }
+    prepare(44100, 2);
+}
+
+void Equalizer::prepare(int sampleRate, int channels)
+{
+    m_sampleRate = std::max(sampleRate, 8000);
+    m_channels = std::max(channels, 1);
+    m_groups = (m_channels + 3) / 4;
+    m_smoothing = float(1.0 - std::exp(-SmoothFrames / (SmoothTimeSeconds * m_sampleRate)));
+    m_state.assign(size_t(m_groups) * BandCount * 8, 0.0f);
+    // 采样率变了，系数需要重新计算
+    m_appliedVersion = 0;
+    reset();
+}
+
+void Equalizer::reset()
+{
+    // 跳转后信号本来就不连续，直接使用目标系数，不再过渡
+    std::fill(m_state.begin(), m_state.end(), 0.0f);
+    updateTargets();
+    m_current = m_target;
+    m_ramping = false;
+    m_activeCount = 0;
+    for (int b = 0; b < BandCount; ++b) {
+        if (!m_targetFlat[b])
+            m_active[m_activeCount++] = b;
+    }
+    m_bypassed = m_activeCount == 0;
+}
+
+void Equalizer::setBand(int index, const Band &band)
+{
+    if (index < 0 || index >= BandCount)
+        return;
+    m_type[index].store(band.type, std::memory_order_relaxed);
+    m_frequency[index].store(std::max(band.frequency, 10.0f), std::memory_order_relaxed);
+    m_gain[index].store(std::clamp(band.gainDb, -MaxGainDb, MaxGainDb), std::memory_order_relaxed);
+    m_q[index].store(std::clamp(band.q, 0.1f, 10.0f), std::memory_order_relaxed);
+    m_version.fetch_add(1, std::memory_order_release);
+}
+
+void Equalizer::setGain(int index, float gainDb)
+{
+    if (index < 0 || index >= BandCount)
+        return;
+    m_gain[index].store(std::clamp(gainDb, -MaxGainDb, MaxGainDb), std::memory_order_relaxed);
+    m_version.fetch_add(1, std::memory_order_release);
+}
+
+void Equalizer::setGains(const Gains &gains)
+{
+    for (int i = 0; i < BandCount; ++i)
+        m_gain[i].store(std::clamp(gains[i], -MaxGainDb, MaxGainDb), std::memory_order_relaxed);
+    m_version.fetch_add(1, std::memory_order_release);
+}
+
+Equalizer::Band Equalizer::band(int index) const
+{
+    Band band;
+    if (index < 0 || index >= BandCount)
+        return band;
+    band.type = BandType(m_type[index].load(std::memory_order_relaxed));
+    band.frequency = m_frequency[index].load(std::memory_order_relaxed);
+    band.gainDb = m_gain[index].load(std::memory_order_relaxed);
+    band.q = m_q[index].load(std::memory_order_relaxed);
+    return band;
+}
+
+Equalizer::Gains Equalizer::gains() const
+{
+    Gains gains;
+    for (int i = 0; i < BandCount; ++i)
+        gains[i] = m_gain[i].load(std::memory_order_relaxed);
+    return gains;
+}
+
+bool Equalizer::isFlat() const
+{
+    for (int i = 0; i < BandCount; ++i) {
+        if (std::abs(m_gain[i].load(std::memory_order_relaxed)) >= FlatGainDb)
+            return false;
+    }
+    return true;
+}
+
+void Equalizer::updateTargets()
+{
+    m_appliedVersion = m_version.load(std::memory_order_acquire);
+    const double pi = 3.14159265358979323846;
+    for (int b = 0; b < BandCount; ++b) {
+        const float gainDb = m_gain[b].load(std::memory_order_relaxed);
+        m_targetFlat[b] = std::abs(gainDb) < FlatGainDb;
+        if (m_targetFlat[b]) {
+            m_target[b] = Coefficients();
+            continue;
+        }
+
+        // RBJ Audio EQ Cookbook，频率不超过奈奎斯特频率的 0.45 倍
+        const double frequency = std::min<double>(m_frequency[b].load(std::memory_order_relaxed), m_sampleRate * 0.45);
+        const double w0 = 2.0 * pi * frequency / m_sampleRate;
+        const double cosW = std::cos(w0);
+        const double alpha = std::sin(w0) / (2.0 * m_q[b].load(std::memory_order_relaxed));
+        const double a = std::pow(10.0, gainDb / 40.0);
+        double b0, b1, b2, a0, a1, a2;
+        switch (BandType(m_type[b].load(std::memory_order_relaxed))) {
+        case LowShelf: {
+            const double k = 2.0 * std::sqrt(a) * alpha;
+            b0 = a * ((a + 1) - (a - 1) * cosW + k);
+            b1 = 2 * a * ((a - 1) - (a + 1) * cosW);
+            b2 = a * ((a + 1) - (a - 1) * cosW - k);
+            a0 = (a + 1) + (a - 1) * cosW + k;
+            a1 = -2 * ((a - 1) + (a + 1) * cosW);
+            a2 = (a + 1) + (a - 1) * cosW - k;
+            break;
+        }
+        case HighShelf: {
+            const double k = 2.0 * std::sqrt(a) * alpha;
+            b0 = a * ((a + 1) + (a - 1) * cosW + k);
+            b1 = -2 * a * ((a - 1) + (a + 1) * cosW);
+            b2 = a * ((a + 1) + (a - 1) * cosW - k);
+            a0 = (a + 1) - (a - 1) * cosW + k;
+            a1 = 2 * ((a - 1) - (a + 1) * cosW);
+            a2 = (a + 1) - (a - 1) * cosW - k;
+            break;
+        }
+        default:
+            b0 = 1 + alpha * a;
+            b1 = -2 * cosW;
+            b2 = 1 - alpha * a;
+            a0 = 1 + alpha / a;
+            a1 = -2 * cosW;
+            a2 = 1 - alpha / a;
+            break;
+        }
+        Coefficients &target = m_target[b];
+        target.b0 = float(b0 / a0);
+        target.b1 = float(b1 / a0);
+        target.b2 = float(b2 / a0);
+        target.a1 = float(a1 / a0);
+        target.a2 = float(a2 / a0);
+    }
+}
+
+void Equalizer::smooth()
+{
+    if (!m_ramping)
+        return;
+
+    bool ramping = false;
+    m_activeCount = 0;
+    for (int b = 0; b < BandCount; ++b) {
+        Coefficients &c = m_current[b];
+        const Coefficients &t = m_target[b];
+        float *current[5] = { &c.b0, &c.b1, &c.b2, &c.a1, &c.a2 };
+        const float target[5] = { t.b0, t.b1, t.b2, t.a1, t.a2 };
+        float distance = 0.0f;
+        for (int k = 0; k < 5; ++k) {
+            *current[k] += (target[k] - *current[k]) * m_smoothing;
+            distance = std::max(distance, std::abs(target[k] - *current[k]));
+        }
+        if (distance < SnapDistance) {
+            c = t;
+            // 刚回到直通的段清掉状态，以后重新启用时从零开始
+            if (m_targetFlat[b]) {
+                for (int g = 0; g < m_groups; ++g)
+                    std::fill_n(m_state.begin() + (size_t(g) * BandCount + b) * 8, 8, 0.0f);
+            }
+        } else {
+            ramping = true;
+        }
+        if (!isIdentity(c.b0, c.b1, c.b2, c.a1, c.a2))
+            m_active[m_activeCount++] = b;
+    }
+    m_ramping = ramping;
+}
+
+void Equalizer::process(AudioBlock &block)
+{
+    if (block.channels != m_channels)
+        prepare(m_sampleRate, block.channels);
+    if (m_version.load(std::memory_order_acquire) != m_appliedVersion) {
+        updateTargets();
+        m_ramping = true;
+    }
+
+    // 平直且过渡结束：不触碰样本
+    if (!m_ramping && m_activeCount == 0) {
+        m_bypassed = true;
+        return;
+    }
+    m_bypassed = false;
+
+#ifdef XC_EQ_SSE2
+    // 反馈滤波器在静音后会衰减到非规格化数，打开 FTZ/DAZ 避免变慢
+    const unsigned int csr = _mm_getcsr();
+    _mm_setcsr(csr | 0x8040);
+#endif
+    const int frames = block.frames();
+    float *samples = block.samples.data();
+    for (int done = 0; done < frames; done += SmoothFrames) {
+        smooth();
+        if (m_activeCount > 0)
+            runBlock(samples + size_t(done) * m_channels, std::min(SmoothFrames, frames - done));
+    }
+#ifdef XC_EQ_SSE2
+    _mm_setcsr(csr);
+#endif
+}
+
+void Equalizer::runBlock(float *samples, int frames)
+{
+    const int count = m_activeCount;
+    for (int g = 0; g < m_groups; ++g) {
+        const int first = g * 4;
+        const int lanes = std::min(4, m_channels - first);
+        float *state = m_state.data() + size_t(g) * BandCount * 8;
+#ifdef XC_EQ_SSE2
+        // 状态和系数在整个小块中留在寄存器里
+        __m128 z1[BandCount], z2[BandCount];
+        __m128 b0[BandCount], b1[BandCount], b2[BandCount], a1[BandCount], a2[BandCount];
+        for (int k = 0; k < count; ++k) {
+            const int b = m_active[k];
+            const Coefficients &c = m_current[b];
+            z1[k] = _mm_loadu_ps(state + b * 8);
+            z2[k] = _mm_loadu_ps(state + b * 8 + 4);
+            b0[k] = _mm_set1_ps(c.b0);
+            b1[k] = _mm_set1_ps(c.b1);
+            b2[k] = _mm_set1_ps(c.b2);
+            a1[k] = _mm_set1_ps(c.a1);
+            a2[k] = _mm_set1_ps(c.a2);
+        }
+        for (int i = 0; i < frames; ++i) {
+            float *frame = samples + size_t(i) * m_channels + first;
+            __m128 x;
+            alignas(16) float lanesBuffer[4] = {};
+            if (lanes == 4) {
+                x = _mm_loadu_ps(frame);
+            } else if (lanes == 2) {
+                x = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(frame));
+            } else if (lanes == 1) {
+                x = _mm_load_ss(frame);
+            } else {
+                std::copy_n(frame, lanes, lanesBuffer);
+                x = _mm_load_ps(lanesBuffer);
+            }
+            for (int k = 0; k < count; ++k) {
+                // 转置直接 II 型
+                const __m128 y = _mm_add_ps(_mm_mul_ps(b0[k], x), z1[k]);
+                z1[k] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1[k], x), _mm_mul_ps(a1[k], y)), z2[k]);
+                z2[k] = _mm_sub_ps(_mm_mul_ps(b2[k], x), _mm_mul_ps(a2[k], y));
+                x = y;
+            }
+            if (lanes == 4) {
+                _mm_storeu_ps(frame, x);
+            } else if (lanes == 2) {
+                _mm_storel_pi(reinterpret_cast<__m64 *>(frame), x);
+            } else if (lanes == 1) {
+                _mm_store_ss(frame, x);
+            } else {
+                _mm_store_ps(lanesBuffer, x);
+                std::copy_n(lanesBuffer, lanes, frame);
+            }
+        }
+        for (int k = 0; k < count; ++k) {
+            const int b = m_active[k];
+            _mm_storeu_ps(state + b * 8, z1[k]);
+            _mm_storeu_ps(state + b * 8 + 4, z2[k]);
+        }
+#else
+        for (int k = 0; k < count; ++k) {
+            const int b = m_active[k];
+            const Coefficients &c = m_current[b];
+            float *z1 = state + b * 8;
+            float *z2 = z1 + 4;
+            for (int i = 0; i < frames; ++i) {
+                float *frame = samples + size_t(i) * m_channels + first;
+                for (int lane = 0; lane < lanes; ++lane) {
+                    const float x = frame[lane];
+                    const float y = c.b0 * x + z1[lane];
+                    z1[lane] = c.b1 * x - c.a1 * y + z2[lane];
+                    z2[lane] = c.b2 * x - c.a2 * y;
+                    frame[lane] = y;
+                }
+            }
+        }
+#endif
+    }
+}
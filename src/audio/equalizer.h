@@ -0,0 +1,85 @@
+#ifndef EQUALIZER_H
+#define EQUALIZER_H
+
+#include <array>
+#include <atomic>
+#include <vector>
+#include "dspstage.h"
+
+// 10 段参数均衡器
+// 每段一个二阶滤波器（RBJ 公式：峰值/低架/高架），按转置直接 II 型级联。SSE2 下同一帧的最多 4 个声道放在一个向量里
+// 同时计算，状态在每 32 帧的小块内一直留在寄存器中。
+// 参数修改后系数不会突变：每个小块把当前系数向目标系数靠近一步（时间常数约 10 ms），拖动滑块时不会出现咔嗒声。
+// 增益为 0 的段不参与计算；全部为 0 且过渡结束后 process() 直接返回，不触碰样本。
+class Equalizer : public DspStage
+{
+public:
+    static constexpr int BandCount = 10;
+    static constexpr float MaxGainDb = 12.0f;
+
+    enum BandType { Peaking, LowShelf, HighShelf };
+
+    struct Band
+    {
+        BandType type = Peaking;
+        float frequency = 1000.0f;
+        float gainDb = 0.0f;
+        float q = 1.41f;            // 约一个倍频程
+    };
+
+    using Gains = std::array<float, BandCount>;
+
+    // 默认中心频率：31 Hz ~ 16 kHz，每段相差一个倍频程
+    static const std::array<float, BandCount> &defaultFrequencies();
+
+    Equalizer();
+
+    const char *name() const override { return "equalizer"; }
+    void prepare(int sampleRate, int channels) override;
+    void reset() override;
+    void process(AudioBlock &block) override;
+
+    // 以下线程安全，下一个小块开始向新参数过渡
+    void setBand(int index, const Band &band);
+    void setGain(int index, float gainDb);
+    void setGains(const Gains &gains);
+    Band band(int index) const;
+    Gains gains() const;
+    bool isFlat() const;
+
+    // 上一次 process() 是否直接跳过（供测试和基准使用）
+    bool isBypassed() const { return m_bypassed; }
+
+private:
+    struct Coefficients
+    {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+    };
+
+    void updateTargets();
+    void smooth();
+    void runBlock(float *samples, int frames);
+
+    std::array<std::atomic<int>, BandCount> m_type;
+    std::array<std::atomic<float>, BandCount> m_frequency;
+    std::array<std::atomic<float>, BandCount> m_gain;
+    std::array<std::atomic<float>, BandCount> m_q;
+    std::atomic<unsigned> m_version{1};
+
+    // 以下仅在音频线程访问
+    unsigned m_appliedVersion = 0;
+    int m_sampleRate = 44100;
+    int m_channels = 2;
+    int m_groups = 1;                   // 每 4 个声道一组
+    float m_smoothing = 0.0f;           // 每个小块靠近目标的比例
+    std::array<Coefficients, BandCount> m_current;
+    std::array<Coefficients, BandCount> m_target;
+    std::array<bool, BandCount> m_targetFlat;
+    std::array<int, BandCount> m_active;    // 需要计算的段
+    int m_activeCount = 0;
+    bool m_ramping = false;
+    bool m_bypassed = true;
+    std::vector<float> m_state;         // [组][段][z1 四个声道, z2 四个声道]
+};
+
+#endif // EQUALIZER_H
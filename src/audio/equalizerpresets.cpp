@@ -0,0 +1,131 @@
+#include "equalizerpresets.h"
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+struct BuiltinPreset
+{
+    const char *name;
+    float gains[Equalizer::BandCount];
+};
+
+// 31 Hz ~ 16 kHz 各段增益（dB）
+const BuiltinPreset Builtins[] = {
+    { "平直", { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 } },
+    { "摇滚", { 5, 4, 3, 1, -1, -1, 1, 3, 4, 5 } },
+    { "流行", { -1, 1, 3, 4, 3, 0, -1, -1, 0, 1 } },
+    { "爵士", { 3, 2, 1, 2, -1, -1, 0, 1, 2, 3 } },
+    { "古典", { 4, 3, 2, 1, -1, -1, 0, 2, 3, 4 } },
+    { "低音增强", { 6, 5, 4, 2, 0, 0, 0, 0, 0, 0 } },
+    { "人声", { -2, -2, -1, 1, 3, 4, 3, 1, 0, -1 } },
+};
+
+QJsonArray toJson(const Equalizer::Gains &gains)
+{
+    QJsonArray array;
+    for (float gain : gains)
+        array.append(double(gain));
+    return array;
+}
+
+bool fromJson(const QJsonValue &value, Equalizer::Gains *gains)
+{
+    const QJsonArray array = value.toArray();
+    if (array.size() != Equalizer::BandCount)
+        return false;
+    for (int i = 0; i < Equalizer::BandCount; ++i)
+        (*gains)[i] = float(array.at(i).toDouble());
+    return true;
+}
+
+QHash<QString, Equalizer::Gains> mapFromJson(const QJsonObject &object)
+{
+    QHash<QString, Equalizer::Gains> result;
+    for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+        Equalizer::Gains gains;
+        if (fromJson(it.value(), &gains))
+            result.insert(it.key(), gains);
+    }
+    return result;
+}
+
+QJsonObject mapToJson(const QHash<QString, Equalizer::Gains> &map)
+{
+    QJsonObject object;
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it)
+        object.insert(it.key(), toJson(it.value()));
+    return object;
+}
+}
+
+QStringList EqualizerPresets::builtinNames()
+{
+    QStringList names;
+    for (const BuiltinPreset &preset : Builtins)
+        names.append(QString::fromUtf8(preset.name));
+    return names;
+}
+
+EqualizerPresets::Gains EqualizerPresets::builtin(const QString &name)
+{
+    Gains gains {};
+    for (const BuiltinPreset &preset : Builtins) {
+        if (name == QString::fromUtf8(preset.name)) {
+            std::copy(std::begin(preset.gains), std::end(preset.gains), gains.begin());
+            break;
+        }
+    }
+    return gains;
+}
+
+bool EqualizerPresets::load(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("version").toInt() != 1) {
+        qWarning() << "Ignoring equalizer presets with unknown version:" << filePath;
+        return false;
+    }
+
+    Gains defaults {};
+    fromJson(root.value("default"), &defaults);
+    m_default = defaults;
+    m_tracks = mapFromJson(root.value("tracks").toObject());
+    m_playlists = mapFromJson(root.value("playlists").toObject());
+    return true;
+}
+
+bool EqualizerPresets::save(const QString &filePath) const
+{
+    QJsonObject root;
+    root.insert("version", 1);
+    root.insert("default", toJson(m_default));
+    root.insert("tracks", mapToJson(m_tracks));
+    root.insert("playlists", mapToJson(m_playlists));
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(QJsonDocument(root).toJson());
+    return file.commit();
+}
+
+EqualizerPresets::Gains EqualizerPresets::gainsFor(const QString &trackPath, const QString &playlist) const
+{
+    auto track = m_tracks.constFind(trackPath);
+    if (track != m_tracks.constEnd())
+        return track.value();
+    auto list = m_playlists.constFind(playlist);
+    if (!playlist.isEmpty() && list != m_playlists.constEnd())
+        return list.value();
+    return m_default;
+}
@@ -0,0 +1,43 @@
+#ifndef EQUALIZERPRESETS_H
+#define EQUALIZERPRESETS_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include "equalizer.h"
+
+// 均衡器预设
+// 内置若干命名预设；用户的设置可以保存给某首歌、某个歌单或作为默认值，
+// 查找时依次为 歌曲 → 歌单 → 默认。保存为 JSON（equalizer.json）。
+class EqualizerPresets
+{
+public:
+    using Gains = Equalizer::Gains;
+
+    static QStringList builtinNames();
+    // 未知名称返回全 0
+    static Gains builtin(const QString &name);
+
+    bool load(const QString &filePath);
+    bool save(const QString &filePath) const;
+
+    Gains gainsFor(const QString &trackPath, const QString &playlist) const;
+
+    void setTrackGains(const QString &trackPath, const Gains &gains) { m_tracks.insert(trackPath, gains); }
+    void clearTrack(const QString &trackPath) { m_tracks.remove(trackPath); }
+    bool hasTrack(const QString &trackPath) const { return m_tracks.contains(trackPath); }
+
+    void setPlaylistGains(const QString &playlist, const Gains &gains) { m_playlists.insert(playlist, gains); }
+    void clearPlaylist(const QString &playlist) { m_playlists.remove(playlist); }
+    bool hasPlaylist(const QString &playlist) const { return m_playlists.contains(playlist); }
+
+    void setDefaultGains(const Gains &gains) { m_default = gains; }
+    Gains defaultGains() const { return m_default; }
+
+private:
+    QHash<QString, Gains> m_tracks;
+    QHash<QString, Gains> m_playlists;
+    Gains m_default {};
+};
+
+#endif // EQUALIZERPRESETS_H
@@ -0,0 +1,128 @@
+#include "fft.h"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define XC_FFT_SSE2 1
+#endif
+
+WindowedFft::WindowedFft(int size)
+    : m_size(size)
+{
+    const double pi = 3.14159265358979323846;
+
+    // 位反转表
+    int bits = 0;
+    while ((1 << bits) < m_size)
+        ++bits;
+    m_bitReverse.resize(m_size);
+    for (int i = 0; i < m_size; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (1 << b))
+                r |= 1 << (bits - 1 - b);
+        }
+        m_bitReverse[i] = r;
+    }
+
+    // Hann 窗
+    m_window.resize(m_size);
+    for (int i = 0; i < m_size; ++i)
+        m_window[i] = float(0.5 - 0.5 * std::cos(2.0 * pi * i / (m_size - 1)));
+
+    // 每一级的旋转因子连续存放，内层循环可以直接按向量读取
+    m_twiddleRe.resize(m_size);
+    m_twiddleIm.resize(m_size);
+    for (int half = 1; half < m_size; half <<= 1) {
+        for (int k = 0; k < half; ++k) {
+            double angle = -pi * k / half;
+            m_twiddleRe[half - 1 + k] = float(std::cos(angle));
+            m_twiddleIm[half - 1 + k] = float(std::sin(angle));
+        }
+    }
+
+    m_re.resize(m_size);
+    m_im.resize(m_size);
+    m_windowed.resize(m_size);
+}
+
+void WindowedFft::powerSpectrum(const float *input, float *power)
+{
+    // 加窗
+    int i = 0;
+#ifdef XC_FFT_SSE2
+    for (; i + 4 <= m_size; i += 4) {
+        __m128 x = _mm_loadu_ps(input + i);
+        __m128 w = _mm_loadu_ps(m_window.data() + i);
+        _mm_storeu_ps(m_windowed.data() + i, _mm_mul_ps(x, w));
+    }
+#endif
+    for (; i < m_size; ++i)
+        m_windowed[i] = input[i] * m_window[i];
+
+    // 按位反转顺序写入，虚部清零
+    for (i = 0; i < m_size; ++i) {
+        m_re[m_bitReverse[i]] = m_windowed[i];
+        m_im[i] = 0.0f;
+    }
+
+    transform();
+
+    const int bins = m_size / 2 + 1;
+    i = 0;
+#ifdef XC_FFT_SSE2
+    for (; i + 4 <= bins; i += 4) {
+        __m128 re = _mm_loadu_ps(m_re.data() + i);
+        __m128 im = _mm_loadu_ps(m_im.data() + i);
+        _mm_storeu_ps(power + i, _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im)));
+    }
+#endif
+    for (; i < bins; ++i)
+        power[i] = m_re[i] * m_re[i] + m_im[i] * m_im[i];
+}
+
+void WindowedFft::transform()
+{
+    float *re = m_re.data();
+    float *im = m_im.data();
+
+    for (int half = 1; half < m_size; half <<= 1) {
+        const float *wr = m_twiddleRe.data() + half - 1;
+        const float *wi = m_twiddleIm.data() + half - 1;
+        const int len = half << 1;
+
+        for (int start = 0; start < m_size; start += len) {
+            float *aRe = re + start;
+            float *aIm = im + start;
+            float *bRe = aRe + half;
+            float *bIm = aIm + half;
+
+            int k = 0;
+#ifdef XC_FFT_SSE2
+            // 前两级 half < 4，走下面的标量分支
+            for (; k + 4 <= half; k += 4) {
+                __m128 twr = _mm_loadu_ps(wr + k);
+                __m128 twi = _mm_loadu_ps(wi + k);
+                __m128 br = _mm_loadu_ps(bRe + k);
+                __m128 bi = _mm_loadu_ps(bIm + k);
+                __m128 tr = _mm_sub_ps(_mm_mul_ps(br, twr), _mm_mul_ps(bi, twi));
+                __m128 ti = _mm_add_ps(_mm_mul_ps(br, twi), _mm_mul_ps(bi, twr));
+                __m128 ar = _mm_loadu_ps(aRe + k);
+                __m128 ai = _mm_loadu_ps(aIm + k);
+                _mm_storeu_ps(bRe + k, _mm_sub_ps(ar, tr));
+                _mm_storeu_ps(bIm + k, _mm_sub_ps(ai, ti));
+                _mm_storeu_ps(aRe + k, _mm_add_ps(ar, tr));
+                _mm_storeu_ps(aIm + k, _mm_add_ps(ai, ti));
+            }
+#endif
+            for (; k < half; ++k) {
+                float tr = bRe[k] * wr[k] - bIm[k] * wi[k];
+                float ti = bRe[k] * wi[k] + bIm[k] * wr[k];
+                bRe[k] = aRe[k] - tr;
+                bIm[k] = aIm[k] - ti;
+                aRe[k] += tr;
+                aIm[k] += ti;
+            }
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <vector>
+
+// 加窗实数 FFT（基 2，迭代实现）
+// 实部/虚部分开存放（SoA），蝶形运算在 SSE2 可用时每次处理 4 组，
+// 否则退化为标量循环。所有缓冲区在构造时一次性分配，计算过程中不再分配内存。
+class WindowedFft
+{
+public:
+    // size 必须是 2 的幂
+    explicit WindowedFft(int size = 2048);
+
+    int size() const { return m_size; }
+
+    // 对 size 个输入样本加 Hann 窗后做 FFT，输出 size/2 + 1 个功率谱值
+    void powerSpectrum(const float *input, float *power);
+
+private:
+    void transform();
+
+    int m_size;
+    std::vector<int> m_bitReverse;
+    std::vector<float> m_window;
+    std::vector<float> m_twiddleRe;   // 各级旋转因子依次拼接，第 h 级从 h-1 处开始
+    std::vector<float> m_twiddleIm;
+    std::vector<float> m_re;
+    std::vector<float> m_im;
+    std::vector<float> m_windowed;
+};
+
+#endif // FFT_H
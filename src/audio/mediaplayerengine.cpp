@@ -0,0 +1,109 @@
+#include "mediaplayerengine.h"
+#include <QAudioBufferOutput>
+#include <QAudioOutput>
+
+MediaPlayerEngine::MediaPlayerEngine(QObject *parent)
+    : AudioEngine(parent)
+    , m_player(new QMediaPlayer(this))
+    , m_output(new QAudioOutput(this))
+    , m_tap(new QAudioBufferOutput(this))
+{
+    m_player->setAudioOutput(m_output);
+    // 音频分接：播放的同时把解码后的样本交出去（保持媒体原始格式）
+    m_player->setAudioBufferOutput(m_tap);
+
+    connect(m_player, &QMediaPlayer::sourceChanged, this, &AudioEngine::sourceChanged);
+    connect(m_player, &QMediaPlayer::positionChanged, this, &AudioEngine::positionChanged);
+    connect(m_player, &QMediaPlayer::durationChanged, this, &AudioEngine::durationChanged);
+    connect(m_player, &QMediaPlayer::playbackStateChanged, this, &AudioEngine::playbackStateChanged);
+    connect(m_player, &QMediaPlayer::mediaStatusChanged, this, &AudioEngine::mediaStatusChanged);
+    connect(m_player, &QMediaPlayer::metaDataChanged, this, &AudioEngine::metaDataChanged);
+    connect(m_player, &QMediaPlayer::playbackRateChanged, this, &AudioEngine::playbackRateChanged);
+    connect(m_tap, &QAudioBufferOutput::audioBufferReceived, this, &AudioEngine::audioBufferReceived,
+            Qt::DirectConnection);
+}
+
+QUrl MediaPlayerEngine::source() const
+{
+    return m_player->source();
+}
+
+void MediaPlayerEngine::setSource(const QUrl &source)
+{
+    m_player->setSource(source);
+}
+
+QMediaPlayer::PlaybackState MediaPlayerEngine::playbackState() const
+{
+    return m_player->playbackState();
+}
+
+QMediaPlayer::MediaStatus MediaPlayerEngine::mediaStatus() const
+{
+    return m_player->mediaStatus();
+}
+
+qint64 MediaPlayerEngine::position() const
+{
+    return m_player->position();
+}
+
+qint64 MediaPlayerEngine::duration() const
+{
+    return m_player->duration();
+}
+
+QMediaMetaData MediaPlayerEngine::metaData() const
+{
+    return m_player->metaData();
+}
+
+qreal MediaPlayerEngine::playbackRate() const
+{
+    return m_player->playbackRate();
+}
+
+void MediaPlayerEngine::setPlaybackRate(qreal rate)
+{
+    m_player->setPlaybackRate(rate);
+}
+
+float MediaPlayerEngine::volume() const
+{
+    return m_output->volume();
+}
+
+void MediaPlayerEngine::setVolume(float volume)
+{
+    m_output->setVolume(volume);
+}
+
+bool MediaPlayerEngine::isMuted() const
+{
+    return m_output->isMuted();
+}
+
+void MediaPlayerEngine::setMuted(bool muted)
+{
+    m_output->setMuted(muted);
+}
+
+void MediaPlayerEngine::play()
+{
+    m_player->play();
+}
+
+void MediaPlayerEngine::pause()
+{
+    m_player->pause();
+}
+
+void MediaPlayerEngine::stop()
+{
+    m_player->stop();
+}
+
+void MediaPlayerEngine::setPosition(qint64 position)
+{
+    m_player->setPosition(position);
+}
@@ -0,0 +1,47 @@
+#ifndef MEDIAPLAYERENGINE_H
+#define MEDIAPLAYERENGINE_H
+
+#include "audioengine.h"
+
+class QAudioBufferOutput;
+class QAudioOutput;
+
+// 基于 QMediaPlayer + QAudioOutput 的播放引擎（默认），音频分接使用 QAudioBufferOutput
+class MediaPlayerEngine : public AudioEngine
+{
+    Q_OBJECT
+
+public:
+    explicit MediaPlayerEngine(QObject *parent = nullptr);
+
+    const char *name() const override { return "mediaplayer"; }
+
+    QUrl source() const override;
+    void setSource(const QUrl &source) override;
+
+    QMediaPlayer::PlaybackState playbackState() const override;
+    QMediaPlayer::MediaStatus mediaStatus() const override;
+    qint64 position() const override;
+    qint64 duration() const override;
+    QMediaMetaData metaData() const override;
+
+    qreal playbackRate() const override;
+    void setPlaybackRate(qreal rate) override;
+
+    float volume() const override;
+    void setVolume(float volume) override;
+    bool isMuted() const override;
+    void setMuted(bool muted) override;
+
+    void play() override;
+    void pause() override;
+    void stop() override;
+    void setPosition(qint64 position) override;
+
+private:
+    QMediaPlayer *m_player;
+    QAudioOutput *m_output;
+    QAudioBufferOutput *m_tap;
+};
+
+#endif // MEDIAPLAYERENGINE_H
@@ -0,0 +1,93 @@
+#include "playbackclock.h"
+#include <QElapsedTimer>
+#include <cmath>
+
+namespace {
+const double ResyncMs = 250.0;      // 误差超过这个值视为跳转或卡顿，直接对齐
+const double Correction = 0.25;     // 每次报告只修正误差的这一部分，抵消通知的抖动
+}
+
+qint64 PlaybackClock::monotonicNs()
+{
+    static QElapsedTimer timer;
+    if (!timer.isValid())
+        timer.start();
+    return timer.nsecsElapsed();
+}
+
+double PlaybackClock::extrapolate(qint64 nowNs) const
+{
+    if (!m_playing)
+        return m_anchorMs;
+    return m_anchorMs + (nowNs - m_anchorNs) / 1e6 * m_rate;
+}
+
+void PlaybackClock::anchor(double positionMs, qint64 nowNs)
+{
+    m_anchorMs = positionMs;
+    m_anchorNs = nowNs;
+}
+
+void PlaybackClock::reset(qint64 positionMs, qint64 nowNs)
+{
+    anchor(positionMs, nowNs);
+    m_synced = true;
+    m_lastReturned = -1;
+}
+
+void PlaybackClock::update(qint64 reportedMs, qint64 nowNs)
+{
+    const double predicted = extrapolate(nowNs);
+    const double error = reportedMs - predicted;
+    if (!m_synced || !m_playing || std::abs(error) > ResyncMs) {
+        reset(reportedMs, nowNs);
+        return;
+    }
+
+    ++m_driftSamples;
+    m_driftSumMs += std::abs(error);
+    m_driftMaxMs = qMax(m_driftMaxMs, qint64(std::llround(std::abs(error))));
+    anchor(predicted + error * Correction, nowNs);
+}
+
+void PlaybackClock::setPlaying(bool playing, qint64 nowNs)
+{
+    if (playing == m_playing)
+        return;
+    // 暂停时停在外推的位置，继续播放时从该位置重新计时
+    anchor(extrapolate(nowNs), nowNs);
+    m_playing = playing;
+}
+
+void PlaybackClock::setRate(qreal rate, qint64 nowNs)
+{
+    anchor(extrapolate(nowNs), nowNs);
+    m_rate = rate > 0 ? rate : 1.0;
+}
+
+qint64 PlaybackClock::position(qint64 nowNs) const
+{
+    // 输出缓冲中的音频按当前速率播放，延迟换算成媒体时间
+    const double audible = extrapolate(nowNs) - (m_playing ? m_latencyMs * m_rate : 0.0);
+    qint64 result = qMax<qint64>(0, qint64(std::floor(audible)));
+    if (m_playing && result < m_lastReturned && m_lastReturned - result < ResyncMs)
+        result = m_lastReturned;
+    m_lastReturned = result;
+    return result;
+}
+
+PlaybackClock::DriftStats PlaybackClock::driftStats() const
+{
+    DriftStats stats;
+    stats.samples = m_driftSamples;
+    stats.meanAbsMs = m_driftSamples ? m_driftSumMs / m_driftSamples : 0.0;
+    stats.maxAbsMs = m_driftMaxMs;
+    return stats;
+}
+
+void PlaybackClock::resetDriftStats()
+{
+    m_driftSamples = 0;
+    m_driftSumMs = 0;
+    m_driftMaxMs = 0;
+}
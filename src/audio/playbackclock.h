@@ -0,0 +1,68 @@
+#ifndef PLAYBACKCLOCK_H
+#define PLAYBACKCLOCK_H
+
+#include <QtGlobal>
+
+// 播放时钟
+// QMediaPlayer::positionChanged 间隔较粗且到达较晚。时钟在两次通知之间用单调时钟按播放速率外推，
+// 收到新的位置时只把误差的一部分计入（误差过大视为跳转，直接重新对齐），播放中返回的位置不会后退；
+// 返回的是“正在听到的位置”，即减去输出延迟后的位置。
+// 所有接口都有带 nowNs 参数的版本，便于用模拟时间测量漂移。
+class PlaybackClock
+{
+public:
+    struct DriftStats
+    {
+        int samples = 0;
+        double meanAbsMs = 0;
+        qint64 maxAbsMs = 0;
+    };
+
+    static qint64 monotonicNs();
+
+    // 切歌或跳转后重新开始
+    void reset(qint64 positionMs = 0) { reset(positionMs, monotonicNs()); }
+    void reset(qint64 positionMs, qint64 nowNs);
+
+    // 播放器报告的位置
+    void update(qint64 reportedMs) { update(reportedMs, monotonicNs()); }
+    void update(qint64 reportedMs, qint64 nowNs);
+
+    void setPlaying(bool playing) { setPlaying(playing, monotonicNs()); }
+    void setPlaying(bool playing, qint64 nowNs);
+    bool isPlaying() const { return m_playing; }
+
+    void setRate(qreal rate) { setRate(rate, monotonicNs()); }
+    void setRate(qreal rate, qint64 nowNs);
+    qreal rate() const { return m_rate; }
+
+    // 输出设备缓冲造成的延迟（毫秒，按实际时间计）
+    void setOutputLatency(qint64 latencyMs) { m_latencyMs = qMax<qint64>(0, latencyMs); }
+    qint64 outputLatency() const { return m_latencyMs; }
+
+    // 当前听到的位置（毫秒）
+    qint64 position() const { return position(monotonicNs()); }
+    qint64 position(qint64 nowNs) const;
+
+    // 每次 update 时报告位置与外推位置之差的统计
+    DriftStats driftStats() const;
+    void resetDriftStats();
+
+private:
+    double extrapolate(qint64 nowNs) const;
+    void anchor(double positionMs, qint64 nowNs);
+
+    double m_anchorMs = 0;
+    qint64 m_anchorNs = 0;
+    qreal m_rate = 1.0;
+    bool m_playing = false;
+    bool m_synced = false;
+    qint64 m_latencyMs = 0;
+    mutable qint64 m_lastReturned = -1;
+
+    int m_driftSamples = 0;
+    double m_driftSumMs = 0;
+    qint64 m_driftMaxMs = 0;
+};
+
+#endif // PLAYBACKCLOCK_H
@@ -0,0 +1,245 @@
+#include "prefetcher.h"
+#include <QDebug>
+#include <algorithm>
+
+#if defined(Q_OS_LINUX)
+#include <fcntl.h>
+#endif
+
+namespace {
+const int TickMs = 20;
+const qint64 MB = 1024 * 1024;
+const char *const WaitNames[] = { "load", "seek", "buffering" };
+
+qint64 envValue(const char *name, qint64 defaultValue)
+{
+    bool ok = false;
+    const qint64 value = qEnvironmentVariableIntValue(name, &ok);
+    return ok && value >= 0 ? value : defaultValue;
+}
+}
+
+TokenBucket::TokenBucket(qint64 bytesPerSecond, qint64 burstBytes)
+    : m_rate(qMax<qint64>(0, bytesPerSecond))
+    , m_burst(qMax<qint64>(0, burstBytes))
+    , m_tokens(m_burst)
+{
+}
+
+void TokenBucket::refill(qint64 nowNs)
+{
+    const qint64 elapsed = nowNs - m_lastNs;
+    if (elapsed <= 0)
+        return;
+    // 按整数换算，余下不足一个字节的时间留到下次，长时间运行也不会丢令牌
+    const qint64 gained = qint64(double(m_rate) * elapsed / 1e9);
+    if (gained <= 0)
+        return;
+    m_tokens = qMin(m_burst, m_tokens + gained);
+    m_lastNs = m_tokens == m_burst ? nowNs : m_lastNs + qint64(double(gained) * 1e9 / m_rate);
+}
+
+qint64 TokenBucket::available(qint64 nowNs)
+{
+    refill(nowNs);
+    return m_tokens;
+}
+
+bool TokenBucket::tryTake(qint64 bytes, qint64 nowNs)
+{
+    refill(nowNs);
+    if (bytes > m_tokens)
+        return false;
+    m_tokens -= bytes;
+    return true;
+}
+
+Prefetcher::Prefetcher()
+    : QObject(nullptr)
+    , m_enabled(qEnvironmentVariable("XC_PREFETCH") != "0")
+    , m_aheadBytes(envValue("XC_PREFETCH_AHEAD_MB", 8) * MB)
+    , m_nextBytes(envValue("XC_PREFETCH_NEXT_MB", 4) * MB)
+    , m_timer(new QTimer(this))
+    // 突发量为 4 块：空闲之后可以立即读 1 MB，之后按限速进行
+    , m_bucket(envValue("XC_PREFETCH_RATE_KB", 2048) * 1024, qint64(ChunkBytes) * 4)
+    , m_buffer(ChunkBytes)
+{
+    m_clock.start();
+    m_timer->setInterval(TickMs);
+    connect(m_timer, &QTimer::timeout, this, &Prefetcher::tick);
+}
+
+void Prefetcher::setCurrent(const QString &path)
+{
+    if (!m_enabled)
+        return;
+    QMetaObject::invokeMethod(this, [this, path] {
+        // 下一首成为当前歌曲时，已经预读的开头不必再读
+        const qint64 warm = m_next.file.isOpen() && m_next.file.fileName() == path ? m_next.offset : 0;
+        m_next.file.close();
+        if (!open(m_current, path))
+            return;
+        m_current.offset = warm;
+        m_current.limit = qMin(m_current.size, m_aheadBytes);
+        schedule();
+    }, Qt::QueuedConnection);
+}
+
+void Prefetcher::setNext(const QString &path)
+{
+    if (!m_enabled)
+        return;
+    QMetaObject::invokeMethod(this, [this, path] {
+        if (path == m_current.file.fileName() || !open(m_next, path))
+            return;
+        m_next.limit = qMin(m_next.size, m_nextBytes);
+        schedule();
+    }, Qt::QueuedConnection);
+}
+
+void Prefetcher::setPosition(qint64 position, qint64 duration)
+{
+    if (!m_enabled || duration <= 0)
+        return;
+    QMetaObject::invokeMethod(this, [this, position, duration] {
+        if (!m_current.file.isOpen())
+            return;
+        // 按码率恒定估算；可变码率下有偏差，但预读窗口足够宽
+        const qint64 anchor = qBound<qint64>(0, qint64(double(m_current.size) * position / duration), m_current.size);
+        // 向后跳过了已读部分，或向前跳出了窗口，从新位置开始读
+        if (anchor > m_current.offset || anchor + m_aheadBytes < m_current.offset)
+            m_current.offset = anchor;
+        m_current.limit = qMin(m_current.size, anchor + m_aheadBytes);
+        schedule();
+    }, Qt::QueuedConnection);
+}
+
+bool Prefetcher::open(Job &job, const QString &path)
+{
+    if (job.file.isOpen() && job.file.fileName() == path)
+        return true;
+    job.file.close();
+    job.offset = 0;
+    job.limit = 0;
+    if (path.isEmpty())
+        return false;
+    job.file.setFileName(path);
+    if (!job.file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        qWarning() << "Prefetch: cannot open" << path << job.file.errorString();
+        return false;
+    }
+    job.size = job.file.size();
+    return true;
+}
+
+void Prefetcher::schedule()
+{
+    if ((m_current.pending() || m_next.pending()) && !m_timer->isActive())
+        m_timer->start();
+}
+
+void Prefetcher::tick()
+{
+    Job &job = m_current.pending() ? m_current : m_next;
+    if (!job.pending()) {
+        m_timer->stop();
+        return;
+    }
+    const qint64 bytes = qMin<qint64>(ChunkBytes, job.limit - job.offset);
+    if (m_bucket.tryTake(bytes, m_clock.nsecsElapsed()))
+        readChunk(job, bytes);
+}
+
+void Prefetcher::readChunk(Job &job, qint64 bytes)
+{
+    QElapsedTimer timer;
+    timer.start();
+    qint64 got = -1;
+    if (job.file.seek(job.offset))
+        got = job.file.read(m_buffer.data(), bytes);
+    const qint64 elapsedNs = timer.nsecsElapsed();
+
+    if (got <= 0) {
+        // 文件被截断或存储断开，放弃这个文件
+        qWarning() << "Prefetch: read failed" << job.file.fileName() << job.file.errorString();
+        job.file.close();
+        return;
+    }
+    job.offset += got;
+
+#if defined(Q_OS_LINUX)
+    // 提示内核预读下一块：在等待令牌的间隙里请求已经发出，超出限速的部分最多一块
+    if (job.pending())
+        posix_fadvise(job.file.handle(), job.offset, qMin<qint64>(ChunkBytes, job.limit - job.offset), POSIX_FADV_WILLNEED);
+#endif
+
+    m_bytes.fetch_add(got, std::memory_order_relaxed);
+    m_reads.fetch_add(1, std::memory_order_relaxed);
+    m_readNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+    if (elapsedNs >= qint64(SlowReadMs) * 1000000)
+        m_slowReads.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Prefetcher::noteWait(WaitKind kind, qint64 ms)
+{
+    if (kind < 0 || kind >= WaitKindCount || ms < 0)
+        return;
+    AtomicWaits &waits = m_waits[kind];
+    waits.count.fetch_add(1, std::memory_order_relaxed);
+    if (ms < StallThresholdMs)
+        return;
+    waits.stalls.fetch_add(1, std::memory_order_relaxed);
+    waits.stallMs.fetch_add(ms, std::memory_order_relaxed);
+    qint64 max = waits.maxMs.load(std::memory_order_relaxed);
+    while (ms > max && !waits.maxMs.compare_exchange_weak(max, ms, std::memory_order_relaxed)) {
+    }
+}
+
+Prefetcher::Stats Prefetcher::stats() const
+{
+    Stats stats;
+    stats.bytes = m_bytes.load(std::memory_order_relaxed);
+    stats.reads = m_reads.load(std::memory_order_relaxed);
+    stats.slowReads = m_slowReads.load(std::memory_order_relaxed);
+    stats.readMs = m_readNs.load(std::memory_order_relaxed) / 1000000;
+    for (int i = 0; i < WaitKindCount; ++i) {
+        stats.waits[i].count = m_waits[i].count.load(std::memory_order_relaxed);
+        stats.waits[i].stalls = m_waits[i].stalls.load(std::memory_order_relaxed);
+        stats.waits[i].stallMs = m_waits[i].stallMs.load(std::memory_order_relaxed);
+        stats.waits[i].maxMs = m_waits[i].maxMs.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void Prefetcher::resetStats()
+{
+    m_bytes.store(0, std::memory_order_relaxed);
+    m_reads.store(0, std::memory_order_relaxed);
+    m_slowReads.store(0, std::memory_order_relaxed);
+    m_readNs.store(0, std::memory_order_relaxed);
+    for (AtomicWaits &waits : m_waits) {
+        waits.count.store(0, std::memory_order_relaxed);
+        waits.stalls.store(0, std::memory_order_relaxed);
+        waits.stallMs.store(0, std::memory_order_relaxed);
+        waits.maxMs.store(0, std::memory_order_relaxed);
+    }
+}
+
+void Prefetcher::reportStats()
+{
+    const Stats current = stats();
+    bool any = current.reads > 0;
+    for (const WaitStats &waits : current.waits)
+        any = any || waits.count > 0;
+    if (!any)
+        return;
+    qDebug().nospace() << "Prefetch: " << (m_enabled ? "" : "(disabled) ") << current.bytes / 1024 << " KB in "
+                       << current.reads << " reads, " << current.slowReads << " cold, " << current.readMs << " ms";
+    for (int i = 0; i < WaitKindCount; ++i) {
+        const WaitStats &waits = current.waits[i];
+        if (waits.count > 0)
+            qDebug().nospace() << "  " << WaitNames[i] << " waits: " << waits.count << ", stalls: " << waits.stalls
+                               << ", stall time: " << waits.stallMs << " ms, max: " << waits.maxMs << " ms";
+    }
+    resetStats();
+}
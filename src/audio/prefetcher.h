@@ -0,0 +1,127 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+#include <QTimer>
+#include <atomic>
+#include <vector>
+
+// 令牌桶：以 bytesPerSecond 积累令牌，最多积累 burstBytes，创建时是满的
+// 接口带 nowNs 参数（单调时钟，从 0 开始计），便于用模拟时间验证
+class TokenBucket
+{
+public:
+    TokenBucket(qint64 bytesPerSecond, qint64 burstBytes);
+
+    // 令牌足够时扣除并返回 true，否则不扣除
+    bool tryTake(qint64 bytes, qint64 nowNs);
+    qint64 available(qint64 nowNs);
+
+private:
+    void refill(qint64 nowNs);
+
+    qint64 m_rate;
+    qint64 m_burst;
+    qint64 m_tokens;
+    qint64 m_lastNs = 0;
+};
+
+// 预读器
+// 音乐放在 SMB/NFS 等慢速存储上时，冷文件的打开和跳转会卡住。预读器在独立工作线程中分块读取
+// 当前歌曲播放位置之后的一段和下一首的开头，把数据提前读进系统页缓存，播放器随后的读取直接命中缓存。
+// 读取速度受令牌桶限制，不会与播放本身争抢带宽；当前歌曲优先，读够之后才预读下一首。
+// 同时统计加载、跳转和播放中缓冲造成的等待（卡顿次数和时间），用于对比预读的效果。
+class Prefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum WaitKind { LoadWait, SeekWait, BufferWait, WaitKindCount };
+
+    struct WaitStats
+    {
+        qint64 count = 0;       // 全部等待
+        qint64 stalls = 0;      // 超过 StallThresholdMs 的等待
+        qint64 stallMs = 0;
+        qint64 maxMs = 0;
+    };
+
+    struct Stats
+    {
+        qint64 bytes = 0;       // 预读的字节数
+        qint64 reads = 0;
+        qint64 slowReads = 0;   // 单块读取超过 SlowReadMs，说明数据原本不在缓存中
+        qint64 readMs = 0;
+        WaitStats waits[WaitKindCount];
+    };
+
+    static constexpr int ChunkBytes = 256 * 1024;
+    static constexpr int SlowReadMs = 20;
+    static constexpr int StallThresholdMs = 100;
+
+    // 预读器会被移动到工作线程，因此不接受父对象
+    // 环境变量：XC_PREFETCH=0 关闭预读（等待统计照常），XC_PREFETCH_RATE_KB 限速（默认 2048 KB/s），
+    // XC_PREFETCH_AHEAD_MB 当前歌曲预读量（默认 8 MB），XC_PREFETCH_NEXT_MB 下一首预读量（默认 4 MB）
+    Prefetcher();
+
+    bool isEnabled() const { return m_enabled; }
+
+    // 以下接口线程安全，在工作线程中排队执行
+    void setCurrent(const QString &path);
+    void setNext(const QString &path);
+    // 按 位置/时长 估算文件中的字节偏移，保持其后 ahead 字节在缓存中
+    void setPosition(qint64 position, qint64 duration);
+
+    // 线程安全：记录一次等待（毫秒）
+    void noteWait(WaitKind kind, qint64 ms);
+    Stats stats() const;
+    void resetStats();
+    // 输出统计后清零（XC_PREFETCH_STATS）
+    void reportStats();
+
+private:
+    struct Job
+    {
+        QFile file;
+        qint64 size = 0;
+        qint64 offset = 0;      // 下一块的起点
+        qint64 limit = 0;       // 读到这里为止
+
+        bool pending() const { return file.isOpen() && offset < limit; }
+    };
+
+    bool open(Job &job, const QString &path);
+    void schedule();
+    void tick();
+    void readChunk(Job &job, qint64 bytes);
+
+    const bool m_enabled;
+    qint64 m_aheadBytes;
+    qint64 m_nextBytes;
+
+    // 以下成员仅在工作线程中访问
+    QTimer *m_timer;
+    QElapsedTimer m_clock;
+    TokenBucket m_bucket;
+    Job m_current;
+    Job m_next;
+    std::vector<char> m_buffer;
+
+    // 统计，任意线程读写
+    std::atomic<qint64> m_bytes{0};
+    std::atomic<qint64> m_reads{0};
+    std::atomic<qint64> m_slowReads{0};
+    std::atomic<qint64> m_readNs{0};
+    struct AtomicWaits
+    {
+        std::atomic<qint64> count{0};
+        std::atomic<qint64> stalls{0};
+        std::atomic<qint64> stallMs{0};
+        std::atomic<qint64> maxMs{0};
+    };
+    AtomicWaits m_waits[WaitKindCount];
+};
+
+#endif // PREFETCHER_H
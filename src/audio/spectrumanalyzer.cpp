@@ -0,0 +1,209 @@
+#include "spectrumanalyzer.h"
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+const int ScratchFrames = 1024;     // 生产者每次下混的帧数
+const float MinDb = -70.0f;         // 显示的动态范围下限
+const float DecayFactor = 0.85f;    // 每帧衰减系数，柱子缓慢回落
+const float MinFrequency = 40.0f;
+const float MaxFrequency = 16000.0f;
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer()
+    : QObject(nullptr)
+    , m_ring(FftSize * 8)
+    , m_producerScratch(ScratchFrames)
+    , m_timer(new QTimer(this))
+    , m_fft(FftSize)
+    , m_history(FftSize, 0.0f)
+    , m_power(FftSize / 2 + 1, 0.0f)
+    , m_bands(BandCount, 0.0f)
+    , m_reportStats(qEnvironmentVariableIsSet("XC_SPECTRUM_STATS"))
+{
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->setInterval(16);
+    connect(m_timer, &QTimer::timeout, this, &SpectrumAnalyzer::processFrame);
+}
+
+void SpectrumAnalyzer::pushSamples(const float *interleaved, int frames, int channels, int sampleRate)
+{
+    if (!m_active.load(std::memory_order_relaxed) || channels <= 0 || frames <= 0)
+        return;
+
+    m_sampleRate.store(sampleRate, std::memory_order_relaxed);
+
+    // 下混为单声道后写入环形缓冲区；缓冲区满时直接丢弃，绝不阻塞音频线程
+    const float scale = 1.0f / channels;
+    while (frames > 0) {
+        int chunk = std::min(frames, ScratchFrames);
+        for (int i = 0; i < chunk; ++i) {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; ++c)
+                sum += interleaved[i * channels + c];
+            m_producerScratch[i] = sum * scale;
+        }
+        m_ring.push(m_producerScratch.data(), chunk);
+        interleaved += chunk * channels;
+        frames -= chunk;
+    }
+}
+
+void SpectrumAnalyzer::pushBuffer(const QAudioBuffer &buffer)
+{
+    if (!m_active.load(std::memory_order_relaxed) || !buffer.isValid())
+        return;
+
+    const QAudioFormat format = buffer.format();
+    const int channels = format.channelCount();
+    const int frames = int(buffer.frameCount());
+    const int sampleRate = format.sampleRate();
+
+    if (format.sampleFormat() == QAudioFormat::Float) {
+        pushSamples(buffer.constData<float>(), frames, channels, sampleRate);
+        return;
+    }
+
+    // 整数格式先逐块转换成浮点
+    std::vector<float> &converted = m_convertScratch;
+    converted.resize(size_t(frames) * channels);
+    const int samples = frames * channels;
+    switch (format.sampleFormat()) {
+    case QAudioFormat::Int16: {
+        const qint16 *data = buffer.constData<qint16>();
+        for (int i = 0; i < samples; ++i)
+            converted[i] = data[i] / 32768.0f;
+        break;
+    }
+    case QAudioFormat::Int32: {
+        const qint32 *data = buffer.constData<qint32>();
+        for (int i = 0; i < samples; ++i)
+            converted[i] = float(data[i] / 2147483648.0);
+        break;
+    }
+    case QAudioFormat::UInt8: {
+        const quint8 *data = buffer.constData<quint8>();
+        for (int i = 0; i < samples; ++i)
+            converted[i] = (data[i] - 128) / 128.0f;
+        break;
+    }
+    default:
+        return;
+    }
+    pushSamples(converted.data(), frames, channels, sampleRate);
+}
+
+void SpectrumAnalyzer::setActive(bool active)
+{
+    m_active.store(active, std::memory_order_relaxed);
+    QMetaObject::invokeMethod(this, [this, active]() {
+        if (active) {
+            m_timer->start();
+        } else {
+            m_timer->stop();
+            // 丢弃残留数据，重新激活时不会显示过期的频谱
+            m_ring.discard(m_ring.readAvailable());
+            std::fill(m_history.begin(), m_history.end(), 0.0f);
+            std::fill(m_bands.begin(), m_bands.end(), 0.0f);
+            m_silent = true;
+        }
+    }, Qt::QueuedConnection);
+}
+
+void SpectrumAnalyzer::setFrameInterval(int msec)
+{
+    QMetaObject::invokeMethod(this, [this, msec]() {
+        m_timer->setInterval(std::max(1, msec));
+    }, Qt::QueuedConnection);
+}
+
+void SpectrumAnalyzer::updateBandLayout(int sampleRate)
+{
+    // 频段按对数间隔划分，低频段至少包含一个频点
+    m_bandStart.assign(BandCount, 0);
+    m_bandEnd.assign(BandCount, 0);
+    const int maxBin = FftSize / 2;
+    const float binWidth = float(sampleRate) / FftSize;
+    const float topFrequency = std::min(MaxFrequency, sampleRate / 2.0f);
+    const float ratio = std::pow(topFrequency / MinFrequency, 1.0f / BandCount);
+
+    float low = MinFrequency;
+    int previousEnd = 1;
+    for (int b = 0; b < BandCount; ++b) {
+        float high = low * ratio;
+        int start = std::max(previousEnd, int(low / binWidth));
+        int end = std::max(start + 1, int(high / binWidth));
+        start = std::min(start, maxBin);
+        end = std::min(end, maxBin + 1);
+        m_bandStart[b] = start;
+        m_bandEnd[b] = end;
+        previousEnd = end;
+        low = high;
+    }
+    m_layoutSampleRate = sampleRate;
+}
+
+void SpectrumAnalyzer::processFrame()
+{
+    QElapsedTimer cost;
+    cost.start();
+
+    // 积压过多时只保留最新的一个窗口，保证显示与声音同步
+    size_t available = m_ring.readAvailable();
+    if (available > size_t(FftSize))
+        available -= m_ring.discard(available - FftSize);
+
+    if (available == 0) {
+        if (m_silent)
+            return;
+        // 没有新数据（暂停/停止）：让柱子自然回落后停止发送
+        bool anyVisible = false;
+        for (float &band : m_bands) {
+            band *= DecayFactor;
+            if (band < 0.01f)
+                band = 0.0f;
+            anyVisible = anyVisible || band > 0.0f;
+        }
+        m_silent = !anyVisible;
+        emit spectrumReady(m_bands);
+        return;
+    }
+
+    // 滑动窗口：左移旧数据，追加新数据
+    const int count = int(available);
+    std::memmove(m_history.data(), m_history.data() + count, sizeof(float) * (FftSize - count));
+    m_ring.pop(m_history.data() + FftSize - count, count);
+
+    const int sampleRate = m_sampleRate.load(std::memory_order_relaxed);
+    if (sampleRate != m_layoutSampleRate)
+        updateBandLayout(sampleRate);
+
+    m_fft.powerSpectrum(m_history.data(), m_power.data());
+
+    // 满幅正弦波经 Hann 窗后的峰值功率约为 (N/4)^2，以此作为 0 dB 参考
+    const float reference = float(FftSize) * FftSize / 16.0f;
+    for (int b = 0; b < BandCount; ++b) {
+        float sum = 0.0f;
+        for (int i = m_bandStart[b]; i < m_bandEnd[b]; ++i)
+            sum += m_power[i];
+        float mean = sum / std::max(1, m_bandEnd[b] - m_bandStart[b]);
+        float db = 10.0f * std::log10(mean / reference + 1e-12f);
+        float level = std::clamp((db - MinDb) / -MinDb, 0.0f, 1.0f);
+        m_bands[b] = std::max(level, m_bands[b] * DecayFactor);
+    }
+    m_silent = false;
+    emit spectrumReady(m_bands);
+
+    if (m_reportStats) {
+        m_costNs += cost.nsecsElapsed();
+        if (++m_costFrames >= 600) {
+            qDebug() << "Spectrum FFT cost per frame (us):" << m_costNs / 1000.0 / m_costFrames
+                     << "interval (ms):" << m_timer->interval();
+            m_costNs = 0;
+            m_costFrames = 0;
+        }
+    }
+}
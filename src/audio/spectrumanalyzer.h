@@ -0,0 +1,74 @@
+#ifndef SPECTRUMANALYZER_H
+#define SPECTRUMANALYZER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <QAudioBuffer>
+#include <atomic>
+#include <vector>
+#include "fft.h"
+#include "spscringbuffer.h"
+
+// 频谱分析器
+// 音频分接端（播放器回调所在线程）通过 pushSamples()/pushBuffer() 把样本写入无锁环形缓冲区，
+// 分析器自身运行在独立的工作线程中，按显示帧率取样、加窗 FFT 并折算成若干频段，
+// 结果通过 spectrumReady 信号交给界面线程绘制。未激活时生产者直接丢弃样本，定时器也停止。
+class SpectrumAnalyzer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int BandCount = 32;
+    static constexpr int FftSize = 2048;
+
+    // 分析器会被移动到工作线程，因此不接受父对象
+    SpectrumAnalyzer();
+
+    // 生产者接口：交错排列的浮点样本，可在任意单一线程调用
+    void pushSamples(const float *interleaved, int frames, int channels, int sampleRate);
+
+    // 线程安全：开启/关闭分析（关闭后不再消耗 CPU）
+    void setActive(bool active);
+    bool isActive() const { return m_active.load(std::memory_order_relaxed); }
+
+    // 线程安全：设置刷新间隔（毫秒），一般取显示器刷新周期
+    void setFrameInterval(int msec);
+
+public slots:
+    // 接收 QAudioBufferOutput 的分接数据，应以 Qt::DirectConnection 连接
+    void pushBuffer(const QAudioBuffer &buffer);
+
+signals:
+    void spectrumReady(const QVector<float> &bands);
+
+private slots:
+    void processFrame();
+
+private:
+    void updateBandLayout(int sampleRate);
+
+    SpscRingBuffer<float> m_ring;
+    std::atomic<bool> m_active{false};
+    std::atomic<int> m_sampleRate{44100};
+    std::vector<float> m_producerScratch;   // 以下两个缓冲区仅生产者线程使用
+    std::vector<float> m_convertScratch;
+
+    // 以下成员仅在工作线程中访问
+    QTimer *m_timer;
+    WindowedFft m_fft;
+    std::vector<float> m_history;
+    std::vector<float> m_power;
+    std::vector<int> m_bandStart;
+    std::vector<int> m_bandEnd;
+    QVector<float> m_bands;
+    int m_layoutSampleRate = 0;
+    bool m_silent = true;
+
+    // CPU 开销统计（设置环境变量 XC_SPECTRUM_STATS 后定期输出）
+    bool m_reportStats;
+    qint64 m_costNs = 0;
+    int m_costFrames = 0;
+};
+
+#endif // SPECTRUMANALYZER_H
@@ -0,0 +1,101 @@
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// 单生产者/单消费者无锁环形缓冲区
+// 生产者线程只写 m_head，消费者线程只写 m_tail，两端各自用 acquire/release 同步，
+// 不需要任何互斥锁。容量会向上取整为 2 的幂，方便用掩码代替取模。
+template <typename T>
+class SpscRingBuffer
+{
+public:
+    explicit SpscRingBuffer(size_t capacity = 0)
+    {
+        reset(capacity);
+    }
+
+    SpscRingBuffer(const SpscRingBuffer &) = delete;
+    SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+
+    // 重新分配容量（只能在两端都空闲时调用）
+    void reset(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity)
+            size <<= 1;
+        m_buffer.assign(size, T());
+        m_mask = size - 1;
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return m_buffer.size(); }
+
+    // 当前可读元素数量（消费者调用）
+    size_t readAvailable() const
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_relaxed);
+    }
+
+    // 当前可写空间（生产者调用）
+    size_t writeAvailable() const
+    {
+        return m_buffer.size() - (m_head.load(std::memory_order_relaxed) - m_tail.load(std::memory_order_acquire));
+    }
+
+    // 写入最多 count 个元素，返回实际写入数量；空间不足时丢弃多余数据而不是阻塞
+    size_t push(const T *data, size_t count)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        const size_t space = m_buffer.size() - (head - tail);
+        if (count > space)
+            count = space;
+
+        for (size_t i = 0; i < count; ++i)
+            m_buffer[(head + i) & m_mask] = data[i];
+
+        m_head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // 读出最多 count 个元素，返回实际读出数量
+    size_t pop(T *data, size_t count)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        const size_t available = head - tail;
+        if (count > available)
+            count = available;
+
+        for (size_t i = 0; i < count; ++i)
+            data[i] = m_buffer[(tail + i) & m_mask];
+
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // 丢弃最多 count 个元素（消费者调用），用于跳过积压的旧数据
+    size_t discard(size_t count)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        const size_t available = head - tail;
+        if (count > available)
+            count = available;
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    std::vector<T> m_buffer;
+    size_t m_mask = 0;
+    // 分开放在不同缓存行，避免生产者和消费者互相伪共享
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+};
+
+#endif // SPSCRINGBUFFER_H
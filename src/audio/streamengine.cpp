@@ -0,0 +1,825 @@
+#include "streamengine.h"
+#include "dspstage.h"
+#include "equalizer.h"
+#include "spscringbuffer.h"
+#include "timestretch.h"
+#include "../library/tagreader.h"
+#include <QAudioDecoder>
+#include <QAudioDevice>
+#include <QAudioSink>
+#include <QDebug>
+#include <QIODevice>
+#include <QMediaDevices>
+#include <QMetaMethod>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace {
+const size_t RingCapacity = 1 << 18;    // 浮点样本数，48 kHz 立体声约 2.7 秒
+const size_t MarkerCapacity = 1024;
+const int NormalAheadMs = 500;          // 环形缓冲区预读长度
+const int LowLatencyAheadMs = 40;
+const int LowLatencyBufferMs = 20;
+const int NormalPumpMs = 10;            // 解码线程检查缓冲区的间隔
+const int LowLatencyPumpMs = 2;
+const int PollIntervalMs = 50;          // 位置通知间隔
+
+// 解码器没有按请求输出浮点时在这里转换
+void toFloat(const QAudioBuffer &buffer, std::vector<float> &out)
+{
+    const QAudioFormat format = buffer.format();
+    const int samples = int(buffer.frameCount()) * format.channelCount();
+    out.resize(size_t(samples));
+    switch (format.sampleFormat()) {
+    case QAudioFormat::Float:
+        std::copy_n(buffer.constData<float>(), samples, out.begin());
+        break;
+    case QAudioFormat::Int16: {
+        const qint16 *data = buffer.constData<qint16>();
+        for (int i = 0; i < samples; ++i)
+            out[i] = data[i] / 32768.0f;
+        break;
+    }
+    case QAudioFormat::Int32: {
+        const qint32 *data = buffer.constData<qint32>();
+        for (int i = 0; i < samples; ++i)
+            out[i] = float(data[i] / 2147483648.0);
+        break;
+    }
+    case QAudioFormat::UInt8: {
+        const quint8 *data = buffer.constData<quint8>();
+        for (int i = 0; i < samples; ++i)
+            out[i] = (data[i] - 128) / 128.0f;
+        break;
+    }
+    default:
+        out.clear();
+        break;
+    }
+}
+}
+
+// 解码线程与输出线程共享的状态，只通过原子变量和无锁队列访问
+struct StreamShared
+{
+    // 输出帧与音源时间的对应关系：一个处理后的块共 frames 帧，覆盖音源 spanUs，
+    // 输出到第 endFrame 帧（自上次清空起）时音源时间为 endUs。变速后两者不再一一对应，需要按块换算
+    struct Marker
+    {
+        quint64 endFrame = 0;
+        qint64 endUs = 0;
+        qint64 spanUs = 0;
+        quint32 frames = 0;
+    };
+
+    SpscRingBuffer<float> ring{RingCapacity};
+    SpscRingBuffer<Marker> markers{MarkerCapacity};
+
+    std::atomic<int> requestedEpoch{0};     // 解码线程：已停止写入旧数据，请求清空
+    std::atomic<int> flushedEpoch{0};       // 输出线程：已清空，可以写入该序号的数据
+    std::atomic<int> endEpoch{-1};          // 解码线程：该序号的数据已全部写入
+    std::atomic<int> drainedEpoch{-1};      // 输出线程：该序号的数据已全部取走
+    std::atomic<int> formatEpoch{-1};       // 解码线程：该序号的流格式已确定
+    std::atomic<int> sampleRate{0};
+    std::atomic<int> channels{0};
+    std::atomic<int> positionEpoch{-1};     // 输出线程：playedUs 属于哪个序号
+    std::atomic<qint64> playedUs{0};        // 输出线程最近取走的一帧对应的音源时间
+    std::atomic<qint64> sinkLatencyUs{0};   // 输出设备缓冲区长度
+    std::atomic<int> aheadMs{NormalAheadMs};
+    std::atomic<float> gain{1.0f};
+    std::atomic<bool> tapEnabled{false};
+    std::atomic<quint64> underruns{0};
+    std::atomic<quint64> silentFrames{0};
+    std::atomic<quint64> droppedMarkers{0};
+};
+
+// 解码与 DSP，运行在解码线程
+class StreamDecoder : public QObject
+{
+public:
+    StreamDecoder(StreamShared *shared, const QAudioFormat &format)
+        : m_shared(shared)
+        , m_format(format)
+    {
+    }
+
+    std::function<void(int epoch, qint64 durationMs)> onDuration;
+    std::function<void(int epoch, const QString &message)> onError;
+
+    // 以下均在解码线程调用
+    void init()
+    {
+        m_decoder = new QAudioDecoder(this);
+        m_decoder->setAudioFormat(m_format);
+        m_pump = new QTimer(this);
+        m_pump->setTimerType(Qt::PreciseTimer);
+        m_pump->setInterval(NormalPumpMs);
+        connect(m_pump, &QTimer::timeout, this, &StreamDecoder::pump);
+        connect(m_decoder, &QAudioDecoder::bufferReady, this, &StreamDecoder::pump);
+        connect(m_decoder, &QAudioDecoder::finished, this, [this] {
+            // 重新开始解码后才送达的上一次的结束通知不算
+            if (m_decoder->isDecoding())
+                return;
+            m_finished = true;
+            pump();
+        });
+        connect(m_decoder, &QAudioDecoder::durationChanged, this, [this](qint64 duration) {
+            onDuration(m_epoch, duration);
+        });
+        connect(m_decoder, QOverload<QAudioDecoder::Error>::of(&QAudioDecoder::error), this, [this] {
+            m_pump->stop();
+            onError(m_epoch, m_decoder->errorString());
+        });
+    }
+
+    void setPumpInterval(int milliseconds) { m_pump->setInterval(milliseconds); }
+
+    void addStage(DspStage *stage)
+    {
+        m_stages.emplace_back(stage);
+        if (m_rate > 0)
+            stage->prepare(m_rate, m_channels);
+    }
+
+    void load(const QUrl &source, qint64 startUs, int epoch)
+    {
+        // 换歌、向后跳转或已经解码完时从头开始，向前跳转只需继续丢弃
+        if (source != m_source || startUs < m_decodedUs || m_finished || !m_decoder->isDecoding()) {
+            m_decoder->stop();
+            if (source != m_source) {
+                m_decoder->setSource(source);
+                m_source = source;
+            }
+            m_decodedUs = 0;
+            m_finished = false;
+            if (!source.isEmpty())
+                m_decoder->start();
+        }
+
+        m_epoch = epoch;
+        m_skipUntilUs = startUs;
+        m_pending.clear();
+        m_pendingOffset = 0;
+        m_markerPending = false;
+        m_queuedFrames = 0;
+        m_formatAnnounced = false;
+        for (const std::unique_ptr<DspStage> &stage : m_stages)
+            stage->reset();
+
+        // 从这里起不再写入旧数据，请输出线程丢弃缓冲区中剩下的
+        m_shared->requestedEpoch.store(epoch, std::memory_order_release);
+        if (source.isEmpty())
+            m_pump->stop();
+        else
+            m_pump->start();
+    }
+
+private:
+    void pump()
+    {
+        // 输出线程确认清空之前只解码（跳过目标之前的数据、确定格式），处理好的一块先留着不写入
+        const bool flushed = m_shared->flushedEpoch.load(std::memory_order_acquire) == m_epoch;
+        while (!flushed || flushPending()) {
+            if (m_pendingOffset < m_pending.size() || !m_decoder->bufferAvailable())
+                break;
+            decodeNext();
+        }
+
+        if (flushed && m_finished && m_pendingOffset == m_pending.size() && !m_decoder->bufferAvailable()) {
+            m_shared->endEpoch.store(m_epoch, std::memory_order_release);
+            m_pump->stop();
+        }
+    }
+
+    void decodeNext()
+    {
+        const QAudioBuffer buffer = m_decoder->read();
+        if (!buffer.isValid())
+            return;
+
+        const QAudioFormat format = buffer.format();
+        const int rate = format.sampleRate();
+        const int channels = format.channelCount();
+        const qint64 startUs = buffer.startTime();
+        const qint64 endUs = startUs + buffer.duration();
+        m_decodedUs = endUs;
+        if (endUs <= m_skipUntilUs || rate <= 0 || channels <= 0)
+            return;
+
+        if (rate != m_rate || channels != m_channels) {
+            m_rate = rate;
+            m_channels = channels;
+            m_formatAnnounced = false;
+            for (const std::unique_ptr<DspStage> &stage : m_stages)
+                stage->prepare(rate, channels);
+        }
+        if (!m_formatAnnounced) {
+            m_shared->channels.store(channels, std::memory_order_relaxed);
+            m_shared->sampleRate.store(rate, std::memory_order_relaxed);
+            m_shared->formatEpoch.store(m_epoch, std::memory_order_release);
+            m_formatAnnounced = true;
+        }
+
+        AudioBlock &block = m_block;
+        block.channels = channels;
+        toFloat(buffer, block.samples);
+
+        // 跳转目标落在这一块中间时丢掉前面的部分
+        qint64 firstUs = startUs;
+        if (startUs < m_skipUntilUs) {
+            const qint64 skip = qMin<qint64>(block.frames(), (m_skipUntilUs - startUs) * rate / 1000000);
+            block.samples.erase(block.samples.begin(), block.samples.begin() + skip * channels);
+            firstUs = m_skipUntilUs;
+        }
+
+        for (const std::unique_ptr<DspStage> &stage : m_stages)
+            stage->process(block);
+
+        const int frames = block.frames();
+        if (frames == 0)
+            return;
+
+        m_marker.endFrame = m_queuedFrames + frames;
+        m_marker.endUs = endUs;
+        m_marker.spanUs = endUs - firstUs;
+        m_marker.frames = quint32(frames);
+        m_markerPending = true;
+        m_queuedFrames += frames;
+
+        m_pending.swap(block.samples);
+        m_pendingOffset = 0;
+    }
+
+    // 把待写数据写入环形缓冲区（不超过预读长度），全部写完返回 true
+    bool flushPending()
+    {
+        if (m_pendingOffset == m_pending.size())
+            return true;
+
+        // 标记先于样本写入，输出线程读到样本时一定能读到对应的标记
+        if (m_markerPending) {
+            if (m_shared->markers.push(&m_marker, 1) == 0)
+                m_shared->droppedMarkers.fetch_add(1, std::memory_order_relaxed);
+            m_markerPending = false;
+        }
+
+        SpscRingBuffer<float> &ring = m_shared->ring;
+        const size_t ahead = size_t(m_rate) * m_channels * m_shared->aheadMs.load(std::memory_order_relaxed) / 1000;
+        const size_t limit = std::min(ahead, ring.capacity());
+        const size_t queued = ring.capacity() - ring.writeAvailable();
+        if (queued >= limit)
+            return false;
+
+        size_t count = std::min(m_pending.size() - m_pendingOffset, limit - queued);
+        count -= count % size_t(m_channels);
+        m_pendingOffset += ring.push(m_pending.data() + m_pendingOffset, count);
+        return m_pendingOffset == m_pending.size();
+    }
+
+    StreamShared *m_shared;
+    QAudioFormat m_format;
+    QAudioDecoder *m_decoder = nullptr;
+    QTimer *m_pump = nullptr;
+    std::vector<std::unique_ptr<DspStage>> m_stages;
+
+    QUrl m_source;
+    int m_epoch = 0;
+    int m_rate = 0;
+    int m_channels = 0;
+    bool m_formatAnnounced = false;
+    bool m_finished = false;
+    qint64 m_decodedUs = 0;         // 解码器已经输出到的位置
+    qint64 m_skipUntilUs = 0;       // 跳转目标，之前的数据直接丢弃
+    quint64 m_queuedFrames = 0;     // 本序号已交给输出的帧数
+
+    AudioBlock m_block;
+    std::vector<float> m_pending;   // 已处理、还没写进环形缓冲区的样本
+    size_t m_pendingOffset = 0;
+    StreamShared::Marker m_marker;  // m_pending 对应的标记
+    bool m_markerPending = false;
+};
+
+// QAudioSink 的拉模式数据源，运行在输出线程，是环形缓冲区唯一的消费者
+class StreamOutput : public QIODevice
+{
+public:
+    StreamOutput(StreamShared *shared, AudioEngine *engine)
+        : m_shared(shared)
+        , m_engine(engine)
+    {
+    }
+
+    // 以下均在输出线程调用
+    void addStage(DspStage *stage)
+    {
+        m_stages.emplace_back(stage);
+        if (m_format.isValid())
+            stage->prepare(m_format.sampleRate(), m_format.channelCount());
+    }
+
+    void start(int sampleRate, int channels, int bufferMs)
+    {
+        QAudioFormat format;
+        format.setSampleRate(sampleRate);
+        format.setChannelCount(channels);
+        format.setSampleFormat(QAudioFormat::Float);
+        const QAudioDevice device = QMediaDevices::defaultAudioOutput();
+        if (!device.isFormatSupported(format))
+            format.setSampleFormat(QAudioFormat::Int16);
+
+        if (m_sink && m_format == format) {
+            if (m_sink->state() == QAudio::SuspendedState) {
+                m_sink->resume();
+                return;
+            }
+            if (m_sink->state() != QAudio::StoppedState)
+                return;
+        } else {
+            delete m_sink;
+            m_sink = new QAudioSink(device, format, this);
+            m_format = format;
+            m_tapFormat = format;
+            m_tapFormat.setSampleFormat(QAudioFormat::Float);
+            m_block.channels = channels;
+            for (const std::unique_ptr<DspStage> &stage : m_stages)
+                stage->prepare(sampleRate, channels);
+        }
+
+        m_sink->setBufferSize(format.bytesForDuration(qint64(bufferMs) * 1000));
+        if (!isOpen())
+            open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+        m_sink->start(this);
+        if (m_sink->error() != QAudio::NoError)
+            qWarning() << "Failed to start audio output:" << m_sink->error();
+        m_shared->sinkLatencyUs.store(format.durationForBytes(m_sink->bufferSize()), std::memory_order_relaxed);
+    }
+
+    void suspend()
+    {
+        if (m_sink && m_sink->state() != QAudio::StoppedState)
+            m_sink->suspend();
+    }
+
+    void stop()
+    {
+        if (m_sink)
+            m_sink->stop();
+    }
+
+    bool isSequential() const override { return true; }
+
+    // 数据不足时补静音，因此总是可读
+    qint64 bytesAvailable() const override { return std::numeric_limits<int>::max(); }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        const int channels = m_format.channelCount();
+        const int bytesPerFrame = m_format.bytesPerFrame();
+        const qint64 frames = bytesPerFrame > 0 ? maxSize / bytesPerFrame : 0;
+        if (frames <= 0)
+            return 0;
+
+        flushIfRequested();
+
+        // 容量只增不减，稳定后不再分配内存
+        const size_t samples = size_t(frames) * channels;
+        std::vector<float> &buffer = m_block.samples;
+        buffer.resize(samples);
+
+        // 切换到不同格式的歌曲、输出还没按新格式重启时先输出静音
+        size_t got = 0;
+        if (m_shared->sampleRate.load(std::memory_order_relaxed) == m_format.sampleRate()
+            && m_shared->channels.load(std::memory_order_relaxed) == channels)
+            got = m_shared->ring.pop(buffer.data(), samples);
+
+        if (got < samples) {
+            std::fill(buffer.begin() + got, buffer.end(), 0.0f);
+            if (m_shared->endEpoch.load(std::memory_order_acquire) == m_flushedEpoch) {
+                if (m_shared->ring.readAvailable() == 0)
+                    m_shared->drainedEpoch.store(m_flushedEpoch, std::memory_order_release);
+            } else if (m_primed) {
+                // 已经开始出声之后数据跟不上才算欠载，跳转/切歌后等待第一块数据的静音不计
+                m_shared->underruns.fetch_add(1, std::memory_order_relaxed);
+                m_shared->silentFrames.fetch_add((samples - got) / channels, std::memory_order_relaxed);
+            }
+        }
+
+        // 补的静音也经过处理，滤波器的余音可以自然衰减
+        for (const std::unique_ptr<DspStage> &stage : m_stages)
+            stage->process(m_block);
+
+        if (got > 0) {
+            m_primed = true;
+            m_consumed += got / channels;
+            updatePosition();
+            if (m_shared->tapEnabled.load(std::memory_order_relaxed)) {
+                // 分接的接收方都是直接连接，发出信号后 m_tapBytes 又只有这里持有，复制样本不会分配内存
+                // （容量只增不减）；有接收方保留了缓冲区时 data() 才会另复制一份
+                m_tapBytes.resize(qsizetype(got * sizeof(float)));
+                std::copy_n(buffer.data(), got, reinterpret_cast<float *>(m_tapBytes.data()));
+                emit m_engine->audioBufferReceived(QAudioBuffer(m_tapBytes, m_tapFormat,
+                                                                m_shared->playedUs.load(std::memory_order_relaxed)));
+            }
+        }
+
+        const float gain = m_shared->gain.load(std::memory_order_relaxed);
+        if (m_format.sampleFormat() == QAudioFormat::Float) {
+            float *out = reinterpret_cast<float *>(data);
+            for (size_t i = 0; i < samples; ++i)
+                out[i] = buffer[i] * gain;
+        } else {
+            qint16 *out = reinterpret_cast<qint16 *>(data);
+            for (size_t i = 0; i < samples; ++i)
+                out[i] = qint16(qBound(-32768.0f, buffer[i] * gain * 32768.0f, 32767.0f));
+        }
+        return frames * bytesPerFrame;
+    }
+
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    // 解码线程请求清空时丢弃所有旧数据并确认
+    void flushIfRequested()
+    {
+        const int requested = m_shared->requestedEpoch.load(std::memory_order_acquire);
+        if (requested == m_flushedEpoch)
+            return;
+        m_shared->ring.discard(m_shared->ring.readAvailable());
+        m_shared->markers.discard(m_shared->markers.readAvailable());
+        m_marker = StreamShared::Marker();
+        m_consumed = 0;
+        m_primed = false;
+        for (const std::unique_ptr<DspStage> &stage : m_stages)
+            stage->reset();
+        m_flushedEpoch = requested;
+        m_shared->flushedEpoch.store(requested, std::memory_order_release);
+    }
+
+    void updatePosition()
+    {
+        StreamShared::Marker next;
+        while (m_marker.endFrame < m_consumed && m_shared->markers.pop(&next, 1))
+            m_marker = next;
+
+        qint64 us = m_marker.endUs;
+        if (m_marker.frames > 0 && m_consumed < m_marker.endFrame)
+            us -= qint64(m_marker.endFrame - m_consumed) * m_marker.spanUs / m_marker.frames;
+        m_shared->playedUs.store(us, std::memory_order_relaxed);
+        m_shared->positionEpoch.store(m_flushedEpoch, std::memory_order_release);
+    }
+
+    StreamShared *m_shared;
+    AudioEngine *m_engine;
+    QAudioSink *m_sink = nullptr;
+    QAudioFormat m_format;
+    QAudioFormat m_tapFormat;
+    QByteArray m_tapBytes;          // 分接数据的复用缓冲区
+    std::vector<std::unique_ptr<DspStage>> m_stages;
+    AudioBlock m_block;
+    StreamShared::Marker m_marker;
+    quint64 m_consumed = 0;         // 自上次清空起取走的帧数
+    int m_flushedEpoch = 0;
+    bool m_primed = false;
+};
+
+StreamEngine::StreamEngine(QObject *parent)
+    : AudioEngine(parent)
+    , m_shared(new StreamShared)
+    , m_stretch(new TimeStretch)
+    , m_equalizer(new Equalizer)
+    , m_reportStats(qEnvironmentVariableIsSet("XC_AUDIO_STATS"))
+{
+    // 请求浮点输出，采样率跟随默认输出设备，最多两个声道
+    const QAudioFormat preferred = QMediaDevices::defaultAudioOutput().preferredFormat();
+    m_decodeFormat.setSampleFormat(QAudioFormat::Float);
+    m_decodeFormat.setSampleRate(preferred.sampleRate() > 0 ? preferred.sampleRate() : 44100);
+    m_decodeFormat.setChannelCount(qBound(1, preferred.channelCount(), 2));
+
+    m_decoder = new StreamDecoder(m_shared.get(), m_decodeFormat);
+    m_decoder->addStage(m_stretch);
+    m_decoder->onDuration = [this](int epoch, qint64 duration) {
+        QMetaObject::invokeMethod(this, [this, epoch, duration] {
+            if (epoch < m_sourceEpoch || duration <= 0 || duration == m_duration)
+                return;
+            m_duration = duration;
+            emit durationChanged(duration);
+        }, Qt::QueuedConnection);
+    };
+    m_decoder->onError = [this](int epoch, const QString &message) {
+        QMetaObject::invokeMethod(this, [this, epoch, message] {
+            if (epoch < m_sourceEpoch)
+                return;
+            qWarning() << "Failed to decode" << m_source << message;
+            m_pollTimer.stop();
+            QMetaObject::invokeMethod(m_output, [output = m_output] { output->stop(); }, Qt::QueuedConnection);
+            m_outputActive = false;
+            setStatus(QMediaPlayer::InvalidMedia);
+            setState(QMediaPlayer::StoppedState);
+        }, Qt::QueuedConnection);
+    };
+    m_output = new StreamOutput(m_shared.get(), this);
+    m_output->addStage(m_equalizer);
+
+    // 两个对象都在各自线程结束时销毁（QAudioDecoder/QAudioSink 的内部对象属于这些线程）
+    m_decoder->moveToThread(&m_decodeThread);
+    m_output->moveToThread(&m_outputThread);
+    connect(&m_decodeThread, &QThread::finished, m_decoder, &QObject::deleteLater);
+    connect(&m_outputThread, &QThread::finished, m_output, &QObject::deleteLater);
+    m_decodeThread.setObjectName("StreamDecoder");
+    m_outputThread.setObjectName("StreamOutput");
+    m_decodeThread.start();
+    m_outputThread.start(QThread::TimeCriticalPriority);
+    QMetaObject::invokeMethod(m_decoder, [decoder = m_decoder] { decoder->init(); }, Qt::QueuedConnection);
+
+    m_pollTimer.setInterval(PollIntervalMs);
+    connect(&m_pollTimer, &QTimer::timeout, this, &StreamEngine::poll);
+}
+
+StreamEngine::~StreamEngine()
+{
+    m_pollTimer.stop();
+    reportStats();
+    m_outputThread.quit();
+    m_decodeThread.quit();
+    m_outputThread.wait();
+    m_decodeThread.wait();
+}
+
+void StreamEngine::setSource(const QUrl &source)
+{
+    reportStats();
+    m_pollTimer.stop();
+    QMetaObject::invokeMethod(m_output, [output = m_output] { output->stop(); }, Qt::QueuedConnection);
+    m_outputActive = false;
+
+    m_source = source;
+    m_position = 0;
+    m_duration = 0;
+    m_metaData = QMediaMetaData();
+    // 解码器不提供标签，用 TagReader 读取（只读文件头）；时长先用标签里的，解码器报告后再更新
+    if (source.isLocalFile()) {
+        const TrackMetadata tags = TagReader::read(source.toLocalFile());
+        m_metaData.insert(QMediaMetaData::Title, tags.title);
+        m_metaData.insert(QMediaMetaData::ContributingArtist, tags.artist);
+        m_metaData.insert(QMediaMetaData::AlbumTitle, tags.album);
+        m_duration = tags.durationMs;
+    }
+
+    m_sourceEpoch = m_epoch + 1;
+    load(0);
+
+    setState(QMediaPlayer::StoppedState);
+    setStatus(source.isEmpty() ? QMediaPlayer::NoMedia : QMediaPlayer::LoadingMedia);
+    emit sourceChanged(source);
+    emit durationChanged(m_duration);
+    emit positionChanged(0);
+    emit metaDataChanged();
+    if (!source.isEmpty())
+        m_pollTimer.start();
+}
+
+void StreamEngine::load(qint64 positionMs)
+{
+    const int epoch = ++m_epoch;
+    m_pendingPosition = positionMs;
+    const QUrl source = m_source;
+    const qint64 startUs = positionMs * 1000;
+    QMetaObject::invokeMethod(m_decoder, [decoder = m_decoder, source, startUs, epoch] {
+        decoder->load(source, startUs, epoch);
+    }, Qt::QueuedConnection);
+}
+
+void StreamEngine::play()
+{
+    if (m_source.isEmpty() || m_status == QMediaPlayer::InvalidMedia || m_state == QMediaPlayer::PlayingState)
+        return;
+
+    if (m_status == QMediaPlayer::EndOfMedia) {
+        load(0);
+        m_position = 0;
+        setStatus(QMediaPlayer::LoadedMedia);
+        emit positionChanged(0);
+    }
+    setState(QMediaPlayer::PlayingState);
+    startOutput();
+    m_pollTimer.start();
+}
+
+void StreamEngine::pause()
+{
+    if (m_source.isEmpty() || m_state == QMediaPlayer::PausedState)
+        return;
+    QMetaObject::invokeMethod(m_output, [output = m_output] { output->suspend(); }, Qt::QueuedConnection);
+    m_outputActive = false;
+    setState(QMediaPlayer::PausedState);
+}
+
+void StreamEngine::stop()
+{
+    if (m_state == QMediaPlayer::StoppedState)
+        return;
+    m_pollTimer.stop();
+    QMetaObject::invokeMethod(m_output, [output = m_output] { output->stop(); }, Qt::QueuedConnection);
+    m_outputActive = false;
+
+    // 回到开头并预先解码，下次播放可以立即出声
+    load(0);
+    m_position = 0;
+    setState(QMediaPlayer::StoppedState);
+    emit positionChanged(0);
+}
+
+void StreamEngine::setPosition(qint64 position)
+{
+    // 进度条跟随播放位置更新时会把同一个值再设置回来，不当作跳转
+    if (m_source.isEmpty() || position == m_position)
+        return;
+    position = qMax<qint64>(0, m_duration > 0 ? qMin(position, m_duration) : position);
+
+    load(position);
+    m_position = position;
+    if (m_status == QMediaPlayer::EndOfMedia)
+        setStatus(QMediaPlayer::LoadedMedia);
+    emit positionChanged(position);
+}
+
+void StreamEngine::setPlaybackRate(qreal rate)
+{
+    rate = qBound(qreal(TimeStretch::MinRate), rate, qreal(TimeStretch::MaxRate));
+    if (qFuzzyCompare(rate, m_rate))
+        return;
+    m_rate = rate;
+    m_stretch->setRate(float(rate));
+    emit playbackRateChanged(rate);
+}
+
+void StreamEngine::setVolume(float volume)
+{
+    m_volume = qBound(0.0f, volume, 1.0f);
+    m_shared->gain.store(m_muted ? 0.0f : m_volume, std::memory_order_relaxed);
+}
+
+void StreamEngine::setMuted(bool muted)
+{
+    m_muted = muted;
+    m_shared->gain.store(m_muted ? 0.0f : m_volume, std::memory_order_relaxed);
+}
+
+void StreamEngine::setBufferDuration(int milliseconds)
+{
+    m_bufferMs = qBound(10, milliseconds, 2000);
+    applyBufferSettings();
+}
+
+void StreamEngine::setLowLatency(bool enabled)
+{
+    m_lowLatency = enabled;
+    applyBufferSettings();
+}
+
+void StreamEngine::applyBufferSettings()
+{
+    // 预读至少是输出缓冲区的两倍，保证输出每次拉取时都有数据
+    m_shared->aheadMs.store(m_lowLatency ? LowLatencyAheadMs : qMax(NormalAheadMs, m_bufferMs * 2),
+                            std::memory_order_relaxed);
+    m_decodeThread.setPriority(m_lowLatency ? QThread::HighestPriority : QThread::NormalPriority);
+    const int interval = m_lowLatency ? LowLatencyPumpMs : NormalPumpMs;
+    QMetaObject::invokeMethod(m_decoder, [decoder = m_decoder, interval] {
+        decoder->setPumpInterval(interval);
+    }, Qt::QueuedConnection);
+}
+
+void StreamEngine::addStage(DspStage *stage)
+{
+    QMetaObject::invokeMethod(m_decoder, [decoder = m_decoder, stage] { decoder->addStage(stage); },
+                              Qt::QueuedConnection);
+}
+
+void StreamEngine::addOutputStage(DspStage *stage)
+{
+    QMetaObject::invokeMethod(m_output, [output = m_output, stage] { output->addStage(stage); },
+                              Qt::QueuedConnection);
+}
+
+StreamEngine::UnderrunStats StreamEngine::underrunStats() const
+{
+    UnderrunStats stats;
+    stats.count = m_shared->underruns.load(std::memory_order_relaxed);
+    stats.silentFrames = m_shared->silentFrames.load(std::memory_order_relaxed);
+    stats.droppedMarkers = m_shared->droppedMarkers.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void StreamEngine::resetUnderrunStats()
+{
+    m_shared->underruns.store(0, std::memory_order_relaxed);
+    m_shared->silentFrames.store(0, std::memory_order_relaxed);
+    m_shared->droppedMarkers.store(0, std::memory_order_relaxed);
+}
+
+void StreamEngine::reportStats()
+{
+    // 设置 XC_AUDIO_STATS 后每首歌输出一次欠载统计
+    if (!m_reportStats || m_source.isEmpty())
+        return;
+    const UnderrunStats stats = underrunStats();
+    qDebug() << "Audio underruns:" << stats.count << "silent frames:" << stats.silentFrames
+             << "dropped markers:" << stats.droppedMarkers
+             << "buffer (ms):" << (m_lowLatency ? LowLatencyBufferMs : m_bufferMs);
+    resetUnderrunStats();
+}
+
+void StreamEngine::startOutput()
+{
+    // 当前音源的格式要等解码出第一块数据才知道，之后由 poll() 重试
+    if (m_shared->formatEpoch.load(std::memory_order_acquire) < m_sourceEpoch)
+        return;
+
+    m_outputRate = m_shared->sampleRate.load(std::memory_order_relaxed);
+    m_outputChannels = m_shared->channels.load(std::memory_order_relaxed);
+    m_outputActive = true;
+    const int rate = m_outputRate;
+    const int channels = m_outputChannels;
+    const int bufferMs = m_lowLatency ? LowLatencyBufferMs : m_bufferMs;
+    QMetaObject::invokeMethod(m_output, [output = m_output, rate, channels, bufferMs] {
+        output->start(rate, channels, bufferMs);
+    }, Qt::QueuedConnection);
+}
+
+void StreamEngine::poll()
+{
+    StreamShared &shared = *m_shared;
+    const bool formatKnown = shared.formatEpoch.load(std::memory_order_acquire) >= m_sourceEpoch;
+    if (m_status == QMediaPlayer::LoadingMedia && formatKnown)
+        setStatus(QMediaPlayer::LoadedMedia);
+
+    if (m_state != QMediaPlayer::PlayingState) {
+        if (m_status != QMediaPlayer::LoadingMedia)
+            m_pollTimer.stop();
+        return;
+    }
+
+    // 第一次拿到格式，或者新歌的格式与输出设备当前的不同
+    if (formatKnown && (!m_outputActive || shared.sampleRate.load(std::memory_order_relaxed) != m_outputRate
+                        || shared.channels.load(std::memory_order_relaxed) != m_outputChannels))
+        startOutput();
+
+    if (shared.drainedEpoch.load(std::memory_order_acquire) == m_epoch) {
+        m_pollTimer.stop();
+        QMetaObject::invokeMethod(m_output, [output = m_output] { output->stop(); }, Qt::QueuedConnection);
+        m_outputActive = false;
+        if (m_duration > 0 && m_position != m_duration) {
+            m_position = m_duration;
+            emit positionChanged(m_position);
+        }
+        // 先更新媒体状态，收到 StoppedState 时即可判断是否播放到了结尾
+        setStatus(QMediaPlayer::EndOfMedia);
+        setState(QMediaPlayer::StoppedState);
+        return;
+    }
+
+    // 输出已取走的位置减去设备缓冲区里还没播出的部分；跳转后的数据到达之前报告跳转目标
+    qint64 position = m_pendingPosition;
+    if (shared.positionEpoch.load(std::memory_order_acquire) == m_epoch) {
+        const qint64 latencyUs = qint64(shared.sinkLatencyUs.load(std::memory_order_relaxed) * m_rate);
+        position = qMax(m_pendingPosition, (shared.playedUs.load(std::memory_order_relaxed) - latencyUs) / 1000);
+    }
+    if (position != m_position) {
+        m_position = position;
+        emit positionChanged(position);
+    }
+}
+
+void StreamEngine::setState(QMediaPlayer::PlaybackState state)
+{
+    if (m_state == state)
+        return;
+    m_state = state;
+    emit playbackStateChanged(state);
+}
+
+void StreamEngine::setStatus(QMediaPlayer::MediaStatus status)
+{
+    if (m_status == status)
+        return;
+    m_status = status;
+    emit mediaStatusChanged(status);
+}
+
+void StreamEngine::connectNotify(const QMetaMethod &signal)
+{
+    // 没有接收方时输出线程不构造 QAudioBuffer
+    if (signal == QMetaMethod::fromSignal(&AudioEngine::audioBufferReceived))
+        m_shared->tapEnabled.store(true, std::memory_order_relaxed);
+}
+
+void StreamEngine::disconnectNotify(const QMetaMethod &signal)
+{
+    if (signal == QMetaMethod::fromSignal(&AudioEngine::audioBufferReceived))
+        m_shared->tapEnabled.store(isSignalConnected(signal), std::memory_order_relaxed);
+}
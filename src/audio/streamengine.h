@@ -0,0 +1,127 @@
+#ifndef STREAMENGINE_H
+#define STREAMENGINE_H
+
+#include <QAudioFormat>
+#include <QThread>
+#include <QTimer>
+#include <memory>
+#include "audioengine.h"
+
+class DspStage;
+class Equalizer;
+class TimeStretch;
+class StreamDecoder;
+class StreamOutput;
+struct StreamShared;
+
+// 自己的播放流水线：解码 → DSP → 无锁环形缓冲区 → QAudioSink
+// 解码线程用 QAudioDecoder 解出浮点样本，依次经过 DSP 链（链首固定为保持音高的变速），
+// 写入单生产者/单消费者环形缓冲区；输出线程上的 QAudioSink 以拉模式从缓冲区取数据，缓冲不足时补静音并计为一次欠载。
+// 不改变帧数的阶段（均衡器）放在输出线程上处理，参数调整不必等环形缓冲区里预读的数据播完就能听到。
+// 跳转/切歌不在两个线程之间加锁：每次操作分配新的序号（epoch），解码线程停止写入后请求清空，
+// 由输出线程（唯一的消费者）丢弃旧数据并确认，解码线程收到确认后才开始写入新数据。
+// QAudioDecoder 不支持跳转，向后跳转需要从头重新解码并丢弃目标之前的数据，向前跳转则在当前解码基础上继续丢弃。
+class StreamEngine : public AudioEngine
+{
+    Q_OBJECT
+
+public:
+    struct UnderrunStats
+    {
+        quint64 count = 0;          // 发生欠载的次数（每次拉取算一次）
+        quint64 silentFrames = 0;   // 因欠载补的静音帧数
+        quint64 droppedMarkers = 0; // 标记队列满时丢弃的位置标记数，不为 0 时变速后的位置会有偏差
+    };
+
+    explicit StreamEngine(QObject *parent = nullptr);
+    ~StreamEngine() override;
+
+    const char *name() const override { return "stream"; }
+
+    QUrl source() const override { return m_source; }
+    void setSource(const QUrl &source) override;
+
+    QMediaPlayer::PlaybackState playbackState() const override { return m_state; }
+    QMediaPlayer::MediaStatus mediaStatus() const override { return m_status; }
+    qint64 position() const override { return m_position; }
+    qint64 duration() const override { return m_duration; }
+    QMediaMetaData metaData() const override { return m_metaData; }
+
+    qreal playbackRate() const override { return m_rate; }
+    void setPlaybackRate(qreal rate) override;
+    bool seamlessRateChange() const override { return true; }
+
+    float volume() const override { return m_volume; }
+    void setVolume(float volume) override;
+    bool isMuted() const override { return m_muted; }
+    void setMuted(bool muted) override;
+
+    Equalizer *equalizer() override { return m_equalizer; }
+
+    void play() override;
+    void pause() override;
+    void stop() override;
+    void setPosition(qint64 position) override;
+
+    // 输出设备缓冲区长度（毫秒，默认 100），下次开始播放时生效
+    void setBufferDuration(int milliseconds);
+    int bufferDuration() const { return m_bufferMs; }
+
+    // 低延迟模式：输出缓冲区 20 毫秒，环形缓冲区只预读 40 毫秒，解码线程提高优先级并更频繁地补充数据。
+    // 变速/均衡等参数的调整更快听到，但对系统调度更敏感，容易欠载
+    void setLowLatency(bool enabled);
+    bool isLowLatency() const { return m_lowLatency; }
+
+    // 在变速之后追加一个 DSP 阶段，引擎取得所有权；可在播放中调用
+    void addStage(DspStage *stage);
+    // 追加一个在输出线程处理的阶段（不得改变帧数），引擎取得所有权；可在播放中调用
+    void addOutputStage(DspStage *stage);
+
+    UnderrunStats underrunStats() const;
+    void resetUnderrunStats();
+
+protected:
+    void connectNotify(const QMetaMethod &signal) override;
+    void disconnectNotify(const QMetaMethod &signal) override;
+
+private:
+    void setState(QMediaPlayer::PlaybackState state);
+    void setStatus(QMediaPlayer::MediaStatus status);
+    void load(qint64 positionMs);
+    void startOutput();
+    void applyBufferSettings();
+    void poll();
+    void reportStats();
+
+    std::unique_ptr<StreamShared> m_shared;
+    QThread m_decodeThread;
+    QThread m_outputThread;
+    StreamDecoder *m_decoder;
+    StreamOutput *m_output;
+    TimeStretch *m_stretch;         // 归解码线程中的 DSP 链所有，这里只调用线程安全的 setRate
+    Equalizer *m_equalizer;         // 归输出线程中的处理链所有，参数接口线程安全
+    QTimer m_pollTimer;
+    QAudioFormat m_decodeFormat;    // 请求解码器输出的格式
+
+    QUrl m_source;
+    QMediaPlayer::PlaybackState m_state = QMediaPlayer::StoppedState;
+    QMediaPlayer::MediaStatus m_status = QMediaPlayer::NoMedia;
+    QMediaMetaData m_metaData;
+    qint64 m_position = 0;
+    qint64 m_duration = 0;
+    qreal m_rate = 1.0;
+    float m_volume = 1.0f;
+    bool m_muted = false;
+    int m_bufferMs = 100;
+    bool m_lowLatency = false;
+    bool m_reportStats = false;
+
+    int m_epoch = 0;                // 最近一次切歌/跳转的序号
+    int m_sourceEpoch = 0;          // 当前音源开始时的序号
+    qint64 m_pendingPosition = 0;   // 新数据到达输出之前报告的位置
+    bool m_outputActive = false;    // 输出已启动（未暂停/停止）
+    int m_outputRate = 0;           // 输出设备当前使用的格式
+    int m_outputChannels = 0;
+};
+
+#endif // STREAMENGINE_H
@@ -0,0 +1,183 @@
+#include "timestretch.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define XC_STRETCH_SSE2 1
+#endif
+
+namespace {
+const int CoarseStep = 4;
+
+// 同时计算 a·b 与 b·b
+void dotAndEnergy(const float *a, const float *b, int n, float &dot, float &energy)
+{
+    int i = 0;
+    float d = 0.0f;
+    float e = 0.0f;
+#ifdef XC_STRETCH_SSE2
+    __m128 dotAcc = _mm_setzero_ps();
+    __m128 energyAcc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        const __m128 va = _mm_loadu_ps(a + i);
+        const __m128 vb = _mm_loadu_ps(b + i);
+        dotAcc = _mm_add_ps(dotAcc, _mm_mul_ps(va, vb));
+        energyAcc = _mm_add_ps(energyAcc, _mm_mul_ps(vb, vb));
+    }
+    alignas(16) float dotLanes[4];
+    alignas(16) float energyLanes[4];
+    _mm_store_ps(dotLanes, dotAcc);
+    _mm_store_ps(energyLanes, energyAcc);
+    d = dotLanes[0] + dotLanes[1] + dotLanes[2] + dotLanes[3];
+    e = energyLanes[0] + energyLanes[1] + energyLanes[2] + energyLanes[3];
+#endif
+    for (; i < n; ++i) {
+        d += a[i] * b[i];
+        e += b[i] * b[i];
+    }
+    dot = d;
+    energy = e;
+}
+}
+
+TimeStretch::TimeStretch()
+{
+    prepare(44100, 2);
+}
+
+void TimeStretch::prepare(int sampleRate, int channels)
+{
+    m_sampleRate = std::max(sampleRate, 8000);
+    m_channels = std::max(channels, 1);
+    m_hop = m_sampleRate / 100;
+    m_search = m_sampleRate * 75 / 10000;
+
+    // 周期 Hann 窗，50% 重叠时两段窗之和恒为 1
+    const double pi = 3.14159265358979323846;
+    const int length = m_hop * 2;
+    m_window.resize(length);
+    for (int i = 0; i < length; ++i)
+        m_window[i] = float(0.5 - 0.5 * std::cos(2.0 * pi * i / length));
+
+    // 预留足够的空间，处理过程中不再扩容
+    const size_t frames = size_t(m_hop) * 16 + size_t(m_search) * 2;
+    m_input.reserve(frames * m_channels * 2);
+    m_mono.reserve(frames * 2);
+    m_output.reserve(frames * m_channels);
+    reset();
+}
+
+void TimeStretch::reset()
+{
+    m_input.clear();
+    m_mono.clear();
+    m_output.clear();
+    m_nominal = 0;
+    m_previous = -1;
+    m_active = m_rate.load(std::memory_order_relaxed) != 1.0f;
+}
+
+void TimeStretch::setRate(float rate)
+{
+    m_rate.store(std::clamp(rate, MinRate, MaxRate), std::memory_order_relaxed);
+}
+
+int TimeStretch::findBestOffset(int nominal) const
+{
+    const float *target = m_mono.data() + m_previous + m_hop;
+    const int low = std::max(0, nominal - m_search);
+    const int high = nominal + m_search;
+
+    float bestScore = -INFINITY;
+    int best = nominal;
+    auto score = [&](int position) {
+        float dot, energy;
+        dotAndEnergy(target, m_mono.data() + position, m_hop, dot, energy);
+        const float value = dot / std::sqrt(energy + 1e-9f);
+        if (value > bestScore) {
+            bestScore = value;
+            best = position;
+        }
+    };
+
+    for (int position = low; position <= high; position += CoarseStep)
+        score(position);
+    const int center = best;
+    for (int position = std::max(low, center - CoarseStep + 1); position <= std::min(high, center + CoarseStep - 1); ++position) {
+        if (position != center)
+            score(position);
+    }
+    return best;
+}
+
+void TimeStretch::compact()
+{
+    // 丢弃之后不会再用到的输入：上一段之前、且在下一次搜索范围之前的部分
+    const int drop = std::min(m_previous, int(m_nominal) - m_search);
+    if (drop < m_hop * 8)
+        return;
+    m_input.erase(m_input.begin(), m_input.begin() + size_t(drop) * m_channels);
+    m_mono.erase(m_mono.begin(), m_mono.begin() + drop);
+    m_previous -= drop;
+    m_nominal -= drop;
+}
+
+void TimeStretch::process(AudioBlock &block)
+{
+    const float rate = m_rate.load(std::memory_order_relaxed);
+    if (!m_active) {
+        if (rate == 1.0f)
+            return;
+        m_active = true;
+    }
+    if (block.channels != m_channels)
+        prepare(m_sampleRate, block.channels);
+
+    // 追加输入并下混
+    const int frames = block.frames();
+    m_input.insert(m_input.end(), block.samples.begin(), block.samples.begin() + size_t(frames) * m_channels);
+    const float scale = 1.0f / m_channels;
+    const float *in = block.samples.data();
+    for (int i = 0; i < frames; ++i) {
+        float sum = 0.0f;
+        for (int c = 0; c < m_channels; ++c)
+            sum += in[i * m_channels + c];
+        m_mono.push_back(sum * scale);
+    }
+
+    m_output.clear();
+    const int available = int(m_mono.size());
+    for (;;) {
+        const int nominal = int(m_nominal);
+        if (nominal + m_search + m_hop * 2 > available)
+            break;
+        if (m_previous >= 0 && m_previous + m_hop * 2 > available)
+            break;
+
+        const int position = m_previous < 0 ? nominal : findBestOffset(nominal);
+        const size_t base = m_output.size();
+        m_output.resize(base + size_t(m_hop) * m_channels);
+        float *out = m_output.data() + base;
+        const float *current = m_input.data() + size_t(position) * m_channels;
+        if (m_previous < 0) {
+            // 第一段没有可叠加的前一段，前半段直接输出
+            std::copy(current, current + size_t(m_hop) * m_channels, out);
+        } else {
+            const float *tail = m_input.data() + size_t(m_previous + m_hop) * m_channels;
+            const float *fadeOut = m_window.data() + m_hop;
+            const float *fadeIn = m_window.data();
+            for (int i = 0; i < m_hop; ++i) {
+                for (int c = 0; c < m_channels; ++c) {
+                    const int k = i * m_channels + c;
+                    out[k] = tail[k] * fadeOut[i] + current[k] * fadeIn[i];
+                }
+            }
+        }
+
+        m_previous = position;
+        m_nominal += m_hop * double(m_rate.load(std::memory_order_relaxed));
+    }
+    compact();
+    block.samples.swap(m_output);
+}
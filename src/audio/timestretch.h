@@ -0,0 +1,53 @@
+#ifndef TIMESTRETCH_H
+#define TIMESTRETCH_H
+
+#include <atomic>
+#include <vector>
+#include "dspstage.h"
+
+// 保持音高的变速（WSOLA）
+// 输出每次前进 10 ms（Hs），输入按 Hs * 速率前进；每一段在名义位置附近 ±7.5 ms 内寻找与上一段自然延续部分
+// 最相似（归一化互相关最大）的位置，再用 50% 重叠的 Hann 窗叠加，因此不会改变音高，也没有拼接处的相位跳变。
+// 互相关在单声道下混信号上计算：先每隔 4 个位置粗搜，再在最佳位置附近逐点细搜，内积使用 SSE2。
+// 速率可以在播放中随时修改（0.5 ~ 2.0，下一段即生效），速率为 1 且从未变速时直接透传。
+class TimeStretch : public DspStage
+{
+public:
+    static constexpr float MinRate = 0.5f;
+    static constexpr float MaxRate = 2.0f;
+
+    TimeStretch();
+
+    const char *name() const override { return "time-stretch"; }
+    void prepare(int sampleRate, int channels) override;
+    void reset() override;
+    void process(AudioBlock &block) override;
+
+    // 线程安全
+    void setRate(float rate);
+    float rate() const { return m_rate.load(std::memory_order_relaxed); }
+
+    // 输出每段的帧数与搜索范围（帧），供测试和基准使用
+    int hopFrames() const { return m_hop; }
+    int searchFrames() const { return m_search; }
+
+private:
+    int findBestOffset(int nominal) const;
+    void compact();
+
+    std::atomic<float> m_rate{1.0f};
+    int m_sampleRate = 44100;
+    int m_channels = 2;
+    int m_hop = 441;            // Hs，也是重叠长度
+    int m_search = 331;         // ±搜索范围
+    bool m_active = false;      // 变过速之后一直处理，避免切回 1 倍速时的跳变
+
+    std::vector<float> m_window;    // 长度 2 * Hs 的 Hann 窗
+    std::vector<float> m_input;     // 交错排列的待处理输入
+    std::vector<float> m_mono;      // m_input 的单声道下混，用于互相关
+    std::vector<float> m_output;
+    double m_nominal = 0;           // 下一段的名义输入位置（帧，相对 m_input 开头）
+    int m_previous = -1;            // 上一段实际选用的输入位置
+};
+
+#endif // TIMESTRETCH_H
@@ -0,0 +1,246 @@
+#include "../library/librarydatabase.h"
+#include "../library/libraryscanner.h"
+#include "../library/playhistory.h"
+#include "../playlist/playlist_interface.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTextStream>
+
+// xc-cli：无界面的批量工具，与 XC 共用 xc_core
+//   xc-cli index <目录> [--recursive] [--jobs N]   建立曲库缓存并写入曲库数据库
+//   xc-cli query [--sort 键] [--filter 文本] [--limit N]  按排序/筛选列出曲库
+//   xc-cli history [--limit N]                     最常播放、最近播放、最常跳过
+//   xc-cli playlists                               列出歌单
+//   xc-cli export <歌单> <文件>                     导出歌单（.m3u/.m3u8/.pls/.json）
+//   xc-cli import <文件> [--name 歌单]              导入歌单（.m3u/.m3u8/.pls/.json）
+
+namespace {
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+int runIndex(const QStringList &args, const QString &dataDir, bool recursive, int jobs)
+{
+    if (args.size() < 2) {
+        err() << "usage: xc-cli index <directory> [--recursive] [--jobs N]" << Qt::endl;
+        return 2;
+    }
+
+    const QString root = QFileInfo(args.at(1)).absoluteFilePath();
+    if (!QFileInfo(root).isDir()) {
+        err() << "not a directory: " << root << Qt::endl;
+        return 1;
+    }
+
+    // 已有缓存中未变化的文件直接复用
+    const QString cachePath = dataDir + "/library_cache.json";
+    QHash<QString, LibraryTrack> cache;
+    const QVector<LibraryTrack> previous = LibraryScanner::loadCache(cachePath);
+    for (const LibraryTrack &track : previous)
+        cache.insert(track.filePath, track);
+
+    QElapsedTimer timer;
+    timer.start();
+    const QStringList files = LibraryScanner::listAudioFiles(root, recursive);
+    const QVector<LibraryTrack> tracks = LibraryScanner::index(files, cache, jobs);
+    if (!LibraryScanner::saveCache(cachePath, root, tracks)) {
+        err() << "failed to write " << cachePath << Qt::endl;
+        return 1;
+    }
+
+    LibraryDatabase database;
+    if (!database.open(dataDir + "/library.db") || !database.syncTracks(root, tracks, recursive)) {
+        err() << "failed to update " << dataDir << "/library.db" << Qt::endl;
+        return 1;
+    }
+
+    int reused = 0, withLyrics = 0;
+    for (const LibraryTrack &track : tracks) {
+        if (cache.contains(track.filePath))
+            ++reused;
+        if (!track.lrcPath.isEmpty())
+            ++withLyrics;
+    }
+    out() << "indexed " << tracks.size() << " tracks (" << reused << " from cache, "
+          << withLyrics << " with lyrics) in " << timer.elapsed() << " ms -> " << cachePath << Qt::endl;
+    return 0;
+}
+
+int runQuery(const QString &dataDir, const QString &sort, bool descending, const QString &filter, int limit)
+{
+    static const QHash<QString, TrackQuery::SortKey> sortKeys = {
+        {"path", TrackQuery::ByPath}, {"title", TrackQuery::ByTitle}, {"artist", TrackQuery::ByArtist},
+        {"album", TrackQuery::ByAlbum}, {"duration", TrackQuery::ByDuration}, {"added", TrackQuery::ByAdded},
+        {"plays", TrackQuery::ByPlayCount},
+    };
+    if (!sortKeys.contains(sort)) {
+        err() << "unknown sort key: " << sort << Qt::endl;
+        return 2;
+    }
+
+    LibraryDatabase database;
+    if (!database.open(dataDir + "/library.db")) {
+        err() << "failed to open " << dataDir << "/library.db" << Qt::endl;
+        return 1;
+    }
+
+    TrackQuery query;
+    query.sort = sortKeys.value(sort);
+    query.descending = descending;
+    query.text = filter;
+    QElapsedTimer timer;
+    timer.start();
+    const QVector<LibraryTrack> tracks = database.tracks(query, 0, limit);
+    for (const LibraryTrack &track : tracks) {
+        out() << track.meta.artist << '\t' << track.meta.title << '\t' << track.meta.album << '\t'
+              << track.meta.durationMs / 1000 << '\t' << track.filePath << Qt::endl;
+    }
+    err() << tracks.size() << " of " << database.countTracks(query) << " tracks in "
+          << timer.elapsed() << " ms" << Qt::endl;
+    return 0;
+}
+
+void printStats(const QString &heading, const QVector<PlayStats> &rows)
+{
+    out() << heading << Qt::endl;
+    for (const PlayStats &row : rows) {
+        out() << '\t' << row.plays << '\t' << row.skips << '\t'
+              << QString::number(row.skipRate() * 100, 'f', 0) << "%\t"
+              << QDateTime::fromMSecsSinceEpoch(row.lastPlayed).toString(Qt::ISODate) << '\t'
+              << row.filePath << Qt::endl;
+    }
+}
+
+int runHistory(const QString &dataDir, int limit)
+{
+    PlayHistory history;
+    if (!history.open(dataDir)) {
+        err() << "failed to open play history in " << dataDir << Qt::endl;
+        return 1;
+    }
+    out() << history.eventCount() << " play events (plays, skips, skip rate, last played, file)" << Qt::endl;
+    printStats("most played:", history.mostPlayed(limit));
+    printStats("recently played:", history.recentlyPlayed(limit));
+    printStats("most skipped:", history.mostSkipped(limit));
+    return 0;
+}
+
+int runPlaylists(PlaylistInterface &playlists)
+{
+    const QStringList names = playlists.getAllPlaylistNames();
+    for (const QString &name : names) {
+        const int count = name == "favorites" ? playlists.getFavoritesSongs().size()
+                                              : playlists.getPlaylistSongs(name).size();
+        out() << name << '\t' << count << (playlists.isSmartPlaylist(name) ? "\tsmart" : "") << Qt::endl;
+    }
+    return 0;
+}
+
+int runExport(PlaylistInterface &playlists, const QStringList &args)
+{
+    if (args.size() < 3) {
+        err() << "usage: xc-cli export <playlist> <file>" << Qt::endl;
+        return 2;
+    }
+    if (!playlists.exportPlaylist(args.at(1), args.at(2))) {
+        err() << "failed to export playlist " << args.at(1) << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int runImport(PlaylistInterface &playlists, const QStringList &args, QString name)
+{
+    if (args.size() < 2) {
+        err() << "usage: xc-cli import <file> [--name playlist]" << Qt::endl;
+        return 2;
+    }
+    if (name.isEmpty())
+        name = QFileInfo(args.at(1)).completeBaseName();
+    PlaylistImportResult result;
+    if (!playlists.importPlaylist(name, args.at(1), &result)) {
+        err() << "failed to import " << args.at(1) << Qt::endl;
+        return 1;
+    }
+    out() << "imported " << result.added << " songs into " << name << " (" << result.duplicates
+          << " duplicates, " << result.missing << " missing files skipped)" << Qt::endl;
+    return 0;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("xc-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("XC music library tool");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "index | query | history | playlists | export | import");
+
+    QCommandLineOption dataOption("data", "Data directory (default ./data).", "dir", "./data");
+    QCommandLineOption recursiveOption(QStringList() << "r" << "recursive", "Scan subdirectories.");
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs", "Worker threads for indexing.", "N", "0");
+    QCommandLineOption nameOption("name", "Playlist name for import.", "name");
+    QCommandLineOption sortOption("sort", "Sort key for query: path, title, artist, album, duration, added, plays.",
+                                  "key", "path");
+    QCommandLineOption descOption("desc", "Sort descending.");
+    QCommandLineOption filterOption("filter", "Only tracks whose title, artist or album contains text.", "text");
+    QCommandLineOption limitOption("limit", "Maximum rows for query and history (default 50).", "N", "50");
+    parser.addOption(dataOption);
+    parser.addOption(recursiveOption);
+    parser.addOption(jobsOption);
+    parser.addOption(nameOption);
+    parser.addOption(sortOption);
+    parser.addOption(descOption);
+    parser.addOption(filterOption);
+    parser.addOption(limitOption);
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.isEmpty())
+        parser.showHelp(2);
+
+    const QString command = args.first();
+    const QString dataDir = parser.value(dataOption);
+
+    if (command == "index")
+        return runIndex(args, dataDir, parser.isSet(recursiveOption), parser.value(jobsOption).toInt());
+    if (command == "history")
+        return runHistory(dataDir, parser.value(limitOption).toInt());
+    if (command == "query")
+        return runQuery(dataDir, parser.value(sortOption), parser.isSet(descOption),
+                        parser.value(filterOption), parser.value(limitOption).toInt());
+
+    PlaylistInterface playlists;
+    if (!playlists.initialize(dataDir + "/playlists")) {
+        err() << "failed to open playlists in " << dataDir << Qt::endl;
+        return 1;
+    }
+
+    // 智能歌单的内容来自曲库数据库
+    LibraryDatabase database;
+    if (QFileInfo::exists(dataDir + "/library.db") && database.open(dataDir + "/library.db"))
+        playlists.setSmartTracks(database.smartTracks());
+
+    if (command == "playlists")
+        return runPlaylists(playlists);
+    if (command == "export")
+        return runExport(playlists, args);
+    if (command == "import")
+        return runImport(playlists, args, parser.value(nameOption));
+
+    err() << "unknown command: " << command << Qt::endl;
+    return 2;
+}
@@ -1,15 +1,40 @@
 #include "../ui/mainwindow.h"
 #include "../playlist/playlist_example.h"
+#include "startupmetrics.h"
+#include "singleinstance.h"
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    // 启动计时从这里开始，--startup-metrics 输出首次绘制和可交互耗时
+    StartupMetrics::start(argc, argv);
+
+    // 单实例：已有实例在运行时把要打开的文件整批转给它，然后立即退出。
+    // 这一步只需要 QCoreApplication，不创建界面、不初始化多媒体
+    const bool singleInstance = SingleInstance::isEnabled(argc, argv);
+    InstanceMessage message;
+    {
+        QCoreApplication probe(argc, argv);
+        message = InstanceMessage::fromArguments(probe.arguments());
+        if (singleInstance && SingleInstance::forward(message))
+            return 0;
+    }
+
     QApplication a(argc, argv);
-    
+
+    // 成为第一个实例；两次启动几乎同时时另一个可能抢先，这时同样转给它
+    SingleInstance instance;
+    if (singleInstance && !instance.listen() && SingleInstance::forward(message))
+        return 0;
+
     // 可选：调用测试函数演示收藏夹和歌单功能（暂时注释掉以避免构建错误）
     // testPlaylistFunctions();
-    
+
+    // 构造函数只创建主界面和播放器，其余部件在首次绘制后延迟创建
     MainWindow w;
+    QObject::connect(&instance, &SingleInstance::messageReceived, &w, &MainWindow::handleInstanceMessage);
     w.show();
+    if (!message.paths.isEmpty())
+        w.handleInstanceMessage(message);
     return a.exec();
-}
\ No newline at end of file
+}
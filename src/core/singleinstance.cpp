@@ -0,0 +1,189 @@
+#include "singleinstance.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QUrl>
+#include <QVector>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+const quint32 Magic = 0x58434931;                   // "XCI1"
+const quint32 MaxFrameBytes = 64 * 1024 * 1024;     // 超过视为格式错误
+const int ProbeTimeoutMs = 100;
+}
+
+InstanceMessage InstanceMessage::fromArguments(const QStringList &arguments)
+{
+    InstanceMessage message;
+    bool enqueueOnly = false;
+    for (int i = 1; i < arguments.size(); ++i) {
+        const QString &argument = arguments.at(i);
+        if (argument == "--enqueue") {
+            enqueueOnly = true;
+        } else if (argument.startsWith('-')) {
+            continue;
+        } else if (argument.startsWith("file:", Qt::CaseInsensitive)) {
+            message.paths << QUrl(argument).toLocalFile();
+        } else {
+            // 转发给另一个进程，工作目录不同，必须用绝对路径
+            message.paths << QFileInfo(argument).absoluteFilePath();
+        }
+    }
+    if (!message.paths.isEmpty())
+        message.command = enqueueOnly ? Enqueue : Play;
+    return message;
+}
+
+QByteArray InstanceMessage::encode() const
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << Magic << quint8(command) << paths;
+
+    QByteArray frame(4, Qt::Uninitialized);
+    qToBigEndian(quint32(payload.size()), frame.data());
+    frame += payload;
+    return frame;
+}
+
+bool InstanceMessage::decode(QByteArray *buffer, InstanceMessage *message, bool *error)
+{
+    if (error)
+        *error = false;
+    if (buffer->size() < 4)
+        return false;
+    const quint32 length = qFromBigEndian<quint32>(buffer->constData());
+    if (length > MaxFrameBytes) {
+        if (error)
+            *error = true;
+        return false;
+    }
+    if (quint32(buffer->size() - 4) < length)
+        return false;
+
+    quint32 magic = 0;
+    quint8 command = 0;
+    QStringList paths;
+    {
+        QDataStream in(QByteArray::fromRawData(buffer->constData() + 4, int(length)));
+        in.setVersion(QDataStream::Qt_6_0);
+        in >> magic >> command >> paths;
+        if (in.status() != QDataStream::Ok || magic != Magic || command > Play) {
+            if (error)
+                *error = true;
+            return false;
+        }
+    }
+    buffer->remove(0, 4 + int(length));
+    message->command = Command(command);
+    message->paths = paths;
+    return true;
+}
+
+SingleInstance::SingleInstance(const QString &name, QObject *parent)
+    : QObject(parent)
+    , m_name(name)
+    , m_server(new QLocalServer(this))
+{
+    connect(m_server, &QLocalServer::newConnection, this, &SingleInstance::onNewConnection);
+}
+
+QString SingleInstance::defaultName()
+{
+    if (qEnvironmentVariableIsSet("XC_INSTANCE_NAME"))
+        return qEnvironmentVariable("XC_INSTANCE_NAME");
+    // 每个用户一个实例；Unix 上服务名是临时目录下的文件名，不能直接用路径
+    const QByteArray home = QDir::homePath().toUtf8();
+    return "xc-music-" + QString::fromLatin1(QCryptographicHash::hash(home, QCryptographicHash::Sha1).toHex().left(12));
+}
+
+bool SingleInstance::isEnabled(int argc, char *argv[])
+{
+    if (qEnvironmentVariable("XC_SINGLE_INSTANCE") == "0")
+        return false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--new-instance") == 0 || std::strncmp(argv[i], "--startup-metrics", 17) == 0)
+            return false;
+    }
+    return true;
+}
+
+bool SingleInstance::forward(const InstanceMessage &message, const QString &name)
+{
+    QLocalSocket socket;
+    socket.connectToServer(name);
+    if (!socket.waitForConnected(ForwardTimeoutMs))
+        return false;
+
+    socket.write(message.encode());
+    while (socket.bytesToWrite() > 0) {
+        if (!socket.waitForBytesWritten(ForwardTimeoutMs)) {
+            qWarning() << "Failed to forward to running instance:" << socket.errorString();
+            return false;
+        }
+    }
+    socket.disconnectFromServer();
+    if (socket.state() != QLocalSocket::UnconnectedState)
+        socket.waitForDisconnected(ForwardTimeoutMs);
+    return true;
+}
+
+bool SingleInstance::listen()
+{
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    if (m_server->listen(m_name))
+        return true;
+
+    if (m_server->serverError() == QAbstractSocket::AddressInUseError) {
+        // 能连上说明另一个实例刚刚启动（两次启动几乎同时），由调用方把命令转给它
+        QLocalSocket probe;
+        probe.connectToServer(m_name);
+        if (probe.waitForConnected(ProbeTimeoutMs))
+            return false;
+        // 连不上：上次崩溃留下的套接字文件
+        QLocalServer::removeServer(m_name);
+        if (m_server->listen(m_name))
+            return true;
+    }
+    qWarning() << "Single instance server failed to listen:" << m_server->errorString();
+    return false;
+}
+
+void SingleInstance::onNewConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket] { onReadyRead(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket] {
+            onReadyRead(socket);
+            m_buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void SingleInstance::onReadyRead(QLocalSocket *socket)
+{
+    // 先取出所有完整的消息再发信号，处理函数里即使处理事件也不会碰到这里的缓冲区
+    QByteArray buffer = m_buffers.take(socket) + socket->readAll();
+    QVector<InstanceMessage> messages;
+    InstanceMessage message;
+    bool error = false;
+    while (InstanceMessage::decode(&buffer, &message, &error))
+        messages.append(message);
+
+    if (error) {
+        qWarning() << "Invalid single instance message, dropping connection";
+        socket->abort();
+    } else if (!buffer.isEmpty()) {
+        m_buffers.insert(socket, buffer);
+    }
+
+    for (const InstanceMessage &received : messages)
+        emit messageReceived(received);
+}
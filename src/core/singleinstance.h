@@ -0,0 +1,75 @@
+#ifndef SINGLEINSTANCE_H
+#define SINGLEINSTANCE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMetaType>
+#include <QObject>
+#include <QStringList>
+
+class QLocalServer;
+class QLocalSocket;
+
+// 转发给已运行实例的命令
+// 一次启动的所有文件放在同一条消息里（从文件管理器选中 1000 个文件打开也只发一条）。
+// 帧格式：4 字节大端长度 + QDataStream（魔数、命令、绝对路径列表）
+struct InstanceMessage
+{
+    enum Command : quint8 {
+        Activate = 0,   // 只把窗口调到前台
+        Enqueue = 1,    // 加入播放列表
+        Play = 2,       // 加入播放列表并播放其中第一首
+    };
+
+    Command command = Activate;
+    QStringList paths;
+
+    // 解析命令行：--enqueue 只加入不播放，其他以 - 开头的参数忽略；相对路径和 file:// 地址转为绝对路径
+    static InstanceMessage fromArguments(const QStringList &arguments);
+
+    QByteArray encode() const;
+    // 从 buffer 开头取出一条完整消息；数据不够时返回 false 并保留 buffer，格式错误时置 *error
+    static bool decode(QByteArray *buffer, InstanceMessage *message, bool *error = nullptr);
+};
+
+Q_DECLARE_METATYPE(InstanceMessage)
+
+// 单实例
+// 第一个实例用 QLocalServer 监听（Unix 域套接字 / Windows 命名管道，只允许当前用户连接），
+// 之后的启动在创建 QApplication 之前用 forward() 把命令交给它然后退出，
+// 不再初始化多媒体、扫描音乐目录和加载歌单。
+// 环境变量：XC_SINGLE_INSTANCE=0 关闭，XC_INSTANCE_NAME 指定服务名（默认按用户主目录区分）
+class SingleInstance : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int ForwardTimeoutMs = 1000;
+
+    explicit SingleInstance(const QString &name = defaultName(), QObject *parent = nullptr);
+
+    static QString defaultName();
+    // 单实例是否启用：环境变量未关闭，且没有 --new-instance / --startup-metrics（测启动耗时需要完整启动）
+    static bool isEnabled(int argc, char *argv[]);
+
+    // 连接已运行的实例并发送消息，成功返回 true。阻塞调用，需要已有 QCoreApplication
+    static bool forward(const InstanceMessage &message, const QString &name = defaultName());
+
+    // 开始监听。服务名被占用时：若另一个实例正在运行（同时启动时的竞争）返回 false，
+    // 否则视为上次崩溃留下的套接字文件，删除后重新监听
+    bool listen();
+    QString name() const { return m_name; }
+
+signals:
+    void messageReceived(const InstanceMessage &message);
+
+private:
+    void onNewConnection();
+    void onReadyRead(QLocalSocket *socket);
+
+    QString m_name;
+    QLocalServer *m_server;
+    QHash<QLocalSocket *, QByteArray> m_buffers;    // 各连接尚未凑成完整消息的数据
+};
+
+#endif // SINGLEINSTANCE_H
@@ -0,0 +1,53 @@
+#include "startupmetrics.h"
+#include "tracer.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QDebug>
+#include <cstring>
+
+namespace {
+QElapsedTimer startupClock;
+bool reportEnabled = false;
+bool exitAfterReport = false;
+qint64 firstPaintUs = -1;
+qint64 interactiveUs = -1;
+qint64 traceOriginUs = 0;   // main() 开始时 Tracer 的时间，用于对齐追踪时间轴
+}
+
+void StartupMetrics::start(int argc, char *argv[])
+{
+    startupClock.start();
+    traceOriginUs = Tracer::instance().nowUs();
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--startup-metrics") == 0) {
+            reportEnabled = true;
+        } else if (std::strcmp(argv[i], "--startup-metrics=exit") == 0) {
+            reportEnabled = true;
+            exitAfterReport = true;
+        }
+    }
+}
+
+void StartupMetrics::markFirstPaint()
+{
+    if (firstPaintUs >= 0)
+        return;
+    firstPaintUs = startupClock.nsecsElapsed() / 1000;
+    Tracer::instance().complete("startup.firstPaint", traceOriginUs, firstPaintUs);
+    if (reportEnabled)
+        qInfo("startup: time-to-first-paint %.1f ms", firstPaintUs / 1000.0);
+}
+
+void StartupMetrics::markInteractive()
+{
+    if (interactiveUs >= 0)
+        return;
+    interactiveUs = startupClock.nsecsElapsed() / 1000;
+    Tracer::instance().complete("startup.interactive", traceOriginUs, interactiveUs);
+    if (!reportEnabled)
+        return;
+    qInfo("startup: time-to-interactive %.1f ms", interactiveUs / 1000.0);
+    if (exitAfterReport)
+        QTimer::singleShot(0, qApp, &QCoreApplication::quit);
+}
@@ -0,0 +1,16 @@
+#ifndef STARTUPMETRICS_H
+#define STARTUPMETRICS_H
+
+// 启动耗时测量
+// 以 main() 开始为零点，记录首次绘制（time-to-first-paint）和可交互（time-to-interactive，
+// 即音乐目录和歌单加载完成）两个时间点。使用 --startup-metrics 启动时输出结果，
+// 使用 --startup-metrics=exit 时输出后自动退出，便于脚本批量测量。
+class StartupMetrics
+{
+public:
+    static void start(int argc, char *argv[]);
+    static void markFirstPaint();
+    static void markInteractive();
+};
+
+#endif // STARTUPMETRICS_H
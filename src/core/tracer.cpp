@@ -0,0 +1,226 @@
+#include "tracer.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+
+namespace {
+const int MaxEvents = 200000;   // 约 10 MB 内存上限
+}
+
+void Tracer::Histogram::add(qint64 us)
+{
+    if (us < 0)
+        us = 0;
+    int bucket = 0;
+    while (bucket < BucketCount - 1 && (qint64(1) << bucket) < us)
+        ++bucket;
+    ++buckets[bucket];
+    min = count == 0 ? us : std::min(min, us);
+    max = count == 0 ? us : std::max(max, us);
+    sum += us;
+    ++count;
+}
+
+qint64 Tracer::Histogram::percentile(double p) const
+{
+    if (count == 0)
+        return 0;
+    qint64 target = qint64(p * count + 0.5);
+    qint64 seen = 0;
+    for (int b = 0; b < BucketCount; ++b) {
+        seen += buckets[b];
+        if (seen >= target && seen > 0)
+            return std::min(qint64(1) << b, max);
+    }
+    return max;
+}
+
+Tracer &Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer()
+{
+    m_dumpPath = qEnvironmentVariable("XC_TRACE_FILE");
+    m_enabled = !m_dumpPath.isEmpty() || qEnvironmentVariableIntValue("XC_TRACE") != 0;
+    if (m_enabled && m_dumpPath.isEmpty())
+        m_dumpPath = "xc_trace.json";
+    m_clock.start();
+    if (m_enabled)
+        m_events.reserve(4096);
+}
+
+int Tracer::threadIndexLocked()
+{
+    quintptr key = quintptr(QThread::currentThreadId());
+    auto it = m_threadIndex.find(key);
+    if (it == m_threadIndex.end())
+        it = m_threadIndex.insert(key, m_threadIndex.size() + 1);
+    return it.value();
+}
+
+void Tracer::appendLocked(const Event &event)
+{
+    if (m_events.size() < MaxEvents) {
+        m_events.append(event);
+        return;
+    }
+    m_events[m_eventHead] = event;
+    m_eventHead = (m_eventHead + 1) % MaxEvents;
+    m_eventsWrapped = true;
+}
+
+void Tracer::complete(const QByteArray &name, qint64 startUs, qint64 durationUs)
+{
+    if (!m_enabled)
+        return;
+    QMutexLocker locker(&m_mutex);
+    m_histograms[name].add(durationUs);
+    appendLocked({name, 'X', startUs, durationUs, 0, threadIndexLocked()});
+}
+
+void Tracer::instant(const QByteArray &name)
+{
+    if (!m_enabled)
+        return;
+    QMutexLocker locker(&m_mutex);
+    appendLocked({name, 'i', nowUs(), 0, 0, threadIndexLocked()});
+}
+
+void Tracer::beginSwitch(const char *reason)
+{
+    if (!m_enabled)
+        return;
+    QMutexLocker locker(&m_mutex);
+    qint64 now = nowUs();
+    if (m_awaitingFirstFrame.load())
+        endSwitchLocked("superseded", now);
+
+    ++m_switchId;
+    m_switchStart = now;
+    m_switchReason = reason;
+    appendLocked({"trackSwitch:" + m_switchReason, 'b', now, 0, m_switchId, threadIndexLocked()});
+    m_awaitingFirstFrame.store(true);
+}
+
+void Tracer::markSwitch(const QByteArray &stage)
+{
+    if (!m_enabled)
+        return;
+    QMutexLocker locker(&m_mutex);
+    if (!m_awaitingFirstFrame.load())
+        return;
+    qint64 now = nowUs();
+    m_histograms["switch." + stage].add(now - m_switchStart);
+    appendLocked({"switch." + stage, 'n', now, 0, m_switchId, threadIndexLocked()});
+}
+
+void Tracer::markFirstAudioFrame()
+{
+    if (!m_awaitingFirstFrame.exchange(false))
+        return;
+    QMutexLocker locker(&m_mutex);
+    endSwitchLocked("firstAudioFrame", nowUs());
+}
+
+void Tracer::endSwitchLocked(const char *outcome, qint64 now)
+{
+    m_awaitingFirstFrame.store(false);
+    qint64 latency = now - m_switchStart;
+    QByteArray stage = QByteArray("switch.") + outcome;
+    m_histograms[stage].add(latency);
+    m_histograms[stage + "." + m_switchReason].add(latency);
+    appendLocked({"trackSwitch:" + m_switchReason, 'e', now, 0, m_switchId, threadIndexLocked()});
+}
+
+QHash<QByteArray, Tracer::Histogram> Tracer::histograms() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_histograms;
+}
+
+QString Tracer::summary() const
+{
+    QHash<QByteArray, Histogram> copy = histograms();
+    QList<QByteArray> names = copy.keys();
+    std::sort(names.begin(), names.end());
+
+    QString text;
+    for (const QByteArray &name : names) {
+        const Histogram &h = copy[name];
+        text += QString("%1  n=%2  avg=%3us  p50=%4us  p95=%5us  max=%6us\n")
+                    .arg(QString::fromUtf8(name), -40)
+                    .arg(h.count)
+                    .arg(h.count ? h.sum / h.count : 0)
+                    .arg(h.percentile(0.5))
+                    .arg(h.percentile(0.95))
+                    .arg(h.max);
+    }
+    return text;
+}
+
+bool Tracer::dumpChromeTrace(const QString &filePath) const
+{
+    if (!m_enabled)
+        return false;
+
+    QMutexLocker locker(&m_mutex);
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray traceEvents;
+    const int total = m_events.size();
+    const int first = m_eventsWrapped ? m_eventHead : 0;
+    for (int i = 0; i < total; ++i) {
+        const Event &event = m_events[(first + i) % total];
+        QJsonObject object;
+        object["name"] = QString::fromUtf8(event.name);
+        object["cat"] = event.id ? "switch" : "xc";
+        object["ph"] = QString(QChar(event.phase));
+        object["ts"] = double(event.ts);
+        object["pid"] = double(pid);
+        object["tid"] = event.tid;
+        if (event.phase == 'X')
+            object["dur"] = double(event.dur);
+        if (event.phase == 'i')
+            object["s"] = "t";
+        if (event.id)
+            object["id"] = QString::number(event.id);
+        traceEvents.append(object);
+    }
+
+    // 直方图放在 otherData 中，Chrome trace 查看器会忽略但保留它
+    QJsonObject histogramData;
+    for (auto it = m_histograms.constBegin(); it != m_histograms.constEnd(); ++it) {
+        const Histogram &h = it.value();
+        QJsonArray buckets;
+        for (int b = 0; b < Histogram::BucketCount; ++b)
+            buckets.append(double(h.buckets[b]));
+        QJsonObject object;
+        object["count"] = double(h.count);
+        object["sumUs"] = double(h.sum);
+        object["minUs"] = double(h.min);
+        object["maxUs"] = double(h.max);
+        object["p50Us"] = double(h.percentile(0.5));
+        object["p95Us"] = double(h.percentile(0.95));
+        object["log2Buckets"] = buckets;
+        histogramData[QString::fromUtf8(it.key())] = object;
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+    root["otherData"] = QJsonObject{{"histograms", histogramData}};
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return true;
+}
@@ -0,0 +1,105 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+// 轻量级性能追踪
+// 记录代码区间（span）和切歌过程中各阶段相对于用户操作的延迟，
+// 每个名称维护一个对数分桶直方图，并可导出为 Chrome trace JSON（chrome://tracing 或 Perfetto 打开）。
+// 通过环境变量启用：XC_TRACE=1 或 XC_TRACE_FILE=<导出路径>，未启用时所有调用立即返回。
+class Tracer
+{
+public:
+    // 直方图：按 2 的幂分桶，单位微秒
+    struct Histogram {
+        static const int BucketCount = 32;
+        qint64 count = 0;
+        qint64 sum = 0;
+        qint64 min = 0;
+        qint64 max = 0;
+        qint64 buckets[BucketCount] = {};
+
+        void add(qint64 us);
+        qint64 percentile(double p) const;
+    };
+
+    static Tracer &instance();
+
+    bool isEnabled() const { return m_enabled; }
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+
+    // 记录一个已完成的区间
+    void complete(const QByteArray &name, qint64 startUs, qint64 durationUs);
+    // 记录一个瞬时事件
+    void instant(const QByteArray &name);
+
+    // 切歌追踪：从用户操作（或自动下一首）开始，到第一帧音频输出结束
+    void beginSwitch(const char *reason);
+    void markSwitch(const QByteArray &stage);
+    void markFirstAudioFrame();   // 可在音频线程调用，未在等待时几乎无开销
+
+    QHash<QByteArray, Histogram> histograms() const;
+    QString summary() const;
+    bool dumpChromeTrace(const QString &filePath) const;
+    QString defaultDumpPath() const { return m_dumpPath; }
+
+private:
+    Tracer();
+    void endSwitchLocked(const char *outcome, qint64 now);
+
+    struct Event {
+        QByteArray name;
+        char phase;         // 'X' 区间，'i' 瞬时，'b'/'e' 异步开始/结束
+        qint64 ts;
+        qint64 dur;
+        quint64 id;
+        int tid;
+    };
+    void appendLocked(const Event &event);
+    int threadIndexLocked();
+
+    bool m_enabled;
+    QString m_dumpPath;
+    QElapsedTimer m_clock;
+
+    mutable QMutex m_mutex;
+    QVector<Event> m_events;       // 环形存储，超过上限后覆盖最旧的事件
+    int m_eventHead = 0;
+    bool m_eventsWrapped = false;
+    QHash<QByteArray, Histogram> m_histograms;
+    QHash<quintptr, int> m_threadIndex;
+
+    quint64 m_switchId = 0;
+    qint64 m_switchStart = -1;
+    QByteArray m_switchReason;
+    std::atomic<bool> m_awaitingFirstFrame{false};
+};
+
+// 作用域区间，析构时自动记录耗时
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name)
+        : m_name(name), m_start(Tracer::instance().isEnabled() ? Tracer::instance().nowUs() : -1) {}
+    ~TraceSpan()
+    {
+        if (m_start >= 0)
+            Tracer::instance().complete(m_name, m_start, Tracer::instance().nowUs() - m_start);
+    }
+
+private:
+    const char *m_name;
+    qint64 m_start;
+};
+
+#define XC_TRACE_CONCAT_INNER(a, b) a##b
+#define XC_TRACE_CONCAT(a, b) XC_TRACE_CONCAT_INNER(a, b)
+#define XC_TRACE_SCOPE(name) TraceSpan XC_TRACE_CONCAT(xcTraceSpan_, __LINE__)(name)
+
+#endif // TRACER_H
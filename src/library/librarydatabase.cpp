@@ -0,0 +1,757 @@
+#include "librarydatabase.h"
+#include "queuesorter.h"
+#include "../playlist/smartplaylist.h"
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+const int SchemaVersion = 2;
+const int BatchSize = 5000;     // 每个事务写入的行数
+const qint64 RankGap = 1 << 20; // 排序名次之间的间隔，新增的文本插在两个名次之间，不必改动其他行
+
+const char UpsertTrackSql[] =
+    "INSERT INTO tracks(path, title, artist, album, duration_ms, size, modified, lrc_path, added_at) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?) "
+    "ON CONFLICT(path) DO UPDATE SET title = excluded.title, artist = excluded.artist,"
+    " album = excluded.album, duration_ms = excluded.duration_ms, size = excluded.size,"
+    " modified = excluded.modified, lrc_path = excluded.lrc_path,"
+    " title_rank = CASE WHEN title = excluded.title THEN title_rank END,"
+    " artist_rank = CASE WHEN artist = excluded.artist THEN artist_rank END,"
+    " album_rank = CASE WHEN album = excluded.album THEN album_rank END";
+
+void bindTrack(QSqlQuery &query, const LibraryTrack &track, qint64 now)
+{
+    const QString title = track.meta.title.isEmpty() ? QFileInfo(track.filePath).completeBaseName()
+                                                     : track.meta.title;
+    query.bindValue(0, track.filePath);
+    query.bindValue(1, title);
+    query.bindValue(2, track.meta.artist);
+    query.bindValue(3, track.meta.album);
+    query.bindValue(4, track.meta.durationMs);
+    query.bindValue(5, track.size);
+    query.bindValue(6, track.modified);
+    query.bindValue(7, track.lrcPath);
+    query.bindValue(8, now);
+}
+
+QSqlDatabase database(const QString &connection)
+{
+    return QSqlDatabase::database(connection, false);
+}
+
+bool exec(QSqlQuery &query, const char *what)
+{
+    if (query.exec())
+        return true;
+    qWarning() << "Library database" << what << "failed:" << query.lastError().text();
+    return false;
+}
+
+bool execSql(const QSqlDatabase &db, const QString &sql)
+{
+    QSqlQuery query(db);
+    if (query.exec(sql))
+        return true;
+    qWarning() << "Library database failed:" << sql << query.lastError().text();
+    return false;
+}
+
+// 按 QueueSorter 的比较规则（简体中文：汉字按拼音，数字按数值）给一列的每个不同文本分配名次，写入 rankColumn。
+// 名次为空的行（新插入或文本变了）才需要处理：已有名次仍然有序的保持不变，新文本取前后两个名次之间的值，
+// 间隔用完或原有名次不再有序时整列重新编号
+bool refreshRankColumn(QSqlDatabase db, const char *column, const char *rankColumn)
+{
+    QSqlQuery pending(db);
+    if (!pending.exec(QString("SELECT 1 FROM tracks WHERE %1 IS NULL LIMIT 1").arg(rankColumn)))
+        return false;
+    if (!pending.next())
+        return true;
+
+    struct Group
+    {
+        QString text;
+        qint64 rank = 0;        // 该文本所有行的名次一致时有效，否则为 0
+        qint64 newRank = 0;
+    };
+    QVector<Group> groups;
+    QSqlQuery select(db);
+    select.setForwardOnly(true);
+    if (!select.exec(QString("SELECT %1, MIN(%2), MAX(%2), COUNT(*) - COUNT(%2) FROM tracks GROUP BY %1")
+                         .arg(column, rankColumn)))
+        return false;
+    while (select.next()) {
+        Group group;
+        group.text = select.value(0).toString();
+        const qint64 minRank = select.value(1).toLongLong();
+        if (select.value(3).toLongLong() == 0 && minRank == select.value(2).toLongLong())
+            group.rank = minRank;
+        groups.append(group);
+    }
+
+    const QCollator collator = QueueSorter::collator();
+    std::vector<QCollatorSortKey> keys;
+    keys.reserve(groups.size());
+    for (const Group &group : std::as_const(groups))
+        keys.push_back(collator.sortKey(group.text));
+    QVector<int> order(groups.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&keys](int a, int b) { return keys[a].compare(keys[b]) < 0; });
+
+    // 比较结果相等的文本（只差大小写等）合为一类，共用一个名次
+    QVector<int> classStart;
+    for (int i = 0; i < order.size(); ++i) {
+        if (i == 0 || keys[order[i - 1]].compare(keys[order[i]]) != 0)
+            classStart.append(i);
+    }
+    const int classes = int(classStart.size());
+    classStart.append(int(order.size()));
+    QVector<qint64> classRank(classes, 0);
+    qint64 last = 0;
+    for (int c = 0; c < classes; ++c) {
+        const qint64 rank = groups[order[classStart[c]]].rank;
+        bool consistent = rank > last;
+        for (int i = classStart[c] + 1; consistent && i < classStart[c + 1]; ++i)
+            consistent = groups[order[i]].rank == rank;
+        if (consistent) {
+            classRank[c] = rank;
+            last = rank;
+        }
+    }
+
+    // 填补没有名次的类；两侧名次之间放不下时整列重新编号
+    bool renumber = false;
+    for (int c = 0; c < classes && !renumber;) {
+        if (classRank[c] != 0) {
+            ++c;
+            continue;
+        }
+        int end = c;
+        while (end < classes && classRank[end] == 0)
+            ++end;
+        const qint64 low = c > 0 ? classRank[c - 1] : 0;
+        const qint64 high = end < classes ? classRank[end] : low + RankGap * (end - c + 1);
+        const qint64 step = (high - low) / (end - c + 1);
+        if (step < 1)
+            renumber = true;
+        for (int i = c; i < end; ++i)
+            classRank[i] = low + step * (i - c + 1);
+        c = end;
+    }
+    if (renumber) {
+        for (int c = 0; c < classes; ++c)
+            classRank[c] = RankGap * (c + 1);
+    }
+    for (int c = 0; c < classes; ++c) {
+        for (int i = classStart[c]; i < classStart[c + 1]; ++i)
+            groups[order[i]].newRank = classRank[c];
+    }
+
+    // 变化的文本先写进临时表，再一次 UPDATE 带到所有对应的行
+    if (!execSql(db, "CREATE TEMP TABLE IF NOT EXISTS rank_updates (text TEXT PRIMARY KEY, rank INTEGER NOT NULL)")
+        || !db.transaction())
+        return false;
+    execSql(db, "DELETE FROM temp.rank_updates");
+    QSqlQuery insert(db);
+    insert.prepare("INSERT INTO temp.rank_updates(text, rank) VALUES (?, ?)");
+    for (const Group &group : std::as_const(groups)) {
+        if (group.rank == group.newRank)
+            continue;
+        insert.bindValue(0, group.text);
+        insert.bindValue(1, group.newRank);
+        if (!exec(insert, "rank")) {
+            db.rollback();
+            return false;
+        }
+    }
+    const QString update = QString("UPDATE tracks SET %2 = (SELECT rank FROM temp.rank_updates u WHERE u.text = tracks.%1)"
+                                   " WHERE %1 IN (SELECT text FROM temp.rank_updates)").arg(column, rankColumn);
+    if (!execSql(db, update)) {
+        db.rollback();
+        return false;
+    }
+    execSql(db, "DELETE FROM temp.rank_updates");
+    return db.commit();
+}
+
+// 目录前缀范围 [root/, root0)，'0' 是 '/' 的下一个字符，可以直接走 path 上的唯一索引
+QPair<QString, QString> prefixRange(const QString &rootDirectory)
+{
+    QString prefix = QDir::cleanPath(rootDirectory) + "/";
+    QString upper = prefix;
+    upper[upper.size() - 1] = QChar('/' + 1);
+    return qMakePair(prefix, upper);
+}
+
+QString likePattern(const QString &text)
+{
+    QString escaped = text;
+    escaped.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+    return "%" + escaped + "%";
+}
+
+QString whereClause(const TrackQuery &query, QVariantList &binds)
+{
+    QStringList conditions;
+    if (!query.rootDirectory.isEmpty()) {
+        const auto range = prefixRange(query.rootDirectory);
+        conditions << "t.path >= ? AND t.path < ?";
+        binds << range.first << range.second;
+    }
+    if (!query.artist.isEmpty()) {
+        conditions << "t.artist = ? COLLATE NOCASE";
+        binds << query.artist;
+    }
+    if (!query.album.isEmpty()) {
+        conditions << "t.album = ? COLLATE NOCASE";
+        binds << query.album;
+    }
+    if (!query.text.isEmpty()) {
+        const QString pattern = likePattern(query.text);
+        conditions << "(t.title LIKE ? ESCAPE '\\' OR t.artist LIKE ? ESCAPE '\\' OR t.album LIKE ? ESCAPE '\\')";
+        binds << pattern << pattern << pattern;
+    }
+    if (query.minDurationMs > 0) {
+        conditions << "t.duration_ms >= ?";
+        binds << query.minDurationMs;
+    }
+    if (query.maxDurationMs > 0) {
+        conditions << "t.duration_ms <= ?";
+        binds << query.maxDurationMs;
+    }
+    return conditions.isEmpty() ? QString() : " WHERE " + conditions.join(" AND ");
+}
+
+// 排序列与 createSchema 中的索引一一对应
+QString orderClause(const TrackQuery &query)
+{
+    QStringList terms;
+    switch (query.sort) {
+    case TrackQuery::ByPath:
+        terms << "t.path";
+        break;
+    case TrackQuery::ByTitle:
+        terms << "t.title_rank";
+        break;
+    case TrackQuery::ByArtist:
+        terms << "t.artist_rank" << "t.album_rank" << "t.title_rank";
+        break;
+    case TrackQuery::ByAlbum:
+        terms << "t.album_rank" << "t.title_rank";
+        break;
+    case TrackQuery::ByDuration:
+        terms << "t.duration_ms";
+        break;
+    case TrackQuery::ByAdded:
+        terms << "t.added_at";
+        break;
+    case TrackQuery::ByPlayCount:
+        terms << "IFNULL(s.play_count, 0)";
+        break;
+    }
+    terms << "t.id";
+    if (query.descending) {
+        for (QString &term : terms)
+            term += " DESC";
+    }
+    return " ORDER BY " + terms.join(", ");
+}
+}
+
+LibraryDatabase::LibraryDatabase()
+{
+    static QAtomicInt counter;
+    m_connection = QString("xc_library_%1").arg(counter.fetchAndAddRelaxed(1));
+}
+
+LibraryDatabase::~LibraryDatabase()
+{
+    close();
+}
+
+bool LibraryDatabase::open(const QString &filePath)
+{
+    close();
+    QDir().mkpath(QFileInfo(filePath).path());
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", m_connection);
+        db.setDatabaseName(filePath);
+        if (!db.open()) {
+            qWarning() << "Failed to open library database" << filePath << db.lastError().text();
+            db = QSqlDatabase();
+            QSqlDatabase::removeDatabase(m_connection);
+            return false;
+        }
+
+        // WAL：读写互不阻塞，批量写入只在提交时同步一次
+        execSql(db, "PRAGMA journal_mode=WAL");
+        execSql(db, "PRAGMA synchronous=NORMAL");
+        execSql(db, "PRAGMA foreign_keys=ON");
+        execSql(db, "PRAGMA temp_store=MEMORY");
+    }
+
+    if (!createSchema()) {
+        close();
+        return false;
+    }
+    // 升级后或上次计算中断时补齐排序名次；都已计算时只是一次索引查找
+    refreshSortRanks();
+    return true;
+}
+
+bool LibraryDatabase::refreshSortRanks()
+{
+    const QSqlDatabase db = database(m_connection);
+    return refreshRankColumn(db, "title", "title_rank")
+        && refreshRankColumn(db, "artist", "artist_rank")
+        && refreshRankColumn(db, "album", "album_rank");
+}
+
+void LibraryDatabase::close()
+{
+    if (!QSqlDatabase::contains(m_connection))
+        return;
+    {
+        QSqlDatabase db = database(m_connection);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(m_connection);
+}
+
+bool LibraryDatabase::isOpen() const
+{
+    return QSqlDatabase::contains(m_connection) && database(m_connection).isOpen();
+}
+
+bool LibraryDatabase::createSchema()
+{
+    QSqlDatabase db = database(m_connection);
+    QSqlQuery version(db);
+    const int current = version.exec("PRAGMA user_version") && version.next() ? version.value(0).toInt() : 0;
+    if (current >= SchemaVersion)
+        return true;
+
+    // 版本 1 → 2：标题/艺术家/专辑改按排序名次排序，名次在 open() 之后计算
+    static const char *upgrades[] = {
+        "ALTER TABLE tracks ADD COLUMN title_rank INTEGER",
+        "ALTER TABLE tracks ADD COLUMN artist_rank INTEGER",
+        "ALTER TABLE tracks ADD COLUMN album_rank INTEGER",
+        "DROP INDEX IF EXISTS idx_tracks_title",
+    };
+
+    static const char *statements[] = {
+        "CREATE TABLE IF NOT EXISTS tracks ("
+        " id INTEGER PRIMARY KEY,"
+        " path TEXT NOT NULL UNIQUE,"
+        " title TEXT NOT NULL DEFAULT '',"
+        " artist TEXT NOT NULL DEFAULT '',"
+        " album TEXT NOT NULL DEFAULT '',"
+        " duration_ms INTEGER NOT NULL DEFAULT 0,"
+        " size INTEGER NOT NULL DEFAULT 0,"
+        " modified INTEGER NOT NULL DEFAULT 0,"
+        " lrc_path TEXT NOT NULL DEFAULT '',"
+        " added_at INTEGER NOT NULL DEFAULT 0,"
+        " title_rank INTEGER,"      // 排序名次，见 refreshRankColumn；为空表示尚未计算
+        " artist_rank INTEGER,"
+        " album_rank INTEGER)",
+        "CREATE INDEX IF NOT EXISTS idx_tracks_title_rank ON tracks(title_rank)",
+        "CREATE INDEX IF NOT EXISTS idx_tracks_artist_rank ON tracks(artist_rank, album_rank, title_rank)",
+        "CREATE INDEX IF NOT EXISTS idx_tracks_album_rank ON tracks(album_rank, title_rank)",
+        "CREATE INDEX IF NOT EXISTS idx_tracks_artist ON tracks(artist COLLATE NOCASE, album COLLATE NOCASE, title COLLATE NOCASE)",
+        "CREATE INDEX IF NOT EXISTS idx_tracks_album ON tracks(album COLLATE NOCASE, title COLLATE NOCASE)",
+        "CREATE INDEX IF NOT EXISTS idx_tracks_duration ON tracks(duration_ms)",
+        "CREATE INDEX IF NOT EXISTS idx_tracks_added ON tracks(added_at)",
+
+        "CREATE TABLE IF NOT EXISTS playlists ("
+        " id INTEGER PRIMARY KEY,"
+        " name TEXT NOT NULL UNIQUE,"
+        " created_at INTEGER NOT NULL DEFAULT 0)",
+        "CREATE TABLE IF NOT EXISTS playlist_tracks ("
+        " playlist_id INTEGER NOT NULL REFERENCES playlists(id) ON DELETE CASCADE,"
+        " position INTEGER NOT NULL,"
+        " track_id INTEGER NOT NULL REFERENCES tracks(id) ON DELETE CASCADE,"
+        " PRIMARY KEY (playlist_id, position)) WITHOUT ROWID",
+        "CREATE INDEX IF NOT EXISTS idx_playlist_tracks_track ON playlist_tracks(track_id)",
+
+        "CREATE TABLE IF NOT EXISTS play_stats ("
+        " track_id INTEGER PRIMARY KEY REFERENCES tracks(id) ON DELETE CASCADE,"
+        " play_count INTEGER NOT NULL DEFAULT 0,"
+        " last_played INTEGER NOT NULL DEFAULT 0)",
+        "CREATE INDEX IF NOT EXISTS idx_play_stats_count ON play_stats(play_count)",
+
+        "CREATE TABLE IF NOT EXISTS metadata_cache ("
+        " track_id INTEGER NOT NULL REFERENCES tracks(id) ON DELETE CASCADE,"
+        " key TEXT NOT NULL,"
+        " value BLOB,"
+        " updated_at INTEGER NOT NULL DEFAULT 0,"
+        " PRIMARY KEY (track_id, key)) WITHOUT ROWID",
+
+        "CREATE TABLE IF NOT EXISTS library_roots ("
+        " path TEXT PRIMARY KEY,"
+        " modified INTEGER NOT NULL DEFAULT 0)",
+    };
+
+    if (!db.transaction())
+        return false;
+    if (current == 1) {
+        for (const char *sql : upgrades) {
+            if (!execSql(db, QString::fromLatin1(sql))) {
+                db.rollback();
+                return false;
+            }
+        }
+    }
+    for (const char *sql : statements) {
+        if (!execSql(db, QString::fromLatin1(sql))) {
+            db.rollback();
+            return false;
+        }
+    }
+    execSql(db, QString("PRAGMA user_version=%1").arg(SchemaVersion));
+    return db.commit();
+}
+
+template <typename BindRow>
+bool LibraryDatabase::syncRows(const QString &rootDirectory, bool recursive, int count, const QString &insertSql,
+                               BindRow bindRow)
+{
+    QSqlDatabase db = database(m_connection);
+    if (!db.isOpen())
+        return false;
+
+    // 本次看到的路径放在临时表里，最后一次性删除目录下已经不存在的歌曲
+    if (!execSql(db, "CREATE TEMP TABLE IF NOT EXISTS scan_seen (path TEXT PRIMARY KEY)")
+        || !execSql(db, "DELETE FROM temp.scan_seen"))
+        return false;
+
+    QSqlQuery insert(db);
+    QSqlQuery seen(db);
+    if (!insert.prepare(insertSql) || !seen.prepare("INSERT OR IGNORE INTO temp.scan_seen(path) VALUES (?)")) {
+        qWarning() << "Library database prepare failed:" << insert.lastError().text();
+        return false;
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (int start = 0; start < count; start += BatchSize) {
+        if (!db.transaction())
+            return false;
+        const int end = qMin(count, start + BatchSize);
+        for (int i = start; i < end; ++i) {
+            QString path = bindRow(insert, i, now);
+            seen.bindValue(0, path);
+            if (!exec(insert, "insert") || !exec(seen, "mark")) {
+                db.rollback();
+                return false;
+            }
+        }
+        if (!db.commit())
+            return false;
+    }
+
+    const auto range = prefixRange(rootDirectory);
+    if (!db.transaction())
+        return false;
+    QSqlQuery remove(db);
+    // 没有扫描子目录时，前缀范围里子目录中的歌曲不能当作已删除
+    remove.prepare(QString("DELETE FROM tracks WHERE path >= ? AND path < ? ")
+                   + (recursive ? "" : "AND instr(substr(path, length(?) + 1), '/') = 0 ")
+                   + "AND path NOT IN (SELECT path FROM temp.scan_seen)");
+    remove.addBindValue(range.first);
+    remove.addBindValue(range.second);
+    if (!recursive)
+        remove.addBindValue(range.first);
+    QSqlQuery root(db);
+    root.prepare("INSERT INTO library_roots(path, modified) VALUES (?, ?) "
+                 "ON CONFLICT(path) DO UPDATE SET modified = excluded.modified");
+    root.addBindValue(QDir::cleanPath(rootDirectory));
+    root.addBindValue(QFileInfo(rootDirectory).lastModified().toMSecsSinceEpoch());
+    if (!exec(remove, "remove missing") || !exec(root, "record root")) {
+        db.rollback();
+        return false;
+    }
+    execSql(db, "DELETE FROM temp.scan_seen");
+    return db.commit() && refreshSortRanks();
+}
+
+bool LibraryDatabase::syncTracks(const QString &rootDirectory, const QVector<LibraryTrack> &tracks, bool recursive)
+{
+    return syncRows(rootDirectory, recursive, tracks.size(), QString::fromLatin1(UpsertTrackSql),
+                    [&tracks](QSqlQuery &query, int i, qint64 now) {
+        bindTrack(query, tracks[i], now);
+        return tracks[i].filePath;
+    });
+}
+
+bool LibraryDatabase::applyChanges(const QString &rootDirectory, const QVector<LibraryTrack> &added,
+                                   const QStringList &removed)
+{
+    QSqlDatabase db = database(m_connection);
+    if (!db.isOpen() || !db.transaction())
+        return false;
+
+    QSqlQuery insert(db);
+    QSqlQuery remove(db);
+    insert.prepare(QString::fromLatin1(UpsertTrackSql));
+    remove.prepare("DELETE FROM tracks WHERE path = ?");
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (const LibraryTrack &track : added) {
+        bindTrack(insert, track, now);
+        if (!exec(insert, "insert")) {
+            db.rollback();
+            return false;
+        }
+    }
+    for (const QString &path : removed) {
+        remove.bindValue(0, path);
+        if (!exec(remove, "remove")) {
+            db.rollback();
+            return false;
+        }
+    }
+
+    // 目录修改时间随之更新，下次启动不必重新同步
+    QSqlQuery root(db);
+    root.prepare("INSERT INTO library_roots(path, modified) VALUES (?, ?) "
+                 "ON CONFLICT(path) DO UPDATE SET modified = excluded.modified");
+    root.addBindValue(QDir::cleanPath(rootDirectory));
+    root.addBindValue(QFileInfo(rootDirectory).lastModified().toMSecsSinceEpoch());
+    if (!exec(root, "record root")) {
+        db.rollback();
+        return false;
+    }
+    return db.commit() && refreshSortRanks();
+}
+
+bool LibraryDatabase::syncPaths(const QString &rootDirectory, const QStringList &paths, bool recursive)
+{
+    const QString sql = "INSERT OR IGNORE INTO tracks(path, title, added_at) VALUES (?, ?, ?)";
+    return syncRows(rootDirectory, recursive, paths.size(), sql, [&paths](QSqlQuery &query, int i, qint64 now) {
+        query.bindValue(0, paths[i]);
+        query.bindValue(1, QFileInfo(paths[i]).completeBaseName());
+        query.bindValue(2, now);
+        return paths[i];
+    });
+}
+
+bool LibraryDatabase::isDirectoryFresh(const QString &rootDirectory) const
+{
+    QSqlQuery query(database(m_connection));
+    query.prepare("SELECT modified FROM library_roots WHERE path = ?");
+    query.addBindValue(QDir::cleanPath(rootDirectory));
+    if (!query.exec() || !query.next())
+        return false;
+    return query.value(0).toLongLong() == QFileInfo(rootDirectory).lastModified().toMSecsSinceEpoch();
+}
+
+int LibraryDatabase::countTracks(const TrackQuery &trackQuery) const
+{
+    QVariantList binds;
+    QSqlQuery query(database(m_connection));
+    query.prepare("SELECT COUNT(*) FROM tracks t" + whereClause(trackQuery, binds));
+    for (const QVariant &value : binds)
+        query.addBindValue(value);
+    if (!exec(query, "count") || !query.next())
+        return 0;
+    return query.value(0).toInt();
+}
+
+QVector<LibraryTrack> LibraryDatabase::tracks(const TrackQuery &trackQuery, int offset, int limit) const
+{
+    QVector<LibraryTrack> result;
+    QVariantList binds;
+    const QString join = trackQuery.sort == TrackQuery::ByPlayCount
+                             ? " LEFT JOIN play_stats s ON s.track_id = t.id" : QString();
+    QSqlQuery query(database(m_connection));
+    query.setForwardOnly(true);
+    query.prepare("SELECT t.path, t.title, t.artist, t.album, t.duration_ms, t.size, t.modified, t.lrc_path"
+                  " FROM tracks t" + join + whereClause(trackQuery, binds) + orderClause(trackQuery)
+                  + " LIMIT ? OFFSET ?");
+    for (const QVariant &value : binds)
+        query.addBindValue(value);
+    query.addBindValue(limit);
+    query.addBindValue(offset);
+    if (!exec(query, "select"))
+        return result;
+
+    result.reserve(limit);
+    while (query.next()) {
+        LibraryTrack track;
+        track.filePath = query.value(0).toString();
+        track.meta.title = query.value(1).toString();
+        track.meta.artist = query.value(2).toString();
+        track.meta.album = query.value(3).toString();
+        track.meta.durationMs = query.value(4).toLongLong();
+        track.size = query.value(5).toLongLong();
+        track.modified = query.value(6).toLongLong();
+        track.lrcPath = query.value(7).toString();
+        result.append(track);
+    }
+    return result;
+}
+
+QVector<SmartTrack> LibraryDatabase::smartTracks() const
+{
+    QVector<SmartTrack> result;
+    QSqlQuery query(database(m_connection));
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT t.path, t.title, t.artist, t.album, t.duration_ms, t.added_at, IFNULL(s.play_count, 0)"
+                    " FROM tracks t LEFT JOIN play_stats s ON s.track_id = t.id")) {
+        qWarning() << "Library database smart tracks failed:" << query.lastError().text();
+        return result;
+    }
+    while (query.next()) {
+        SmartTrack track;
+        track.filePath = query.value(0).toString();
+        track.title = query.value(1).toString();
+        track.artist = query.value(2).toString();
+        track.album = query.value(3).toString();
+        track.duration = int(query.value(4).toLongLong() / 1000);
+        track.addedAt = query.value(5).toLongLong();
+        track.playCount = query.value(6).toInt();
+        result.append(track);
+    }
+    return result;
+}
+
+qint64 LibraryDatabase::trackId(const QString &filePath, bool create) const
+{
+    QSqlDatabase db = database(m_connection);
+    if (create) {
+        QSqlQuery insert(db);
+        insert.prepare("INSERT OR IGNORE INTO tracks(path, title, added_at) VALUES (?, ?, ?)");
+        insert.addBindValue(filePath);
+        insert.addBindValue(QFileInfo(filePath).completeBaseName());
+        insert.addBindValue(QDateTime::currentMSecsSinceEpoch());
+        exec(insert, "insert track");
+    }
+    QSqlQuery query(db);
+    query.prepare("SELECT id FROM tracks WHERE path = ?");
+    query.addBindValue(filePath);
+    if (!query.exec() || !query.next())
+        return -1;
+    return query.value(0).toLongLong();
+}
+
+bool LibraryDatabase::setPlaylistTracks(const QString &name, const QStringList &paths)
+{
+    QSqlDatabase db = database(m_connection);
+    if (!db.transaction())
+        return false;
+
+    QSqlQuery playlist(db);
+    playlist.prepare("INSERT OR IGNORE INTO playlists(name, created_at) VALUES (?, ?)");
+    playlist.addBindValue(name);
+    playlist.addBindValue(QDateTime::currentMSecsSinceEpoch());
+    QSqlQuery clear(db);
+    clear.prepare("DELETE FROM playlist_tracks WHERE playlist_id = (SELECT id FROM playlists WHERE name = ?)");
+    clear.addBindValue(name);
+    if (!exec(playlist, "create playlist") || !exec(clear, "clear playlist")) {
+        db.rollback();
+        return false;
+    }
+
+    QSqlQuery track(db);
+    QSqlQuery item(db);
+    track.prepare("INSERT OR IGNORE INTO tracks(path, title, added_at) VALUES (?, ?, ?)");
+    item.prepare("INSERT INTO playlist_tracks(playlist_id, position, track_id) "
+                 "SELECT p.id, ?, t.id FROM playlists p, tracks t WHERE p.name = ? AND t.path = ?");
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (int i = 0; i < paths.size(); ++i) {
+        track.bindValue(0, paths[i]);
+        track.bindValue(1, QFileInfo(paths[i]).completeBaseName());
+        track.bindValue(2, now);
+        item.bindValue(0, i);
+        item.bindValue(1, name);
+        item.bindValue(2, paths[i]);
+        if (!exec(track, "insert track") || !exec(item, "insert playlist item")) {
+            db.rollback();
+            return false;
+        }
+    }
+    return db.commit();
+}
+
+QStringList LibraryDatabase::playlistTracks(const QString &name, int offset, int limit) const
+{
+    QStringList paths;
+    QSqlQuery query(database(m_connection));
+    query.setForwardOnly(true);
+    query.prepare("SELECT t.path FROM playlist_tracks i"
+                  " JOIN playlists p ON p.id = i.playlist_id"
+                  " JOIN tracks t ON t.id = i.track_id"
+                  " WHERE p.name = ? ORDER BY i.position LIMIT ? OFFSET ?");
+    query.addBindValue(name);
+    query.addBindValue(limit);
+    query.addBindValue(offset);
+    if (!exec(query, "playlist tracks"))
+        return paths;
+    while (query.next())
+        paths.append(query.value(0).toString());
+    return paths;
+}
+
+bool LibraryDatabase::removePlaylist(const QString &name)
+{
+    QSqlQuery query(database(m_connection));
+    query.prepare("DELETE FROM playlists WHERE name = ?");
+    query.addBindValue(name);
+    return exec(query, "remove playlist");
+}
+
+bool LibraryDatabase::recordPlay(const QString &filePath)
+{
+    const qint64 id = trackId(filePath, true);
+    if (id < 0)
+        return false;
+    QSqlQuery query(database(m_connection));
+    query.prepare("INSERT INTO play_stats(track_id, play_count, last_played) VALUES (?, 1, ?) "
+                  "ON CONFLICT(track_id) DO UPDATE SET play_count = play_count + 1, last_played = excluded.last_played");
+    query.addBindValue(id);
+    query.addBindValue(QDateTime::currentMSecsSinceEpoch());
+    return exec(query, "record play");
+}
+
+int LibraryDatabase::playCount(const QString &filePath) const
+{
+    QSqlQuery query(database(m_connection));
+    query.prepare("SELECT s.play_count FROM play_stats s JOIN tracks t ON t.id = s.track_id WHERE t.path = ?");
+    query.addBindValue(filePath);
+    if (!query.exec() || !query.next())
+        return 0;
+    return query.value(0).toInt();
+}
+
+bool LibraryDatabase::setCachedMetadata(const QString &filePath, const QString &key, const QVariant &value)
+{
+    const qint64 id = trackId(filePath, true);
+    if (id < 0)
+        return false;
+    QSqlQuery query(database(m_connection));
+    query.prepare("INSERT INTO metadata_cache(track_id, key, value, updated_at) VALUES (?, ?, ?, ?) "
+                  "ON CONFLICT(track_id, key) DO UPDATE SET value = excluded.value, updated_at = excluded.updated_at");
+    query.addBindValue(id);
+    query.addBindValue(key);
+    query.addBindValue(value);
+    query.addBindValue(QDateTime::currentMSecsSinceEpoch());
+    return exec(query, "cache metadata");
+}
+
+QVariant LibraryDatabase::cachedMetadata(const QString &filePath, const QString &key) const
+{
+    QSqlQuery query(database(m_connection));
+    query.prepare("SELECT c.value FROM metadata_cache c JOIN tracks t ON t.id = c.track_id"
+                  " WHERE t.path = ? AND c.key = ?");
+    query.addBindValue(filePath);
+    query.addBindValue(key);
+    if (!query.exec() || !query.next())
+        return QVariant();
+    return query.value(0);
+}
@@ -0,0 +1,82 @@
+#ifndef LIBRARYDATABASE_H
+#define LIBRARYDATABASE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+#include "libraryscanner.h"
+
+struct SmartTrack;
+
+// 曲库查询条件，排序和筛选都落在索引上。
+// 标题/艺术家/专辑按预先计算的排序名次排序，与播放队列的排序规则一致（汉字按拼音，数字按数值）
+struct TrackQuery
+{
+    enum SortKey { ByPath, ByTitle, ByArtist, ByAlbum, ByDuration, ByAdded, ByPlayCount };
+
+    SortKey sort = ByPath;
+    bool descending = false;
+    QString rootDirectory;      // 只返回该目录下的歌曲（按路径前缀走唯一索引）
+    QString artist;             // 精确匹配（不区分大小写）
+    QString album;
+    QString text;               // 标题/艺术家/专辑包含该文本
+    qint64 minDurationMs = 0;
+    qint64 maxDurationMs = 0;   // 0 表示不限
+};
+
+// 曲库数据库（SQLite，WAL 模式）
+// 表：tracks 歌曲、playlists/playlist_tracks 歌单、play_stats 播放统计、
+//     metadata_cache 按歌曲缓存的附加元数据、library_roots 已同步目录及其修改时间。
+// QSqlDatabase 连接只能在创建它的线程使用，每个实例持有独立连接。
+class LibraryDatabase
+{
+public:
+    LibraryDatabase();
+    ~LibraryDatabase();
+    Q_DISABLE_COPY(LibraryDatabase)
+
+    bool open(const QString &filePath);
+    void close();
+    bool isOpen() const;
+
+    // 扫描结果整体写入：按批提交事务，更新标签，删除目录下已不存在的歌曲。
+    // recursive 表示扫描是否包含子目录；不包含时只删除目录下一层的歌曲，子目录中的记录（及其播放统计、歌单条目）保留
+    bool syncTracks(const QString &rootDirectory, const QVector<LibraryTrack> &tracks, bool recursive = false);
+    // 只有路径时的轻量同步：新文件以文件名作为标题插入，已有记录（含标签）保持不变
+    bool syncPaths(const QString &rootDirectory, const QStringList &paths, bool recursive = false);
+    // 增量更新：只写入新增的歌曲、删除已移除的歌曲（文件监视使用）
+    bool applyChanges(const QString &rootDirectory, const QVector<LibraryTrack> &added, const QStringList &removed);
+    // 目录修改时间与上次同步时一致
+    bool isDirectoryFresh(const QString &rootDirectory) const;
+
+    int countTracks(const TrackQuery &query) const;
+    QVector<LibraryTrack> tracks(const TrackQuery &query, int offset, int limit) const;
+    // 智能歌单使用的全部歌曲（含添加时间和播放次数）
+    QVector<SmartTrack> smartTracks() const;
+
+    // 歌单镜像
+    bool setPlaylistTracks(const QString &name, const QStringList &paths);
+    QStringList playlistTracks(const QString &name, int offset, int limit) const;
+    bool removePlaylist(const QString &name);
+
+    // 播放统计
+    bool recordPlay(const QString &filePath);
+    int playCount(const QString &filePath) const;
+
+    // 附加元数据缓存（如网络歌词、封面地址）
+    bool setCachedMetadata(const QString &filePath, const QString &key, const QVariant &value);
+    QVariant cachedMetadata(const QString &filePath, const QString &key) const;
+
+private:
+    bool createSchema();
+    // 为名次为空的行计算标题/艺术家/专辑的排序名次（按 QueueSorter 的比较规则，汉字按拼音）
+    bool refreshSortRanks();
+    qint64 trackId(const QString &filePath, bool create) const;
+    template <typename BindRow>
+    bool syncRows(const QString &rootDirectory, bool recursive, int count, const QString &insertSql, BindRow bindRow);
+
+    QString m_connection;
+};
+
+#endif // LIBRARYDATABASE_H
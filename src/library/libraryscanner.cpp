@@ -0,0 +1,160 @@
+#include "libraryscanner.h"
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+
+namespace {
+const int CacheVersion = 1;
+
+qint64 modifiedTime(const QFileInfo &info)
+{
+    return info.lastModified().toMSecsSinceEpoch();
+}
+}
+
+QStringList LibraryScanner::audioFilters()
+{
+    return QStringList() << "*.mp3" << "*.wav" << "*.wma" << "*.flac";
+}
+
+QStringList LibraryScanner::listAudioFiles(const QString &directory, bool recursive)
+{
+    QStringList files;
+    if (!recursive) {
+        QDir dir(directory);
+        const QStringList names = dir.entryList(audioFilters(), QDir::Files);
+        files.reserve(names.size());
+        for (const QString &name : names)
+            files.append(directory + "/" + name);
+        return files;
+    }
+
+    QDirIterator it(directory, audioFilters(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+        files.append(it.next());
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+QVector<LibraryTrack> LibraryScanner::index(const QStringList &files,
+                                            const QHash<QString, LibraryTrack> &cache, int jobs)
+{
+    QVector<LibraryTrack> tracks(files.size());
+    for (int i = 0; i < files.size(); ++i)
+        tracks[i].filePath = files[i];
+
+    auto indexOne = [&cache](LibraryTrack &track) {
+        const QFileInfo info(track.filePath);
+        track.size = info.size();
+        track.modified = modifiedTime(info);
+
+        // 大小和修改时间都没变，直接复用缓存
+        auto cached = cache.constFind(track.filePath);
+        if (cached != cache.constEnd() && cached->size == track.size && cached->modified == track.modified) {
+            track = *cached;
+            return;
+        }
+
+        track.meta = TagReader::read(track.filePath);
+        const QString lrcPath = info.path() + "/" + info.completeBaseName() + ".lrc";
+        track.lrcPath = QFileInfo::exists(lrcPath) ? lrcPath : QString();
+    };
+
+    if (jobs > 0) {
+        QThreadPool pool;
+        pool.setMaxThreadCount(jobs);
+        QtConcurrent::blockingMap(&pool, tracks, indexOne);
+    } else {
+        QtConcurrent::blockingMap(tracks, indexOne);
+    }
+    return tracks;
+}
+
+bool LibraryScanner::saveCache(const QString &cachePath, const QString &rootDirectory,
+                               const QVector<LibraryTrack> &tracks)
+{
+    QJsonArray array;
+    for (const LibraryTrack &track : tracks) {
+        QJsonObject object;
+        object["path"] = track.filePath;
+        object["size"] = double(track.size);
+        object["modified"] = double(track.modified);
+        object["lrc"] = track.lrcPath;
+        object["title"] = track.meta.title;
+        object["artist"] = track.meta.artist;
+        object["album"] = track.meta.album;
+        object["durationMs"] = double(track.meta.durationMs);
+        array.append(object);
+    }
+
+    QJsonObject root;
+    root["version"] = CacheVersion;
+    root["root"] = rootDirectory;
+    root["rootModified"] = double(modifiedTime(QFileInfo(rootDirectory)));
+    root["tracks"] = array;
+
+    QDir().mkpath(QFileInfo(cachePath).path());
+    QSaveFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+QVector<LibraryTrack> LibraryScanner::loadCache(const QString &cachePath, QString *rootDirectory,
+                                                qint64 *rootModified)
+{
+    QVector<LibraryTrack> tracks;
+    QFile file(cachePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return tracks;
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root["version"].toInt() != CacheVersion)
+        return tracks;
+    if (rootDirectory)
+        *rootDirectory = root["root"].toString();
+    if (rootModified)
+        *rootModified = qint64(root["rootModified"].toDouble());
+
+    const QJsonArray array = root["tracks"].toArray();
+    tracks.reserve(array.size());
+    for (const QJsonValue &value : array) {
+        const QJsonObject object = value.toObject();
+        LibraryTrack track;
+        track.filePath = object["path"].toString();
+        track.size = qint64(object["size"].toDouble());
+        track.modified = qint64(object["modified"].toDouble());
+        track.lrcPath = object["lrc"].toString();
+        track.meta.title = object["title"].toString();
+        track.meta.artist = object["artist"].toString();
+        track.meta.album = object["album"].toString();
+        track.meta.durationMs = qint64(object["durationMs"].toDouble());
+        tracks.append(track);
+    }
+    return tracks;
+}
+
+bool LibraryScanner::isCacheFresh(const QString &cachePath, const QString &rootDirectory)
+{
+    // 缓存写于目录最近一次变化之前时一定已经过期，不必解析整个文件
+    const QFileInfo cacheInfo(cachePath);
+    if (!cacheInfo.exists() || cacheInfo.lastModified() < QFileInfo(rootDirectory).lastModified())
+        return false;
+
+    QString cachedRoot;
+    qint64 cachedModified = -1;
+    loadCache(cachePath, &cachedRoot, &cachedModified);
+    return !cachedRoot.isEmpty()
+           && QFileInfo(cachedRoot) == QFileInfo(rootDirectory)
+           && cachedModified == modifiedTime(QFileInfo(rootDirectory));
+}
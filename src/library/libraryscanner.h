@@ -0,0 +1,45 @@
+#ifndef LIBRARYSCANNER_H
+#define LIBRARYSCANNER_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "tagreader.h"
+
+// 曲库中的一首歌曲
+struct LibraryTrack
+{
+    QString filePath;
+    qint64 size = 0;
+    qint64 modified = 0;    // 修改时间（毫秒时间戳），与 size 一起判断缓存是否有效
+    QString lrcPath;        // 同目录同名 .lrc，不存在时为空
+    TrackMetadata meta;
+};
+
+// 曲库扫描与缓存
+// 只依赖 QtCore，图形界面和 xc-cli 共用。标签读取按文件并行执行，
+// 缓存中大小和修改时间都未变化的文件直接复用，不再重复读取。
+class LibraryScanner
+{
+public:
+    static QStringList audioFilters();
+
+    // 列出目录下的音频文件（按文件名排序）
+    static QStringList listAudioFiles(const QString &directory, bool recursive = false);
+
+    // 并行建立索引，jobs <= 0 时使用全局线程池默认线程数
+    static QVector<LibraryTrack> index(const QStringList &files,
+                                       const QHash<QString, LibraryTrack> &cache = {},
+                                       int jobs = 0);
+
+    // 缓存文件：记录扫描根目录及其修改时间，根目录未变化时可直接使用缓存的文件列表
+    static bool saveCache(const QString &cachePath, const QString &rootDirectory,
+                          const QVector<LibraryTrack> &tracks);
+    static QVector<LibraryTrack> loadCache(const QString &cachePath, QString *rootDirectory = nullptr,
+                                           qint64 *rootModified = nullptr);
+    // 缓存是否对应 rootDirectory 的当前状态；可能需要解析整个缓存文件，大曲库时不要在界面线程调用
+    static bool isCacheFresh(const QString &cachePath, const QString &rootDirectory);
+};
+
+#endif // LIBRARYSCANNER_H
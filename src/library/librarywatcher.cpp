@@ -0,0 +1,100 @@
+#include "librarywatcher.h"
+#include "librarydatabase.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrentRun>
+
+LibraryWatcher::LibraryWatcher(QObject *parent)
+    : QObject(parent)
+{
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(1500);
+
+    // 每个事件都重新计时，一批连续的变化只在结束后处理一次
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, &m_debounce, qOverload<>(&QTimer::start));
+    connect(&m_debounce, &QTimer::timeout, this, [this] { startScan(false); });
+    connect(&m_scan, &QFutureWatcher<Delta>::finished, this, &LibraryWatcher::scanFinished);
+}
+
+LibraryWatcher::~LibraryWatcher()
+{
+    m_scan.waitForFinished();
+}
+
+bool LibraryWatcher::watch(const QString &directory)
+{
+    m_scan.waitForFinished();
+    if (!m_directory.isEmpty())
+        m_watcher.removePath(m_directory);
+    m_directory = QDir::cleanPath(QFileInfo(directory).absoluteFilePath());
+    m_known.clear();
+    if (!m_watcher.addPath(m_directory)) {
+        qWarning() << "Failed to watch music directory" << m_directory;
+        return false;
+    }
+    startScan(true);
+    return true;
+}
+
+void LibraryWatcher::startScan(bool baseline)
+{
+    // 上一次还没结束，结束后再扫描一次
+    if (m_scan.isRunning()) {
+        m_pending = true;
+        return;
+    }
+    m_pending = false;
+    m_scan.setFuture(QtConcurrent::run(&LibraryWatcher::scan, m_directory, m_known, baseline, m_databasePath));
+}
+
+LibraryWatcher::Delta LibraryWatcher::scan(const QString &directory, const QSet<QString> &known, bool baseline,
+                                           const QString &databasePath)
+{
+    Delta delta;
+    delta.baseline = baseline;
+    const QStringList files = LibraryScanner::listAudioFiles(directory);
+    delta.files = QSet<QString>(files.cbegin(), files.cend());
+    if (baseline)
+        return delta;
+
+    QStringList addedPaths;
+    for (const QString &file : files) {
+        if (!known.contains(file))
+            addedPaths.append(file);
+    }
+    for (const QString &file : known) {
+        if (!delta.files.contains(file))
+            delta.removed.append(file);
+    }
+    if (addedPaths.isEmpty() && delta.removed.isEmpty())
+        return delta;
+
+    // 只读取新增文件的标签
+    delta.added = LibraryScanner::index(addedPaths);
+
+    // QSqlDatabase 连接不能跨线程使用，这里单独打开一个（WAL 模式下不阻塞界面线程的读取）
+    if (!databasePath.isEmpty()) {
+        LibraryDatabase database;
+        if (!database.open(databasePath) || !database.applyChanges(directory, delta.added, delta.removed))
+            qWarning() << "Failed to apply library changes to" << databasePath;
+    }
+    return delta;
+}
+
+void LibraryWatcher::scanFinished()
+{
+    const Delta delta = m_scan.result();
+    m_known = delta.files;
+
+    // 目录被删除后重新创建时需要重新加入监视
+    if (!m_watcher.directories().contains(m_directory) && QFileInfo(m_directory).isDir())
+        m_watcher.addPath(m_directory);
+
+    if (!delta.added.isEmpty() || !delta.removed.isEmpty()) {
+        qDebug() << "Music directory changed:" << delta.added.size() << "added," << delta.removed.size() << "removed";
+        emit changed(delta.added, delta.removed);
+    }
+    if (m_pending)
+        startScan(false);
+}
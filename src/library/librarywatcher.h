@@ -0,0 +1,58 @@
+#ifndef LIBRARYWATCHER_H
+#define LIBRARYWATCHER_H
+
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include "libraryscanner.h"
+
+// 音乐目录监视
+// 目录变化事件先合并（最后一次事件后 debounce 毫秒内没有新事件才处理），然后在工作线程中
+// 对比文件列表，只为新增的文件读取标签，并用独立的数据库连接写入增量，最后在本对象所在线程发出 changed。
+// 拷贝一整张专辑只会产生一次更新；处理期间又有变化时，结束后再补一次。
+class LibraryWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LibraryWatcher(QObject *parent = nullptr);
+    ~LibraryWatcher();
+
+    // 设置后增量同时写入该曲库数据库
+    void setDatabasePath(const QString &databasePath) { m_databasePath = databasePath; }
+    void setDebounceInterval(int milliseconds) { m_debounce.setInterval(milliseconds); }
+
+    // 开始监视（不递归，与 LibraryScanner::listAudioFiles 默认一致），先在后台建立当前文件列表
+    bool watch(const QString &directory);
+    QString directory() const { return m_directory; }
+
+signals:
+    void changed(const QVector<LibraryTrack> &added, const QStringList &removed);
+
+private:
+    struct Delta
+    {
+        QSet<QString> files;
+        QVector<LibraryTrack> added;
+        QStringList removed;
+        bool baseline = false;
+    };
+
+    static Delta scan(const QString &directory, const QSet<QString> &known, bool baseline,
+                      const QString &databasePath);
+    void startScan(bool baseline);
+    void scanFinished();
+
+    QFileSystemWatcher m_watcher;
+    QTimer m_debounce;
+    QFutureWatcher<Delta> m_scan;
+    QString m_directory;
+    QString m_databasePath;
+    QSet<QString> m_known;
+    bool m_pending = false;
+};
+
+#endif // LIBRARYWATCHER_H
@@ -0,0 +1,534 @@
+#include "playhistory.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+
+// 日志中的定长记录（本机字节序）
+struct PlayHistory::Record
+{
+    qint64 timestamp;
+    quint32 track;
+    quint32 listenedMs;
+    quint32 durationMs;
+    quint32 flags;
+};
+
+namespace {
+const char LogMagic[8] = { 'X', 'C', 'P', 'H', 'L', 'O', 'G', '1' };
+const qint64 HeaderSize = sizeof(LogMagic);
+const quint32 StatsMagic = 0x58435053;  // "XCPS"
+const quint32 StatsVersion = 1;
+const qint64 CheckpointInterval = 10000;   // 每追加这么多事件写一次汇总
+const quint32 FlagSkipped = 1;
+const int ReadBatch = 4096;
+
+quint32 clampMs(qint64 value)
+{
+    return quint32(qBound<qint64>(0, value, 0xffffffffLL));
+}
+}
+
+PlayHistory::PlayHistory(int recentCapacity)
+{
+    m_ring.resize(qMax(1, recentCapacity));
+}
+
+PlayHistory::~PlayHistory()
+{
+    close();
+}
+
+bool PlayHistory::open(const QString &directory)
+{
+    static_assert(sizeof(Record) == 24, "play history records must stay 24 bytes");
+    close();
+    m_directory = directory;
+    QDir().mkpath(directory);
+
+    // 路径表：每行一个，行号即编号；末尾不完整的一行是写入中断留下的，丢弃
+    m_tracksFile.setFileName(directory + "/play_history.tracks");
+    if (m_tracksFile.open(QIODevice::ReadWrite)) {
+        const QByteArray data = m_tracksFile.readAll();
+        qint64 valid = 0;
+        for (qint64 start = 0; start < data.size();) {
+            const qint64 end = data.indexOf('\n', start);
+            if (end < 0)
+                break;
+            const QString path = QString::fromUtf8(data.constData() + start, int(end - start));
+            m_ids.insert(path, int(m_paths.size()));
+            m_paths.append(path);
+            start = valid = end + 1;
+        }
+        if (valid != data.size())
+            m_tracksFile.resize(valid);
+        m_tracksFile.seek(valid);
+    }
+    if (!m_tracksFile.isOpen()) {
+        qWarning() << "Failed to open play history tracks" << m_tracksFile.fileName();
+        close();
+        return false;
+    }
+
+    m_log.setFileName(directory + "/play_history.log");
+    if (!m_log.open(QIODevice::ReadWrite)) {
+        qWarning() << "Failed to open play history" << m_log.fileName();
+        close();
+        return false;
+    }
+    if (m_log.size() < HeaderSize) {
+        m_log.resize(0);
+        m_log.write(LogMagic, HeaderSize);
+    } else {
+        char magic[HeaderSize];
+        if (m_log.read(magic, HeaderSize) != HeaderSize || memcmp(magic, LogMagic, HeaderSize) != 0) {
+            qWarning() << "Play history has an unknown format" << m_log.fileName();
+            close();
+            return false;
+        }
+    }
+
+    // 中断写入留下的半条记录截掉
+    const qint64 events = (m_log.size() - HeaderSize) / qint64(sizeof(Record));
+    if (m_log.size() != HeaderSize + events * qint64(sizeof(Record)))
+        m_log.resize(HeaderSize + events * qint64(sizeof(Record)));
+
+    m_stats.resize(m_paths.size());
+    for (int i = 0; i < m_paths.size(); ++i)
+        m_stats[i].filePath = m_paths[i];
+    if (!loadCheckpoint(events)) {
+        for (PlayStats &stats : m_stats) {
+            stats.plays = stats.skips = 0;
+            stats.listenedMs = stats.lastPlayed = 0;
+        }
+        m_checkpointEvents = 0;
+    }
+
+    // 只重放检查点之后的事件
+    QVector<Record> batch(ReadBatch);
+    m_log.seek(HeaderSize + m_checkpointEvents * qint64(sizeof(Record)));
+    for (qint64 done = m_checkpointEvents; done < events;) {
+        const int n = int(qMin<qint64>(ReadBatch, events - done));
+        const qint64 bytes = n * qint64(sizeof(Record));
+        if (m_log.read(reinterpret_cast<char *>(batch.data()), bytes) != bytes)
+            break;
+        for (int i = 0; i < n; ++i) {
+            const Record &record = batch[i];
+            if (record.track < quint32(m_paths.size()))
+                apply(int(record.track), record.timestamp, record.listenedMs, record.flags & FlagSkipped);
+        }
+        done += n;
+    }
+    m_eventCount = events;
+
+    // 最近事件从日志尾部读回环形缓冲
+    const int recent = int(qMin<qint64>(m_ring.size(), events));
+    QVector<Record> tail(recent);
+    m_log.seek(HeaderSize + (events - recent) * qint64(sizeof(Record)));
+    if (recent > 0 && m_log.read(reinterpret_cast<char *>(tail.data()), recent * qint64(sizeof(Record)))
+                          == recent * qint64(sizeof(Record))) {
+        for (const Record &record : std::as_const(tail)) {
+            if (record.track >= quint32(m_paths.size()))
+                continue;
+            PlayEvent event;
+            event.filePath = m_paths[int(record.track)];
+            event.timestamp = record.timestamp;
+            event.listenedMs = record.listenedMs;
+            event.durationMs = record.durationMs;
+            event.skipped = record.flags & FlagSkipped;
+            remember(event);
+        }
+    }
+
+    rebuildIndexes();
+    m_log.seek(m_log.size());
+    return true;
+}
+
+void PlayHistory::close()
+{
+    if (m_log.isOpen())
+        checkpoint();
+    m_log.close();
+    m_tracksFile.close();
+
+    m_paths.clear();
+    m_ids.clear();
+    m_stats.clear();
+    m_eventCount = 0;
+    m_checkpointEvents = 0;
+    m_playIndex.resize(0);
+    m_skipRateIndex.clear();
+    m_recentPrev.clear();
+    m_recentNext.clear();
+    m_recentHead = -1;
+    m_ringStart = 0;
+    m_ringSize = 0;
+}
+
+bool PlayHistory::append(const PlayEvent &event)
+{
+    if (!isOpen() || event.filePath.isEmpty())
+        return false;
+
+    const int track = trackId(event.filePath, true);
+    if (track < 0)
+        return false;
+
+    Record record;
+    record.timestamp = event.timestamp;
+    record.track = quint32(track);
+    record.listenedMs = clampMs(event.listenedMs);
+    record.durationMs = clampMs(event.durationMs);
+    record.flags = event.skipped ? FlagSkipped : 0;
+    if (m_log.write(reinterpret_cast<const char *>(&record), sizeof(record)) != qint64(sizeof(record)))
+        return false;
+    m_log.flush();
+
+    // 每次播放都会改变跳过率，先按旧值移出索引再按新值放回
+    unindexSkipRate(track);
+    apply(track, event.timestamp, event.listenedMs, event.skipped);
+    indexSkipRate(track);
+    m_playIndex.increment(track);
+    touch(track);
+    remember(event);
+    ++m_eventCount;
+
+    if (m_eventCount - m_checkpointEvents >= CheckpointInterval)
+        checkpoint();
+    return true;
+}
+
+QVector<PlayEvent> PlayHistory::recentEvents(int k) const
+{
+    QVector<PlayEvent> result;
+    const int n = qMin(k, m_ringSize);
+    result.reserve(n);
+    for (int i = 0; i < n; ++i)
+        result.append(m_ring[(m_ringStart + m_ringSize - 1 - i) % m_ring.size()]);
+    return result;
+}
+
+QVector<PlayStats> PlayHistory::mostPlayed(int k) const
+{
+    QVector<PlayStats> result;
+    const QVector<int> ids = m_playIndex.top(k);
+    result.reserve(ids.size());
+    for (int id : ids)
+        result.append(statsFor(id));
+    return result;
+}
+
+QVector<PlayStats> PlayHistory::recentlyPlayed(int k) const
+{
+    QVector<PlayStats> result;
+    for (int id = m_recentHead; id >= 0 && result.size() < k; id = m_recentNext[id])
+        result.append(statsFor(id));
+    return result;
+}
+
+QVector<PlayStats> PlayHistory::mostSkipped(int k) const
+{
+    QVector<PlayStats> result;
+    for (auto it = m_skipRateIndex.cbegin(); it != m_skipRateIndex.cend() && result.size() < k; ++it)
+        result.append(statsFor(it->id));
+    return result;
+}
+
+PlayStats PlayHistory::stats(const QString &filePath) const
+{
+    const int id = m_ids.value(filePath, -1);
+    if (id < 0) {
+        PlayStats empty;
+        empty.filePath = filePath;
+        return empty;
+    }
+    return statsFor(id);
+}
+
+bool PlayHistory::checkpoint()
+{
+    if (!isOpen())
+        return false;
+
+    QSaveFile file(m_directory + "/play_history.stats");
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    QDataStream stream(&file);
+    stream << StatsMagic << StatsVersion << m_eventCount << qint32(m_stats.size());
+    for (const PlayStats &stats : std::as_const(m_stats))
+        stream << stats.plays << stats.skips << stats.listenedMs << stats.lastPlayed;
+    if (stream.status() != QDataStream::Ok || !file.commit())
+        return false;
+    m_checkpointEvents = m_eventCount;
+    return true;
+}
+
+bool PlayHistory::loadCheckpoint(qint64 logEvents)
+{
+    QFile file(m_directory + "/play_history.stats");
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream stream(&file);
+    quint32 magic = 0, version = 0;
+    qint64 events = 0;
+    qint32 tracks = 0;
+    stream >> magic >> version >> events >> tracks;
+    // 汇总必须落后于日志（日志被删除或替换时作废）
+    if (magic != StatsMagic || version != StatsVersion || events > logEvents || tracks < 0
+        || tracks > m_paths.size())
+        return false;
+    for (int i = 0; i < tracks; ++i) {
+        PlayStats &stats = m_stats[i];
+        stream >> stats.plays >> stats.skips >> stats.listenedMs >> stats.lastPlayed;
+    }
+    if (stream.status() != QDataStream::Ok)
+        return false;
+    m_checkpointEvents = events;
+    return true;
+}
+
+int PlayHistory::trackId(const QString &filePath, bool create)
+{
+    const auto it = m_ids.constFind(filePath);
+    if (it != m_ids.constEnd())
+        return it.value();
+    if (!create)
+        return -1;
+
+    if (m_tracksFile.write(filePath.toUtf8() + '\n') < 0)
+        return -1;
+    m_tracksFile.flush();
+
+    const int id = int(m_paths.size());
+    m_paths.append(filePath);
+    m_ids.insert(filePath, id);
+    PlayStats stats;
+    stats.filePath = filePath;
+    m_stats.append(stats);
+    m_playIndex.resize(id + 1);
+    m_recentPrev.append(-1);
+    m_recentNext.append(-1);
+    return id;
+}
+
+bool PlayHistory::SkipRateKey::operator<(const SkipRateKey &other) const
+{
+    const quint64 lhs = quint64(skips) * other.plays;
+    const quint64 rhs = quint64(other.skips) * plays;
+    if (lhs != rhs)
+        return lhs > rhs;
+    // 跳过率相同时跳过次数多的在前
+    if (skips != other.skips)
+        return skips > other.skips;
+    return id < other.id;
+}
+
+void PlayHistory::indexSkipRate(int track)
+{
+    const PlayStats &stats = m_stats[track];
+    if (stats.plays >= MinPlaysForSkipRate && stats.skips > 0)
+        m_skipRateIndex.insert({ stats.skips, stats.plays, track });
+}
+
+void PlayHistory::unindexSkipRate(int track)
+{
+    const PlayStats &stats = m_stats[track];
+    m_skipRateIndex.erase({ stats.skips, stats.plays, track });
+}
+
+void PlayHistory::apply(int track, qint64 timestamp, qint64 listenedMs, bool skipped)
+{
+    PlayStats &stats = m_stats[track];
+    ++stats.plays;
+    if (skipped)
+        ++stats.skips;
+    stats.listenedMs += listenedMs;
+    stats.lastPlayed = qMax(stats.lastPlayed, timestamp);
+}
+
+void PlayHistory::touch(int track)
+{
+    if (m_recentHead == track)
+        return;
+    const int prev = m_recentPrev[track];
+    const int next = m_recentNext[track];
+    if (prev >= 0)
+        m_recentNext[prev] = next;
+    if (next >= 0)
+        m_recentPrev[next] = prev;
+
+    m_recentPrev[track] = -1;
+    m_recentNext[track] = m_recentHead;
+    if (m_recentHead >= 0)
+        m_recentPrev[m_recentHead] = track;
+    m_recentHead = track;
+}
+
+void PlayHistory::rebuildIndexes()
+{
+    const int count = int(m_stats.size());
+    QVector<quint32> plays(count);
+    QVector<int> played;
+    m_skipRateIndex.clear();
+    for (int i = 0; i < count; ++i) {
+        plays[i] = m_stats[i].plays;
+        if (m_stats[i].plays > 0)
+            played.append(i);
+        indexSkipRate(i);
+    }
+    m_playIndex.build(plays);
+
+    // 按最后播放时间从旧到新依次放到表头
+    m_recentPrev.fill(-1, count);
+    m_recentNext.fill(-1, count);
+    m_recentHead = -1;
+    std::stable_sort(played.begin(), played.end(), [this](int a, int b) {
+        return m_stats[a].lastPlayed < m_stats[b].lastPlayed;
+    });
+    for (int id : std::as_const(played))
+        touch(id);
+}
+
+void PlayHistory::remember(const PlayEvent &event)
+{
+    const int capacity = int(m_ring.size());
+    if (m_ringSize < capacity) {
+        m_ring[(m_ringStart + m_ringSize) % capacity] = event;
+        ++m_ringSize;
+    } else {
+        m_ring[m_ringStart] = event;
+        m_ringStart = (m_ringStart + 1) % capacity;
+    }
+}
+
+PlayStats PlayHistory::statsFor(int track) const
+{
+    return m_stats[track];
+}
+
+void PlayHistory::FrequencyIndex::resize(int size)
+{
+    if (size == 0) {
+        m_buckets.clear();
+        m_freeBuckets.clear();
+        m_nodes.clear();
+        m_lowest = m_highest = -1;
+        return;
+    }
+    m_nodes.resize(size);
+}
+
+void PlayHistory::FrequencyIndex::build(const QVector<quint32> &counts)
+{
+    resize(0);
+    m_nodes.resize(counts.size());
+
+    QVector<int> ids;
+    ids.reserve(counts.size());
+    for (int i = 0; i < counts.size(); ++i) {
+        if (counts[i] > 0)
+            ids.append(i);
+    }
+    std::stable_sort(ids.begin(), ids.end(), [&counts](int a, int b) { return counts[a] < counts[b]; });
+
+    for (int id : std::as_const(ids)) {
+        int bucket = m_highest;
+        if (bucket < 0 || m_buckets[bucket].count != counts[id])
+            bucket = newBucket(counts[id], m_highest, -1);
+        pushNode(bucket, id);
+    }
+}
+
+void PlayHistory::FrequencyIndex::increment(int id)
+{
+    const int from = m_nodes[id].bucket;
+    const quint32 count = from >= 0 ? m_buckets[from].count + 1 : 1;
+    const int next = from >= 0 ? m_buckets[from].next : m_lowest;
+
+    int target = next;
+    if (target < 0 || m_buckets[target].count != count)
+        target = newBucket(count, from, next);
+    unlinkNode(id);
+    pushNode(target, id);
+}
+
+QVector<int> PlayHistory::FrequencyIndex::top(int k) const
+{
+    QVector<int> result;
+    for (int bucket = m_highest; bucket >= 0 && result.size() < k; bucket = m_buckets[bucket].prev) {
+        for (int id = m_buckets[bucket].head; id >= 0 && result.size() < k; id = m_nodes[id].next)
+            result.append(id);
+    }
+    return result;
+}
+
+int PlayHistory::FrequencyIndex::newBucket(quint32 count, int prev, int next)
+{
+    int index;
+    if (!m_freeBuckets.isEmpty()) {
+        index = m_freeBuckets.takeLast();
+    } else {
+        index = int(m_buckets.size());
+        m_buckets.append(Bucket());
+    }
+    Bucket &bucket = m_buckets[index];
+    bucket.count = count;
+    bucket.prev = prev;
+    bucket.next = next;
+    bucket.head = -1;
+
+    if (prev >= 0)
+        m_buckets[prev].next = index;
+    else
+        m_lowest = index;
+    if (next >= 0)
+        m_buckets[next].prev = index;
+    else
+        m_highest = index;
+    return index;
+}
+
+void PlayHistory::FrequencyIndex::unlinkNode(int id)
+{
+    Node &node = m_nodes[id];
+    const int bucket = node.bucket;
+    if (bucket < 0)
+        return;
+
+    if (node.prev >= 0)
+        m_nodes[node.prev].next = node.next;
+    else
+        m_buckets[bucket].head = node.next;
+    if (node.next >= 0)
+        m_nodes[node.next].prev = node.prev;
+    node = Node();
+
+    // 桶空了就从链表中摘掉
+    if (m_buckets[bucket].head < 0) {
+        const int prev = m_buckets[bucket].prev;
+        const int next = m_buckets[bucket].next;
+        if (prev >= 0)
+            m_buckets[prev].next = next;
+        else
+            m_lowest = next;
+        if (next >= 0)
+            m_buckets[next].prev = prev;
+        else
+            m_highest = prev;
+        m_freeBuckets.append(bucket);
+    }
+}
+
+void PlayHistory::FrequencyIndex::pushNode(int bucket, int id)
+{
+    Node &node = m_nodes[id];
+    node.bucket = bucket;
+    node.prev = -1;
+    node.next = m_buckets[bucket].head;
+    if (node.next >= 0)
+        m_nodes[node.next].prev = id;
+    m_buckets[bucket].head = id;
+}
@@ -0,0 +1,131 @@
+#ifndef PLAYHISTORY_H
+#define PLAYHISTORY_H
+
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <set>
+
+// 一次播放
+struct PlayEvent
+{
+    QString filePath;
+    qint64 timestamp = 0;       // 结束播放的时间（毫秒时间戳）
+    qint64 listenedMs = 0;      // 实际收听时长（不含跳转）
+    qint64 durationMs = 0;      // 歌曲总时长
+    bool skipped = false;
+};
+
+// 按歌曲汇总的统计
+struct PlayStats
+{
+    QString filePath;
+    quint32 plays = 0;
+    quint32 skips = 0;
+    qint64 listenedMs = 0;
+    qint64 lastPlayed = 0;
+
+    double skipRate() const { return plays ? double(skips) / plays : 0.0; }
+};
+
+// 播放历史
+// 事件以定长记录追加到 play_history.log，路径只在 play_history.tracks 中出现一次，记录里存编号；
+// 内存中保留最近事件的环形缓冲、按播放次数分桶的计数链表、按最近播放排序的链表和按跳过率排序的有序集合，
+// 追加是常数时间（跳过率索引为 O(log n)），“最常播放”“最近播放”“最常跳过”取前 k 个只需 O(k)。
+// 汇总计数定期写入 play_history.stats，打开时只重放检查点之后的事件。
+class PlayHistory
+{
+public:
+    explicit PlayHistory(int recentCapacity = 1000);
+    ~PlayHistory();
+    Q_DISABLE_COPY(PlayHistory)
+
+    bool open(const QString &directory);
+    void close();
+    bool isOpen() const { return m_log.isOpen(); }
+
+    bool append(const PlayEvent &event);
+
+    QVector<PlayEvent> recentEvents(int k) const;       // 最新的在前，同一首歌可重复出现
+    QVector<PlayStats> mostPlayed(int k) const;
+    QVector<PlayStats> recentlyPlayed(int k) const;     // 每首歌只出现一次
+    // 按跳过率从高到低；播放不足 MinPlaysForSkipRate 次或从未跳过的歌曲不参与，避免 1/1 排在最前
+    static constexpr quint32 MinPlaysForSkipRate = 3;
+    QVector<PlayStats> mostSkipped(int k) const;
+    PlayStats stats(const QString &filePath) const;
+    qint64 eventCount() const { return m_eventCount; }
+
+    bool checkpoint();
+
+private:
+    struct Record;
+
+    // 计数分桶链表：计数相同的条目在同一个桶里，非空桶按计数从小到大串起来
+    class FrequencyIndex
+    {
+    public:
+        void resize(int size);
+        void build(const QVector<quint32> &counts);
+        void increment(int id);
+        QVector<int> top(int k) const;
+
+    private:
+        struct Bucket { quint32 count = 0; int prev = -1; int next = -1; int head = -1; };
+        struct Node { int bucket = -1; int prev = -1; int next = -1; };
+
+        int newBucket(quint32 count, int prev, int next);
+        void unlinkNode(int id);
+        void pushNode(int bucket, int id);
+
+        QVector<Bucket> m_buckets;
+        QVector<int> m_freeBuckets;
+        QVector<Node> m_nodes;
+        int m_lowest = -1;
+        int m_highest = -1;
+    };
+
+    // 跳过率索引的键：比率用交叉相乘比较，不受浮点误差影响
+    struct SkipRateKey
+    {
+        quint32 skips;
+        quint32 plays;
+        int id;
+        bool operator<(const SkipRateKey &other) const;
+    };
+
+    int trackId(const QString &filePath, bool create);
+    void indexSkipRate(int track);
+    void unindexSkipRate(int track);
+    void apply(int track, qint64 timestamp, qint64 listenedMs, bool skipped);
+    void touch(int track);
+    void rebuildIndexes();
+    void remember(const PlayEvent &event);
+    bool loadCheckpoint(qint64 logEvents);
+    PlayStats statsFor(int track) const;
+
+    QString m_directory;
+    QFile m_log;
+    QFile m_tracksFile;
+
+    QVector<QString> m_paths;
+    QHash<QString, int> m_ids;
+    QVector<PlayStats> m_stats;
+    qint64 m_eventCount = 0;
+    qint64 m_checkpointEvents = 0;
+
+    FrequencyIndex m_playIndex;
+    std::set<SkipRateKey> m_skipRateIndex;    // 跳过率最高的在前
+
+    // 最近播放链表，m_recentHead 为最近一首
+    QVector<int> m_recentPrev;
+    QVector<int> m_recentNext;
+    int m_recentHead = -1;
+
+    // 最近事件环形缓冲
+    QVector<PlayEvent> m_ring;
+    int m_ringStart = 0;
+    int m_ringSize = 0;
+};
+
+#endif // PLAYHISTORY_H
@@ -0,0 +1,150 @@
+#include "queuesorter.h"
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+const int ChunkSize = 4096;     // 少于这个数量不值得分给多个线程
+
+QVector<int> chunkIds(int count)
+{
+    QVector<int> ids(count);
+    std::iota(ids.begin(), ids.end(), 0);
+    return ids;
+}
+
+// 对下标做并行稳定归并排序：各段先分别 stable_sort，再逐轮两两归并（std::merge 保持稳定）
+template <typename Less>
+void parallelStableSort(QVector<int> &indices, Less less)
+{
+    const int n = int(indices.size());
+    const int parts = qBound(1, n / ChunkSize, qMax(1, QThread::idealThreadCount()));
+    if (parts == 1) {
+        std::stable_sort(indices.begin(), indices.end(), less);
+        return;
+    }
+
+    QVector<int> bounds(parts + 1);
+    for (int i = 0; i <= parts; ++i)
+        bounds[i] = int(qint64(n) * i / parts);
+
+    QVector<int> ids = chunkIds(parts);
+    QtConcurrent::blockingMap(ids, [&](int &part) {
+        std::stable_sort(indices.begin() + bounds[part], indices.begin() + bounds[part + 1], less);
+    });
+
+    QVector<int> buffer(n);
+    while (bounds.size() > 2) {
+        const int ranges = int(bounds.size()) - 1;
+        QVector<int> pairs = chunkIds((ranges + 1) / 2);
+        QtConcurrent::blockingMap(pairs, [&](int &pair) {
+            const int begin = bounds[pair * 2];
+            const int middle = bounds[pair * 2 + 1];
+            const int end = pair * 2 + 2 < bounds.size() ? bounds[pair * 2 + 2] : middle;
+            std::merge(indices.cbegin() + begin, indices.cbegin() + middle,
+                       indices.cbegin() + middle, indices.cbegin() + end,
+                       buffer.begin() + begin, less);
+        });
+        indices.swap(buffer);
+
+        QVector<int> merged;
+        for (int i = 0; i < bounds.size(); i += 2)
+            merged.append(bounds[i]);
+        if (merged.constLast() != n)
+            merged.append(n);
+        bounds.swap(merged);
+    }
+}
+}
+
+QueueSorter::QueueSorter(const QLocale &locale)
+    : m_collator(collator(locale))
+{
+}
+
+QCollator QueueSorter::collator(const QLocale &locale)
+{
+    QCollator collator(locale);
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    collator.setNumericMode(true);      // “第2首”排在“第10首”之前
+    return collator;
+}
+
+void QueueSorter::clearCache()
+{
+    m_keyIndex.clear();
+    m_keys.clear();
+}
+
+void QueueSorter::prepareKeys(const QStringList &texts)
+{
+    // 多半是已经替换掉的队列留下的键，全部丢弃后只为当前队列重新计算
+    if (int(m_keys.size()) >= MaxCachedKeys)
+        clearCache();
+
+    QStringList missing;
+    for (const QString &text : texts) {
+        if (!m_keyIndex.contains(text)) {
+            m_keyIndex.insert(text, int(m_keys.size() + missing.size()));
+            missing.append(text);
+        }
+    }
+    if (missing.isEmpty())
+        return;
+
+    // 分块并行计算排序键，每块使用自己的 QCollator 副本
+    const int parts = (int(missing.size()) + ChunkSize - 1) / ChunkSize;
+    QVector<std::vector<QCollatorSortKey>> results(parts);
+    QVector<int> ids = chunkIds(parts);
+    QtConcurrent::blockingMap(ids, [&](int &part) {
+        const QCollator collator = m_collator;
+        const int begin = part * ChunkSize;
+        const int end = qMin(int(missing.size()), begin + ChunkSize);
+        std::vector<QCollatorSortKey> &keys = results[part];
+        keys.reserve(end - begin);
+        for (int i = begin; i < end; ++i)
+            keys.push_back(collator.sortKey(missing.at(i)));
+    });
+
+    m_keys.reserve(m_keys.size() + missing.size());
+    for (std::vector<QCollatorSortKey> &keys : results) {
+        for (QCollatorSortKey &key : keys)
+            m_keys.push_back(std::move(key));
+    }
+}
+
+QVector<int> QueueSorter::order(const QVector<Entry> &entries, Key key, bool descending)
+{
+    const int n = int(entries.size());
+    QVector<int> indices = chunkIds(n);
+    if (n < 2)
+        return indices;
+
+    if (key == Duration) {
+        QVector<qint64> durations(n);
+        for (int i = 0; i < n; ++i)
+            durations[i] = entries[i].durationMs;
+        parallelStableSort(indices, [&durations, descending](int a, int b) {
+            return descending ? durations[b] < durations[a] : durations[a] < durations[b];
+        });
+        return indices;
+    }
+
+    QStringList texts;
+    texts.reserve(n);
+    for (const Entry &entry : entries)
+        texts.append(key == Title ? entry.title : key == Artist ? entry.artist : entry.fileName);
+    prepareKeys(texts);
+
+    QVector<int> keyOf(n);
+    for (int i = 0; i < n; ++i)
+        keyOf[i] = m_keyIndex.value(texts.at(i));
+
+    const std::vector<QCollatorSortKey> &keys = m_keys;
+    parallelStableSort(indices, [&keys, &keyOf, descending](int a, int b) {
+        const int result = keys[keyOf[a]].compare(keys[keyOf[b]]);
+        return descending ? result > 0 : result < 0;
+    });
+    return indices;
+}
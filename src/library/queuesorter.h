@@ -0,0 +1,50 @@
+#ifndef QUEUESORTER_H
+#define QUEUESORTER_H
+
+#include <QCollator>
+#include <QHash>
+#include <QLocale>
+#include <QString>
+#include <QVector>
+#include <vector>
+
+// 播放队列排序
+// 标题/艺术家按区域设置排序（默认简体中文：拉丁字母在前，汉字按拼音），每个字符串的排序键只计算一次并缓存，
+// 之后的排序只比较排序键；排序本身是对下标的并行稳定归并排序。
+class QueueSorter
+{
+public:
+    enum Key { Title, Artist, Duration, FileName };
+
+    // 缓存的排序键上限（10 万首队列的标题和艺术家），超过后整体丢弃并按当前队列重建
+    static constexpr int MaxCachedKeys = 200000;
+
+    struct Entry
+    {
+        QString title;
+        QString artist;
+        QString fileName;
+        qint64 durationMs = 0;
+    };
+
+    explicit QueueSorter(const QLocale &locale = QLocale(QLocale::Chinese, QLocale::China));
+
+    // 排序使用的比较规则（不区分大小写，数字按数值比较），曲库数据库计算排序名次时使用同一规则
+    static QCollator collator(const QLocale &locale = QLocale(QLocale::Chinese, QLocale::China));
+
+    // 返回新顺序：第 i 项为原来的第 result[i] 项。键相同的条目保持原有先后
+    QVector<int> order(const QVector<Entry> &entries, Key key, bool descending = false);
+
+    int cachedKeys() const { return int(m_keys.size()); }
+    // 队列整体替换时调用，丢弃旧队列的排序键
+    void clearCache();
+
+private:
+    void prepareKeys(const QStringList &texts);
+
+    QCollator m_collator;
+    QHash<QString, int> m_keyIndex;         // 字符串 -> m_keys 下标
+    std::vector<QCollatorSortKey> m_keys;
+};
+
+#endif // QUEUESORTER_H
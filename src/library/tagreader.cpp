@@ -0,0 +1,331 @@
+#include "tagreader.h"
+#include <QFile>
+#include <QtEndian>
+#include <algorithm>
+
+namespace {
+const qint64 MaxTagSize = 32 * 1024 * 1024;   // 超过此大小的标签视为损坏
+
+quint32 syncSafe(const uchar *p)
+{
+    return (quint32(p[0] & 0x7F) << 21) | (quint32(p[1] & 0x7F) << 14)
+           | (quint32(p[2] & 0x7F) << 7) | quint32(p[3] & 0x7F);
+}
+
+QString decodeUtf16(const char *data, int size, bool littleEndian)
+{
+    QString result;
+    result.reserve(size / 2);
+    for (int i = 0; i + 1 < size; i += 2) {
+        const uchar lo = uchar(data[littleEndian ? i : i + 1]);
+        const uchar hi = uchar(data[littleEndian ? i + 1 : i]);
+        const char16_t unit = char16_t((hi << 8) | lo);
+        if (unit == 0)
+            break;
+        result.append(QChar(unit));
+    }
+    return result;
+}
+
+// 按 ID3 文本编码解码，遇到结束符为止
+QString decodeEncoded(char encoding, const char *data, int size)
+{
+    switch (encoding) {
+    case 1: // 带 BOM 的 UTF-16
+        if (size >= 2 && uchar(data[0]) == 0xFF && uchar(data[1]) == 0xFE)
+            return decodeUtf16(data + 2, size - 2, true);
+        if (size >= 2 && uchar(data[0]) == 0xFE && uchar(data[1]) == 0xFF)
+            return decodeUtf16(data + 2, size - 2, false);
+        return decodeUtf16(data, size, true);
+    case 2: // UTF-16BE
+        return decodeUtf16(data, size, false);
+    case 3: // UTF-8
+        return QString::fromUtf8(data, int(qstrnlen(data, uint(size))));
+    default: // ISO-8859-1
+        return QString::fromLatin1(data, int(qstrnlen(data, uint(size))));
+    }
+}
+
+// 按 ID3 文本编码字节解码，只取第一个值（2.4 中多值以 \0 分隔）
+QString decodeId3Text(const QByteArray &frame)
+{
+    if (frame.isEmpty())
+        return QString();
+    return decodeEncoded(frame.at(0), frame.constData() + 1, int(frame.size()) - 1);
+}
+
+// 从 pos 开始的以结束符结尾的字符串长度（不含结束符），UTF-16 的结束符为两字节且按两字节对齐
+int terminatedLength(const QByteArray &data, int pos, char encoding, int *terminator)
+{
+    const bool wide = encoding == 1 || encoding == 2;
+    *terminator = wide ? 2 : 1;
+    for (int i = pos; i + *terminator <= data.size(); i += *terminator) {
+        if (data.at(i) == 0 && (!wide || data.at(i + 1) == 0))
+            return i - pos;
+    }
+    *terminator = 0;
+    return int(data.size()) - pos;
+}
+
+// USLT：编码(1) 语言(3) 描述\0 歌词
+QString decodeUslt(const QByteArray &payload)
+{
+    if (payload.size() < 5)
+        return QString();
+    const char encoding = payload.at(0);
+    int terminator = 0;
+    const int descriptor = terminatedLength(payload, 4, encoding, &terminator);
+    const int pos = 4 + descriptor + terminator;
+    if (pos >= payload.size())
+        return QString();
+    return decodeEncoded(encoding, payload.constData() + pos, int(payload.size()) - pos);
+}
+
+// SYLT：编码(1) 语言(3) 时间格式(1) 内容类型(1) 描述\0，之后重复“文本\0 + 4 字节大端时间”
+// 只支持以毫秒为单位的时间（格式 2），以 MPEG 帧计时的无法换算
+QVector<QPair<qint64, QString>> decodeSylt(const QByteArray &payload)
+{
+    QVector<QPair<qint64, QString>> result;
+    if (payload.size() < 7 || payload.at(4) != 2)
+        return result;
+    const char encoding = payload.at(0);
+    int terminator = 0;
+    int pos = 6 + terminatedLength(payload, 6, encoding, &terminator) + terminator;
+    while (pos < payload.size()) {
+        const int length = terminatedLength(payload, pos, encoding, &terminator);
+        if (!terminator || pos + length + terminator + 4 > payload.size())
+            break;
+        const QString text = decodeEncoded(encoding, payload.constData() + pos, length);
+        pos += length + terminator;
+        const qint64 time = qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(payload.constData() + pos));
+        pos += 4;
+        result.append({ time, text });
+    }
+    std::stable_sort(result.begin(), result.end(), [](const QPair<qint64, QString> &a, const QPair<qint64, QString> &b) {
+        return a.first < b.first;
+    });
+    return result;
+}
+
+void assignText(TrackMetadata &meta, const QByteArray &id, const QByteArray &payload)
+{
+    if (id == "TIT2" || id == "TT2")
+        meta.title = decodeId3Text(payload).trimmed();
+    else if (id == "TPE1" || id == "TP1")
+        meta.artist = decodeId3Text(payload).trimmed();
+    else if (id == "TALB" || id == "TAL")
+        meta.album = decodeId3Text(payload).trimmed();
+    else if (id == "TLEN" || id == "TLE")
+        meta.durationMs = decodeId3Text(payload).trimmed().toLongLong();
+}
+
+// 去除不同步编码（0xFF 0x00 -> 0xFF）
+QByteArray removeUnsynchronisation(const QByteArray &data)
+{
+    QByteArray result;
+    result.reserve(data.size());
+    for (int i = 0; i < data.size(); ++i) {
+        result.append(data.at(i));
+        if (uchar(data.at(i)) == 0xFF && i + 1 < data.size() && data.at(i + 1) == 0)
+            ++i;
+    }
+    return result;
+}
+
+// 解析 ID3v2 标签，返回标签总长度（含 10 字节头），不存在时返回 0
+// meta 和 lyrics 可以为空，为空时跳过对应的帧
+qint64 readId3v2(QFile &file, TrackMetadata *meta, EmbeddedLyrics *lyrics)
+{
+    file.seek(0);
+    const QByteArray header = file.read(10);
+    if (header.size() < 10 || !header.startsWith("ID3"))
+        return 0;
+
+    const uchar *h = reinterpret_cast<const uchar *>(header.constData());
+    const int version = h[3];
+    const uchar flags = h[5];
+    const qint64 tagSize = syncSafe(h + 6);
+    if (tagSize > MaxTagSize)
+        return 0;
+
+    QByteArray tag = file.read(tagSize);
+    if ((flags & 0x80) && version < 4)
+        tag = removeUnsynchronisation(tag);
+
+    int pos = 0;
+    // 扩展头；长度来自文件，先按 64 位检查范围再使用
+    if ((flags & 0x40) && tag.size() >= 4) {
+        const uchar *e = reinterpret_cast<const uchar *>(tag.constData());
+        const qint64 extendedSize = version >= 4 ? syncSafe(e) : qint64(qFromBigEndian<quint32>(e)) + 4;
+        if (extendedSize < 0 || extendedSize > tag.size())
+            return tagSize + 10;    // 扩展头损坏：不读帧，但仍跳过整个标签
+        pos = int(extendedSize);
+    }
+
+    const int idLength = version <= 2 ? 3 : 4;
+    const int headerLength = version <= 2 ? 6 : 10;
+    while (pos + headerLength <= tag.size()) {
+        const uchar *f = reinterpret_cast<const uchar *>(tag.constData() + pos);
+        if (f[0] == 0)
+            break;  // 填充区
+        const QByteArray id = tag.mid(pos, idLength);
+        qint64 frameSize;
+        quint16 frameFlags = 0;
+        if (version <= 2) {
+            frameSize = (quint32(f[3]) << 16) | (quint32(f[4]) << 8) | f[5];
+        } else if (version == 3) {
+            frameSize = qFromBigEndian<quint32>(f + 4);
+            frameFlags = qFromBigEndian<quint16>(f + 8);
+        } else {
+            frameSize = syncSafe(f + 4);
+            frameFlags = qFromBigEndian<quint16>(f + 8);
+        }
+        pos += headerLength;
+        if (frameSize <= 0 || pos + frameSize > tag.size())
+            break;
+
+        QByteArray payload = tag.mid(pos, int(frameSize));
+        pos += int(frameSize);
+
+        if (version >= 4) {
+            if (frameFlags & 0x000C)        // 压缩或加密，跳过
+                continue;
+            if (frameFlags & 0x0002)
+                payload = removeUnsynchronisation(payload);
+            if ((frameFlags & 0x0001) && payload.size() >= 4)
+                payload.remove(0, 4);       // 数据长度指示
+        } else if (version == 3 && (frameFlags & 0x00C0)) {
+            continue;
+        }
+
+        if (meta && id.startsWith('T'))
+            assignText(*meta, id, payload);
+        else if (lyrics && (id == "USLT" || id == "ULT") && lyrics->id3Unsynced.isEmpty())
+            lyrics->id3Unsynced = decodeUslt(payload);
+        else if (lyrics && (id == "SYLT" || id == "SLT") && lyrics->id3Synced.isEmpty())
+            lyrics->id3Synced = decodeSylt(payload);
+    }
+    return tagSize + 10;
+}
+
+void readId3v1(QFile &file, TrackMetadata &meta)
+{
+    if (file.size() < 128 || !file.seek(file.size() - 128))
+        return;
+    const QByteArray tag = file.read(128);
+    if (tag.size() < 128 || !tag.startsWith("TAG"))
+        return;
+
+    auto field = [&tag](int offset) {
+        const char *data = tag.constData() + offset;
+        return QString::fromLatin1(data, int(qstrnlen(data, 30))).trimmed();
+    };
+    if (meta.title.isEmpty())
+        meta.title = field(3);
+    if (meta.artist.isEmpty())
+        meta.artist = field(33);
+    if (meta.album.isEmpty())
+        meta.album = field(63);
+}
+
+// 解析 FLAC 元数据块，meta 和 lyrics 的含义同 readId3v2
+bool readFlac(QFile &file, qint64 offset, TrackMetadata *meta, EmbeddedLyrics *lyrics)
+{
+    if (!file.seek(offset) || file.read(4) != "fLaC")
+        return false;
+
+    bool last = false;
+    while (!last) {
+        const QByteArray blockHeader = file.read(4);
+        if (blockHeader.size() < 4)
+            break;
+        const uchar *b = reinterpret_cast<const uchar *>(blockHeader.constData());
+        last = b[0] & 0x80;
+        const int type = b[0] & 0x7F;
+        const qint64 length = (quint32(b[1]) << 16) | (quint32(b[2]) << 8) | b[3];
+
+        if (type == 0 && length >= 18 && meta) {
+            // STREAMINFO：采样率 20 位，总采样数 36 位
+            const QByteArray info = file.read(length);
+            if (info.size() < 18)
+                break;  // 文件被截断
+            const uchar *s = reinterpret_cast<const uchar *>(info.constData());
+            const quint32 sampleRate = (quint32(s[10]) << 12) | (quint32(s[11]) << 4) | (s[12] >> 4);
+            const quint64 totalSamples = (quint64(s[13] & 0x0F) << 32) | qFromBigEndian<quint32>(s + 14);
+            if (sampleRate > 0)
+                meta->durationMs = qint64(totalSamples * 1000 / sampleRate);
+        } else if (type == 4) {
+            // VORBIS_COMMENT：小端长度 + "KEY=value"
+            const QByteArray block = file.read(length);
+            const uchar *c = reinterpret_cast<const uchar *>(block.constData());
+            qint64 pos = 0;
+            auto readLength = [&](quint32 &value) {
+                if (pos + 4 > block.size())
+                    return false;
+                value = qFromLittleEndian<quint32>(c + pos);
+                pos += 4;
+                return true;
+            };
+            quint32 vendorLength = 0, count = 0;
+            if (!readLength(vendorLength))
+                continue;
+            pos += vendorLength;
+            if (!readLength(count))
+                continue;
+            for (quint32 i = 0; i < count; ++i) {
+                quint32 entryLength = 0;
+                if (!readLength(entryLength) || pos + entryLength > block.size())
+                    break;
+                const QString entry = QString::fromUtf8(block.constData() + pos, int(entryLength));
+                pos += entryLength;
+                const int eq = entry.indexOf('=');
+                if (eq <= 0)
+                    continue;
+                const QString key = entry.left(eq).toUpper();
+                if (lyrics) {
+                    if ((key == "LYRICS" || key == "UNSYNCEDLYRICS") && lyrics->vorbis.isEmpty())
+                        lyrics->vorbis = entry.mid(eq + 1);
+                    continue;
+                }
+                if (!meta)
+                    continue;
+                const QString value = entry.mid(eq + 1).trimmed();
+                if (key == "TITLE" && meta->title.isEmpty())
+                    meta->title = value;
+                else if (key == "ARTIST" && meta->artist.isEmpty())
+                    meta->artist = value;
+                else if (key == "ALBUM" && meta->album.isEmpty())
+                    meta->album = value;
+            }
+        } else if (!file.seek(file.pos() + length)) {
+            break;
+        }
+    }
+    return true;
+}
+}
+
+TrackMetadata TagReader::read(const QString &filePath)
+{
+    TrackMetadata meta;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return meta;
+
+    const qint64 id3Size = readId3v2(file, &meta, nullptr);
+    if (!readFlac(file, id3Size, &meta, nullptr) && meta.isEmpty())
+        readId3v1(file, meta);
+    return meta;
+}
+
+EmbeddedLyrics TagReader::readLyrics(const QString &filePath)
+{
+    EmbeddedLyrics lyrics;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return lyrics;
+
+    const qint64 id3Size = readId3v2(file, nullptr, &lyrics);
+    readFlac(file, id3Size, nullptr, &lyrics);
+    return lyrics;
+}
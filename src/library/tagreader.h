@@ -0,0 +1,38 @@
+#ifndef TAGREADER_H
+#define TAGREADER_H
+
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+// 歌曲元数据
+struct TrackMetadata
+{
+    QString title;
+    QString artist;
+    QString album;
+    qint64 durationMs = 0;
+
+    bool isEmpty() const { return title.isEmpty() && artist.isEmpty() && album.isEmpty(); }
+};
+
+// 内嵌歌词
+struct EmbeddedLyrics
+{
+    QString id3Unsynced;                        // ID3 USLT（常见为 LRC 文本）
+    QVector<QPair<qint64, QString>> id3Synced;  // ID3 SYLT（毫秒时间戳 + 文本），已按时间排序
+    QString vorbis;                             // Vorbis 注释 LYRICS / UNSYNCEDLYRICS
+
+    bool isEmpty() const { return id3Unsynced.isEmpty() && id3Synced.isEmpty() && vorbis.isEmpty(); }
+};
+
+// 轻量级标签读取，不依赖 QMediaPlayer，可在后台线程和命令行工具中批量使用
+// 支持 ID3v2.2/2.3/2.4 文本帧、ID3v1、FLAC STREAMINFO 与 Vorbis 注释
+class TagReader
+{
+public:
+    static TrackMetadata read(const QString &filePath);
+    static EmbeddedLyrics readLyrics(const QString &filePath);
+};
+
+#endif // TAGREADER_H
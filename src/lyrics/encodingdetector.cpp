@@ -0,0 +1,308 @@
+#include "encodingdetector.h"
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QStringDecoder>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define XC_HAVE_SSE2
+#endif
+#ifdef Q_OS_WIN
+#include <qt_windows.h>
+#endif
+
+namespace {
+const qsizetype SampleLimit = 64 * 1024;    // GBK/Big5 统计只看开头这么多字节
+
+// 双字节编码的统计：所有字符都合法时，常用字区间所占比例越高越可能是该编码
+struct DbcsScore
+{
+    qsizetype pairs = 0;
+    qsizetype common = 0;
+    bool valid = true;
+
+    double ratio() const { return pairs ? double(common) / pairs : 0.0; }
+};
+
+// GBK：首字节 0x81-0xFE，尾字节 0x40-0x7E/0x80-0xFE；GB2312 常用汉字在 0xB0-0xF7 x 0xA1-0xFE
+DbcsScore scoreGbk(const uchar *data, qsizetype size)
+{
+    DbcsScore score;
+    qsizetype i = 0;
+    while (i < size) {
+        const uchar lead = data[i];
+        if (lead < 0x80) {
+            ++i;
+            continue;
+        }
+        if (i + 1 >= size)
+            break;      // 样本截断处
+        const uchar trail = data[i + 1];
+        if (lead == 0x80 || lead == 0xFF || trail < 0x40 || trail == 0x7F || trail == 0xFF) {
+            score.valid = false;
+            break;
+        }
+        ++score.pairs;
+        if (lead >= 0xB0 && lead <= 0xF7 && trail >= 0xA1)
+            ++score.common;
+        i += 2;
+    }
+    return score;
+}
+
+// Big5：首字节 0x81-0xFE，尾字节 0x40-0x7E/0xA1-0xFE；常用字在 0xA440-0xC67E
+DbcsScore scoreBig5(const uchar *data, qsizetype size)
+{
+    DbcsScore score;
+    qsizetype i = 0;
+    while (i < size) {
+        const uchar lead = data[i];
+        if (lead < 0x80) {
+            ++i;
+            continue;
+        }
+        if (i + 1 >= size)
+            break;
+        const uchar trail = data[i + 1];
+        const bool trailValid = (trail >= 0x40 && trail <= 0x7E) || (trail >= 0xA1 && trail <= 0xFE);
+        if (lead == 0x80 || lead == 0xFF || !trailValid) {
+            score.valid = false;
+            break;
+        }
+        ++score.pairs;
+        if (lead >= 0xA4 && (lead < 0xC6 || (lead == 0xC6 && trail <= 0x7E)))
+            ++score.common;
+        i += 2;
+    }
+    return score;
+}
+
+// 没有 BOM 的 UTF-16：ASCII 字符的高字节为 0，集中出现在奇数或偶数位置
+bool looksLikeUtf16(const uchar *data, qsizetype size, bool *littleEndian)
+{
+    const qsizetype sample = qMin<qsizetype>(size, 1024) & ~qsizetype(1);
+    if (sample < 16)
+        return false;
+    qsizetype evenZeros = 0;
+    qsizetype oddZeros = 0;
+    for (qsizetype i = 0; i < sample; i += 2) {
+        evenZeros += data[i] == 0;
+        oddZeros += data[i + 1] == 0;
+    }
+    const qsizetype units = sample / 2;
+    if (oddZeros * 10 > units * 4 && evenZeros * 20 < units) {
+        *littleEndian = true;
+        return true;
+    }
+    if (evenZeros * 10 > units * 4 && oddZeros * 20 < units) {
+        *littleEndian = false;
+        return true;
+    }
+    return false;
+}
+
+#ifdef Q_OS_WIN
+// 没有 ICU 时 QStringDecoder 不支持 GBK/Big5，改用系统代码页转换
+QString decodeCodePage(UINT codePage, const char *data, qsizetype size)
+{
+    if (size <= 0)
+        return QString();
+    const int length = MultiByteToWideChar(codePage, 0, data, int(size), nullptr, 0);
+    QString result(length, Qt::Uninitialized);
+    MultiByteToWideChar(codePage, 0, data, int(size), reinterpret_cast<wchar_t *>(result.data()), length);
+    return result;
+}
+#endif
+
+struct CacheEntry
+{
+    qint64 size = 0;
+    qint64 modified = 0;
+    EncodingDetector::Encoding encoding = EncodingDetector::Utf8;
+};
+
+QMutex cacheMutex;
+QHash<QString, CacheEntry> &cache()
+{
+    static QHash<QString, CacheEntry> entries;
+    return entries;
+}
+}
+
+bool EncodingDetector::isValidUtf8(const char *text, qsizetype size)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(text);
+    qsizetype i = 0;
+    while (i < size) {
+#ifdef XC_HAVE_SSE2
+        // 最高位全为 0 的 16 字节整块跳过，歌词中的时间标签和英文大多走这里
+        while (i + 16 <= size) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            if (_mm_movemask_epi8(chunk) != 0)
+                break;
+            i += 16;
+        }
+        if (i >= size)
+            break;
+#endif
+        const uchar c = data[i];
+        if (c < 0x80) {
+            ++i;
+            continue;
+        }
+
+        int length;
+        uchar min = 0x80;
+        uchar max = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) {
+            length = 2;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            length = 3;
+            if (c == 0xE0)
+                min = 0xA0;     // 过长编码
+            else if (c == 0xED)
+                max = 0x9F;     // 代理区
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            length = 4;
+            if (c == 0xF0)
+                min = 0x90;
+            else if (c == 0xF4)
+                max = 0x8F;     // 超过 U+10FFFF
+        } else {
+            return false;
+        }
+        if (i + length > size || data[i + 1] < min || data[i + 1] > max)
+            return false;
+        for (int k = 2; k < length; ++k) {
+            if ((data[i + k] & 0xC0) != 0x80)
+                return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+EncodingDetector::Encoding EncodingDetector::detect(const QByteArray &bytes, int *bomLength)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(bytes.constData());
+    const qsizetype size = bytes.size();
+    int bom = 0;
+    Encoding encoding;
+
+    bool littleEndian = true;
+    if (size >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) {
+        bom = 3;
+        encoding = Utf8;
+    } else if (size >= 2 && data[0] == 0xFF && data[1] == 0xFE) {
+        bom = 2;
+        encoding = Utf16LE;
+    } else if (size >= 2 && data[0] == 0xFE && data[1] == 0xFF) {
+        bom = 2;
+        encoding = Utf16BE;
+    } else if (looksLikeUtf16(data, size, &littleEndian)) {
+        encoding = littleEndian ? Utf16LE : Utf16BE;
+    } else if (isValidUtf8(bytes.constData(), size)) {
+        encoding = Utf8;
+    } else {
+        const qsizetype sample = qMin(size, SampleLimit);
+        const DbcsScore gbk = scoreGbk(data, sample);
+        const DbcsScore big5 = scoreBig5(data, sample);
+        if (gbk.valid && (!big5.valid || gbk.ratio() >= big5.ratio()))
+            encoding = Gbk;     // 分不出时按 GBK，本地歌词以简体为主
+        else if (big5.valid)
+            encoding = Big5;
+        else
+            encoding = Latin1;
+    }
+
+    if (bomLength)
+        *bomLength = bom;
+    return encoding;
+}
+
+QString EncodingDetector::decode(const QByteArray &data, Encoding encoding, int bomLength)
+{
+    const QByteArrayView bytes = QByteArrayView(data).sliced(qMin<qsizetype>(bomLength, data.size()));
+    switch (encoding) {
+    case Utf8:
+        return QString::fromUtf8(bytes);
+    case Utf16LE:
+        return QStringDecoder(QStringConverter::Utf16LE).decode(bytes);
+    case Utf16BE:
+        return QStringDecoder(QStringConverter::Utf16BE).decode(bytes);
+    case Latin1:
+        return QString::fromLatin1(bytes);
+    case Gbk:
+    case Big5: {
+        // GB18030 兼容 GBK
+        QStringDecoder decoder(encoding == Gbk ? "GB18030" : "Big5");
+        if (decoder.isValid())
+            return decoder.decode(bytes);
+#ifdef Q_OS_WIN
+        return decodeCodePage(encoding == Gbk ? 936 : 950, bytes.constData(), bytes.size());
+#else
+        qWarning() << "No decoder available for" << name(encoding) << ", falling back to the local 8-bit codec";
+        return QString::fromLocal8Bit(bytes);
+#endif
+    }
+    }
+    return QString();
+}
+
+const char *EncodingDetector::name(Encoding encoding)
+{
+    switch (encoding) {
+    case Utf8: return "UTF-8";
+    case Utf16LE: return "UTF-16LE";
+    case Utf16BE: return "UTF-16BE";
+    case Gbk: return "GBK";
+    case Big5: return "Big5";
+    case Latin1: return "ISO-8859-1";
+    }
+    return "";
+}
+
+QString EncodingDetector::readFile(const QString &filePath, Encoding *used)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+    const QByteArray data = file.readAll();
+    const QFileInfo info(file);
+    const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+
+    Encoding encoding;
+    int bomLength = 0;
+    bool cached = false;
+    {
+        QMutexLocker locker(&cacheMutex);
+        auto it = cache().constFind(filePath);
+        if (it != cache().cend() && it->size == data.size() && it->modified == modified) {
+            encoding = it->encoding;
+            cached = true;
+        }
+    }
+    if (cached) {
+        // BOM 只需比较开头几个字节
+        if (encoding == Utf8 && data.startsWith("\xEF\xBB\xBF"))
+            bomLength = 3;
+        else if ((encoding == Utf16LE && data.startsWith("\xFF\xFE")) || (encoding == Utf16BE && data.startsWith("\xFE\xFF")))
+            bomLength = 2;
+    } else {
+        encoding = detect(data, &bomLength);
+        QMutexLocker locker(&cacheMutex);
+        cache().insert(filePath, { data.size(), modified, encoding });
+    }
+
+    if (used)
+        *used = encoding;
+    return decode(data, encoding, bomLength);
+}
+
+void EncodingDetector::clearCache()
+{
+    QMutexLocker locker(&cacheMutex);
+    cache().clear();
+}
@@ -0,0 +1,26 @@
+#ifndef ENCODINGDETECTOR_H
+#define ENCODINGDETECTOR_H
+
+#include <QByteArray>
+#include <QString>
+
+// 歌词文件编码识别（不依赖界面）
+// 先看 BOM，再校验 UTF-8（SSE2 每次跳过 16 个 ASCII 字节），都不是时统计双字节字符的分布区分 GBK 和 Big5。
+// 解码只做一次转换；按文件路径缓存识别结果（大小或修改时间变化后失效），重复加载同一文件时不再识别。
+class EncodingDetector
+{
+public:
+    enum Encoding { Utf8, Utf16LE, Utf16BE, Gbk, Big5, Latin1 };
+
+    // bomLength 返回需要跳过的 BOM 字节数
+    static Encoding detect(const QByteArray &data, int *bomLength = nullptr);
+    static bool isValidUtf8(const char *data, qsizetype size);
+    static QString decode(const QByteArray &data, Encoding encoding, int bomLength = 0);
+    static const char *name(Encoding encoding);
+
+    // 读取并解码文件，失败时返回空字符串
+    static QString readFile(const QString &filePath, Encoding *used = nullptr);
+    static void clearCache();
+};
+
+#endif // ENCODINGDETECTOR_H
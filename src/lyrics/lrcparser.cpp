@@ -0,0 +1,177 @@
+#include "lrcparser.h"
+#include "encodingdetector.h"
+#include <QRegularExpression>
+#include <algorithm>
+
+namespace {
+// [mm:ss]、[mm:ss:xx] 或 [mm:ss.xx]/[mm:ss.xxx]，两位时为百分之一秒
+const QRegularExpression &lineRegex()
+{
+    static const QRegularExpression regex(R"(\[(\d{2}):(\d{2})(?:[:.](\d{2,3}))?\](.*))");
+    return regex;
+}
+
+// 增强 LRC 的逐字时间 <mm:ss.xx>
+const QRegularExpression &wordRegex()
+{
+    static const QRegularExpression regex(R"(<(\d{2}):(\d{2})(?:[:.](\d{2,3}))?>)");
+    return regex;
+}
+
+qint64 toMilliseconds(const QRegularExpressionMatch &match)
+{
+    const QString fraction = match.captured(3);
+    int milliseconds = fraction.isEmpty() ? 0 : fraction.toInt();
+    if (fraction.size() == 2)
+        milliseconds *= 10;
+    return (match.captured(1).toInt() * 60 + match.captured(2).toInt()) * 1000LL + milliseconds;
+}
+
+void parseLine(const QString &line, QMap<QTime, QString> &lyricsMap)
+{
+    QRegularExpressionMatch match = lineRegex().match(line);
+    if (match.hasMatch()) {
+        QString text = match.captured(4).trimmed();
+        QTime time = QTime(0, 0).addMSecs(toMilliseconds(match));
+        lyricsMap[time] = text;
+    }
+}
+
+// 拆出逐字时间：标签之间的文本是一个词，词的开始时间为前面的标签；
+// 标签后面没有文本时表示行尾时间
+bool parseWords(const QString &rest, LyricLine &line, qint64 &lineEnd)
+{
+    QRegularExpressionMatchIterator it = wordRegex().globalMatch(rest);
+    if (!it.hasNext())
+        return false;
+
+    qint64 wordStart = line.startMs;
+    int pos = 0;
+    auto append = [&](const QString &segment) {
+        if (segment.isEmpty())
+            return;
+        line.text += segment;
+        const qint32 offset = qint32(qMax<qint64>(wordStart - line.startMs, 0));
+        const qint32 previous = line.words.isEmpty() ? 0 : line.words.constLast().offsetMs;
+        line.words.append({ qMax(offset, previous), quint16(qMin<qsizetype>(line.text.size(), 0xFFFF)) });
+    };
+    while (it.hasNext()) {
+        const QRegularExpressionMatch match = it.next();
+        append(rest.mid(pos, match.capturedStart() - pos));
+        wordStart = toMilliseconds(match);
+        pos = match.capturedEnd();
+    }
+    const QString tail = rest.mid(pos);
+    if (tail.trimmed().isEmpty() && !line.words.isEmpty())
+        lineEnd = wordStart;
+    else
+        append(tail);
+
+    // 与只有行时间的歌词一样去掉首尾空白，词的结束位置随之平移
+    const QString trimmed = line.text.trimmed();
+    const int leading = line.text.indexOf(trimmed);
+    for (LyricWord &word : line.words)
+        word.end = quint16(qBound(0, int(word.end) - leading, int(trimmed.size())));
+    line.text = trimmed;
+    if (line.text.size() > 0xFFFF)
+        line.words.clear();
+    return true;
+}
+}
+
+qreal LyricLine::sungLength(qint64 ms) const
+{
+    if (words.isEmpty())
+        return ms >= startMs ? text.size() : 0;
+
+    const qint64 t = ms - startMs;
+    if (t < words.constFirst().offsetMs)
+        return 0;
+    auto it = std::upper_bound(words.cbegin(), words.cend(), t, [](qint64 value, const LyricWord &word) {
+        return value < word.offsetMs;
+    });
+    const int i = int(it - words.cbegin()) - 1;
+    const int begin = i > 0 ? words[i - 1].end : 0;
+    const int end = words[i].end;
+    const qint64 next = i + 1 < words.size() ? words[i + 1].offsetMs : endMs - startMs;
+    const qint64 span = next - words[i].offsetMs;
+    const qreal fraction = span > 0 ? qBound<qreal>(0, qreal(t - words[i].offsetMs) / span, 1) : 1;
+    return begin + fraction * (end - begin);
+}
+
+QMap<QTime, QString> LrcParser::parseFile(const QString &filePath)
+{
+    // 编码由 EncodingDetector 识别（GBK、带 BOM 的文件等），解码一次后按文本解析
+    return parseText(EncodingDetector::readFile(filePath));
+}
+
+QMap<QTime, QString> LrcParser::parseText(const QString &text)
+{
+    QMap<QTime, QString> lyricsMap;
+    const QStringList lines = text.split('\n');
+    for (const QString &line : lines)
+        parseLine(line, lyricsMap);
+    return lyricsMap;
+}
+
+QVector<LyricLine> LrcParser::parseLinesFile(const QString &filePath)
+{
+    return parseLines(EncodingDetector::readFile(filePath));
+}
+
+QVector<LyricLine> LrcParser::parseLines(const QString &text)
+{
+    QVector<LyricLine> lines;
+    QVector<qint64> lineEnds;
+    const QStringList rows = text.split('\n');
+    for (const QString &row : rows) {
+        const QRegularExpressionMatch match = lineRegex().match(row);
+        if (!match.hasMatch())
+            continue;
+        LyricLine line;
+        line.startMs = toMilliseconds(match);
+        qint64 lineEnd = -1;
+        if (!parseWords(match.captured(4), line, lineEnd))
+            line.text = match.captured(4).trimmed();
+        lines.append(line);
+        lineEnds.append(lineEnd);
+    }
+
+    // 按时间排序；时间相同的行与 parseText 一致，保留最后一行
+    QVector<int> order(lines.size());
+    for (int i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&lines](int a, int b) {
+        return lines[a].startMs < lines[b].startMs;
+    });
+    QVector<LyricLine> sorted;
+    QVector<qint64> sortedEnds;
+    sorted.reserve(lines.size());
+    for (int index : order) {
+        if (!sorted.isEmpty() && sorted.constLast().startMs == lines[index].startMs) {
+            sorted.last() = lines[index];
+            sortedEnds.last() = lineEnds[index];
+        } else {
+            sorted.append(lines[index]);
+            sortedEnds.append(lineEnds[index]);
+        }
+    }
+
+    for (int i = 0; i < sorted.size(); ++i) {
+        LyricLine &line = sorted[i];
+        if (sortedEnds[i] > line.startMs)
+            line.endMs = sortedEnds[i];
+        else if (i + 1 < sorted.size())
+            line.endMs = sorted[i + 1].startMs;
+        else
+            line.endMs = line.startMs + (line.words.isEmpty() ? 5000 : line.words.constLast().offsetMs + 1000);
+    }
+    return sorted;
+}
+
+bool LrcParser::hasWordTimings(const QVector<LyricLine> &lines)
+{
+    return std::any_of(lines.cbegin(), lines.cend(), [](const LyricLine &line) {
+        return !line.words.isEmpty();
+    });
+}
@@ -0,0 +1,43 @@
+#ifndef LRCPARSER_H
+#define LRCPARSER_H
+
+#include <QMap>
+#include <QString>
+#include <QTime>
+#include <QVector>
+
+// 逐字歌词（增强 LRC 中的 <mm:ss.xx>）里的一个词
+// 只保存相对行开始的时间和在去掉时间标签后文本中的结束位置，每个词 8 字节
+struct LyricWord
+{
+    qint32 offsetMs = 0;    // 该词开始时间，相对于所在行
+    quint16 end = 0;        // 该词在 LyricLine::text 中的结束位置（不含），开始位置为上一个词的 end
+};
+
+struct LyricLine
+{
+    qint64 startMs = 0;
+    qint64 endMs = 0;           // 行尾时间标签，没有时为下一行开始时间
+    QString text;               // 去掉时间标签后的文本
+    QVector<LyricWord> words;   // 空表示只有行时间
+
+    // 时间 ms 时已唱过的文本长度（以字符计，可为小数），用于逐字扫过高亮
+    qreal sungLength(qint64 ms) const;
+};
+
+// LRC 歌词解析（不依赖界面，可在命令行工具和后台线程中使用）
+class LrcParser
+{
+public:
+    // 解析歌词文件，文件不存在或无有效行时返回空映射
+    static QMap<QTime, QString> parseFile(const QString &filePath);
+    // 解析已读入内存的歌词文本
+    static QMap<QTime, QString> parseText(const QString &text);
+
+    // 按时间排序的歌词行，保留增强 LRC 的逐字时间
+    static QVector<LyricLine> parseLinesFile(const QString &filePath);
+    static QVector<LyricLine> parseLines(const QString &text);
+    static bool hasWordTimings(const QVector<LyricLine> &lines);
+};
+
+#endif // LRCPARSER_H
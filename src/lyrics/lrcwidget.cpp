@@ -9,6 +9,8 @@
 #include<QTime>
 #include <QGraphicsScene>
 #include <QGraphicsPixmapItem>
+#include <QScreen>
+#include "lrcparser.h"
 
 lrcwidget::lrcwidget(QWidget *parent) :
     QWidget(parent),
@@ -55,37 +57,17 @@ lrcwidget::lrcwidget(QWidget *parent) :
     // 将 noLyricsLabel 添加到 stackedWidget
     stackedWidget->addWidget(noLyricsLabel);
 
-    // 将 lrc_list 添加到 stackedWidget
-    //stackedWidget->addWidget(ui->lrc_list);
     stackedWidget->setCurrentWidget(noLyricsLabel);
 
 
     // 调整按钮层级关系
     ui->btnLrcClose->raise();
 
-    //创建动画对象
-    ui->lrc_list->setStyleSheet(
-        "QListWidget {"
-        "    background: transparent;"      // 设置背景透明
-        "    font-family: 'Arial';"     // 设置字体家族
-        "    font-size: 15pt;"          // 设置字体大小
-        "    border: none;"                 // 取消边框
-        "}"
-        "QListWidget::item {"
-        "    color: white;"                 // 设置文字颜色为白色
-        "    text-align: center;"           // 文字居中显示
-        "    padding: 10px 0px;"        // 设置上下边距为10px，左右边距为0px
-        "}"
-
-        "QListWidget::item:selected {"
-        "    color: yellow;"
-
-        "    font-weight: bold;"
-        "}"
-        );
+    // 歌词视图：行高和可见行数由视图自己决定，只需指定位置和宽度
+    lyricView = new LyricView(this);
+    lyricView->setGeometry(QRect(QPoint(430, 130), QSize(301, lyricView->sizeHint().height())));
+    lyricView->hide();
 
-    ui->lrc_list->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    ui->lrc_list->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     ui->labCov->setAlignment(Qt::AlignCenter | Qt::AlignVCenter);
     ui->labCov->setStyleSheet("margin: 0px; padding: 0px; border: none;");
 
@@ -98,11 +80,22 @@ lrcwidget::lrcwidget(QWidget *parent) :
     connect(ui->horizontalSlider, &QSlider::sliderPressed, this, &lrcwidget::on_horizontalSlider_sliderPressed);
     connect(ui->horizontalSlider, &QSlider::sliderReleased, this, &lrcwidget::on_horizontalSlider_sliderReleased);
 
-
+    // 频谱显示：分析器在独立线程中计算，界面只负责绘制
+    spectrumView = new SpectrumWidget(this);
+    spectrumView->setGeometry(30, 445, 711, 65);
+    spectrumAnalyzer = new SpectrumAnalyzer;
+    spectrumThread = new QThread(this);
+    spectrumAnalyzer->moveToThread(spectrumThread);
+    connect(spectrumThread, &QThread::finished, spectrumAnalyzer, &QObject::deleteLater);
+    connect(spectrumAnalyzer, &SpectrumAnalyzer::spectrumReady, spectrumView, &SpectrumWidget::setBands);
+    spectrumThread->start();
 }
 
 lrcwidget::~lrcwidget()
 {
+    spectrumAnalyzer->setActive(false);
+    spectrumThread->quit();
+    spectrumThread->wait();
     delete ui;
 }
 
@@ -135,6 +128,10 @@ QPushButton* lrcwidget::getModeButton() const {
     return ui->btnMode;
 }
 
+SpectrumAnalyzer* lrcwidget::getSpectrumAnalyzer() const {
+    return spectrumAnalyzer;
+}
+
 void lrcwidget::updateLabProcess(const QString &text)
 {
     ui->labProcess->setText(text);
@@ -143,101 +140,45 @@ void lrcwidget::updateLabProcess(const QString &text)
 
 void lrcwidget::loadLyrics(const QString &filePath)
 {
-    lyricsMap = parseLyrics(filePath);
-    ui->lrc_list->clear();
+    setLyrics(LrcParser::parseLinesFile(filePath));
+}
+
+void lrcwidget::setLyrics(const QVector<LyricLine> &lines)
+{
+    lyricView->setLines(lines);
 
-    if (lyricsMap.isEmpty()) {
+    if (lines.isEmpty()) {
+        lyricView->hide();
         stackedWidget->show();
     } else {
         stackedWidget->hide();
-
-        for (auto it = lyricsMap.begin(); it != lyricsMap.end(); ++it) {
-            QListWidgetItem *item = new QListWidgetItem(it.value());
-            item->setTextAlignment(Qt::AlignCenter);
-            ui->lrc_list->addItem(item);
-        }
-
-        // 更新列表高度以适应行
-        updateListHeight();
+        lyricView->show();
     }
 }
 
 QMap<QTime, QString> lrcwidget::parseLyrics(const QString &filePath)
 {
-    QFile file(filePath);
-    //QMap<QTime, QString> lyricsMap;
-    if(file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        lyricsMap.clear();
-        QTextStream in(&file);
-
-        QRegularExpression regex(R"(\[(\d{2}):(\d{2})(?::(\d{2}))?\](.*))");
-
-
-        while(!in.atEnd()){
-            QString line = in.readLine();
-            QRegularExpressionMatch match = regex.match(line);
-            if(match.hasMatch()){
-                int minutes = match.captured(1).toInt();
-                int seconds = match.captured(2).toInt();
-
-                int milliseconds = match.captured(3).isEmpty() ? 0 : match.captured(3).toInt() * 10;
-                QString text = match.captured(4).trimmed();
-
-                QTime time(0, minutes, seconds, milliseconds);
-                lyricsMap[time] = text;
-                //qDebug() << "Parsed lyrics:" << time.toString() << text; // Debug output
-            }
-        }
-    }
-
-    file.close();
-    return lyricsMap;
+    // 解析逻辑在 LrcParser 中，命令行工具和后台任务可以共用
+    return LrcParser::parseFile(filePath);
 }
 
 
 void lrcwidget::updateLyrics(qint64 position)
 {
-
-
-
-    int totalSeconds = position / 1000; // 将毫秒转换为秒
-    int seconds = totalSeconds % 60; // 计算剩余的秒数
-    int minutes = totalSeconds / 60; // 计算分钟数
-    int milliseconds = position % 1000; // 计算剩余的毫秒
-
-    QTime currentTime(0, minutes, seconds, milliseconds);
-    //QString currentLyric = "No lyric available"; // 默认文本
-    QTime bestMatch(0, 0, 0, 0); // 初始化为一个有效的最小时间
-
-
-    // 查找第一个大于当前时间的迭代器
-    auto it = lyricsMap.upperBound(currentTime);
-
-    // 如果不是第一个元素，回退到最后一个不大于当前时间的元素
-    if (it != lyricsMap.begin()) {
-        --it;
-    }
-
-    // 确保找到的时间不晚于当前时间
-    while (it != lyricsMap.end() && it.key() > currentTime) {
-        if (it == lyricsMap.begin()) {
-            break;  // 如果已经是第一个元素，则停止
-        }
-        --it;
-    }
-
-    if (it != lyricsMap.end() && it.key() <= currentTime) {
-        int index = std::distance(lyricsMap.begin(), it);
-        ui->lrc_list->setCurrentRow(index);
-        ui->lrc_list->scrollToItem(ui->lrc_list->item(index), QAbstractItemView::PositionAtCenter);
-        // 高亮显示当前行
-        ui->lrc_list->item(index)->setSelected(true);
-    }
-
+    lyricView->setPosition(position);
     ui->horizontalSlider->setValue(position);
+}
 
+
+void lrcwidget::setPlaying(bool playing)
+{
+    lyricView->setPlaying(playing);
 }
 
+void lrcwidget::setPlaybackClock(const PlaybackClock *clock)
+{
+    lyricView->setClock(clock);
+}
 
 void lrcwidget::on_horizontalSlider_sliderMoved(int position)
 {
@@ -276,15 +217,6 @@ void lrcwidget::setCoverImage(const QPixmap &pixmap)
 
 }
 
-void lrcwidget::updateListHeight()
-{
-    if (ui->lrc_list->count() > 0) {
-        int rowHeight = ui->lrc_list->sizeHintForRow(0);
-        int numRowsToShow = 7;
-        ui->lrc_list->setFixedHeight(rowHeight * numRowsToShow);
-    }
-}
-
 void lrcwidget::showLyric()
 {
     QWidget *parent = parentWidget();
@@ -350,8 +282,7 @@ void lrcwidget::resetCoverImage()
 
 void lrcwidget::clearLyrics()
 {
-    ui->lrc_list->clear();  // 清空歌词列表
-    lyricsMap.clear();  // 清空歌词映射
+    lyricView->clear();  // 清空歌词
 
 
 }
@@ -382,6 +313,27 @@ void lrcwidget::paintEvent(QPaintEvent *event)
     }
 }
 
+void lrcwidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+
+    // 频谱刷新与显示器刷新率对齐
+    qreal refreshRate = screen() ? screen()->refreshRate() : 60.0;
+    if (refreshRate <= 0)
+        refreshRate = 60.0;
+    spectrumAnalyzer->setFrameInterval(qRound(1000.0 / refreshRate));
+    spectrumAnalyzer->setActive(true);
+}
+
+void lrcwidget::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+
+    // 歌词界面隐藏后完全停止频谱分析和绘制
+    spectrumAnalyzer->setActive(false);
+    spectrumView->setBands(QVector<float>());
+}
+
 QImage lrcwidget::applyBlurToImage(QImage sourceImage, int radius)
 {
     QGraphicsScene scene;
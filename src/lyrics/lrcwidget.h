@@ -8,6 +8,10 @@
 #include <QPropertyAnimation>
 #include <QWidget>
 #include <QStackedWidget>
+#include <QThread>
+#include "spectrumwidget.h"
+#include "lyricview.h"
+#include "../audio/spectrumanalyzer.h"
 
 namespace Ui {
 class lrcwidget;
@@ -29,16 +33,18 @@ public:
     QSlider* getSoundSlider() const;
     QDoubleSpinBox* getSpeedSpinBox() const;
     QPushButton* getModeButton() const;
+    SpectrumAnalyzer* getSpectrumAnalyzer() const;
 
     void loadLyrics(const QString& filePath);
+    void setLyrics(const QVector<LyricLine> &lines);
     QMap<QTime, QString> parseLyrics(const QString& filePath);
     void setCoverImage(const QPixmap &pixmap);
-    void updateListHeight();
     void showLyric();//显示歌词
     void hideLyric();//隐藏歌词
     void resetCoverImage();//更新封面
     void clearLyrics();  // 添加一个清空歌词的方法
     void updateLabProcess(const QString &text);
+    void setPlaybackClock(const PlaybackClock *clock);
 
 signals:
     void sliderMoved(int position);
@@ -53,18 +59,24 @@ private slots:
 
 protected:
     void paintEvent(QPaintEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
     QImage applyBlurToImage(QImage sourceImage, int radius);
 
 public slots:
     void updateLyrics(qint64 position);
+    void setPlaying(bool playing);
 
 private:
     Ui::lrcwidget *ui;
     QPixmap coverPixmap;//保存封面图像
     QPropertyAnimation *animation;//动画对象
-    QMap<QTime, QString> lyricsMap;//歌词时间映射
     QLabel *noLyricsLabel; // 用于显示没有歌词的提示
     QStackedWidget *stackedWidget; // 用于管理多个窗口部件
+    LyricView *lyricView; // 歌词显示（自绘，支持逐字歌词）
+    SpectrumWidget *spectrumView; // 频谱显示
+    SpectrumAnalyzer *spectrumAnalyzer; // 频谱分析（运行在 spectrumThread 中）
+    QThread *spectrumThread;
 };
 
 #endif // LRCWIDGET_H
@@ -0,0 +1,171 @@
+#include "lyricresolver.h"
+#include "../library/tagreader.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+
+namespace {
+// SYLT 转成 LRC 文本。有片段以换行开头时按逐字歌词处理：换行开始新的一行，其余片段作为上一行中的一个词；
+// 否则每个片段就是一行
+QString syltToLrc(const QVector<QPair<qint64, QString>> &entries)
+{
+    auto stamp = [](qint64 ms) {
+        return QString::asprintf("%02lld:%02lld.%02lld", ms / 60000, ms / 1000 % 60, ms / 10 % 100);
+    };
+    auto startsLine = [](const QString &piece) {
+        return piece.startsWith('\n') || piece.startsWith('\r');
+    };
+    const bool wordLevel = std::any_of(entries.cbegin(), entries.cend(), [&startsLine](const QPair<qint64, QString> &entry) {
+        return startsLine(entry.second);
+    });
+
+    QString text;
+    bool lineOpen = false;
+    for (const auto &entry : entries) {
+        QString piece = entry.second;
+        const bool newLine = !lineOpen || !wordLevel || startsLine(piece);
+        piece.remove('\r');
+        piece.remove('\n');
+        if (newLine) {
+            if (lineOpen)
+                text += '\n';
+            text += '[' + stamp(entry.first) + ']';
+            lineOpen = true;
+        }
+        if (wordLevel)
+            text += '<' + stamp(entry.first) + '>';
+        text += piece;
+    }
+    return text;
+}
+
+// 文件名中不能出现的字符替换为下划线
+QString safeFileName(QString name)
+{
+    static const QString invalid = QStringLiteral("\\/:*?\"<>|");
+    for (QChar &c : name) {
+        if (invalid.contains(c))
+            c = '_';
+    }
+    return name.trimmed();
+}
+}
+
+LyricResolver::LyricResolver()
+    : m_found(FoundCacheSize)
+    , m_missing(MissCacheSize)
+{
+}
+
+void LyricResolver::setLyricsDirectory(const QString &directory)
+{
+    if (directory == m_lyricsDirectory)
+        return;
+    m_lyricsDirectory = directory;
+    clear();    // 查找范围变了，之前的结果都不再可靠
+}
+
+ResolvedLyrics LyricResolver::resolve(const QString &audioPath)
+{
+    // 歌曲文件本身马上就要被播放器打开，取一次它的信息代价很小
+    const QFileInfo info(audioPath);
+    const Identity identity{ info.exists() ? info.size() : -1, info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0 };
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    if (Entry *entry = m_found.object(audioPath)) {
+        if (entry->identity == identity) {
+            ++m_hits;
+            return entry->lyrics;
+        }
+        m_found.remove(audioPath);
+    }
+    if (Miss *missing = m_missing.object(audioPath)) {
+        if (missing->identity == identity && missing->expiresAt > now) {
+            ++m_hits;
+            return ResolvedLyrics();
+        }
+        m_missing.remove(audioPath);
+    }
+
+    ++m_misses;
+    const ResolvedLyrics lyrics = probe(audioPath);
+    if (lyrics.isEmpty())
+        m_missing.insert(audioPath, new Miss{ identity, now + m_missTimeoutMs });
+    else
+        m_found.insert(audioPath, new Entry{ identity, lyrics });
+    return lyrics;
+}
+
+ResolvedLyrics LyricResolver::probe(const QString &audioPath) const
+{
+    ResolvedLyrics result;
+    const QFileInfo info(audioPath);
+    const QString baseName = info.completeBaseName();
+
+    auto tryFile = [&result](const QString &path, ResolvedLyrics::Source source) {
+        if (!QFileInfo::exists(path))
+            return false;
+        result.lines = LrcParser::parseLinesFile(path);
+        if (result.lines.isEmpty())
+            return false;
+        result.source = source;
+        result.path = path;
+        return true;
+    };
+    auto tryText = [&result](const QString &text, ResolvedLyrics::Source source) {
+        if (text.isEmpty())
+            return false;
+        result.lines = LrcParser::parseLines(text);
+        if (result.lines.isEmpty())
+            return false;
+        result.source = source;
+        return true;
+    };
+
+    if (tryFile(info.path() + '/' + baseName + ".lrc", ResolvedLyrics::Sidecar))
+        return result;
+
+    // 内嵌歌词：不带时间标签的纯文本无法同步显示，跳过
+    const EmbeddedLyrics embedded = TagReader::readLyrics(audioPath);
+    if (tryText(embedded.id3Unsynced, ResolvedLyrics::Id3Unsynced)
+        || tryText(syltToLrc(embedded.id3Synced), ResolvedLyrics::Id3Synced)
+        || tryText(embedded.vorbis, ResolvedLyrics::VorbisComment))
+        return result;
+
+    if (!m_lyricsDirectory.isEmpty()) {
+        const QDir directory(m_lyricsDirectory);
+        if (tryFile(directory.filePath(baseName + ".lrc"), ResolvedLyrics::LyricsDirectory))
+            return result;
+        const TrackMetadata meta = TagReader::read(audioPath);
+        if (!meta.artist.isEmpty() && !meta.title.isEmpty()
+            && tryFile(directory.filePath(safeFileName(meta.artist + " - " + meta.title) + ".lrc"), ResolvedLyrics::LyricsDirectory))
+            return result;
+    }
+    return ResolvedLyrics();
+}
+
+void LyricResolver::invalidate(const QString &audioPath)
+{
+    m_found.remove(audioPath);
+    m_missing.remove(audioPath);
+}
+
+void LyricResolver::clear()
+{
+    m_found.clear();
+    m_missing.clear();
+}
+
+const char *LyricResolver::sourceName(ResolvedLyrics::Source source)
+{
+    switch (source) {
+    case ResolvedLyrics::None: return "none";
+    case ResolvedLyrics::Sidecar: return "sidecar";
+    case ResolvedLyrics::Id3Unsynced: return "USLT";
+    case ResolvedLyrics::Id3Synced: return "SYLT";
+    case ResolvedLyrics::VorbisComment: return "Vorbis LYRICS";
+    case ResolvedLyrics::LyricsDirectory: return "lyrics directory";
+    }
+    return "";
+}
@@ -0,0 +1,80 @@
+#ifndef LYRICRESOLVER_H
+#define LYRICRESOLVER_H
+
+#include <QCache>
+#include <QString>
+#include <QVector>
+#include "lrcparser.h"
+
+// 一首歌的歌词查找结果
+struct ResolvedLyrics
+{
+    enum Source { None, Sidecar, Id3Unsynced, Id3Synced, VorbisComment, LyricsDirectory };
+
+    Source source = None;
+    QString path;               // 来自 .lrc 文件时为该文件路径
+    QVector<LyricLine> lines;
+
+    bool isEmpty() const { return lines.isEmpty(); }
+};
+
+// 歌词查找（不依赖界面）
+// 依次尝试：同目录同名 .lrc、ID3 USLT/SYLT、Vorbis 注释 LYRICS、歌词目录（同名 .lrc 或“艺术家 - 标题.lrc”），
+// 第一个能解析出歌词行的来源即为结果。找到和找不到都按歌曲文件（路径 + 大小 + 修改时间）缓存，
+// 再次播放时只检查歌曲文件本身，不再探测其他文件；找不到的结果过一段时间后失效，以便补上歌词文件后能被发现。
+// 两种结果都只保留最近的若干首，长时间随机播放大曲库时内存不会一直增长。
+class LyricResolver
+{
+public:
+    static constexpr int FoundCacheSize = 256;
+    static constexpr int MissCacheSize = 4096;
+
+    LyricResolver();
+
+    void setLyricsDirectory(const QString &directory);
+    QString lyricsDirectory() const { return m_lyricsDirectory; }
+    void setMissTimeout(qint64 milliseconds) { m_missTimeoutMs = milliseconds; }
+
+    ResolvedLyrics resolve(const QString &audioPath);
+
+    void invalidate(const QString &audioPath);
+    void clear();
+
+    int cacheHits() const { return m_hits; }
+    int cacheMisses() const { return m_misses; }
+    int cachedMissing() const { return int(m_missing.size()); }
+
+    static const char *sourceName(ResolvedLyrics::Source source);
+
+private:
+    struct Identity
+    {
+        qint64 size = -1;
+        qint64 modified = 0;
+
+        bool operator==(const Identity &other) const { return size == other.size && modified == other.modified; }
+    };
+
+    struct Entry
+    {
+        Identity identity;
+        ResolvedLyrics lyrics;
+    };
+
+    struct Miss
+    {
+        Identity identity;
+        qint64 expiresAt = 0;   // 毫秒时间戳
+    };
+
+    ResolvedLyrics probe(const QString &audioPath) const;
+
+    QString m_lyricsDirectory;
+    qint64 m_missTimeoutMs = 5 * 60 * 1000;
+    QCache<QString, Entry> m_found;     // 歌词行占内存较多，只保留最近的若干首
+    QCache<QString, Miss> m_missing;    // 每项很小，但随机播放时每首歌都会留下一项，同样按最近使用淘汰
+    int m_hits = 0;
+    int m_misses = 0;
+};
+
+#endif // LYRICRESOLVER_H
@@ -0,0 +1,298 @@
+#include "lyricview.h"
+#include <QFontMetricsF>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QScreen>
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+const int LinePadding = 10;         // 与原歌词列表的上下边距一致
+const int ScrollDurationMs = 300;
+const int MaxLineWaitMs = 250;      // 变速播放时媒体时间与实际时间不一致，等待较久时分段重新计算
+
+QStaticText makeStaticText(const QString &text, const QFont &font)
+{
+    QStaticText staticText(text);
+    staticText.setTextFormat(Qt::PlainText);
+    staticText.setPerformanceHint(QStaticText::AggressiveCaching);
+    staticText.prepare(QTransform(), font);
+    return staticText;
+}
+}
+
+LyricView::LyricView(QWidget *parent)
+    : QWidget(parent)
+    , m_font("Arial", 15)
+    , m_activeFont(m_font)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setAttribute(Qt::WA_NoSystemBackground);
+    m_activeFont.setBold(true);
+    m_lineHeight = QFontMetrics(m_activeFont).height() + LinePadding * 2;
+
+    m_frameTimer.setTimerType(Qt::PreciseTimer);
+    m_frameTimer.setInterval(16);
+    connect(&m_frameTimer, &QTimer::timeout, this, &LyricView::advanceFrame);
+    m_lineTimer.setTimerType(Qt::PreciseTimer);
+    m_lineTimer.setSingleShot(true);
+    connect(&m_lineTimer, &QTimer::timeout, this, [this] {
+        advanceFrame();
+        updateFrameTimer();
+    });
+
+    m_scrollAnimation.setDuration(ScrollDurationMs);
+    m_scrollAnimation.setEasingCurve(QEasingCurve::OutCubic);
+    connect(&m_scrollAnimation, &QVariantAnimation::valueChanged, this, [this](const QVariant &value) {
+        m_scroll = value.toReal();
+        update();
+    });
+}
+
+QSize LyricView::sizeHint() const
+{
+    return QSize(300, m_lineHeight * VisibleLines);
+}
+
+void LyricView::setLines(const QVector<LyricLine> &lines)
+{
+    m_scrollAnimation.stop();
+    m_lines = lines;
+    m_texts = QVector<QStaticText>(lines.size());
+    m_activeText = QStaticText();
+    m_scroll = 0;
+    m_current = -1;
+    m_lastTime = 0;
+    m_wordX.clear();
+    m_sweepX = -1;
+    advanceFrame();
+    update();
+}
+
+void LyricView::clear()
+{
+    setLines(QVector<LyricLine>());
+}
+
+void LyricView::setClock(const PlaybackClock *clock)
+{
+    m_clock = clock;
+    advanceFrame();
+}
+
+void LyricView::setPosition(qint64 position)
+{
+    m_position = position;
+    advanceFrame();
+    updateFrameTimer();     // 跳转后重新计算到下一行的等待时间
+}
+
+void LyricView::setPlaying(bool playing)
+{
+    if (m_playing == playing)
+        return;
+    m_playing = playing;
+    advanceFrame();
+    updateFrameTimer();
+}
+
+qint64 LyricView::currentTime() const
+{
+    // 有播放时钟时取插值并扣除输出延迟后的位置，否则只能用最近一次报告的位置
+    return m_clock ? m_clock->position() : m_position;
+}
+
+int LyricView::lineAt(qint64 position) const
+{
+    auto it = std::upper_bound(m_lines.cbegin(), m_lines.cend(), position, [](qint64 value, const LyricLine &line) {
+        return value < line.startMs;
+    });
+    return int(it - m_lines.cbegin()) - 1;
+}
+
+void LyricView::advanceFrame()
+{
+    const qint64 time = currentTime();
+    m_lastTime = time;
+
+    const int line = lineAt(time);
+    if (line != m_current) {
+        m_current = line;
+        prepareSweep();
+        m_sweepX = sweepX(time);
+        updateFrameTimer();
+        scrollTo(line);
+        return;
+    }
+
+    const int x = sweepX(time);
+    if (x != m_sweepX) {
+        m_sweepX = x;
+        update(lineRect(m_current));
+    }
+}
+
+void LyricView::updateFrameTimer()
+{
+    const bool active = m_playing && isVisible() && !m_lines.isEmpty();
+    const bool karaoke = m_current >= 0 && !m_lines[m_current].words.isEmpty();
+    if (active && karaoke) {
+        m_lineTimer.stop();
+        if (!m_frameTimer.isActive()) {
+            // 与显示器刷新率对齐
+            qreal refreshRate = screen() ? screen()->refreshRate() : 60.0;
+            if (refreshRate <= 0)
+                refreshRate = 60.0;
+            m_frameTimer.start(qMax(1, qRound(1000.0 / refreshRate)));
+        }
+        return;
+    }
+
+    m_frameTimer.stop();
+    const int next = m_current + 1;
+    if (!active || next >= m_lines.size()) {
+        m_lineTimer.stop();
+        return;
+    }
+    // 普通行只在换行时需要重绘：按时钟算出到下一行开始的时间，届时再从时钟取位置
+    const qint64 wait = m_lines[next].startMs - currentTime();
+    m_lineTimer.start(int(qBound<qint64>(0, wait, MaxLineWaitMs)));
+}
+
+void LyricView::scrollTo(int line)
+{
+    const qreal target = qMax(line, 0);
+    m_scrollAnimation.stop();
+    // 不可见或跳转较远时直接定位，相邻行之间平滑滚动
+    if (!isVisible() || qAbs(target - m_scroll) > VisibleLines) {
+        m_scroll = target;
+        update();
+        return;
+    }
+    m_scrollAnimation.setStartValue(m_scroll);
+    m_scrollAnimation.setEndValue(target);
+    m_scrollAnimation.start();
+}
+
+const QStaticText &LyricView::staticText(int index)
+{
+    QStaticText &text = m_texts[index];
+    if (text.text().isEmpty() && !m_lines[index].text.isEmpty())
+        text = makeStaticText(m_lines[index].text, m_font);
+    return text;
+}
+
+void LyricView::prepareSweep()
+{
+    m_wordX.clear();
+    m_activeWidth = 0;
+    m_activeText = QStaticText();
+    if (m_current < 0)
+        return;
+    const LyricLine &line = m_lines[m_current];
+    m_activeText = makeStaticText(line.text, m_activeFont);
+    m_activeWidth = m_activeText.size().width();
+    const QFontMetricsF metrics(m_activeFont);
+    m_wordX.reserve(line.words.size());
+    for (const LyricWord &word : line.words)
+        m_wordX.append(metrics.horizontalAdvance(line.text.left(word.end)));
+}
+
+int LyricView::sweepX(qint64 position) const
+{
+    if (m_current < 0)
+        return -1;
+    const LyricLine &line = m_lines[m_current];
+    const qreal left = (width() - m_activeWidth) / 2;
+    if (line.words.isEmpty())
+        return qCeil(left + m_activeWidth);
+
+    // 已唱长度落在第 i 个词内，按字符比例在该词的像素范围内插值
+    const qreal sung = line.sungLength(position);
+    auto it = std::lower_bound(line.words.cbegin(), line.words.cend(), sung, [](const LyricWord &word, qreal value) {
+        return word.end < value;
+    });
+    if (it == line.words.cend())
+        return qCeil(left + m_activeWidth);
+    const int i = int(it - line.words.cbegin());
+    const int begin = i > 0 ? line.words[i - 1].end : 0;
+    const qreal beginX = i > 0 ? m_wordX[i - 1] : 0;
+    const qreal fraction = it->end > begin ? (sung - begin) / (it->end - begin) : 1;
+    return qRound(left + beginX + fraction * (m_wordX[i] - beginX));
+}
+
+QRect LyricView::lineRect(int index) const
+{
+    const int top = qRound(height() / 2 - m_lineHeight / 2 + (index - m_scroll) * m_lineHeight);
+    return QRect(0, top, width(), m_lineHeight);
+}
+
+void LyricView::paintEvent(QPaintEvent *event)
+{
+    if (m_lines.isEmpty())
+        return;
+
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+
+    // 只绘制与重绘区域相交的行
+    const QRect dirty = event->rect();
+    const int anchor = qFloor(m_scroll);
+    const int first = qMax(0, anchor - (height() / 2) / m_lineHeight - 1);
+    const int last = qMin(int(m_lines.size()) - 1, anchor + (height() / 2) / m_lineHeight + 2);
+    for (int i = first; i <= last; ++i) {
+        const QRect rect = lineRect(i);
+        if (!rect.intersects(dirty) || m_lines[i].text.isEmpty())
+            continue;
+        if (i != m_current) {
+            const QStaticText &text = staticText(i);
+            const QSizeF size = text.size();
+            painter.setFont(m_font);
+            painter.setPen(Qt::white);
+            painter.drawStaticText(QPointF((width() - size.width()) / 2, rect.top() + (m_lineHeight - size.height()) / 2), text);
+            continue;
+        }
+
+        // 当前行：先画白色整行，再在已唱部分画黄色
+        const QSizeF size = m_activeText.size();
+        const QPointF origin((width() - size.width()) / 2, rect.top() + (m_lineHeight - size.height()) / 2);
+        const bool fullySung = m_sweepX >= origin.x() + size.width();
+        painter.setFont(m_activeFont);
+        if (!fullySung) {
+            painter.setPen(Qt::white);
+            painter.drawStaticText(origin, m_activeText);
+        }
+        if (m_sweepX > rect.left()) {
+            painter.save();
+            if (!fullySung)
+                painter.setClipRect(QRect(rect.left(), rect.top(), m_sweepX - rect.left(), rect.height()));
+            painter.setPen(Qt::yellow);
+            painter.drawStaticText(origin, m_activeText);
+            painter.restore();
+        }
+    }
+}
+
+void LyricView::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    advanceFrame();
+    updateFrameTimer();
+}
+
+void LyricView::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    m_frameTimer.stop();
+    if (m_scrollAnimation.state() == QAbstractAnimation::Running) {
+        m_scrollAnimation.stop();
+        m_scroll = qMax(m_current, 0);
+    }
+}
+
+void LyricView::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    // 行居中绘制，宽度变化后高亮位置需要重新计算
+    m_sweepX = sweepX(m_lastTime);
+}
@@ -0,0 +1,83 @@
+#ifndef LYRICVIEW_H
+#define LYRICVIEW_H
+
+#include <QFont>
+#include <QStaticText>
+#include <QTimer>
+#include <QVariantAnimation>
+#include <QVector>
+#include <QWidget>
+#include "lrcparser.h"
+#include "../audio/playbackclock.h"
+
+// 歌词视图（代替原来带样式表的 QListWidget）
+// 每行文字第一次绘制时排版为 QStaticText 并缓存，之后只画缓存的字形；当前行居中，切换行时平滑滚动过去。
+// 增强 LRC 的当前行按词的时间从左向右扫过高亮。位置都从 PlaybackClock 取插值后的值（没有设置时钟时用最近一次报告的位置）；
+// 播放且可见时，当前行有逐字时间则按显示器刷新率逐帧推进，每帧只在高亮移动了整像素时重绘当前行所在区域；
+// 普通行不逐帧重绘，而是用单次定时器在下一行开始的时刻切换，不必等播放器下一次报告位置。
+// 绘制的行数不超过可见行数，开销与歌词长度无关。
+class LyricView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit LyricView(QWidget *parent = nullptr);
+
+    void setLines(const QVector<LyricLine> &lines);
+    void clear();
+    bool isEmpty() const { return m_lines.isEmpty(); }
+    int currentLine() const { return m_current; }
+
+    // 时钟由播放器所在的一方维护，视图只读取
+    void setClock(const PlaybackClock *clock);
+
+    // 高度为 VisibleLines 行
+    QSize sizeHint() const override;
+
+    static const int VisibleLines = 7;
+
+public slots:
+    void setPosition(qint64 position);      // 播放器报告了新位置（毫秒）
+    void setPlaying(bool playing);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    qint64 currentTime() const;
+    void advanceFrame();
+    void updateFrameTimer();
+    void prepareSweep();
+    void scrollTo(int line);
+    int lineAt(qint64 position) const;
+    int sweepX(qint64 position) const;
+    QRect lineRect(int index) const;
+    const QStaticText &staticText(int index);
+
+    QVector<LyricLine> m_lines;
+    QVector<QStaticText> m_texts;   // 普通行的排版缓存，按需生成
+    QStaticText m_activeText;       // 当前行（粗体）
+    int m_current = -1;
+
+    const PlaybackClock *m_clock = nullptr;
+    qint64 m_position = 0;
+    qint64 m_lastTime = 0;          // 最近一帧使用的时间
+    bool m_playing = false;
+    QTimer m_frameTimer;
+    QTimer m_lineTimer;             // 普通行：到下一行开始时触发
+
+    qreal m_scroll = 0;             // 居中位置对应的行号，滚动动画期间为小数
+    QVariantAnimation m_scrollAnimation;
+
+    QFont m_font;
+    QFont m_activeFont;
+    int m_lineHeight = 0;
+    QVector<qreal> m_wordX;     // 当前行各词结束位置的横坐标，切换行时计算一次
+    qreal m_activeWidth = 0;
+    int m_sweepX = -1;          // 上一帧高亮到的像素位置
+};
+
+#endif // LYRICVIEW_H
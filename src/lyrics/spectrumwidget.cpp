@@ -0,0 +1,53 @@
+#include "spectrumwidget.h"
+#include <QPainter>
+#include <QElapsedTimer>
+#include <QLinearGradient>
+#include <QDebug>
+
+SpectrumWidget::SpectrumWidget(QWidget *parent)
+    : QWidget(parent)
+    , m_reportStats(qEnvironmentVariableIsSet("XC_SPECTRUM_STATS"))
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setAttribute(Qt::WA_NoSystemBackground);
+}
+
+void SpectrumWidget::setBands(const QVector<float> &bands)
+{
+    m_bands = bands;
+    update();
+}
+
+void SpectrumWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    if (m_bands.isEmpty())
+        return;
+
+    QElapsedTimer cost;
+    cost.start();
+
+    QPainter painter(this);
+    QLinearGradient gradient(0, height(), 0, 0);
+    gradient.setColorAt(0.0, QColor(135, 206, 250, 200));   // 与进度条一致的浅天蓝色
+    gradient.setColorAt(1.0, QColor(255, 255, 255, 220));
+
+    const int count = m_bands.size();
+    const qreal slot = qreal(width()) / count;
+    const qreal barWidth = slot * 0.7;
+    for (int i = 0; i < count; ++i) {
+        qreal barHeight = m_bands[i] * height();
+        if (barHeight < 1.0)
+            continue;
+        painter.fillRect(QRectF(i * slot + (slot - barWidth) / 2, height() - barHeight, barWidth, barHeight), gradient);
+    }
+
+    if (m_reportStats) {
+        m_costNs += cost.nsecsElapsed();
+        if (++m_costFrames >= 600) {
+            qDebug() << "Spectrum paint cost per frame (us):" << m_costNs / 1000.0 / m_costFrames;
+            m_costNs = 0;
+            m_costFrames = 0;
+        }
+    }
+}
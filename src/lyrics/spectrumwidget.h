@@ -0,0 +1,30 @@
+#ifndef SPECTRUMWIDGET_H
+#define SPECTRUMWIDGET_H
+
+#include <QWidget>
+#include <QVector>
+
+// 频谱柱状图，只负责绘制；数据由 SpectrumAnalyzer 按帧率推送
+class SpectrumWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SpectrumWidget(QWidget *parent = nullptr);
+
+public slots:
+    void setBands(const QVector<float> &bands);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QVector<float> m_bands;
+
+    // 绘制开销统计（与分析器共用环境变量 XC_SPECTRUM_STATS）
+    bool m_reportStats;
+    qint64 m_costNs = 0;
+    int m_costFrames = 0;
+};
+
+#endif // SPECTRUMWIDGET_H
@@ -10,10 +10,12 @@ extern "C" {
 #endif
 
 #include <QDir>
+#include <QFileInfo>
 #include <QStandardPaths>
-#include <QMediaPlayer>
-#include <QMediaMetaData>
 #include <QDebug>
+#include <QPromise>
+#include <QtConcurrent/QtConcurrentRun>
+#include "../library/tagreader.h"
 
 PlaylistInterface::PlaylistInterface(QObject *parent) : QObject(parent), m_manager(nullptr)
 {
@@ -21,6 +23,9 @@ PlaylistInterface::PlaylistInterface(QObject *parent) : QObject(parent), m_manag
 
 PlaylistInterface::~PlaylistInterface()
 {
+    // 等待后台导入结束，之后投递到本对象的数据块会随对象一起丢弃
+    m_importFuture.cancel();
+    m_importFuture.waitForFinished();
     cleanup();
 }
 
@@ -31,20 +36,74 @@ bool PlaylistInterface::initialize(const QString &dataDir)
     // 确保数据目录存在
     ensureDataDirectory();
     
-    // 初始化C语言管理器
-    m_manager = playlist_manager_init(m_dataDir.toUtf8().constData());
+    // 优先映射二进制快照：不解析 JSON，读取直接走快照，第一次修改时才建立链表
+    if (m_snapshot.open(snapshotPath(), m_dataDir + "/playlists.json")) {
+        m_manager = playlist_manager_create(m_dataDir.toUtf8().constData());
+        m_hydrated = false;
+    } else {
+        // 初始化C语言管理器（从 JSON 加载）
+        m_manager = playlist_manager_init(m_dataDir.toUtf8().constData());
+        m_hydrated = true;
+    }
     
     if (!m_manager) {
         qWarning() << "Failed to initialize playlist manager";
+        m_snapshot.close();
         return false;
     }
     
-    // 加载已保存的歌单
-    loadPlaylists();
+    // 智能歌单定义（文件不存在时为空）
+    m_smart.load(smartPath());
     
     return true;
 }
 
+QString PlaylistInterface::snapshotPath() const
+{
+    return m_dataDir + "/playlists.snapshot";
+}
+
+QString PlaylistInterface::smartPath() const
+{
+    return m_dataDir + "/smart_playlists.json";
+}
+
+void PlaylistInterface::ensureHydrated()
+{
+    if (m_hydrated || !m_manager) {
+        return;
+    }
+    m_hydrated = true;
+
+    // 快照异常时回退到 JSON（load_playlists 会先清空已写入的部分）
+    if (!m_snapshot.hydrate(m_manager)) {
+        qWarning() << "Playlist snapshot hydrate failed, loading JSON";
+        load_playlists(m_manager);
+    }
+    m_snapshot.close();
+}
+
+QString PlaylistInterface::formatSong(const QString &title, const QString &artist, const QString &album,
+                                      const QString &filePath, int duration)
+{
+    return QString("%1|%2|%3|%4|%5").arg(title, artist, album, filePath, QString::number(duration));
+}
+
+QStringList PlaylistInterface::snapshotSongs(int playlist) const
+{
+    QStringList songs;
+    const int count = m_snapshot.songCount(playlist);
+    songs.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        songs.append(formatSong(m_snapshot.songField(playlist, i, PlaylistSnapshot::Title),
+                                m_snapshot.songField(playlist, i, PlaylistSnapshot::Artist),
+                                m_snapshot.songField(playlist, i, PlaylistSnapshot::Album),
+                                m_snapshot.songField(playlist, i, PlaylistSnapshot::FilePath),
+                                m_snapshot.songDuration(playlist, i)));
+    }
+    return songs;
+}
+
 void PlaylistInterface::cleanup()
 {
     if (m_manager) {
@@ -71,6 +130,7 @@ bool PlaylistInterface::addToFavorites(const QString &title, const QString &arti
             return false;
         }
     }
+    ensureHydrated();
     
     // 创建歌曲信息
     SongInfo *song = create_song_info(
@@ -92,6 +152,8 @@ bool PlaylistInterface::addToFavorites(const QString &title, const QString &arti
     // 如果添加失败，释放歌曲信息
     if (!result) {
         free_song_info(song);
+    } else {
+        m_smart.setFavorite(filePath, true);
     }
     
     return result;
@@ -102,8 +164,13 @@ bool PlaylistInterface::removeFromFavorites(const QString &filePath)
     if (!m_manager) {
         return false;
     }
+    ensureHydrated();
     
-    return remove_from_favorites(m_manager, filePath.toUtf8().constData());
+    if (!remove_from_favorites(m_manager, filePath.toUtf8().constData())) {
+        return false;
+    }
+    m_smart.setFavorite(filePath, false);
+    return true;
 }
 
 bool PlaylistInterface::isInFavorites(const QString &filePath)
@@ -111,6 +178,9 @@ bool PlaylistInterface::isInFavorites(const QString &filePath)
     if (!m_manager) {
         return false;
     }
+    if (!m_hydrated) {
+        return m_snapshot.containsPath(0, filePath.toUtf8());
+    }
     
     return is_in_favorites(m_manager, filePath.toUtf8().constData());
 }
@@ -122,6 +192,9 @@ QStringList PlaylistInterface::getFavoritesSongs()
     if (!m_manager) {
         return songs;
     }
+    if (!m_hydrated) {
+        return snapshotSongs(0);
+    }
     
     Playlist *favorites = get_favorites(m_manager);
     if (!favorites || !favorites->head) {
@@ -132,12 +205,12 @@ QStringList PlaylistInterface::getFavoritesSongs()
     struct PlaylistItem *item = favorites->head;
     while (item) {
         if (item->song && item->song->file_path) {
-            QString songInfo = QString("%1|%2|%3|%4|%5")
-                .arg(item->song->title ? QString::fromUtf8(item->song->title) : "")
-                .arg(item->song->artist ? QString::fromUtf8(item->song->artist) : "")
-                .arg(item->song->album ? QString::fromUtf8(item->song->album) : "")
-                .arg(QString::fromUtf8(item->song->file_path))
-                .arg(item->song->duration);
+            QString songInfo = formatSong(
+                item->song->title ? QString::fromUtf8(item->song->title) : "",
+                item->song->artist ? QString::fromUtf8(item->song->artist) : "",
+                item->song->album ? QString::fromUtf8(item->song->album) : "",
+                QString::fromUtf8(item->song->file_path),
+                item->song->duration);
             songs.append(songInfo);
         }
         item = item->next;
@@ -153,6 +226,11 @@ bool PlaylistInterface::createPlaylist(const QString &name)
             return false;
         }
     }
+    ensureHydrated();
+    // 不与智能歌单重名（create_playlist 另外拒绝 favorites 等保留名称）
+    if (m_smart.contains(name)) {
+        return false;
+    }
     
     Playlist *playlist = create_playlist(m_manager, name.toUtf8().constData());
     return playlist != nullptr;
@@ -163,6 +241,10 @@ bool PlaylistInterface::deletePlaylist(const QString &name)
     if (!m_manager) {
         return false;
     }
+    if (m_smart.removeDefinition(name)) {
+        return m_smart.save(smartPath());
+    }
+    ensureHydrated();
     
     return delete_playlist(m_manager, name.toUtf8().constData());
 }
@@ -174,39 +256,41 @@ QStringList PlaylistInterface::getAllPlaylistNames()
     if (!m_manager) {
         return names;
     }
+    // 旧版本可能留下与智能歌单同名的普通歌单，它无法通过名称访问，不再列出
+    if (!m_hydrated) {
+        for (int i = 0; i < m_snapshot.playlistCount(); i++) {
+            const QString name = m_snapshot.playlistName(i);
+            if (!m_smart.contains(name)) {
+                names.append(name);
+            }
+        }
+        return names + m_smart.names();
+    }
     
     int count = 0;
     char **c_names = get_all_playlist_names(m_manager, &count);
     
     if (c_names && count > 0) {
         for (int i = 0; i < count; i++) {
-            if (c_names[i]) {
+            if (c_names[i] && !m_smart.contains(QString::fromUtf8(c_names[i]))) {
                 names.append(QString::fromUtf8(c_names[i]));
             }
         }
         free_playlist_names(c_names, count);
     }
     
-    return names;
+    // 智能歌单排在普通歌单之后
+    return names + m_smart.names();
 }
 
 bool PlaylistInterface::addToPlaylist(const QString &playlistName, const QString &title, const QString &artist,
                                     const QString &album, const QString &filePath, const QString &coverPath,
                                     const QString &lrcPath, int duration)
 {
-    if (!m_manager) {
-        if (!initialize()) {
-            return false;
-        }
-    }
-    
-    // 获取或创建歌单
-    Playlist *playlist = get_playlist(m_manager, playlistName.toUtf8().constData());
+    // 获取或创建歌单（favorites 指收藏夹，智能歌单不能手动添加）
+    Playlist *playlist = ensurePlaylist(playlistName);
     if (!playlist) {
-        playlist = create_playlist(m_manager, playlistName.toUtf8().constData());
-        if (!playlist) {
-            return false;
-        }
+        return false;
     }
     
     // 创建歌曲信息
@@ -230,6 +314,9 @@ bool PlaylistInterface::addToPlaylist(const QString &playlistName, const QString
     if (!result) {
         free_song_info(song);
     } else {
+        if (playlist == get_favorites(m_manager)) {
+            setFavoriteFlags(QStringList{filePath}, true);
+        }
         // 保存歌单
         savePlaylists();
     }
@@ -242,6 +329,7 @@ bool PlaylistInterface::removeFromPlaylist(const QString &playlistName, const QS
     if (!m_manager) {
         return false;
     }
+    ensureHydrated();
     
     Playlist *playlist = get_playlist(m_manager, playlistName.toUtf8().constData());
     if (!playlist) {
@@ -265,6 +353,18 @@ QStringList PlaylistInterface::getPlaylistSongs(const QString &playlistName)
     if (!m_manager) {
         return songs;
     }
+    if (m_smart.contains(playlistName)) {
+        const QVector<SmartTrack> tracks = m_smart.songs(playlistName);
+        songs.reserve(tracks.size());
+        for (const SmartTrack &track : tracks) {
+            songs.append(formatSong(track.title, track.artist, track.album, track.filePath, track.duration));
+        }
+        return songs;
+    }
+    if (!m_hydrated) {
+        const int index = m_snapshot.indexOf(playlistName);
+        return index > 0 ? snapshotSongs(index) : songs;
+    }
     
     Playlist *playlist = get_playlist(m_manager, playlistName.toUtf8().constData());
     if (!playlist || !playlist->head) {
@@ -275,12 +375,12 @@ QStringList PlaylistInterface::getPlaylistSongs(const QString &playlistName)
     struct PlaylistItem *item = playlist->head;
     while (item) {
         if (item->song && item->song->file_path) {
-            QString songInfo = QString("%1|%2|%3|%4|%5")
-                .arg(item->song->title ? QString::fromUtf8(item->song->title) : "")
-                .arg(item->song->artist ? QString::fromUtf8(item->song->artist) : "")
-                .arg(item->song->album ? QString::fromUtf8(item->song->album) : "")
-                .arg(QString::fromUtf8(item->song->file_path))
-                .arg(item->song->duration);
+            QString songInfo = formatSong(
+                item->song->title ? QString::fromUtf8(item->song->title) : "",
+                item->song->artist ? QString::fromUtf8(item->song->artist) : "",
+                item->song->album ? QString::fromUtf8(item->song->album) : "",
+                QString::fromUtf8(item->song->file_path),
+                item->song->duration);
             songs.append(songInfo);
         }
         item = item->next;
@@ -289,13 +389,159 @@ QStringList PlaylistInterface::getPlaylistSongs(const QString &playlistName)
     return songs;
 }
 
+int PlaylistInterface::addSongsToPlaylist(const QString &playlistName, const QStringList &filePaths, int position)
+{
+    if (filePaths.isEmpty()) {
+        return 0;
+    }
+    Playlist *playlist = ensurePlaylist(playlistName);
+    if (!playlist) {
+        return 0;
+    }
+
+    QVector<SongInfo *> songs;
+    songs.reserve(filePaths.size());
+    for (const QString &filePath : filePaths) {
+        const QString title = QFileInfo(filePath).completeBaseName();
+        songs.append(create_song_info(title.toUtf8().constData(), "", "",
+                                      filePath.toUtf8().constData(), "", "", 0));
+    }
+
+    // 歌曲的所有权交给 C 层，重复的由它释放
+    const int added = insert_songs_into_playlist(playlist, position, songs.data(), int(songs.size()));
+    if (added > 0) {
+        if (playlist == get_favorites(m_manager)) {
+            setFavoriteFlags(filePaths, true);
+        }
+        savePlaylists();
+    }
+    return added;
+}
+
+int PlaylistInterface::removeSongsFromPlaylist(const QString &playlistName, const QStringList &filePaths)
+{
+    Playlist *playlist = findPlaylist(playlistName);
+    if (!playlist || filePaths.isEmpty()) {
+        return 0;
+    }
+
+    QVector<QByteArray> utf8;
+    QVector<const char *> paths;
+    utf8.reserve(filePaths.size());
+    paths.reserve(filePaths.size());
+    for (const QString &filePath : filePaths) {
+        utf8.append(filePath.toUtf8());
+        paths.append(utf8.constLast().constData());
+    }
+
+    const int removed = remove_songs_from_playlist(playlist, paths.constData(), int(paths.size()));
+    if (removed > 0) {
+        if (playlist == get_favorites(m_manager)) {
+            setFavoriteFlags(filePaths, false);
+        }
+        savePlaylists();
+    }
+    return removed;
+}
+
+bool PlaylistInterface::createSmartPlaylist(const SmartPlaylistDefinition &definition)
+{
+    if (!m_manager || definition.name == "favorites") {
+        return false;
+    }
+    // 不与普通歌单重名
+    if (m_hydrated ? get_playlist(m_manager, definition.name.toUtf8().constData()) != nullptr
+                   : m_snapshot.indexOf(definition.name) > 0) {
+        return false;
+    }
+    if (!m_smart.addDefinition(definition)) {
+        return false;
+    }
+    return m_smart.save(smartPath());
+}
+
+bool PlaylistInterface::isSmartPlaylist(const QString &name) const
+{
+    return m_smart.contains(name);
+}
+
+void PlaylistInterface::setSmartTracks(QVector<SmartTrack> tracks)
+{
+    // 收藏状态由歌单管理器提供
+    QSet<QString> favorites;
+    if (m_manager && m_hydrated) {
+        favorites = playlistPaths(get_favorites(m_manager));
+    } else if (m_manager) {
+        for (int i = 0; i < m_snapshot.songCount(0); i++) {
+            favorites.insert(m_snapshot.songField(0, i, PlaylistSnapshot::FilePath));
+        }
+    }
+    for (SmartTrack &track : tracks) {
+        track.favorite = favorites.contains(track.filePath);
+    }
+    m_smart.setTracks(tracks);
+}
+
+void PlaylistInterface::updateSmartTrack(const SmartTrack &track)
+{
+    SmartTrack updated = track;
+    updated.favorite = isInFavorites(track.filePath);
+    m_smart.upsertTrack(updated);
+}
+
+void PlaylistInterface::removeSmartTrack(const QString &filePath)
+{
+    m_smart.removeTrack(filePath);
+}
+
+void PlaylistInterface::recordSmartPlay(const QString &filePath)
+{
+    m_smart.trackPlayed(filePath);
+}
+
+void PlaylistInterface::setFavoriteFlags(const QStringList &filePaths, bool favorite)
+{
+    for (const QString &filePath : filePaths) {
+        m_smart.setFavorite(filePath, favorite);
+    }
+}
+
+bool PlaylistInterface::moveSongs(const QString &playlistName, int from, int count, int to)
+{
+    Playlist *playlist = findPlaylist(playlistName);
+    if (!playlist || !move_playlist_range(playlist, from, count, to)) {
+        return false;
+    }
+    return savePlaylists();
+}
+
+bool PlaylistInterface::reorderPlaylist(const QString &playlistName, const QVector<int> &order)
+{
+    Playlist *playlist = findPlaylist(playlistName);
+    if (!playlist || !reorder_playlist(playlist, order.constData(), int(order.size()))) {
+        return false;
+    }
+    return savePlaylists();
+}
+
 bool PlaylistInterface::savePlaylists()
 {
     if (!m_manager) {
         return false;
     }
+    // 仍在使用快照说明内容没有被修改过，无需重写
+    if (!m_hydrated) {
+        return true;
+    }
     
-    return save_playlists(m_manager);
+    if (!save_playlists(m_manager)) {
+        return false;
+    }
+    // 快照写失败不影响 JSON，下次启动回退到 JSON 即可
+    if (!PlaylistSnapshot::write(snapshotPath(), m_manager)) {
+        qWarning() << "Failed to write playlist snapshot";
+    }
+    return true;
 }
 
 bool PlaylistInterface::loadPlaylists()
@@ -304,24 +550,284 @@ bool PlaylistInterface::loadPlaylists()
         return false;
     }
     
+    // 显式重新加载时以 JSON 为准
+    m_hydrated = true;
+    m_snapshot.close();
     return load_playlists(m_manager);
 }
 
-bool PlaylistInterface::addCurrentSongToFavorites(const QString &filePath, QMediaPlayer *player)
+bool PlaylistInterface::addCurrentSongToFavorites(const QString &filePath, int duration)
 {
-    QString title, artist, album;
-    int duration = 0;
-    
-    // 简化实现，暂时跳过元数据获取
-    // 在实际使用时，可以根据具体Qt版本的API调整元数据获取方式
-    if (player) {
-        duration = player->duration() / 1000;  // 只获取时长
+    TrackMetadata meta = TagReader::read(filePath);
+    if (duration <= 0) {
+        duration = int(meta.durationMs / 1000);
     }
-    
-    // 使用文件名作为标题
-    QFileInfo fileInfo(filePath);
-    title = fileInfo.baseName();
-    
+
+    // 没有标题标签时使用文件名作为标题
+    QString title = meta.title;
+    if (title.isEmpty()) {
+        title = QFileInfo(filePath).baseName();
+    }
+
     // 添加到收藏夹
-    return addToFavorites(title, artist, album, filePath, "", "", duration);
-}
\ No newline at end of file
+    return addToFavorites(title, meta.artist, meta.album, filePath, "", "", duration);
+}
+
+Playlist *PlaylistInterface::findPlaylist(const QString &name)
+{
+    if (!m_manager) {
+        return nullptr;
+    }
+    ensureHydrated();
+
+    // getAllPlaylistNames 中收藏夹的名称为 favorites
+    if (name == "favorites") {
+        return get_favorites(m_manager);
+    }
+    return get_playlist(m_manager, name.toUtf8().constData());
+}
+
+Playlist *PlaylistInterface::ensurePlaylist(const QString &name)
+{
+    if (!m_manager) {
+        if (!initialize()) {
+            return nullptr;
+        }
+    }
+
+    // 智能歌单的内容由规则决定；若在这里建同名普通歌单，它既列不出来也读不到
+    if (m_smart.contains(name)) {
+        qWarning() << "Cannot add songs to smart playlist" << name;
+        return nullptr;
+    }
+
+    Playlist *playlist = findPlaylist(name);
+    if (!playlist) {
+        playlist = create_playlist(m_manager, name.toUtf8().constData());
+    }
+    return playlist;
+}
+
+QSet<QString> PlaylistInterface::playlistPaths(const Playlist *playlist)
+{
+    QSet<QString> paths;
+    paths.reserve(playlist->count);
+    for (const PlaylistItem *item = playlist->head; item; item = item->next) {
+        if (item->song && item->song->file_path) {
+            paths.insert(QString::fromUtf8(item->song->file_path));
+        }
+    }
+    return paths;
+}
+
+void PlaylistInterface::appendEntries(Playlist *playlist, const QVector<PlaylistEntry> &entries,
+                                      QSet<QString> &seen, PlaylistImportResult &result)
+{
+    for (const PlaylistEntry &entry : entries) {
+        if (!entry.exists) {
+            ++result.missing;
+            continue;
+        }
+        // 用哈希集合去重，整个导入只需线性时间
+        if (seen.contains(entry.filePath)) {
+            ++result.duplicates;
+            continue;
+        }
+        seen.insert(entry.filePath);
+
+        QString title = entry.title.isEmpty() ? QFileInfo(entry.filePath).completeBaseName() : entry.title;
+        SongInfo *song = create_song_info(
+            title.toUtf8().constData(),
+            entry.artist.toUtf8().constData(),
+            "",
+            entry.filePath.toUtf8().constData(),
+            "",
+            "",
+            entry.duration
+        );
+        if (song && append_to_playlist(playlist, song)) {
+            ++result.added;
+        } else if (song) {
+            free_song_info(song);
+        }
+    }
+}
+
+bool PlaylistInterface::importPlaylist(const QString &playlistName, const QString &filePath,
+                                       PlaylistImportResult *result)
+{
+    PlaylistImportResult local;
+    PlaylistImportResult &stats = result ? *result : local;
+    stats = PlaylistImportResult();
+
+    Playlist *playlist = ensurePlaylist(playlistName);
+    if (!playlist) {
+        return false;
+    }
+
+    const PlaylistIO::Format format = PlaylistIO::formatForFile(filePath);
+    bool ok;
+    if (format == PlaylistIO::M3U || format == PlaylistIO::PLS) {
+        QSet<QString> seen = playlistPaths(playlist);
+        ok = PlaylistIO::read(filePath, [&](QVector<PlaylistEntry> &chunk) {
+            appendEntries(playlist, chunk, seen, stats);
+            return true;
+        });
+    } else {
+        const int before = playlist->count;
+        ok = import_playlist_file(playlist, filePath.toUtf8().constData());
+        stats.added = playlist->count - before;
+    }
+
+    if (!ok) {
+        return false;
+    }
+    return savePlaylists();
+}
+
+bool PlaylistInterface::importPlaylistAsync(const QString &playlistName, const QString &filePath)
+{
+    if (isImporting()) {
+        return false;
+    }
+
+    const PlaylistIO::Format format = PlaylistIO::formatForFile(filePath);
+    if (format != PlaylistIO::M3U && format != PlaylistIO::PLS) {
+        // JSON 歌单由本程序导出，规模小，直接同步导入
+        PlaylistImportResult result;
+        const bool ok = importPlaylist(playlistName, filePath, &result);
+        emit importFinished(playlistName, ok, result.added, result.missing);
+        return ok;
+    }
+
+    Playlist *playlist = ensurePlaylist(playlistName);
+    if (!playlist) {
+        return false;
+    }
+
+    m_importName = playlistName;
+    m_importSeen = playlistPaths(playlist);
+    m_importResult = PlaylistImportResult();
+
+    m_importFuture = QtConcurrent::run([this, filePath](QPromise<void> &promise) {
+        const bool ok = PlaylistIO::read(filePath, [this, &promise](QVector<PlaylistEntry> &chunk) {
+            if (promise.isCanceled()) {
+                return false;
+            }
+            // C 链表不是线程安全的，写入放回本对象所在线程
+            QMetaObject::invokeMethod(this, [this, entries = std::move(chunk)] {
+                appendImportChunk(entries);
+            }, Qt::QueuedConnection);
+            return true;
+        });
+        if (!promise.isCanceled()) {
+            QMetaObject::invokeMethod(this, [this, ok] { finishImport(ok); }, Qt::QueuedConnection);
+        }
+    });
+    return true;
+}
+
+bool PlaylistInterface::isImporting() const
+{
+    return m_importFuture.isRunning() || !m_importName.isEmpty();
+}
+
+void PlaylistInterface::appendImportChunk(const QVector<PlaylistEntry> &entries)
+{
+    // 导入期间歌单可能被删除，每块重新查找
+    Playlist *playlist = findPlaylist(m_importName);
+    if (!playlist) {
+        return;
+    }
+    appendEntries(playlist, entries, m_importSeen, m_importResult);
+    emit importProgress(m_importName, m_importResult.added);
+}
+
+void PlaylistInterface::finishImport(bool ok)
+{
+    const QString name = m_importName;
+    const PlaylistImportResult result = m_importResult;
+    m_importName.clear();
+    m_importSeen.clear();
+
+    // 整个导入只保存一次
+    if (ok) {
+        ok = savePlaylists();
+    }
+    emit importFinished(name, ok, result.added, result.missing);
+}
+
+bool PlaylistInterface::exportPlaylist(const QString &playlistName, const QString &filePath)
+{
+    if (m_smart.contains(playlistName)) {
+        return exportSmartPlaylist(playlistName, filePath);
+    }
+
+    Playlist *playlist = findPlaylist(playlistName);
+    if (!playlist) {
+        return false;
+    }
+
+    const PlaylistIO::Format format = PlaylistIO::formatForFile(filePath);
+    if (format != PlaylistIO::M3U && format != PlaylistIO::PLS) {
+        return export_playlist_file(playlist, filePath.toUtf8().constData());
+    }
+
+    // 逐首写出，不在内存中拼出整个文件
+    PlaylistIO::Writer writer(filePath, format);
+    if (!writer.open()) {
+        return false;
+    }
+    for (const PlaylistItem *item = playlist->head; item; item = item->next) {
+        if (!item->song || !item->song->file_path) {
+            continue;
+        }
+        PlaylistEntry entry;
+        entry.filePath = QString::fromUtf8(item->song->file_path);
+        entry.title = item->song->title ? QString::fromUtf8(item->song->title) : QString();
+        entry.artist = item->song->artist ? QString::fromUtf8(item->song->artist) : QString();
+        entry.duration = item->song->duration;
+        writer.add(entry);
+    }
+    return writer.finish();
+}
+
+bool PlaylistInterface::exportSmartPlaylist(const QString &playlistName, const QString &filePath) const
+{
+    // 智能歌单没有对应的 C 歌单，写出规则当前匹配的歌曲
+    const QVector<SmartTrack> tracks = m_smart.songs(playlistName);
+    const PlaylistIO::Format format = PlaylistIO::formatForFile(filePath);
+    if (format == PlaylistIO::M3U || format == PlaylistIO::PLS) {
+        PlaylistIO::Writer writer(filePath, format);
+        if (!writer.open()) {
+            return false;
+        }
+        for (const SmartTrack &track : tracks) {
+            PlaylistEntry entry;
+            entry.filePath = track.filePath;
+            entry.title = track.title;
+            entry.artist = track.artist;
+            entry.duration = track.duration;
+            writer.add(entry);
+        }
+        return writer.finish();
+    }
+
+    // JSON 与普通歌单同一格式：临时拼出一个不属于管理器的歌单交给 export_playlist_file，写完逐首释放
+    QByteArray name = playlistName.toUtf8();
+    Playlist playlist = {};
+    playlist.name = name.data();
+    for (const SmartTrack &track : tracks) {
+        SongInfo *song = create_song_info(track.title.toUtf8().constData(), track.artist.toUtf8().constData(),
+                                          track.album.toUtf8().constData(), track.filePath.toUtf8().constData(),
+                                          "", "", track.duration);
+        if (song && !append_to_playlist(&playlist, song)) {
+            free_song_info(song);
+        }
+    }
+    const bool ok = export_playlist_file(&playlist, filePath.toUtf8().constData());
+    while (playlist.head) {
+        remove_from_playlist(&playlist, playlist.head->song->file_path);
+    }
+    return ok;
+}
@@ -3,11 +3,24 @@
 
 #include <QString>
 #include <QStringList>
-#include <QMediaPlayer>
-#include <QMediaMetaData>
+#include <QObject>
+#include <QFuture>
+#include <QSet>
+#include <QVector>
 
 // 包含完整的playlist_manager头文件而不是前向声明
 #include "playlist_manager.h"
+#include "playlist_io.h"
+#include "playlist_snapshot.h"
+#include "smartplaylist.h"
+
+// 外部歌单导入统计
+struct PlaylistImportResult
+{
+    int added = 0;       // 新加入的歌曲
+    int duplicates = 0;  // 已在歌单中的歌曲
+    int missing = 0;     // 本地文件不存在，未导入
+};
 
 // Qt接口类，封装C语言实现的播放列表管理功能
 class PlaylistInterface : public QObject
@@ -32,6 +45,7 @@ public:
     QStringList getFavoritesSongs();
 
     // 歌单相关操作
+    // 与已有歌单、智能歌单或保留名称（favorites、playlists、smart_playlists）重名时返回 false
     bool createPlaylist(const QString &name);
     bool deletePlaylist(const QString &name);
     QStringList getAllPlaylistNames();
@@ -41,19 +55,77 @@ public:
     bool removeFromPlaylist(const QString &playlistName, const QString &filePath);
     QStringList getPlaylistSongs(const QString &playlistName);
 
+    // 批量操作：整批用哈希去重一次、保存一次；playlistName 为 favorites 时操作收藏夹
+    // 只给出路径时以文件名作为标题；position 为 -1 时追加到末尾；返回实际加入/移除的数量
+    int addSongsToPlaylist(const QString &playlistName, const QStringList &filePaths, int position = -1);
+    int removeSongsFromPlaylist(const QString &playlistName, const QStringList &filePaths);
+    bool moveSongs(const QString &playlistName, int from, int count, int to);
+    bool reorderPlaylist(const QString &playlistName, const QVector<int> &order);
+
+    // 智能歌单：只保存规则定义（smart_playlists.json），名称出现在 getAllPlaylistNames 中，
+    // 歌曲同样通过 getPlaylistSongs 读取。曲库内容由 setSmartTracks 提供，之后按变化增量维护
+    bool createSmartPlaylist(const SmartPlaylistDefinition &definition);
+    bool isSmartPlaylist(const QString &name) const;
+    void setSmartTracks(QVector<SmartTrack> tracks);
+    void updateSmartTrack(const SmartTrack &track);
+    void removeSmartTrack(const QString &filePath);
+    void recordSmartPlay(const QString &filePath);
+
     // 保存和加载
     bool savePlaylists();
     bool loadPlaylists();
 
-    // 从QMediaPlayer获取当前歌曲信息并添加到收藏夹
-    bool addCurrentSongToFavorites(const QString &filePath, class QMediaPlayer *player = nullptr);
+    // 读取文件标签并添加到收藏夹（duration 为秒，0 时使用标签中的时长）
+    bool addCurrentSongToFavorites(const QString &filePath, int duration = 0);
+
+    // 单个歌单的导入导出，按扩展名选择格式：.m3u/.m3u8/.pls，其余按 JSON 处理
+    // 导入时追加到已有歌单（不存在则创建），重复和不存在的文件会被跳过；智能歌单导出当前匹配的歌曲
+    bool importPlaylist(const QString &playlistName, const QString &filePath,
+                        PlaylistImportResult *result = nullptr);
+    bool exportPlaylist(const QString &playlistName, const QString &filePath);
+
+    // 后台导入：解析和路径检查在工作线程进行，每块结果回到本对象所在线程写入歌单，
+    // 完成后保存一次并发出 importFinished。同一时间只能有一个导入任务
+    bool importPlaylistAsync(const QString &playlistName, const QString &filePath);
+    bool isImporting() const;
+
+signals:
+    void importProgress(const QString &playlistName, int added);
+    void importFinished(const QString &playlistName, bool ok, int added, int missing);
 
 private:
     PlaylistManager *m_manager;  // C语言实现的管理器
     QString m_dataDir;           // 数据保存目录
 
+    // 启动时映射的二进制快照；m_hydrated 为 false 时读取走快照，链表尚未建立
+    PlaylistSnapshot m_snapshot;
+    bool m_hydrated = true;
+
+    SmartPlaylistEngine m_smart;
+
+    // 后台导入状态
+    QFuture<void> m_importFuture;
+    QString m_importName;
+    QSet<QString> m_importSeen;
+    PlaylistImportResult m_importResult;
+
     // 辅助方法
     void ensureDataDirectory();
+    QString snapshotPath() const;
+    QString smartPath() const;
+    void setFavoriteFlags(const QStringList &filePaths, bool favorite);
+    bool exportSmartPlaylist(const QString &playlistName, const QString &filePath) const;
+    void ensureHydrated();
+    static QString formatSong(const QString &title, const QString &artist, const QString &album,
+                              const QString &filePath, int duration);
+    QStringList snapshotSongs(int playlist) const;
+    Playlist *findPlaylist(const QString &name);
+    Playlist *ensurePlaylist(const QString &name);
+    static QSet<QString> playlistPaths(const Playlist *playlist);
+    static void appendEntries(Playlist *playlist, const QVector<PlaylistEntry> &entries,
+                              QSet<QString> &seen, PlaylistImportResult &result);
+    void appendImportChunk(const QVector<PlaylistEntry> &entries);
+    void finishImport(bool ok);
 };
 
 #endif // PLAYLIST_INTERFACE_H
\ No newline at end of file
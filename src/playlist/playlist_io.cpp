@@ -0,0 +1,242 @@
+#include "playlist_io.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QUrl>
+#include <QtConcurrent/QtConcurrentMap>
+
+namespace {
+const int WriteBufferSize = 64 * 1024;
+
+// .m3u8 固定为 UTF-8；.m3u/.pls 先按 UTF-8 解码，不合法时按本地编码处理
+QString decodeLine(const QByteArray &line, bool forceUtf8)
+{
+    if (forceUtf8 || line.isValidUtf8())
+        return QString::fromUtf8(line);
+    return QString::fromLocal8Bit(line);
+}
+
+// #EXTINF:时长[ 属性...],艺术家 - 标题
+void parseExtInf(QStringView info, PlaylistEntry &entry)
+{
+    int comma = -1;
+    bool quoted = false;
+    for (int i = 0; i < info.size(); ++i) {
+        if (info[i] == '"')
+            quoted = !quoted;
+        else if (info[i] == ',' && !quoted) {
+            comma = i;
+            break;
+        }
+    }
+
+    QStringView durationText = comma >= 0 ? info.left(comma) : info;
+    const int space = durationText.indexOf(' ');
+    if (space >= 0)
+        durationText = durationText.left(space);
+    entry.duration = qMax(0, durationText.toInt());
+
+    if (comma < 0)
+        return;
+    const QString text = info.mid(comma + 1).trimmed().toString();
+    const int separator = text.indexOf(" - ");
+    if (separator > 0) {
+        entry.artist = text.left(separator).trimmed();
+        entry.title = text.mid(separator + 3).trimmed();
+    } else {
+        entry.title = text;
+    }
+}
+
+// PLS 键名：File1、Title1、Length1 ...
+bool splitPlsKey(QStringView key, QStringView &name, int &index)
+{
+    int digits = key.size();
+    while (digits > 0 && key[digits - 1].isDigit())
+        --digits;
+    if (digits == key.size() || digits == 0)
+        return false;
+    name = key.left(digits);
+    index = key.mid(digits).toInt();
+    return true;
+}
+
+// 解析相对路径、file:// 地址和 Windows 分隔符，并检查本地文件是否存在
+void resolveEntry(PlaylistEntry &entry, const QString &baseDir)
+{
+    QString path = entry.filePath;
+    if (path.startsWith("file://", Qt::CaseInsensitive)) {
+        path = QUrl(path).toLocalFile();
+    } else if (path.contains("://")) {
+        entry.exists = true;    // 网络地址不做检查
+        return;
+    }
+
+    path.replace('\\', '/');
+    if (QDir::isRelativePath(path))
+        path = baseDir + "/" + path;
+    entry.filePath = QDir::cleanPath(path);
+    entry.exists = QFileInfo::exists(entry.filePath);
+}
+}
+
+PlaylistIO::Format PlaylistIO::formatForFile(const QString &filePath)
+{
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix == "m3u" || suffix == "m3u8")
+        return M3U;
+    if (suffix == "pls")
+        return PLS;
+    if (suffix == "json")
+        return Json;
+    return Unknown;
+}
+
+bool PlaylistIO::read(const QString &filePath, const ChunkSink &sink, int chunkSize)
+{
+    const Format format = formatForFile(filePath);
+    if (format != M3U && format != PLS)
+        return false;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const QString baseDir = QFileInfo(filePath).absolutePath();
+    const bool forceUtf8 = filePath.endsWith(".m3u8", Qt::CaseInsensitive);
+
+    QVector<PlaylistEntry> chunk;
+    chunk.reserve(chunkSize);
+    QHash<int, int> plsIndex;   // PLS 序号 -> 块内位置
+    PlaylistEntry pending;      // M3U 中 #EXTINF 之后等待路径行的记录
+
+    // 整块并行解析路径后交给调用方
+    auto flush = [&]() {
+        if (chunk.isEmpty())
+            return true;
+        QtConcurrent::blockingMap(chunk, [&baseDir](PlaylistEntry &entry) {
+            resolveEntry(entry, baseDir);
+        });
+        const bool more = sink(chunk);
+        chunk.clear();
+        plsIndex.clear();
+        return more;
+    };
+
+    bool firstLine = true;
+    while (!file.atEnd()) {
+        QByteArray raw = file.readLine();
+        if (firstLine) {
+            if (raw.startsWith("\xEF\xBB\xBF"))
+                raw.remove(0, 3);
+            firstLine = false;
+        }
+        raw = raw.trimmed();
+        if (raw.isEmpty())
+            continue;
+        const QString line = decodeLine(raw, forceUtf8);
+
+        if (format == M3U) {
+            if (line.startsWith('#')) {
+                if (line.startsWith("#EXTINF:", Qt::CaseInsensitive))
+                    parseExtInf(QStringView(line).mid(8), pending);
+                continue;
+            }
+            if (chunk.size() >= chunkSize && !flush())
+                return true;
+            pending.filePath = line;
+            chunk.append(std::move(pending));
+            pending = PlaylistEntry();
+            continue;
+        }
+
+        // PLS：同一序号的 Title/Length 通常紧跟在 File 之后，只在当前块内查找
+        const int eq = line.indexOf('=');
+        QStringView name;
+        int index = 0;
+        if (eq <= 0 || !splitPlsKey(QStringView(line).left(eq).trimmed(), name, index))
+            continue;
+        const QString value = line.mid(eq + 1).trimmed();
+        if (name.compare(QLatin1String("File"), Qt::CaseInsensitive) == 0) {
+            if (chunk.size() >= chunkSize && !flush())
+                return true;
+            PlaylistEntry entry;
+            entry.filePath = value;
+            plsIndex.insert(index, chunk.size());
+            chunk.append(std::move(entry));
+            continue;
+        }
+        auto it = plsIndex.constFind(index);
+        if (it == plsIndex.constEnd())
+            continue;
+        if (name.compare(QLatin1String("Title"), Qt::CaseInsensitive) == 0)
+            chunk[it.value()].title = value;
+        else if (name.compare(QLatin1String("Length"), Qt::CaseInsensitive) == 0)
+            chunk[it.value()].duration = qMax(0, value.toInt());
+    }
+
+    flush();
+    return true;
+}
+
+PlaylistIO::Writer::Writer(const QString &filePath, Format format)
+    : m_file(filePath), m_format(format), m_baseDir(QFileInfo(filePath).absolutePath() + "/")
+{
+}
+
+bool PlaylistIO::Writer::open()
+{
+    if (m_format != M3U && m_format != PLS)
+        return false;
+    if (!m_file.open(QIODevice::WriteOnly))
+        return false;
+    m_buffer.reserve(WriteBufferSize + 1024);
+    m_buffer.append(m_format == M3U ? "#EXTM3U\n" : "[playlist]\n");
+    return true;
+}
+
+void PlaylistIO::Writer::add(const PlaylistEntry &entry)
+{
+    // 与歌单文件同目录（或子目录）的歌曲写相对路径，便于整个目录一起拷贝
+    QString path = entry.filePath;
+    if (path.startsWith(m_baseDir))
+        path = path.mid(m_baseDir.size());
+
+    QString title = entry.title.isEmpty() ? QFileInfo(entry.filePath).completeBaseName() : entry.title;
+    if (!entry.artist.isEmpty())
+        title = entry.artist + " - " + title;
+
+    ++m_count;
+    if (m_format == M3U) {
+        m_buffer.append("#EXTINF:" + QByteArray::number(entry.duration > 0 ? entry.duration : -1) + ",");
+        m_buffer.append(title.toUtf8());
+        m_buffer.append('\n');
+        m_buffer.append(path.toUtf8());
+        m_buffer.append('\n');
+    } else {
+        const QByteArray n = QByteArray::number(m_count);
+        m_buffer.append("File" + n + "=" + path.toUtf8() + "\n");
+        m_buffer.append("Title" + n + "=" + title.toUtf8() + "\n");
+        m_buffer.append("Length" + n + "=" + QByteArray::number(entry.duration > 0 ? entry.duration : -1) + "\n");
+    }
+
+    if (m_buffer.size() >= WriteBufferSize)
+        flushBuffer();
+}
+
+void PlaylistIO::Writer::flushBuffer()
+{
+    m_file.write(m_buffer);
+    m_buffer.resize(0);     // 保留容量
+}
+
+bool PlaylistIO::Writer::finish()
+{
+    if (m_format == PLS) {
+        m_buffer.append("NumberOfEntries=" + QByteArray::number(m_count) + "\n");
+        m_buffer.append("Version=2\n");
+    }
+    flushBuffer();
+    return m_file.commit();
+}
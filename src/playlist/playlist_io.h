@@ -0,0 +1,54 @@
+#ifndef PLAYLIST_IO_H
+#define PLAYLIST_IO_H
+
+#include <QSaveFile>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+// 外部歌单中的一条记录
+struct PlaylistEntry
+{
+    QString filePath;       // 已解析为绝对路径（网络地址保持原样）
+    QString title;
+    QString artist;
+    int duration = 0;       // 秒，未知时为 0
+    bool exists = true;     // 本地文件是否存在
+};
+
+// M3U/M3U8/PLS 歌单读写
+// 读取按块进行：每读满一块就并行解析相对路径并检查文件是否存在，然后交给调用方，
+// 不会把整份文件或全部行读入内存。
+class PlaylistIO
+{
+public:
+    enum Format { Unknown, M3U, PLS, Json };
+
+    // 按扩展名判断格式（.m3u/.m3u8/.pls/.json）
+    static Format formatForFile(const QString &filePath);
+
+    // sink 每次收到一块记录，返回 false 时停止读取
+    using ChunkSink = std::function<bool(QVector<PlaylistEntry> &chunk)>;
+    static bool read(const QString &filePath, const ChunkSink &sink, int chunkSize = 2048);
+
+    // 流式写出，歌单文件所在目录下的歌曲写成相对路径
+    class Writer
+    {
+    public:
+        Writer(const QString &filePath, Format format);
+        bool open();
+        void add(const PlaylistEntry &entry);
+        bool finish();
+
+    private:
+        void flushBuffer();
+
+        QSaveFile m_file;
+        Format m_format;
+        QString m_baseDir;
+        QByteArray m_buffer;
+        int m_count = 0;
+    };
+};
+
+#endif // PLAYLIST_IO_H
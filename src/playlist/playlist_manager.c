@@ -1,10 +1,16 @@
 #include "playlist_manager.h"
-#include <direct.h>
 #include <errno.h>
+#ifdef _WIN32
+#include <direct.h>
+#define make_directory(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define make_directory(path) mkdir(path, 0755)
+#endif
 
 // 确保目录存在
 static bool ensure_directory(const char *dir_path) {
-    if (_mkdir(dir_path) == 0) {
+    if (make_directory(dir_path) == 0) {
         return true;  // 成功创建目录
     }
     if (errno == EEXIST) {
@@ -13,6 +19,18 @@ static bool ensure_directory(const char *dir_path) {
     return false;  // 创建失败
 }
 
+static void playlist_file_path(const PlaylistManager *manager, const char *name, char *out, size_t size);
+static bool legacy_playlist_file_path(const PlaylistManager *manager, const char *name, char *out, size_t size);
+
+// favorites.json、playlists.json 等固定文件占用的名称，不能用作歌单名
+static bool is_reserved_playlist_name(const char *name) {
+    static const char *reserved[] = { "favorites", "playlists", "smart_playlists" };
+    for (size_t i = 0; i < sizeof(reserved) / sizeof(reserved[0]); i++) {
+        if (strcmp(name, reserved[i]) == 0) return true;
+    }
+    return false;
+}
+
 // 初始化歌单项
 static PlaylistItem *create_playlist_item(SongInfo *song) {
     PlaylistItem *item = (PlaylistItem *)malloc(sizeof(PlaylistItem));
@@ -34,12 +52,24 @@ static Playlist *create_playlist_structure(const char *name) {
     playlist->head = NULL;
     playlist->tail = NULL;
     playlist->count = 0;
+    playlist->next = NULL;
     
     return playlist;
 }
 
-// 初始化播放列表管理器
+// 初始化播放列表管理器并加载保存的歌单
 PlaylistManager *playlist_manager_init(const char *data_directory) {
+    PlaylistManager *manager = playlist_manager_create(data_directory);
+    if (!manager) return NULL;
+    
+    // 加载保存的歌单
+    load_playlists(manager);
+    
+    return manager;
+}
+
+// 创建空的播放列表管理器（不读取文件，由调用方决定从快照还是 JSON 加载）
+PlaylistManager *playlist_manager_create(const char *data_directory) {
     PlaylistManager *manager = (PlaylistManager *)malloc(sizeof(PlaylistManager));
     if (!manager) return NULL;
     
@@ -64,9 +94,6 @@ PlaylistManager *playlist_manager_init(const char *data_directory) {
     manager->playlists = NULL;
     manager->playlist_count = 0;
     
-    // 加载保存的歌单
-    load_playlists(manager);
-    
     return manager;
 }
 
@@ -233,7 +260,7 @@ Playlist *get_favorites(PlaylistManager *manager) {
 
 // 创建歌单
 Playlist *create_playlist(PlaylistManager *manager, const char *name) {
-    if (!manager || !name) return NULL;
+    if (!manager || !name || !name[0] || is_reserved_playlist_name(name)) return NULL;
     
     // 检查歌单是否已存在
     Playlist *playlist = manager->playlists;
@@ -249,7 +276,7 @@ Playlist *create_playlist(PlaylistManager *manager, const char *name) {
     if (!new_playlist) return NULL;
     
     // 添加到歌单列表
-    new_playlist->next = (PlaylistItem *)manager->playlists;  // 强制转换
+    new_playlist->next = manager->playlists;
     manager->playlists = new_playlist;
     manager->playlist_count++;
     
@@ -288,7 +315,7 @@ bool delete_playlist(PlaylistManager *manager, const char *name) {
             
             // 删除歌单文件
             char filename[1024];
-            snprintf(filename, sizeof(filename), "%s\\%s.json", manager->data_dir, name);
+            playlist_file_path(manager, name, filename, sizeof(filename));
             remove(filename);
             
             return true;
@@ -328,6 +355,13 @@ bool add_to_playlist(Playlist *playlist, SongInfo *song) {
         item = item->next;
     }
     
+    return append_to_playlist(playlist, song);
+}
+
+// 追加到歌单末尾，不做重复检查（批量导入时由调用方一次性去重）
+bool append_to_playlist(Playlist *playlist, SongInfo *song) {
+    if (!playlist || !song || !song->file_path) return false;
+
     // 创建新的歌单项
     PlaylistItem *new_item = create_playlist_item(song);
     if (!new_item) return false;
@@ -380,64 +414,831 @@ bool remove_from_playlist(Playlist *playlist, const char *file_path) {
     return false;
 }
 
+// 路径哈希集合（开放寻址），只保存指针，不复制字符串
+typedef struct {
+    const char **slots;
+    size_t mask;
+    size_t count;
+} PathSet;
+
+static size_t hash_path(const char *text) {
+    // FNV-1a
+    size_t hash = (size_t)14695981039346656037ULL;
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        hash ^= *p;
+        hash *= (size_t)1099511628211ULL;
+    }
+    return hash;
+}
+
+static bool path_set_init(PathSet *set, size_t expected) {
+    size_t capacity = 16;
+    while (capacity < expected * 2) {
+        capacity <<= 1;
+    }
+    set->slots = (const char **)calloc(capacity, sizeof(const char *));
+    set->mask = capacity - 1;
+    set->count = 0;
+    return set->slots != NULL;
+}
+
+// 装载因子超过 1/2 时扩容一倍（事先不知道数量时使用，例如读取歌单文件）
+static bool path_set_grow(PathSet *set) {
+    size_t capacity = (set->mask + 1) * 2;
+    const char **slots = (const char **)calloc(capacity, sizeof(const char *));
+    if (!slots) return false;
+    for (size_t i = 0; i <= set->mask; i++) {
+        if (!set->slots[i]) continue;
+        size_t j = hash_path(set->slots[i]) & (capacity - 1);
+        while (slots[j]) {
+            j = (j + 1) & (capacity - 1);
+        }
+        slots[j] = set->slots[i];
+    }
+    free(set->slots);
+    set->slots = slots;
+    set->mask = capacity - 1;
+    return true;
+}
+
+static void path_set_free(PathSet *set) {
+    free(set->slots);
+    set->slots = NULL;
+}
+
+// 插入成功返回 true，已存在（或已满且无法扩容）返回 false
+static bool path_set_insert(PathSet *set, const char *path) {
+    if ((set->count + 1) * 2 > set->mask + 1 && !path_set_grow(set) && set->count + 1 > set->mask) {
+        return false;
+    }
+    size_t i = hash_path(path) & set->mask;
+    while (set->slots[i]) {
+        if (strcmp(set->slots[i], path) == 0) {
+            return false;
+        }
+        i = (i + 1) & set->mask;
+    }
+    set->slots[i] = path;
+    set->count++;
+    return true;
+}
+
+// 歌单文件名：<data_dir>/playlist-<转义后的名称>.json
+// 字母、数字、'-'、'_' 和非 ASCII 字节（中文等）原样保留，其余字节（'/'、'.'、'\\'、':' 等）写成 %XX，
+// 因此不会与 favorites.json/playlists.json 冲突，也不会落到数据目录之外；过长的名称改用哈希值
+static void playlist_file_path(const PlaylistManager *manager, const char *name, char *out, size_t size) {
+    static const char hex[] = "0123456789ABCDEF";
+    char escaped[256];
+    size_t length = 0;
+    bool too_long = false;  // 多数文件系统限制文件名 255 字节
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++) {
+        if (length + 3 > 200) {
+            too_long = true;
+            break;
+        }
+        if ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9')
+            || *p == '-' || *p == '_' || *p >= 0x80) {
+            escaped[length++] = (char)*p;
+        } else {
+            escaped[length++] = '%';
+            escaped[length++] = hex[*p >> 4];
+            escaped[length++] = hex[*p & 0x0F];
+        }
+    }
+    escaped[length] = '\0';
+    if (too_long) {
+        snprintf(out, size, "%s/playlist-~%016llx.json", manager->data_dir, (unsigned long long)hash_path(name));
+    } else {
+        snprintf(out, size, "%s/playlist-%s.json", manager->data_dir, escaped);
+    }
+}
+
+// 旧版本直接以歌单名作文件名（<data_dir>/<名称>.json），只对不会越出数据目录的名称兼容读取。
+// 旧文件不删除：同一目录下还有 equalizer.json 等其他模块的文件，无法确认它一定是歌单
+static bool legacy_playlist_file_path(const PlaylistManager *manager, const char *name, char *out, size_t size) {
+    if (!name[0] || name[0] == '.' || is_reserved_playlist_name(name) || strpbrk(name, "/\\:")) {
+        return false;
+    }
+    snprintf(out, size, "%s/%s.json", manager->data_dir, name);
+    return true;
+}
+
+static bool path_set_contains(const PathSet *set, const char *path) {
+    size_t i = hash_path(path) & set->mask;
+    while (set->slots[i]) {
+        if (strcmp(set->slots[i], path) == 0) {
+            return true;
+        }
+        i = (i + 1) & set->mask;
+    }
+    return false;
+}
+
+// 按下标取歌单项，从较近的一端开始走
+static PlaylistItem *item_at(const Playlist *playlist, int index) {
+    if (index < 0 || index >= playlist->count) return NULL;
+    PlaylistItem *item;
+    if (index <= playlist->count / 2) {
+        item = playlist->head;
+        while (index-- > 0) item = item->next;
+    } else {
+        item = playlist->tail;
+        for (int i = playlist->count - 1; i > index; i--) item = item->prev;
+    }
+    return item;
+}
+
+// 把 first..last 这段链（已与原链表断开）接到 before 之前，before 为 NULL 时接到末尾
+static void splice_before(Playlist *playlist, PlaylistItem *before, PlaylistItem *first, PlaylistItem *last) {
+    PlaylistItem *after = before ? before->prev : playlist->tail;
+    first->prev = after;
+    last->next = before;
+    if (after) {
+        after->next = first;
+    } else {
+        playlist->head = first;
+    }
+    if (before) {
+        before->prev = last;
+    } else {
+        playlist->tail = last;
+    }
+}
+
+// 批量插入
+int insert_songs_into_playlist(Playlist *playlist, int position, SongInfo **songs, int count) {
+    if (!songs || count <= 0) return 0;
+    if (!playlist) {
+        for (int i = 0; i < count; i++) free_song_info(songs[i]);
+        return 0;
+    }
+
+    PathSet seen;
+    if (!path_set_init(&seen, (size_t)playlist->count + (size_t)count)) {
+        for (int i = 0; i < count; i++) free_song_info(songs[i]);
+        return 0;
+    }
+    for (PlaylistItem *item = playlist->head; item; item = item->next) {
+        if (item->song->file_path) path_set_insert(&seen, item->song->file_path);
+    }
+
+    // 先在旁边串成一段链，最后一次接入
+    PlaylistItem *first = NULL;
+    PlaylistItem *last = NULL;
+    int added = 0;
+    for (int i = 0; i < count; i++) {
+        SongInfo *song = songs[i];
+        PlaylistItem *item = NULL;
+        if (song && song->file_path && path_set_insert(&seen, song->file_path)) {
+            item = create_playlist_item(song);
+        }
+        if (!item) {
+            free_song_info(song);
+            continue;
+        }
+        item->prev = last;
+        if (last) {
+            last->next = item;
+        } else {
+            first = item;
+        }
+        last = item;
+        added++;
+    }
+    path_set_free(&seen);
+
+    if (first) {
+        splice_before(playlist, item_at(playlist, position), first, last);
+        playlist->count += added;
+    }
+    return added;
+}
+
+// 批量追加
+int add_songs_to_playlist(Playlist *playlist, SongInfo **songs, int count) {
+    return insert_songs_into_playlist(playlist, -1, songs, count);
+}
+
+// 批量移除：一次遍历歌单
+int remove_songs_from_playlist(Playlist *playlist, const char *const *file_paths, int count) {
+    if (!playlist || !file_paths || count <= 0) return 0;
+
+    PathSet targets;
+    if (!path_set_init(&targets, (size_t)count)) return 0;
+    for (int i = 0; i < count; i++) {
+        if (file_paths[i]) path_set_insert(&targets, file_paths[i]);
+    }
+
+    int removed = 0;
+    PlaylistItem *item = playlist->head;
+    while (item) {
+        PlaylistItem *next = item->next;
+        if (item->song->file_path && path_set_contains(&targets, item->song->file_path)) {
+            if (item->prev) {
+                item->prev->next = item->next;
+            } else {
+                playlist->head = item->next;
+            }
+            if (item->next) {
+                item->next->prev = item->prev;
+            } else {
+                playlist->tail = item->prev;
+            }
+            free_song_info(item->song);
+            free(item);
+            removed++;
+        }
+        item = next;
+    }
+    path_set_free(&targets);
+
+    playlist->count -= removed;
+    return removed;
+}
+
+// 移动一段连续的歌曲
+bool move_playlist_range(Playlist *playlist, int from, int count, int to) {
+    if (!playlist || count <= 0 || from < 0 || from + count > playlist->count) return false;
+    if (to < 0 || to > playlist->count - count) return false;
+    if (to == from) return true;
+
+    PlaylistItem *first = item_at(playlist, from);
+    PlaylistItem *last = first;
+    for (int i = 1; i < count; i++) last = last->next;
+
+    // 摘下这一段
+    if (first->prev) {
+        first->prev->next = last->next;
+    } else {
+        playlist->head = last->next;
+    }
+    if (last->next) {
+        last->next->prev = first->prev;
+    } else {
+        playlist->tail = first->prev;
+    }
+    playlist->count -= count;
+
+    // 剩余链表中第 to 个之前插回
+    splice_before(playlist, item_at(playlist, to), first, last);
+    playlist->count += count;
+    return true;
+}
+
+// 按给定排列重排，order 必须是 0..count-1 的一个排列
+bool reorder_playlist(Playlist *playlist, const int *order, int count) {
+    if (!playlist || !order || count != playlist->count) return false;
+    if (count == 0) return true;
+
+    PlaylistItem **items = (PlaylistItem **)malloc((size_t)count * sizeof(PlaylistItem *));
+    bool *used = (bool *)calloc((size_t)count, sizeof(bool));
+    if (!items || !used) {
+        free(items);
+        free(used);
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (order[i] < 0 || order[i] >= count || used[order[i]]) {
+            free(items);
+            free(used);
+            return false;
+        }
+        used[order[i]] = true;
+    }
+
+    int index = 0;
+    for (PlaylistItem *item = playlist->head; item; item = item->next) {
+        items[index++] = item;
+    }
+    for (int i = 0; i < count; i++) {
+        PlaylistItem *item = items[order[i]];
+        item->prev = i > 0 ? items[order[i - 1]] : NULL;
+        item->next = i + 1 < count ? items[order[i + 1]] : NULL;
+    }
+    playlist->head = items[order[0]];
+    playlist->tail = items[order[count - 1]];
+
+    free(items);
+    free(used);
+    return true;
+}
+
+// 批量添加到收藏夹，整批保存一次
+int add_songs_to_favorites(PlaylistManager *manager, SongInfo **songs, int count) {
+    if (!manager) {
+        for (int i = 0; songs && i < count; i++) free_song_info(songs[i]);
+        return 0;
+    }
+    int added = add_songs_to_playlist(manager->favorites, songs, count);
+    if (added > 0) {
+        save_playlists(manager);
+    }
+    return added;
+}
+
+// 批量移出收藏夹，整批保存一次
+int remove_songs_from_favorites(PlaylistManager *manager, const char *const *file_paths, int count) {
+    if (!manager) return 0;
+    int removed = remove_songs_from_playlist(manager->favorites, file_paths, count);
+    if (removed > 0) {
+        save_playlists(manager);
+    }
+    return removed;
+}
+
+// 以 JSON 字符串形式写出（处理引号、反斜杠和控制字符）
+static void write_json_string(FILE *fp, const char *text) {
+    fputc('"', fp);
+    for (const unsigned char *p = (const unsigned char *)(text ? text : ""); *p; p++) {
+        switch (*p) {
+        case '"':  fputs("\\\"", fp); break;
+        case '\\': fputs("\\\\", fp); break;
+        case '\n': fputs("\\n", fp); break;
+        case '\r': fputs("\\r", fp); break;
+        case '\t': fputs("\\t", fp); break;
+        default:
+            if (*p < 0x20) {
+                fprintf(fp, "\\u%04x", *p);
+            } else {
+                fputc(*p, fp);
+            }
+        }
+    }
+    fputc('"', fp);
+}
+
+// 写出单个歌单文件
+static bool save_playlist_file(const Playlist *playlist, const char *file_path) {
+    FILE *fp = fopen(file_path, "w");
+    if (!fp) return false;
+
+    fprintf(fp, "{\n\t\"name\": ");
+    write_json_string(fp, playlist->name);
+    fprintf(fp, ",\n\t\"count\": %d,\n\t\"songs\": [\n", playlist->count);
+
+    PlaylistItem *item = playlist->head;
+    while (item) {
+        fprintf(fp, "\t\t{\n");
+        fprintf(fp, "\t\t\t\"title\": ");
+        write_json_string(fp, item->song->title);
+        fprintf(fp, ",\n\t\t\t\"artist\": ");
+        write_json_string(fp, item->song->artist);
+        fprintf(fp, ",\n\t\t\t\"album\": ");
+        write_json_string(fp, item->song->album);
+        fprintf(fp, ",\n\t\t\t\"file_path\": ");
+        write_json_string(fp, item->song->file_path);
+        fprintf(fp, ",\n\t\t\t\"cover_path\": ");
+        write_json_string(fp, item->song->cover_path);
+        fprintf(fp, ",\n\t\t\t\"lrc_path\": ");
+        write_json_string(fp, item->song->lrc_path);
+        fprintf(fp, ",\n\t\t\t\"duration\": %d\n", item->song->duration);
+        fprintf(fp, "\t\t}");
+
+        item = item->next;
+        if (item) {
+            fprintf(fp, ",");
+        }
+        fprintf(fp, "\n");
+    }
+
+    fprintf(fp, "\t]\n}");
+    return fclose(fp) == 0;
+}
+
 // 保存歌单到文件系统
+// favorites.json 保存收藏夹，<歌单名>.json 保存各歌单，playlists.json 记录歌单名称及顺序
 bool save_playlists(PlaylistManager *manager) {
     if (!manager) return false;
     
+    char file_path[1024];
+
     // 保存收藏夹
-    char favorites_file[1024];
-    snprintf(favorites_file, sizeof(favorites_file), "%s\\favorites.json", manager->data_dir);
-    
-    FILE *fp = fopen(favorites_file, "w");
-    if (fp) {
-        fprintf(fp, "{\n\t\"name\": \"favorites\",\n\t\"count\": %d,\n\t\"songs\": [\n", manager->favorites->count);
-        
-        PlaylistItem *item = manager->favorites->head;
-        while (item) {
-            fprintf(fp, "\t\t{\n");
-            fprintf(fp, "\t\t\t\"title\": \"%s\",\n", item->song->title ? item->song->title : "");
-            fprintf(fp, "\t\t\t\"artist\": \"%s\",\n", item->song->artist ? item->song->artist : "");
-            fprintf(fp, "\t\t\t\"album\": \"%s\",\n", item->song->album ? item->song->album : "");
-            fprintf(fp, "\t\t\t\"file_path\": \"%s\",\n", item->song->file_path ? item->song->file_path : "");
-            fprintf(fp, "\t\t\t\"cover_path\": \"%s\",\n", item->song->cover_path ? item->song->cover_path : "");
-            fprintf(fp, "\t\t\t\"lrc_path\": \"%s\",\n", item->song->lrc_path ? item->song->lrc_path : "");
-            fprintf(fp, "\t\t\t\"duration\": %d\n", item->song->duration);
-            fprintf(fp, "\t\t}");
-            
-            item = item->next;
-            if (item) {
-                fprintf(fp, ",");
-            }
-            fprintf(fp, "\n");
+    snprintf(file_path, sizeof(file_path), "%s/favorites.json", manager->data_dir);
+    if (!save_playlist_file(manager->favorites, file_path)) {
+        return false;
+    }
+
+    // 保存各歌单
+    bool ok = true;
+    Playlist *playlist = manager->playlists;
+    while (playlist) {
+        playlist_file_path(manager, playlist->name, file_path, sizeof(file_path));
+        if (!save_playlist_file(playlist, file_path)) {
+            ok = false;
+        }
+        playlist = playlist->next;
+    }
+
+    // 保存歌单索引
+    snprintf(file_path, sizeof(file_path), "%s/playlists.json", manager->data_dir);
+    FILE *fp = fopen(file_path, "w");
+    if (!fp) return false;
+    fprintf(fp, "{\n\t\"playlists\": [");
+    playlist = manager->playlists;
+    while (playlist) {
+        fprintf(fp, "\n\t\t");
+        write_json_string(fp, playlist->name);
+        playlist = playlist->next;
+        if (playlist) {
+            fprintf(fp, ",");
         }
-        
-        fprintf(fp, "\t]\n}");
+    }
+    fprintf(fp, "\n\t]\n}");
+    if (fclose(fp) != 0) {
+        ok = false;
+    }
+    
+    return ok;
+}
+
+// ---- 简易 JSON 读取（只需支持 save_playlists 写出的结构） ----
+
+// 读入整个文件，返回以 '\0' 结尾的缓冲区
+static char *read_whole_file(const char *file_path) {
+    FILE *fp = fopen(file_path, "rb");
+    if (!fp) return NULL;
+
+    if (fseek(fp, 0, SEEK_END) != 0) {
+        fclose(fp);
+        return NULL;
+    }
+    long size = ftell(fp);
+    if (size < 0 || fseek(fp, 0, SEEK_SET) != 0) {
+        fclose(fp);
+        return NULL;
+    }
+
+    char *buffer = (char *)malloc((size_t)size + 1);
+    if (!buffer) {
         fclose(fp);
+        return NULL;
+    }
+    size_t read = fread(buffer, 1, (size_t)size, fp);
+    buffer[read] = '\0';
+    fclose(fp);
+    return buffer;
+}
+
+static void json_skip_ws(const char **p) {
+    while (**p == ' ' || **p == '\t' || **p == '\n' || **p == '\r') {
+        (*p)++;
+    }
+}
+
+// 追加一个 Unicode 码点的 UTF-8 编码
+static char *utf8_append(char *out, unsigned long cp) {
+    if (cp < 0x80) {
+        *out++ = (char)cp;
+    } else if (cp < 0x800) {
+        *out++ = (char)(0xC0 | (cp >> 6));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        *out++ = (char)(0xE0 | (cp >> 12));
+        *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (char)(0x80 | (cp & 0x3F));
     } else {
+        *out++ = (char)(0xF0 | (cp >> 18));
+        *out++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+        *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    }
+    return out;
+}
+
+static bool json_hex4(const char *p, unsigned long *value) {
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        *value <<= 4;
+        if (c >= '0' && c <= '9') *value |= (unsigned long)(c - '0');
+        else if (c >= 'a' && c <= 'f') *value |= (unsigned long)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') *value |= (unsigned long)(c - 'A' + 10);
+        else return false;
+    }
+    return true;
+}
+
+// 解析字符串并去掉转义，out 为 NULL 时只跳过
+static bool json_parse_string(const char **p, char **out) {
+    if (**p != '"') return false;
+    (*p)++;
+
+    const char *start = *p;
+    while (**p && **p != '"') {
+        if (**p == '\\' && (*p)[1]) (*p)++;
+        (*p)++;
+    }
+    if (**p != '"') return false;
+    const char *end = *p;
+    (*p)++;
+
+    if (!out) return true;
+
+    // 去转义后的长度不会超过原始长度
+    char *result = (char *)malloc((size_t)(end - start) + 1);
+    if (!result) return false;
+    char *w = result;
+    for (const char *r = start; r < end; r++) {
+        if (*r != '\\') {
+            *w++ = *r;
+            continue;
+        }
+        r++;
+        switch (*r) {
+        case 'n': *w++ = '\n'; break;
+        case 'r': *w++ = '\r'; break;
+        case 't': *w++ = '\t'; break;
+        case 'b': *w++ = '\b'; break;
+        case 'f': *w++ = '\f'; break;
+        case 'u': {
+            unsigned long cp;
+            if (end - r < 5 || !json_hex4(r + 1, &cp)) {
+                free(result);
+                return false;
+            }
+            r += 4;
+            // 代理对
+            if (cp >= 0xD800 && cp <= 0xDBFF && end - r >= 7 && r[1] == '\\' && r[2] == 'u') {
+                unsigned long low;
+                if (json_hex4(r + 3, &low) && low >= 0xDC00 && low <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    r += 6;
+                }
+            }
+            w = utf8_append(w, cp);
+            break;
+        }
+        default: *w++ = *r; break;   // \" \\ \/
+        }
+    }
+    *w = '\0';
+    *out = result;
+    return true;
+}
+
+// 跳过任意 JSON 值（用于忽略未知字段）
+static bool json_skip_value(const char **p) {
+    json_skip_ws(p);
+    if (**p == '"') return json_parse_string(p, NULL);
+    if (**p == '{' || **p == '[') {
+        int depth = 0;
+        while (**p) {
+            if (**p == '"') {
+                if (!json_parse_string(p, NULL)) return false;
+                continue;
+            }
+            if (**p == '{' || **p == '[') depth++;
+            if (**p == '}' || **p == ']') depth--;
+            (*p)++;
+            if (depth == 0) return true;
+        }
         return false;
     }
-    
+    while (**p && **p != ',' && **p != '}' && **p != ']') {
+        (*p)++;
+    }
     return true;
 }
 
-// 从文件系统加载歌单
+// 解析一首歌曲对象并加入歌单（seen 为歌单中已有的路径，用于去重）
+static bool json_parse_song(const char **p, Playlist *playlist, PathSet *seen) {
+    char *fields[6] = { NULL, NULL, NULL, NULL, NULL, NULL };
+    static const char *names[6] = { "title", "artist", "album", "file_path", "cover_path", "lrc_path" };
+    int duration = 0;
+    bool ok = false;
+
+    json_skip_ws(p);
+    if (**p != '{') return false;
+    (*p)++;
+
+    for (;;) {
+        json_skip_ws(p);
+        if (**p == '}') {
+            (*p)++;
+            ok = true;
+            break;
+        }
+        char *key = NULL;
+        if (!json_parse_string(p, &key)) break;
+        json_skip_ws(p);
+        if (**p != ':') {
+            free(key);
+            break;
+        }
+        (*p)++;
+        json_skip_ws(p);
+
+        int index = -1;
+        for (int i = 0; i < 6; i++) {
+            if (strcmp(key, names[i]) == 0) {
+                index = i;
+                break;
+            }
+        }
+        bool parsed;
+        if (index >= 0 && **p == '"') {
+            free(fields[index]);
+            fields[index] = NULL;
+            parsed = json_parse_string(p, &fields[index]);
+        } else if (strcmp(key, "duration") == 0) {
+            duration = (int)strtol(*p, (char **)p, 10);
+            parsed = true;
+        } else {
+            parsed = json_skip_value(p);
+        }
+        free(key);
+        if (!parsed) break;
+
+        json_skip_ws(p);
+        if (**p == ',') (*p)++;
+    }
+
+    if (ok && fields[3] && fields[3][0]) {
+        SongInfo *song = create_song_info(fields[0], fields[1], fields[2], fields[3], fields[4], fields[5], duration);
+        if (song) {
+            // 哈希集合去重，整个文件线性时间；集合中的指针指向歌单所有的路径，所以先加入歌单再记录
+            if (!path_set_contains(seen, song->file_path) && append_to_playlist(playlist, song)) {
+                path_set_insert(seen, song->file_path);
+            } else {
+                free_song_info(song);
+            }
+        }
+    }
+    for (int i = 0; i < 6; i++) {
+        free(fields[i]);
+    }
+    return ok;
+}
+
+// 从单个歌单文件读取歌曲
+static bool load_playlist_file(Playlist *playlist, const char *file_path) {
+    char *buffer = read_whole_file(file_path);
+    if (!buffer) return false;
+
+    // 导入时歌单可能已有歌曲，一并放进去重集合；之后随加入的歌曲自动扩容
+    PathSet seen;
+    if (!path_set_init(&seen, (size_t)playlist->count + 64)) {
+        free(buffer);
+        return false;
+    }
+    for (PlaylistItem *item = playlist->head; item; item = item->next) {
+        if (item->song->file_path) path_set_insert(&seen, item->song->file_path);
+    }
+
+    const char *p = buffer;
+    bool ok = false;
+    json_skip_ws(&p);
+    if (*p == '{') {
+        p++;
+        for (;;) {
+            json_skip_ws(&p);
+            if (*p == '}') {
+                ok = true;
+                break;
+            }
+            char *key = NULL;
+            if (!json_parse_string(&p, &key)) break;
+            json_skip_ws(&p);
+            if (*p != ':') {
+                free(key);
+                break;
+            }
+            p++;
+            json_skip_ws(&p);
+
+            bool parsed = true;
+            if (strcmp(key, "songs") == 0 && *p == '[') {
+                p++;
+                for (;;) {
+                    json_skip_ws(&p);
+                    if (*p == ']') {
+                        p++;
+                        break;
+                    }
+                    if (!json_parse_song(&p, playlist, &seen)) {
+                        parsed = false;
+                        break;
+                    }
+                    json_skip_ws(&p);
+                    if (*p == ',') p++;
+                }
+            } else {
+                parsed = json_skip_value(&p);
+            }
+            free(key);
+            if (!parsed) break;
+
+            json_skip_ws(&p);
+            if (*p == ',') p++;
+        }
+    }
+
+    path_set_free(&seen);
+    free(buffer);
+    return ok;
+}
+
+// 释放歌单中的所有歌曲
+static void clear_playlist_items(Playlist *playlist) {
+    PlaylistItem *item = playlist->head;
+    while (item) {
+        PlaylistItem *next = item->next;
+        free_song_info(item->song);
+        free(item);
+        item = next;
+    }
+    playlist->head = NULL;
+    playlist->tail = NULL;
+    playlist->count = 0;
+}
+
+// 从文件系统加载歌单（会先清空内存中的现有内容）
 bool load_playlists(PlaylistManager *manager) {
     if (!manager) return false;
     
+    char file_path[1024];
+
+    // 清空现有内容，保证重复加载的结果一致
+    clear_playlist_items(manager->favorites);
+    while (manager->playlists) {
+        Playlist *next = manager->playlists->next;
+        clear_playlist_items(manager->playlists);
+        free(manager->playlists->name);
+        free(manager->playlists);
+        manager->playlists = next;
+    }
+    manager->playlist_count = 0;
+
     // 加载收藏夹
-    char favorites_file[1024];
-    snprintf(favorites_file, sizeof(favorites_file), "%s\\favorites.json", manager->data_dir);
-    
-    FILE *fp = fopen(favorites_file, "r");
-    if (fp) {
-        // 这里简化处理，实际项目中应该使用JSON解析库
-        // 这里仅作为示例，实际使用时需要完整的JSON解析
-        fclose(fp);
+    snprintf(file_path, sizeof(file_path), "%s/favorites.json", manager->data_dir);
+    load_playlist_file(manager->favorites, file_path);
+
+    // 加载歌单索引
+    snprintf(file_path, sizeof(file_path), "%s/playlists.json", manager->data_dir);
+    char *buffer = read_whole_file(file_path);
+    if (!buffer) {
+        return true;  // 尚未保存过歌单
+    }
+
+    // 先收集名称，再倒序创建，使 create_playlist 头插后的顺序与保存时一致
+    char **names = NULL;
+    int count = 0;
+    int capacity = 0;
+    const char *p = strstr(buffer, "\"playlists\"");
+    if (p) {
+        p = strchr(p, '[');
     }
+    if (p) {
+        p++;
+        for (;;) {
+            json_skip_ws(&p);
+            if (*p != '"') break;
+            char *name = NULL;
+            if (!json_parse_string(&p, &name)) break;
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 8;
+                char **grown = (char **)realloc(names, sizeof(char *) * (size_t)capacity);
+                if (!grown) {
+                    free(name);
+                    break;
+                }
+                names = grown;
+            }
+            names[count++] = name;
+            json_skip_ws(&p);
+            if (*p == ',') p++;
+        }
+    }
+    free(buffer);
+
+    for (int i = count - 1; i >= 0; i--) {
+        Playlist *playlist = create_playlist(manager, names[i]);
+        if (playlist) {
+            playlist_file_path(manager, names[i], file_path, sizeof(file_path));
+            if (!load_playlist_file(playlist, file_path)
+                && legacy_playlist_file_path(manager, names[i], file_path, sizeof(file_path))) {
+                load_playlist_file(playlist, file_path);
+            }
+        }
+        free(names[i]);
+    }
+    free(names);
     
     return true;
 }
 
+// 从指定文件导入单个歌单（格式与 save_playlists 写出的歌单文件相同）
+bool import_playlist_file(Playlist *playlist, const char *file_path) {
+    if (!playlist || !file_path) return false;
+    return load_playlist_file(playlist, file_path);
+}
+
+// 把单个歌单导出到指定文件
+bool export_playlist_file(const Playlist *playlist, const char *file_path) {
+    if (!playlist || !file_path) return false;
+    return save_playlist_file(playlist, file_path);
+}
+
 // 获取所有歌单名称
 char **get_all_playlist_names(PlaylistManager *manager, int *count) {
     if (!manager || !count) return NULL;
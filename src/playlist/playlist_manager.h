@@ -48,6 +48,7 @@ typedef struct {
 
 // 初始化函数
 PlaylistManager *playlist_manager_init(const char *data_directory);
+PlaylistManager *playlist_manager_create(const char *data_directory);  // 不加载已保存的歌单
 void playlist_manager_free(PlaylistManager *manager);
 
 // 收藏夹操作
@@ -61,11 +62,24 @@ Playlist *create_playlist(PlaylistManager *manager, const char *name);
 bool delete_playlist(PlaylistManager *manager, const char *name);
 Playlist *get_playlist(PlaylistManager *manager, const char *name);
 bool add_to_playlist(Playlist *playlist, SongInfo *song);
+bool append_to_playlist(Playlist *playlist, SongInfo *song);  // 不检查重复，由调用方保证
 bool remove_from_playlist(Playlist *playlist, const char *file_path);
 
+// 批量操作：先用哈希集合一次性去重，整批只需线性时间，不会自动保存
+// 传入的 songs 全部交给函数处理：加入歌单的归歌单所有，重复或无效的直接释放
+int insert_songs_into_playlist(Playlist *playlist, int position, SongInfo **songs, int count);  // position 越界时追加到末尾，返回加入数量
+int add_songs_to_playlist(Playlist *playlist, SongInfo **songs, int count);
+int remove_songs_from_playlist(Playlist *playlist, const char *const *file_paths, int count);    // 返回移除数量
+bool move_playlist_range(Playlist *playlist, int from, int count, int to);  // 移动后第一首位于 to（按移动后的位置计）
+bool reorder_playlist(Playlist *playlist, const int *order, int count);     // 新的第 i 首为原来的第 order[i] 首
+int add_songs_to_favorites(PlaylistManager *manager, SongInfo **songs, int count);               // 整批保存一次
+int remove_songs_from_favorites(PlaylistManager *manager, const char *const *file_paths, int count);
+
 // 文件系统操作
 bool save_playlists(PlaylistManager *manager);
 bool load_playlists(PlaylistManager *manager);
+bool import_playlist_file(Playlist *playlist, const char *file_path);
+bool export_playlist_file(const Playlist *playlist, const char *file_path);
 
 // 工具函数
 SongInfo *create_song_info(const char *title, const char *artist, const char *album, 
@@ -0,0 +1,369 @@
+#include "playlist_snapshot.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QVector>
+#include <cstring>
+
+struct PlaylistSnapshot::Header
+{
+    char magic[8];              // "XCPLSNAP"
+    quint32 version;
+    quint32 headerSize;
+    quint32 playlistCount;      // 含收藏夹
+    quint32 songCount;          // 所有歌单的歌曲总数
+    quint64 playlistOffset;
+    quint64 songOffset;
+    quint64 stringsOffset;
+    quint64 stringsSize;
+    quint64 checksum;           // 文件头之后全部内容的校验和
+};
+
+struct PlaylistSnapshot::PlaylistRecord
+{
+    quint32 nameOffset;
+    quint32 nameLength;
+    quint32 firstSong;          // 在歌曲表中的起始位置
+    quint32 songCount;
+};
+
+struct PlaylistSnapshot::SongRecord
+{
+    quint32 offsets[FieldCount];
+    quint32 lengths[FieldCount];
+    qint32 duration;
+    quint32 reserved;
+};
+
+namespace {
+const char Magic[8] = { 'X', 'C', 'P', 'L', 'S', 'N', 'A', 'P' };
+const quint32 Version = 1;
+
+inline quint64 rotl(quint64 value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// 四路并行的乘法-旋转散列（轮函数同 xxHash64），启动时需要校验整个文件，
+// 逐字节的 CRC 对几十 MB 的快照来说太慢
+quint64 checksum(const uchar *data, qint64 size)
+{
+    const quint64 P1 = 0x9E3779B185EBCA87ULL;
+    const quint64 P2 = 0xC2B2AE3D27D4EB4FULL;
+    quint64 acc[4] = { P1 + P2, P2, 0, 0 - P1 };
+
+    qint64 i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            quint64 value;
+            memcpy(&value, data + i + lane * 8, 8);
+            acc[lane] = rotl(acc[lane] + value * P2, 31) * P1;
+        }
+    }
+
+    quint64 hash = rotl(acc[0], 1) + rotl(acc[1], 7) + rotl(acc[2], 12) + rotl(acc[3], 18);
+    for (; i < size; ++i)
+        hash = rotl(hash ^ (data[i] * P1), 11) * P2;
+    hash ^= quint64(size);
+    hash ^= hash >> 33;
+    hash *= P2;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+inline quint64 align8(quint64 value)
+{
+    return (value + 7) & ~quint64(7);
+}
+}
+
+PlaylistSnapshot::~PlaylistSnapshot()
+{
+    close();
+}
+
+bool PlaylistSnapshot::write(const QString &filePath, const PlaylistManager *manager)
+{
+    static_assert(sizeof(Header) == 64, "snapshot header layout");
+    static_assert(sizeof(SongRecord) == 56, "snapshot song record layout");
+
+    if (!manager || !manager->favorites) {
+        return false;
+    }
+
+    QVector<const Playlist *> lists;
+    lists.append(manager->favorites);
+    qint64 totalSongs = manager->favorites->count;
+    for (const Playlist *playlist = manager->playlists; playlist; playlist = playlist->next) {
+        lists.append(playlist);
+        totalSongs += playlist->count;
+    }
+
+    // 偏移 0 处放一个 \0，空字段都指向它
+    QByteArray strings;
+    strings.reserve(totalSongs * 96 + 1);
+    strings.append('\0');
+    QHash<QByteArray, quint32> shared;  // 艺术家、专辑、封面重复率高，只存一份
+    auto addString = [&](const char *text, bool dedupe, quint32 &offset, quint32 &length) {
+        offset = 0;
+        length = 0;
+        if (!text || !*text) {
+            return;
+        }
+        const qsizetype size = qsizetype(strlen(text));
+        length = quint32(size);
+        if (dedupe) {
+            const QByteArray key = QByteArray::fromRawData(text, size);
+            auto it = shared.constFind(key);
+            if (it != shared.constEnd()) {
+                offset = it.value();
+                return;
+            }
+            shared.insert(key, quint32(strings.size()));
+        }
+        offset = quint32(strings.size());
+        strings.append(text, size);
+        strings.append('\0');
+    };
+
+    QVector<PlaylistRecord> playlistRecords(lists.size());
+    QVector<SongRecord> songRecords;
+    songRecords.reserve(totalSongs);
+    for (int i = 0; i < lists.size(); ++i) {
+        PlaylistRecord &record = playlistRecords[i];
+        addString(lists[i]->name, false, record.nameOffset, record.nameLength);
+        record.firstSong = quint32(songRecords.size());
+        for (const PlaylistItem *item = lists[i]->head; item; item = item->next) {
+            const SongInfo *info = item->song;
+            if (!info || !info->file_path) {
+                continue;
+            }
+            SongRecord song = {};
+            addString(info->title, false, song.offsets[Title], song.lengths[Title]);
+            addString(info->artist, true, song.offsets[Artist], song.lengths[Artist]);
+            addString(info->album, true, song.offsets[Album], song.lengths[Album]);
+            addString(info->file_path, false, song.offsets[FilePath], song.lengths[FilePath]);
+            addString(info->cover_path, true, song.offsets[CoverPath], song.lengths[CoverPath]);
+            addString(info->lrc_path, false, song.offsets[LrcPath], song.lengths[LrcPath]);
+            song.duration = info->duration;
+            songRecords.append(song);
+        }
+        record.songCount = quint32(songRecords.size()) - record.firstSong;
+    }
+
+    if (quint64(strings.size()) > 0xFFFFFFFFULL) {
+        qWarning() << "Playlist snapshot too large:" << strings.size();
+        return false;
+    }
+
+    Header header = {};
+    memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.headerSize = sizeof(Header);
+    header.playlistCount = quint32(playlistRecords.size());
+    header.songCount = quint32(songRecords.size());
+    header.playlistOffset = sizeof(Header);
+    header.songOffset = align8(header.playlistOffset + quint64(playlistRecords.size()) * sizeof(PlaylistRecord));
+    header.stringsOffset = align8(header.songOffset + quint64(songRecords.size()) * sizeof(SongRecord));
+    header.stringsSize = quint64(strings.size());
+
+    QByteArray image(qsizetype(header.stringsOffset + header.stringsSize), '\0');
+    char *base = image.data();
+    memcpy(base + header.playlistOffset, playlistRecords.constData(), playlistRecords.size() * sizeof(PlaylistRecord));
+    memcpy(base + header.songOffset, songRecords.constData(), songRecords.size() * sizeof(SongRecord));
+    memcpy(base + header.stringsOffset, strings.constData(), strings.size());
+    header.checksum = checksum(reinterpret_cast<const uchar *>(base) + sizeof(Header), image.size() - qsizetype(sizeof(Header)));
+    memcpy(base, &header, sizeof(Header));
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(image);
+    return file.commit();
+}
+
+bool PlaylistSnapshot::open(const QString &filePath, const QString &jsonIndexPath)
+{
+    close();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    auto fail = [this](const char *reason) {
+        qWarning() << "Playlist snapshot ignored:" << reason;
+        close();
+        return false;
+    };
+
+    // JSON 比快照新，说明歌单在快照之外被保存过（例如 C 层直接调用 save_playlists）
+    if (!jsonIndexPath.isEmpty()) {
+        QFileInfo json(jsonIndexPath);
+        if (json.exists() && json.lastModified() > QFileInfo(filePath).lastModified()) {
+            return fail("older than playlists.json");
+        }
+    }
+
+    const qint64 size = m_file.size();
+    if (size < qint64(sizeof(Header))) {
+        return fail("truncated header");
+    }
+    const uchar *data = m_file.map(0, size);
+    if (!data) {
+        return fail("mmap failed");
+    }
+    m_data = data;
+
+    const Header *header = reinterpret_cast<const Header *>(data);
+    if (memcmp(header->magic, Magic, sizeof(Magic)) != 0 || header->version != Version
+        || header->headerSize != sizeof(Header)) {
+        return fail("unknown format or version");
+    }
+
+    const quint64 playlistEnd = header->playlistOffset + quint64(header->playlistCount) * sizeof(PlaylistRecord);
+    const quint64 songEnd = header->songOffset + quint64(header->songCount) * sizeof(SongRecord);
+    if (header->playlistOffset != sizeof(Header) || header->playlistCount == 0
+        || playlistEnd > header->songOffset || songEnd > header->stringsOffset
+        || header->stringsOffset + header->stringsSize != quint64(size) || header->stringsSize == 0
+        || header->songOffset % 8 != 0) {
+        return fail("inconsistent offsets");
+    }
+
+    if (checksum(data + sizeof(Header), size - qint64(sizeof(Header))) != header->checksum) {
+        return fail("checksum mismatch");
+    }
+
+    m_header = header;
+    m_playlists = reinterpret_cast<const PlaylistRecord *>(data + header->playlistOffset);
+    m_songs = reinterpret_cast<const SongRecord *>(data + header->songOffset);
+    m_strings = reinterpret_cast<const char *>(data + header->stringsOffset);
+    if (m_strings[header->stringsSize - 1] != '\0') {
+        return fail("unterminated string table");
+    }
+    for (quint32 i = 0; i < header->playlistCount; ++i) {
+        if (quint64(m_playlists[i].firstSong) + m_playlists[i].songCount > header->songCount) {
+            return fail("playlist range out of bounds");
+        }
+    }
+    return true;
+}
+
+void PlaylistSnapshot::close()
+{
+    if (m_data) {
+        m_file.unmap(const_cast<uchar *>(m_data));
+    }
+    m_file.close();
+    m_data = nullptr;
+    m_header = nullptr;
+    m_playlists = nullptr;
+    m_songs = nullptr;
+    m_strings = nullptr;
+}
+
+const char *PlaylistSnapshot::string(quint32 offset, quint32 length) const
+{
+    if (quint64(offset) + length >= m_header->stringsSize) {
+        return m_strings;   // 越界时返回空字符串
+    }
+    return m_strings + offset;
+}
+
+const PlaylistSnapshot::SongRecord *PlaylistSnapshot::songRecord(int playlist, int song) const
+{
+    return m_songs + m_playlists[playlist].firstSong + song;
+}
+
+int PlaylistSnapshot::playlistCount() const
+{
+    return m_header ? int(m_header->playlistCount) : 0;
+}
+
+QString PlaylistSnapshot::playlistName(int playlist) const
+{
+    const PlaylistRecord &record = m_playlists[playlist];
+    return QString::fromUtf8(string(record.nameOffset, record.nameLength), record.nameLength);
+}
+
+int PlaylistSnapshot::indexOf(const QString &name) const
+{
+    const QByteArray utf8 = name.toUtf8();
+    for (int i = 1; i < playlistCount(); ++i) {
+        const PlaylistRecord &record = m_playlists[i];
+        if (record.nameLength == quint32(utf8.size())
+            && memcmp(string(record.nameOffset, record.nameLength), utf8.constData(), utf8.size()) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int PlaylistSnapshot::songCount(int playlist) const
+{
+    return int(m_playlists[playlist].songCount);
+}
+
+QString PlaylistSnapshot::songField(int playlist, int song, Field field) const
+{
+    const SongRecord *record = songRecord(playlist, song);
+    const quint32 length = record->lengths[field];
+    return QString::fromUtf8(string(record->offsets[field], length), length);
+}
+
+int PlaylistSnapshot::songDuration(int playlist, int song) const
+{
+    return songRecord(playlist, song)->duration;
+}
+
+bool PlaylistSnapshot::containsPath(int playlist, const QByteArray &filePath) const
+{
+    const int count = songCount(playlist);
+    for (int i = 0; i < count; ++i) {
+        const SongRecord *record = songRecord(playlist, i);
+        if (record->lengths[FilePath] == quint32(filePath.size())
+            && memcmp(string(record->offsets[FilePath], record->lengths[FilePath]), filePath.constData(), filePath.size()) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PlaylistSnapshot::hydrate(PlaylistManager *manager) const
+{
+    if (!isOpen() || !manager || !manager->favorites) {
+        return false;
+    }
+
+    // create_playlist 插入到链表头部，倒序创建才能保持原有顺序
+    QVector<Playlist *> targets(playlistCount());
+    targets[0] = manager->favorites;
+    for (int i = playlistCount() - 1; i >= 1; --i) {
+        const PlaylistRecord &record = m_playlists[i];
+        targets[i] = create_playlist(manager, string(record.nameOffset, record.nameLength));
+        if (!targets[i]) {
+            return false;
+        }
+    }
+
+    // 快照由去重后的歌单写出，直接追加
+    for (int i = 0; i < playlistCount(); ++i) {
+        const int count = songCount(i);
+        for (int j = 0; j < count; ++j) {
+            const SongRecord *record = songRecord(i, j);
+            auto field = [this, record](Field f) { return string(record->offsets[f], record->lengths[f]); };
+            SongInfo *song = create_song_info(field(Title), field(Artist), field(Album), field(FilePath),
+                                              field(CoverPath), field(LrcPath), record->duration);
+            if (!song) {
+                return false;
+            }
+            if (!append_to_playlist(targets[i], song)) {
+                free_song_info(song);
+            }
+        }
+    }
+    return true;
+}
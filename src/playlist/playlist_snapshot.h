@@ -0,0 +1,58 @@
+#ifndef PLAYLIST_SNAPSHOT_H
+#define PLAYLIST_SNAPSHOT_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include "playlist_manager.h"
+
+// 歌单二进制快照
+// 保存 JSON 时一并写出，启动时只读映射到内存，不需要解析即可读取歌单：
+//   文件头（64 字节） | 歌单表 | 歌曲表 | 字符串区
+// 各表的偏移相对文件开头，字符串偏移相对字符串区，字符串以 \0 结尾。文件头之后的内容带 64 位校验和，
+// 校验失败、版本不符或比 playlists.json 旧时 open() 返回 false，调用方回退到 JSON。
+class PlaylistSnapshot
+{
+public:
+    enum Field { Title, Artist, Album, FilePath, CoverPath, LrcPath, FieldCount };
+
+    PlaylistSnapshot() = default;
+    ~PlaylistSnapshot();
+    Q_DISABLE_COPY(PlaylistSnapshot)
+
+    static bool write(const QString &filePath, const PlaylistManager *manager);
+
+    // jsonIndexPath 不为空时，若该文件比快照新则视为快照过期
+    bool open(const QString &filePath, const QString &jsonIndexPath = QString());
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    // 第 0 个歌单为收藏夹，其余与 PlaylistManager 中的链表顺序一致
+    int playlistCount() const;
+    QString playlistName(int playlist) const;
+    int indexOf(const QString &name) const;     // 只查找普通歌单，不含收藏夹
+    int songCount(int playlist) const;
+    QString songField(int playlist, int song, Field field) const;
+    int songDuration(int playlist, int song) const;
+    bool containsPath(int playlist, const QByteArray &filePath) const;
+
+    // 把快照内容写入空的 PlaylistManager（第一次修改歌单时调用）
+    bool hydrate(PlaylistManager *manager) const;
+
+private:
+    struct Header;
+    struct PlaylistRecord;
+    struct SongRecord;
+
+    const char *string(quint32 offset, quint32 length) const;
+    const SongRecord *songRecord(int playlist, int song) const;
+
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    const Header *m_header = nullptr;
+    const PlaylistRecord *m_playlists = nullptr;
+    const SongRecord *m_songs = nullptr;
+    const char *m_strings = nullptr;
+};
+
+#endif // PLAYLIST_SNAPSHOT_H
@@ -0,0 +1,344 @@
+#include "smartplaylist.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <algorithm>
+
+namespace {
+const qint64 DayMs = 24LL * 60 * 60 * 1000;
+
+const char *const FieldNames[] = { "artist", "album", "duration", "playCount", "addedWithinDays", "favorite" };
+const char *const OpNames[] = { "equals", "contains", "atLeast", "atMost" };
+
+template <int N>
+int nameIndex(const char *const (&names)[N], const QString &name)
+{
+    for (int i = 0; i < N; ++i) {
+        if (name == QLatin1String(names[i]))
+            return i;
+    }
+    return -1;
+}
+
+bool compareNumber(SmartRule::Op op, qint64 value, qint64 bound)
+{
+    switch (op) {
+    case SmartRule::AtLeast:
+        return value >= bound;
+    case SmartRule::AtMost:
+        return value <= bound;
+    default:
+        return value == bound;
+    }
+}
+
+bool compareText(SmartRule::Op op, const QString &value, const QString &text)
+{
+    if (op == SmartRule::Contains)
+        return value.contains(text, Qt::CaseInsensitive);
+    return value.compare(text, Qt::CaseInsensitive) == 0;
+}
+}
+
+bool SmartPlaylistEngine::load(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("version").toInt() != 1)
+        return false;
+
+    m_views.clear();
+    const QJsonArray playlists = root.value("playlists").toArray();
+    for (const QJsonValue &value : playlists) {
+        const QJsonObject object = value.toObject();
+        SmartPlaylistDefinition definition;
+        definition.name = object.value("name").toString();
+        definition.matchAll = object.value("match").toString() != "any";
+        const QJsonArray rules = object.value("rules").toArray();
+        for (const QJsonValue &ruleValue : rules) {
+            const QJsonObject ruleObject = ruleValue.toObject();
+            const int field = nameIndex(FieldNames, ruleObject.value("field").toString());
+            const int op = nameIndex(OpNames, ruleObject.value("op").toString());
+            if (field < 0 || op < 0) {
+                qWarning() << "Skipping unknown smart playlist rule in" << definition.name;
+                continue;
+            }
+            SmartRule rule;
+            rule.field = SmartRule::Field(field);
+            rule.op = SmartRule::Op(op);
+            rule.text = ruleObject.value("text").toString();
+            rule.number = qint64(ruleObject.value("number").toDouble());
+            definition.rules.append(rule);
+        }
+        addDefinition(definition);
+    }
+    return true;
+}
+
+bool SmartPlaylistEngine::save(const QString &filePath) const
+{
+    QJsonArray playlists;
+    for (const View &view : m_views) {
+        QJsonArray rules;
+        for (const SmartRule &rule : view.definition.rules) {
+            QJsonObject object;
+            object.insert("field", QLatin1String(FieldNames[rule.field]));
+            object.insert("op", QLatin1String(OpNames[rule.op]));
+            if (rule.field == SmartRule::Artist || rule.field == SmartRule::Album)
+                object.insert("text", rule.text);
+            else
+                object.insert("number", double(rule.number));
+            rules.append(object);
+        }
+        QJsonObject object;
+        object.insert("name", view.definition.name);
+        object.insert("match", view.definition.matchAll ? "all" : "any");
+        object.insert("rules", rules);
+        playlists.append(object);
+    }
+
+    QJsonObject root;
+    root.insert("version", 1);
+    root.insert("playlists", playlists);
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(QJsonDocument(root).toJson());
+    return file.commit();
+}
+
+QStringList SmartPlaylistEngine::names() const
+{
+    QStringList result;
+    for (const View &view : m_views)
+        result.append(view.definition.name);
+    return result;
+}
+
+bool SmartPlaylistEngine::contains(const QString &name) const
+{
+    return findView(name) != nullptr;
+}
+
+bool SmartPlaylistEngine::addDefinition(const SmartPlaylistDefinition &definition)
+{
+    if (definition.name.isEmpty() || definition.rules.isEmpty())
+        return false;
+
+    View view;
+    view.definition = definition;
+    for (const SmartRule &rule : definition.rules)
+        view.fields |= 1u << rule.field;
+    // 新定义只能完整计算一次
+    rebuild(view);
+
+    for (View &existing : m_views) {
+        if (existing.definition.name == definition.name) {
+            existing = std::move(view);
+            return true;
+        }
+    }
+    m_views.append(std::move(view));
+    return true;
+}
+
+bool SmartPlaylistEngine::removeDefinition(const QString &name)
+{
+    for (int i = 0; i < m_views.size(); ++i) {
+        if (m_views[i].definition.name == name) {
+            m_views.remove(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void SmartPlaylistEngine::setTracks(const QVector<SmartTrack> &tracks)
+{
+    m_tracks.clear();
+    m_tracks.reserve(tracks.size());
+    for (const SmartTrack &track : tracks)
+        m_tracks.insert(track.filePath, track);
+    for (View &view : m_views)
+        rebuild(view);
+}
+
+void SmartPlaylistEngine::upsertTrack(const SmartTrack &track)
+{
+    auto it = m_tracks.find(track.filePath);
+    quint32 changed = MaskAll;
+    if (it != m_tracks.end()) {
+        changed = changedFields(*it, track);
+        *it = track;
+    } else {
+        m_tracks.insert(track.filePath, track);
+    }
+    if (changed)
+        update(track, changed);
+}
+
+void SmartPlaylistEngine::removeTrack(const QString &filePath)
+{
+    if (!m_tracks.remove(filePath))
+        return;
+    for (View &view : m_views) {
+        if (view.members.remove(filePath))
+            view.dirty = true;
+    }
+}
+
+void SmartPlaylistEngine::trackPlayed(const QString &filePath)
+{
+    auto it = m_tracks.find(filePath);
+    if (it == m_tracks.end())
+        return;
+    ++it->playCount;
+    update(*it, MaskPlayCount);
+}
+
+void SmartPlaylistEngine::setFavorite(const QString &filePath, bool favorite)
+{
+    auto it = m_tracks.find(filePath);
+    if (it == m_tracks.end() || it->favorite == favorite)
+        return;
+    it->favorite = favorite;
+    update(*it, MaskFavorite);
+}
+
+QVector<SmartTrack> SmartPlaylistEngine::songs(const QString &name) const
+{
+    QVector<SmartTrack> result;
+    const View *view = findView(name);
+    if (!view)
+        return result;
+
+    expire(*view);
+    if (view->dirty) {
+        view->ordered = QStringList(view->members.cbegin(), view->members.cend());
+        std::sort(view->ordered.begin(), view->ordered.end());
+        view->dirty = false;
+    }
+    result.reserve(view->ordered.size());
+    for (const QString &path : std::as_const(view->ordered))
+        result.append(m_tracks.value(path));
+    return result;
+}
+
+int SmartPlaylistEngine::songCount(const QString &name) const
+{
+    const View *view = findView(name);
+    if (!view)
+        return 0;
+    expire(*view);
+    return int(view->members.size());
+}
+
+bool SmartPlaylistEngine::matches(const SmartPlaylistDefinition &definition, const SmartTrack &track, qint64 now)
+{
+    for (const SmartRule &rule : definition.rules) {
+        const bool hit = matchRule(rule, track, now);
+        if (definition.matchAll && !hit)
+            return false;
+        if (!definition.matchAll && hit)
+            return true;
+    }
+    return definition.matchAll;
+}
+
+bool SmartPlaylistEngine::matchRule(const SmartRule &rule, const SmartTrack &track, qint64 now)
+{
+    switch (rule.field) {
+    case SmartRule::Artist:
+        return compareText(rule.op, track.artist, rule.text);
+    case SmartRule::Album:
+        return compareText(rule.op, track.album, rule.text);
+    case SmartRule::Duration:
+        return compareNumber(rule.op, track.duration, rule.number);
+    case SmartRule::PlayCount:
+        return compareNumber(rule.op, track.playCount, rule.number);
+    case SmartRule::AddedWithinDays:
+        return track.addedAt > 0 && track.addedAt >= now - rule.number * DayMs;
+    case SmartRule::Favorite:
+        return track.favorite == (rule.number != 0);
+    }
+    return false;
+}
+
+quint32 SmartPlaylistEngine::changedFields(const SmartTrack &before, const SmartTrack &after)
+{
+    quint32 changed = 0;
+    if (before.artist != after.artist)
+        changed |= MaskArtist;
+    if (before.album != after.album)
+        changed |= MaskAlbum;
+    if (before.duration != after.duration)
+        changed |= MaskDuration;
+    if (before.playCount != after.playCount)
+        changed |= MaskPlayCount;
+    if (before.addedAt != after.addedAt)
+        changed |= MaskAdded;
+    if (before.favorite != after.favorite)
+        changed |= MaskFavorite;
+    return changed;
+}
+
+void SmartPlaylistEngine::rebuild(View &view)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    view.members.clear();
+    for (auto it = m_tracks.cbegin(); it != m_tracks.cend(); ++it) {
+        if (matches(view.definition, it.value(), now))
+            view.members.insert(it.key());
+    }
+    view.dirty = true;
+}
+
+void SmartPlaylistEngine::update(const SmartTrack &track, quint32 changed)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (View &view : m_views) {
+        // 规则不涉及变化的字段，成员关系不会变
+        if (!(view.fields & changed))
+            continue;
+        const bool member = view.members.contains(track.filePath);
+        if (matches(view.definition, track, now) != member) {
+            if (member)
+                view.members.remove(track.filePath);
+            else
+                view.members.insert(track.filePath);
+            view.dirty = true;
+        }
+    }
+}
+
+void SmartPlaylistEngine::expire(const View &view) const
+{
+    if (!(view.fields & MaskAdded))
+        return;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (auto it = view.members.begin(); it != view.members.end();) {
+        if (!matches(view.definition, m_tracks.value(*it), now)) {
+            it = view.members.erase(it);
+            view.dirty = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+const SmartPlaylistEngine::View *SmartPlaylistEngine::findView(const QString &name) const
+{
+    for (const View &view : m_views) {
+        if (view.definition.name == name)
+            return &view;
+    }
+    return nullptr;
+}
@@ -0,0 +1,101 @@
+#ifndef SMARTPLAYLIST_H
+#define SMARTPLAYLIST_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 智能歌单看到的歌曲信息
+struct SmartTrack
+{
+    QString filePath;
+    QString title;
+    QString artist;
+    QString album;
+    int duration = 0;       // 秒
+    qint64 addedAt = 0;     // 加入曲库的时间（毫秒时间戳）
+    int playCount = 0;
+    bool favorite = false;
+};
+
+// 单条规则
+struct SmartRule
+{
+    enum Field { Artist, Album, Duration, PlayCount, AddedWithinDays, Favorite };
+    enum Op { Equals, Contains, AtLeast, AtMost };
+
+    Field field = Artist;
+    Op op = Equals;
+    QString text;           // Artist/Album 使用
+    qint64 number = 0;      // 时长（秒）、播放次数、天数；Favorite 为 1/0
+};
+
+// 智能歌单只保存定义，内容由曲库计算
+struct SmartPlaylistDefinition
+{
+    QString name;
+    QVector<SmartRule> rules;
+    bool matchAll = true;   // true：满足全部规则；false：满足任意一条
+};
+
+// 智能歌单引擎
+// setTracks() 时对每个歌单完整计算一次，之后歌曲新增、标签变化、播放或收藏变化时，
+// 只有规则涉及变化字段的歌单会重新判断这一首歌，不再整体重算。
+// “最近添加”规则随时间过期，读取时只复查已有成员。
+class SmartPlaylistEngine
+{
+public:
+    bool load(const QString &filePath);
+    bool save(const QString &filePath) const;
+
+    QStringList names() const;
+    bool contains(const QString &name) const;
+    bool addDefinition(const SmartPlaylistDefinition &definition);   // 同名定义会被替换
+    bool removeDefinition(const QString &name);
+
+    // 曲库变化
+    void setTracks(const QVector<SmartTrack> &tracks);
+    void upsertTrack(const SmartTrack &track);
+    void removeTrack(const QString &filePath);
+    void trackPlayed(const QString &filePath);
+    void setFavorite(const QString &filePath, bool favorite);
+
+    // 按路径排序的成员
+    QVector<SmartTrack> songs(const QString &name) const;
+    int songCount(const QString &name) const;
+
+private:
+    enum FieldMask : quint32 {
+        MaskArtist = 1u << SmartRule::Artist,
+        MaskAlbum = 1u << SmartRule::Album,
+        MaskDuration = 1u << SmartRule::Duration,
+        MaskPlayCount = 1u << SmartRule::PlayCount,
+        MaskAdded = 1u << SmartRule::AddedWithinDays,
+        MaskFavorite = 1u << SmartRule::Favorite,
+        MaskAll = 0x3f
+    };
+
+    struct View
+    {
+        SmartPlaylistDefinition definition;
+        quint32 fields = 0;             // 规则涉及的字段
+        mutable QSet<QString> members;  // 过期成员在读取时移除
+        mutable QStringList ordered;    // 读取时按需排序
+        mutable bool dirty = true;
+    };
+
+    static bool matches(const SmartPlaylistDefinition &definition, const SmartTrack &track, qint64 now);
+    static bool matchRule(const SmartRule &rule, const SmartTrack &track, qint64 now);
+    static quint32 changedFields(const SmartTrack &before, const SmartTrack &after);
+    void rebuild(View &view);
+    void update(const SmartTrack &track, quint32 changed);
+    void expire(const View &view) const;
+    const View *findView(const QString &name) const;
+
+    QHash<QString, SmartTrack> m_tracks;
+    QVector<View> m_views;
+};
+
+#endif // SMARTPLAYLIST_H
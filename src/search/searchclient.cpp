@@ -0,0 +1,205 @@
+#include "searchclient.h"
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QUrlQuery>
+#include <iterator>
+
+namespace {
+const char *const DefaultSearchUrl = "http://mobilecdn.kugou.com/api/v3/search/song";
+}
+
+SearchClient::SearchClient(QNetworkAccessManager *network, QObject *parent)
+    : QObject(parent)
+    , m_network(network)
+    , m_baseUrl(qEnvironmentVariable("XC_SEARCH_URL", DefaultSearchUrl))
+    , m_maxConcurrent(qEnvironmentVariableIsSet("XC_SEARCH_MAX_REQUESTS")
+                          ? qMax(1, qEnvironmentVariableIntValue("XC_SEARCH_MAX_REQUESTS")) : 2)
+{
+}
+
+QUrl SearchClient::pageUrl(const QUrl &base, const QString &keyword, int page, int pageSize)
+{
+    QUrlQuery query;
+    query.addQueryItem("format", "json");
+    // QUrlQuery 不会编码 '+'（服务器会当作空格），先完整编码，已编码的部分 QUrlQuery 原样保留
+    query.addQueryItem("keyword", QString::fromLatin1(QUrl::toPercentEncoding(keyword)));
+    query.addQueryItem("page", QString::number(page));
+    query.addQueryItem("pagesize", QString::number(pageSize));
+    query.addQueryItem("showtype", "1");
+    QUrl url(base);
+    url.setQuery(query);
+    return url;
+}
+
+QVector<SearchResult> SearchClient::parseResponse(const QByteArray &data, int *total, bool *ok)
+{
+    QVector<SearchResult> results;
+    *total = -1;
+    const QJsonDocument document = QJsonDocument::fromJson(data);
+    const QJsonValue dataValue = document.object().value("data");
+    if (ok)
+        *ok = dataValue.isObject() && dataValue.toObject().value("info").isArray();
+    if (!dataValue.isObject())
+        return results;
+
+    const QJsonObject dataObj = dataValue.toObject();
+    if (dataObj.value("total").isDouble())
+        *total = dataObj.value("total").toInt();
+    const QJsonArray info = dataObj.value("info").toArray();
+    results.reserve(info.size());
+    for (const QJsonValue &value : info) {
+        if (!value.isObject())
+            continue;
+        const QJsonObject songObj = value.toObject();
+        SearchResult song;
+        song.title = songObj.value("songname").toString();
+        song.artist = songObj.value("singername").toString();
+        song.durationSec = songObj.value("duration").toInt();
+        song.hash = songObj.value("hash").toString();
+        song.albumId = songObj.value("album_id").toString();
+        results.append(song);
+    }
+    return results;
+}
+
+bool SearchClient::search(const QString &keyword)
+{
+    const QString trimmed = keyword.trimmed();
+    // 同一个关键字还在加载或已有结果时不重复请求
+    if (trimmed == m_keyword && (!m_inFlight.isEmpty() || m_loadedRows > 0))
+        return false;
+
+    abortAll();
+    m_keyword = trimmed;
+    m_nextPage = 1;
+    m_deliverPage = 1;
+    m_lastPage = -1;
+    m_total = -1;
+    m_loadedRows = 0;
+    m_requestCount = 0;
+    m_pages.clear();
+    m_retry.clear();
+    m_failures.clear();
+    m_seen.clear();
+    // 第一页加上预取量
+    m_wantRows = m_keyword.isEmpty() ? 0 : m_pageSize + m_prefetchRows;
+    pump();
+    return true;
+}
+
+void SearchClient::prefetchFor(int row)
+{
+    if (m_keyword.isEmpty())
+        return;
+    m_wantRows = qMax(m_wantRows, row + 1 + m_prefetchRows);
+    pump();
+}
+
+void SearchClient::abortAll()
+{
+    const QList<QNetworkReply *> replies = m_inFlight.values();
+    m_inFlight.clear();
+    for (QNetworkReply *reply : replies) {
+        reply->disconnect(this);
+        reply->abort();
+        reply->deleteLater();
+    }
+}
+
+void SearchClient::pump()
+{
+    const int wantPages = (m_wantRows + m_pageSize - 1) / m_pageSize;
+    while (m_inFlight.size() < m_maxConcurrent) {
+        int page;
+        if (!m_retry.isEmpty()) {
+            page = m_retry.takeFirst();
+            if (m_lastPage >= 0 && page > m_lastPage)
+                continue;
+        } else if (m_nextPage <= wantPages && (m_lastPage < 0 || m_nextPage <= m_lastPage))
+            page = m_nextPage++;
+        else
+            break;
+        request(page);
+    }
+}
+
+void SearchClient::request(int page)
+{
+    QNetworkRequest request(pageUrl(m_baseUrl, m_keyword, page, m_pageSize));
+    request.setHeader(QNetworkRequest::UserAgentHeader, "Mozilla/5.0 ...");
+    request.setRawHeader("Referer", "http://www.kuwo.cn/");
+    QNetworkReply *reply = m_network->get(request);
+    m_inFlight.insert(page, reply);
+    ++m_requestCount;
+    connect(reply, &QNetworkReply::finished, this, [this, reply, page] { onFinished(reply, page); });
+}
+
+void SearchClient::onFinished(QNetworkReply *reply, int page)
+{
+    reply->deleteLater();
+    m_inFlight.remove(page);
+
+    int total = -1;
+    bool ok = false;
+    QVector<SearchResult> results;
+    if (reply->error() == QNetworkReply::NoError)
+        results = parseResponse(reply->readAll(), &total, &ok);
+    if (!ok) {
+        const QString message = reply->error() == QNetworkReply::NoError ? QString("invalid response") : reply->errorString();
+        qDebug() << "Search page" << page << "failed:" << message;
+        if (++m_failures[page] <= MaxRetries) {
+            m_retry.append(page);
+        } else {
+            // 放弃这一页及之后的页，已经取到的结果照常显示
+            m_lastPage = page - 1;
+            emit failed(message);
+        }
+        pump();
+        deliver();
+        return;
+    }
+
+    if (total >= 0) {
+        m_total = total;
+        const int lastPage = (total + m_pageSize - 1) / m_pageSize;
+        m_lastPage = m_lastPage < 0 ? lastPage : qMin(m_lastPage, lastPage);
+    }
+    // 不满一页说明已经到底
+    if (results.size() < m_pageSize)
+        m_lastPage = m_lastPage < 0 ? page : qMin(m_lastPage, page);
+
+    m_pages.insert(page, results);
+    deliver();
+    pump();
+}
+
+void SearchClient::deliver()
+{
+    while (m_lastPage < 0 || m_deliverPage <= m_lastPage) {
+        auto it = m_pages.find(m_deliverPage);
+        if (it == m_pages.end())
+            break;
+        QVector<SearchResult> results;
+        results.reserve(it->size());
+        for (const SearchResult &result : *it) {
+            if (result.hash.isEmpty() || !m_seen.contains(result.hash)) {
+                m_seen.insert(result.hash);
+                results.append(result);
+            }
+        }
+        m_pages.erase(it);
+        ++m_deliverPage;
+        m_loadedRows += results.size();
+        if (!results.isEmpty())
+            emit resultsAppended(results);
+    }
+    // 超出最后一页的结果（总数变小时）不再需要
+    if (m_lastPage >= 0) {
+        while (!m_pages.isEmpty() && m_pages.lastKey() > m_lastPage)
+            m_pages.erase(std::prev(m_pages.end()));
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef SEARCHCLIENT_H
+#define SEARCHCLIENT_H
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+#include <QUrl>
+#include <QVector>
+#include "searchresult.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// 分页在线搜索
+// 界面报告显示到第几行（prefetchFor），客户端保证其后 prefetchRows 行所在的页已经请求，
+// 因此滚动到底之前下一页通常早已到达。同一页只请求一次，同时最多 maxConcurrent 个请求；
+// 各页可能乱序返回，按页序依次通过 resultsAppended 追加，跨页重复的曲目（相同 hash）只保留第一条。
+// 关键字用 QUrlQuery 编码。
+class SearchClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultPageSize = 30;
+    static constexpr int MaxRetries = 2;
+
+    // 环境变量：XC_SEARCH_URL 搜索接口地址，XC_SEARCH_MAX_REQUESTS 并发上限（默认 2）
+    explicit SearchClient(QNetworkAccessManager *network, QObject *parent = nullptr);
+
+    void setBaseUrl(const QUrl &url) { m_baseUrl = url; }
+    QUrl baseUrl() const { return m_baseUrl; }
+    void setPageSize(int size) { m_pageSize = qMax(1, size); }
+    int pageSize() const { return m_pageSize; }
+    void setMaxConcurrent(int count) { m_maxConcurrent = qMax(1, count); }
+    int maxConcurrent() const { return m_maxConcurrent; }
+    // 可见末行之后预先准备的行数，默认两页
+    void setPrefetchRows(int rows) { m_prefetchRows = qMax(0, rows); }
+
+    static QUrl pageUrl(const QUrl &base, const QString &keyword, int page, int pageSize);
+    // 解析一页结果；total 为服务器报告的结果总数（没有时为 -1）
+    static QVector<SearchResult> parseResponse(const QByteArray &data, int *total, bool *ok = nullptr);
+
+    // 开始新的搜索，返回 false 表示与正在进行的搜索相同（不重复请求）
+    bool search(const QString &keyword);
+    // 界面已经显示到第 row 行
+    void prefetchFor(int row);
+
+    QString keyword() const { return m_keyword; }
+    int loadedRows() const { return m_loadedRows; }
+    int total() const { return m_total; }
+    bool hasMore() const { return m_lastPage < 0 || m_deliverPage <= m_lastPage; }
+    int inFlight() const { return m_inFlight.size(); }
+    int requestCount() const { return m_requestCount; }
+
+signals:
+    void resultsAppended(const QVector<SearchResult> &results);
+    void failed(const QString &message);
+
+private:
+    void abortAll();
+    void pump();
+    void request(int page);
+    void onFinished(QNetworkReply *reply, int page);
+    void deliver();
+
+    QNetworkAccessManager *m_network;
+    QUrl m_baseUrl;
+    int m_pageSize = DefaultPageSize;
+    int m_maxConcurrent;
+    int m_prefetchRows = DefaultPageSize * 2;
+
+    // 当前搜索
+    QString m_keyword;
+    int m_wantRows = 0;         // 需要准备好的行数
+    int m_nextPage = 1;         // 下一个尚未请求的页
+    int m_deliverPage = 1;      // 下一个要交给界面的页
+    int m_lastPage = -1;        // 最后一页，未知时为 -1
+    int m_total = -1;
+    int m_loadedRows = 0;
+    int m_requestCount = 0;
+    QHash<int, QNetworkReply *> m_inFlight;
+    QMap<int, QVector<SearchResult>> m_pages;  // 已返回但前面的页还没到
+    QList<int> m_retry;
+    QHash<int, int> m_failures;
+    QSet<QString> m_seen;
+};
+
+#endif // SEARCHCLIENT_H
@@ -0,0 +1,19 @@
+#ifndef SEARCHRESULT_H
+#define SEARCHRESULT_H
+
+#include <QMetaType>
+#include <QString>
+
+// 在线搜索的一条结果，保留播放所需的曲目标识
+struct SearchResult
+{
+    QString title;
+    QString artist;
+    int durationSec = 0;
+    QString hash;           // 曲目标识，用来换取播放地址，也是本地缓存的键
+    QString albumId;
+};
+
+Q_DECLARE_METATYPE(SearchResult)
+
+#endif // SEARCHRESULT_H
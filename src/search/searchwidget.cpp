@@ -1,6 +1,7 @@
 #include "searchwidget.h"
 #include <QVBoxLayout>
 #include <QLabel>
+#include <QScrollBar>
 
 searchwidget::searchwidget(QWidget *parent)
     : QWidget{parent}
@@ -24,11 +25,18 @@ searchwidget::searchwidget(QWidget *parent)
             if (item) {
                 emit songDoubleClicked(item->text());
             }
+            if (row >= 0 && row < m_results.size())
+                emit resultActivated(m_results.at(row));
         });
+
+    connect(tableWidget->verticalScrollBar(), &QScrollBar::valueChanged, this, [this] {
+        emit scrolledTo(lastVisibleRow());
+    });
 }
 
 void searchwidget::displaySearchResults(const QStringList &results)
 {
+    m_results.clear();
     tableWidget->setRowCount(results.size());  // 设置行数
     for (int i = 0; i < results.size(); ++i) {
         QStringList songDetails = results[i].split(",");
@@ -38,3 +46,36 @@ void searchwidget::displaySearchResults(const QStringList &results)
         }
     }
 }
+
+void searchwidget::displaySearchResults(const QVector<SearchResult> &results)
+{
+    clearResults();
+    appendSearchResults(results);
+}
+
+void searchwidget::clearResults()
+{
+    m_results.clear();
+    tableWidget->setRowCount(0);
+}
+
+void searchwidget::appendSearchResults(const QVector<SearchResult> &results)
+{
+    const int first = tableWidget->rowCount();
+    m_results += results;
+    tableWidget->setRowCount(first + results.size());
+    for (int i = 0; i < results.size(); ++i) {
+        const SearchResult &result = results.at(i);
+        tableWidget->setItem(first + i, 0, new QTableWidgetItem(result.title));
+        tableWidget->setItem(first + i, 1, new QTableWidgetItem(result.artist));
+        const QString duration = QString::number(result.durationSec / 60) + "分" + QString::number(result.durationSec % 60) + "秒";
+        tableWidget->setItem(first + i, 2, new QTableWidgetItem(duration));
+    }
+}
+
+int searchwidget::lastVisibleRow() const
+{
+    // 视口底部没有行时（内容不满一屏）取最后一行
+    const int row = tableWidget->rowAt(tableWidget->viewport()->height() - 1);
+    return row >= 0 ? row : tableWidget->rowCount() - 1;
+}
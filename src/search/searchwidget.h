@@ -5,6 +5,7 @@
 #include <QWidget>
 #include <QTableWidget>
 #include <QHeaderView>
+#include "searchresult.h"
 
 class searchwidget : public QWidget
 {
@@ -12,12 +13,22 @@ class searchwidget : public QWidget
 public:
     explicit searchwidget(QWidget *parent = nullptr);
     void displaySearchResults(const QStringList &results);
+    // 带曲目标识的结果，双击时发出 resultActivated
+    void displaySearchResults(const QVector<SearchResult> &results);
+    // 分页加载：清空后逐页追加，已有的行不重建
+    void clearResults();
+    void appendSearchResults(const QVector<SearchResult> &results);
+    int lastVisibleRow() const;
 
 private:
     QTableWidget *tableWidget;
+    QVector<SearchResult> m_results;
 
 Q_SIGNALS:
     void songDoubleClicked(const QString &songName);
+    void resultActivated(const SearchResult &result);
+    // 滚动后可见的最后一行，用于提前加载下一页
+    void scrolledTo(int lastVisibleRow);
 };
 
 #endif // SEARCHWIDGET_H
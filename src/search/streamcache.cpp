@@ -0,0 +1,176 @@
+#include "streamcache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <vector>
+
+namespace {
+const char *const PartialSuffix = ".part";
+const qint64 StalePartialMs = 7LL * 24 * 3600 * 1000;    // 一周没有续传的临时文件直接删除
+}
+
+StreamCache::StreamCache(const QString &directory, qint64 maxBytes)
+    : m_directory(directory)
+    , m_maxBytes(maxBytes)
+{
+    QDir().mkpath(m_directory);
+    scan();
+    evict(QString());
+}
+
+QString StreamCache::hashName(const QString &key)
+{
+    return QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex());
+}
+
+qint64 StreamCache::nextStamp()
+{
+    // 同一毫秒内的多次使用也要分出先后
+    m_lastStamp = qMax(QDateTime::currentMSecsSinceEpoch(), m_lastStamp + 1);
+    return m_lastStamp;
+}
+
+void StreamCache::scan()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const QFileInfoList files = QDir(m_directory).entryInfoList(QDir::Files);
+    for (const QFileInfo &info : files) {
+        const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+        const bool partial = info.fileName().endsWith(PartialSuffix);
+        if (partial && now - modified > StalePartialMs) {
+            QFile::remove(info.absoluteFilePath());
+            continue;
+        }
+        Entry entry;
+        entry.fileName = info.fileName();
+        entry.size = info.size();
+        entry.lastUsed = modified;
+        m_lastStamp = qMax(m_lastStamp, modified);
+        if (partial)
+            m_partials.insert(entry.fileName, entry);
+        else
+            m_entries.insert(info.baseName(), entry);
+        m_totalBytes += entry.size;
+    }
+}
+
+QString StreamCache::lookup(const QString &key)
+{
+    auto it = m_entries.find(hashName(key));
+    if (it == m_entries.end())
+        return QString();
+
+    const QString path = m_directory + "/" + it->fileName;
+    QFile file(path);
+    if (!file.exists()) {
+        m_totalBytes -= it->size;
+        m_entries.erase(it);
+        return QString();
+    }
+    it->lastUsed = nextStamp();
+    if (file.open(QIODevice::ReadWrite))
+        file.setFileTime(QDateTime::fromMSecsSinceEpoch(it->lastUsed), QFileDevice::FileModificationTime);
+    return path;
+}
+
+QString StreamCache::partialPath(const QString &key, const QString &suffix) const
+{
+    QString name = hashName(key);
+    if (!suffix.isEmpty())
+        name += "." + suffix;
+    return m_directory + "/" + name + PartialSuffix;
+}
+
+void StreamCache::beginPartial(const QString &key, const QString &suffix)
+{
+    const auto it = m_partials.constFind(QFileInfo(partialPath(key, suffix)).fileName());
+    if (it == m_partials.cend())
+        return;
+    m_totalBytes -= it->size;
+    m_partials.erase(it);
+}
+
+void StreamCache::endPartial(const QString &key, const QString &suffix)
+{
+    const QFileInfo info(partialPath(key, suffix));
+    if (!info.exists())
+        return;
+    beginPartial(key, suffix);  // 同一个文件只记一次
+    Entry entry;
+    entry.fileName = info.fileName();
+    entry.size = info.size();
+    entry.lastUsed = nextStamp();
+    m_partials.insert(entry.fileName, entry);
+    m_totalBytes += entry.size;
+    evict(QString());
+}
+
+bool StreamCache::commit(const QString &key, const QString &suffix)
+{
+    const QString partial = partialPath(key, suffix);
+    beginPartial(key, suffix);
+    const QString path = partial.left(partial.size() - int(qstrlen(PartialSuffix)));
+    remove(key);
+    QFile::remove(path);
+    if (!QFile::rename(partial, path)) {
+        qWarning() << "Failed to commit stream cache entry" << partial;
+        return false;
+    }
+
+    Entry entry;
+    entry.fileName = QFileInfo(path).fileName();
+    entry.size = QFileInfo(path).size();
+    entry.lastUsed = nextStamp();
+    const QString name = hashName(key);
+    m_entries.insert(name, entry);
+    m_totalBytes += entry.size;
+    evict(name);
+    return true;
+}
+
+void StreamCache::remove(const QString &key)
+{
+    auto it = m_entries.find(hashName(key));
+    if (it == m_entries.end())
+        return;
+    QFile::remove(m_directory + "/" + it->fileName);
+    m_totalBytes -= it->size;
+    m_entries.erase(it);
+}
+
+void StreamCache::evict(const QString &keep)
+{
+    if (m_totalBytes <= m_maxBytes)
+        return;
+
+    // 缓存项不多（几百个），超限时排一次序即可；临时文件与缓存项一起按最久未使用淘汰
+    struct Candidate
+    {
+        qint64 lastUsed;
+        bool partial;
+        QString key;
+
+        bool operator<(const Candidate &other) const { return lastUsed < other.lastUsed; }
+    };
+    std::vector<Candidate> order;
+    order.reserve(m_entries.size() + m_partials.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        if (it.key() != keep)
+            order.push_back({ it->lastUsed, false, it.key() });
+    }
+    for (auto it = m_partials.cbegin(); it != m_partials.cend(); ++it)
+        order.push_back({ it->lastUsed, true, it.key() });
+    std::sort(order.begin(), order.end());
+
+    for (const Candidate &item : order) {
+        if (m_totalBytes <= m_maxBytes)
+            break;
+        const Entry entry = (item.partial ? m_partials : m_entries).take(item.key);
+        QFile::remove(m_directory + "/" + entry.fileName);
+        m_totalBytes -= entry.size;
+    }
+}
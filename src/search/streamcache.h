@@ -0,0 +1,57 @@
+#ifndef STREAMCACHE_H
+#define STREAMCACHE_H
+
+#include <QHash>
+#include <QString>
+
+// 在线播放的磁盘缓存
+// 每首歌一个文件，文件名为键的 SHA-1（保留原扩展名，便于播放后端识别格式）。
+// 下载中的数据写在 .part 文件里，可以断点续传；下载完成后 commit() 转为缓存项。
+// 中途取消或失败留下的临时文件同样计入总大小，超过上限时与缓存项一起按最久未使用淘汰。
+// 使用时间记录在文件修改时间上，重启后仍然有效。
+class StreamCache
+{
+public:
+    StreamCache(const QString &directory, qint64 maxBytes);
+
+    QString directory() const { return m_directory; }
+    qint64 maxBytes() const { return m_maxBytes; }
+    qint64 totalBytes() const { return m_totalBytes; }
+    int count() const { return m_entries.size(); }
+
+    // 已完整缓存时返回文件路径并记为最近使用，否则返回空
+    QString lookup(const QString &key);
+    bool contains(const QString &key) const { return m_entries.contains(hashName(key)); }
+
+    // 下载中使用的临时文件
+    QString partialPath(const QString &key, const QString &suffix) const;
+    // 开始写入临时文件：正在写的文件不参与淘汰，也暂不计入总大小
+    void beginPartial(const QString &key, const QString &suffix);
+    // 没有 commit 就停止写入（取消、失败）：临时文件留作续传，计入总大小后淘汰到上限以内
+    void endPartial(const QString &key, const QString &suffix);
+    // 临时文件下载完成，转为缓存项，然后淘汰到上限以内（刚加入的这一项除外）
+    bool commit(const QString &key, const QString &suffix);
+    void remove(const QString &key);
+
+private:
+    struct Entry
+    {
+        QString fileName;
+        qint64 size = 0;
+        qint64 lastUsed = 0;    // 毫秒时间戳
+    };
+
+    static QString hashName(const QString &key);
+    qint64 nextStamp();
+    void scan();
+    void evict(const QString &keep);
+
+    QString m_directory;
+    qint64 m_maxBytes;
+    qint64 m_totalBytes = 0;
+    qint64 m_lastStamp = 0;
+    QHash<QString, Entry> m_entries;    // 键的 SHA-1 → 缓存项
+    QHash<QString, Entry> m_partials;   // 没在写入的临时文件名 → 临时文件
+};
+
+#endif // STREAMCACHE_H
@@ -0,0 +1,403 @@
+#include "streamloader.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <algorithm>
+#include <limits>
+
+namespace {
+const qint64 ServeBytes = 64 * 1024;           // 每次写给播放器的块大小
+const qint64 SocketHighWater = 512 * 1024;     // 播放器读得慢时，套接字里最多积压这么多
+const int MaxRequestHeader = 16 * 1024;
+
+// "bytes 0-1048575/5242880" 中的总长度，未知（*）时返回 -1
+qint64 totalFromContentRange(const QByteArray &value)
+{
+    const int slash = value.lastIndexOf('/');
+    if (slash < 0)
+        return -1;
+    bool ok = false;
+    const qint64 total = value.mid(slash + 1).trimmed().toLongLong(&ok);
+    return ok ? total : -1;
+}
+
+QByteArray headerValue(const QList<QByteArray> &lines, const QByteArray &name)
+{
+    for (const QByteArray &line : lines) {
+        const int colon = line.indexOf(':');
+        if (colon > 0 && line.left(colon).trimmed().toLower() == name)
+            return line.mid(colon + 1).trimmed();
+    }
+    return QByteArray();
+}
+}
+
+StreamLoader::StreamLoader(StreamCache *cache, QObject *parent)
+    : QObject(parent)
+    , m_cache(cache)
+    , m_network(new QNetworkAccessManager(this))
+    , m_server(new QTcpServer(this))
+{
+    connect(m_server, &QTcpServer::newConnection, this, &StreamLoader::onNewConnection);
+}
+
+StreamLoader::~StreamLoader()
+{
+    cancel();
+}
+
+QUrl StreamLoader::cachedUrl(const QString &key)
+{
+    const QString path = m_cache->lookup(key);
+    return path.isEmpty() ? QUrl() : QUrl::fromLocalFile(path);
+}
+
+void StreamLoader::load(const QString &key, const QUrl &remote)
+{
+    cancel();
+
+    const QUrl cached = cachedUrl(key);
+    if (!cached.isEmpty()) {
+        emit ready(cached);
+        return;
+    }
+
+    if (!m_server->isListening() && !m_server->listen(QHostAddress::LocalHost)) {
+        emit failed(m_server->errorString());
+        return;
+    }
+
+    // 扩展名只保留常见的短后缀，播放后端靠它识别格式
+    m_suffix = QFileInfo(remote.path()).suffix().toLower();
+    if (m_suffix.size() > 5 || !std::all_of(m_suffix.cbegin(), m_suffix.cend(), [](QChar c) { return c.isLetterOrNumber(); }))
+        m_suffix.clear();
+
+    m_part.setFileName(m_cache->partialPath(key, m_suffix));
+    m_cache->beginPartial(key, m_suffix);
+    if (!m_part.open(QIODevice::ReadWrite)) {
+        m_cache->endPartial(key, m_suffix);
+        emit failed(m_part.errorString());
+        return;
+    }
+    // 上次没下完的部分直接续传
+    m_received = m_part.size();
+    m_part.seek(m_received);
+
+    m_key = key;
+    m_remote = remote;
+    m_urlPath = "/" + QFileInfo(m_part.fileName()).completeBaseName();
+    requestChunk();
+}
+
+void StreamLoader::cancel()
+{
+    ++m_generation;
+    if (m_reply) {
+        QNetworkReply *reply = m_reply;
+        m_reply = nullptr;
+        reply->disconnect(this);
+        reply->abort();
+        reply->deleteLater();
+    }
+    dropClients();
+    m_part.close();
+    // 没有转入缓存的临时文件交还给缓存计数，超出上限时会被淘汰
+    if (!m_key.isEmpty() && m_cachedPath.isEmpty())
+        m_cache->endPartial(m_key, m_suffix);
+
+    m_key.clear();
+    m_suffix.clear();
+    m_urlPath.clear();
+    m_cachedPath.clear();
+    m_remote.clear();
+    m_contentType.clear();
+    m_requestOffset = 0;
+    m_received = 0;
+    m_total = -1;
+    m_retries = 0;
+    m_ready = false;
+    m_complete = false;
+}
+
+QUrl StreamLoader::serverUrl() const
+{
+    return QUrl(QString("http://127.0.0.1:%1%2").arg(m_server->serverPort()).arg(m_urlPath));
+}
+
+void StreamLoader::requestChunk()
+{
+    QNetworkRequest request(m_remote);
+    m_requestOffset = m_received;
+    request.setRawHeader("Range", "bytes=" + QByteArray::number(m_requestOffset) + "-"
+                                      + QByteArray::number(m_requestOffset + ChunkBytes - 1));
+    m_reply = m_network->get(request);
+    connect(m_reply, &QNetworkReply::readyRead, this, &StreamLoader::onReadyRead);
+    connect(m_reply, &QNetworkReply::finished, this, &StreamLoader::onChunkFinished);
+}
+
+void StreamLoader::onReadyRead()
+{
+    const int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status >= 300)
+        return;     // 错误页面的内容不写入文件，由 onChunkFinished 处理
+
+    if (status == 206) {
+        const qint64 total = totalFromContentRange(m_reply->rawHeader("Content-Range"));
+        if (total >= 0)
+            m_total = total;
+    } else if (m_requestOffset > 0) {
+        // 服务器忽略了 Range，返回的是整个文件，从头写起
+        m_part.resize(0);
+        m_part.seek(0);
+        m_received = 0;
+        m_requestOffset = 0;
+    }
+    if (status != 206 && m_total < 0) {
+        const QVariant length = m_reply->header(QNetworkRequest::ContentLengthHeader);
+        if (length.isValid())
+            m_total = length.toLongLong();
+    }
+    if (m_contentType.isEmpty())
+        m_contentType = m_reply->header(QNetworkRequest::ContentTypeHeader).toByteArray();
+
+    const QByteArray data = m_reply->readAll();
+    if (data.isEmpty())
+        return;
+    m_part.write(data);
+    m_part.flush();
+    m_received += data.size();
+    emit progress(m_received, m_total);
+
+    if (!m_ready && m_received >= m_prebufferBytes) {
+        m_ready = true;
+        emit ready(serverUrl());
+    }
+    for (const auto &client : m_clients)
+        pump(client.get());
+}
+
+void StreamLoader::onChunkFinished()
+{
+    QNetworkReply *reply = m_reply;
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->error() == QNetworkReply::NoError)
+        onReadyRead();
+    m_reply = nullptr;
+    reply->deleteLater();
+
+    // 续传时临时文件其实已经完整
+    if (status == 416 && m_received > 0) {
+        m_total = m_received;
+        complete();
+        return;
+    }
+
+    if (reply->error() != QNetworkReply::NoError) {
+        if (++m_retries > MaxRetries) {
+            qWarning() << "Stream download failed:" << m_remote << reply->errorString();
+            emit failed(reply->errorString());
+            return;
+        }
+        // 稍等后从断点重试
+        QTimer::singleShot(1000 * m_retries, this, [this, generation = m_generation] {
+            if (generation == m_generation && !m_reply)
+                requestChunk();
+        });
+        return;
+    }
+    m_retries = 0;
+
+    if (status != 206) {
+        // 整个文件一次返回
+        m_total = m_received;
+        complete();
+    } else if (m_total >= 0 ? m_received >= m_total : m_received - m_requestOffset < ChunkBytes) {
+        m_total = m_received;
+        complete();
+    } else if (m_received == m_requestOffset) {
+        emit failed("empty range response");
+    } else {
+        requestChunk();
+    }
+}
+
+void StreamLoader::complete()
+{
+    m_complete = true;
+    m_part.flush();
+    if (!m_ready) {
+        // 整首都没有预缓冲大，直接转入缓存播放本地文件
+        m_ready = true;
+        commitIfIdle();
+        emit ready(m_cachedPath.isEmpty() ? serverUrl() : QUrl::fromLocalFile(m_cachedPath));
+        return;
+    }
+    for (const auto &client : m_clients)
+        pump(client.get());
+    commitIfIdle();
+}
+
+void StreamLoader::commitIfIdle()
+{
+    // 播放器还连着时不改文件名（Windows 上打开的文件不能重命名），等连接全部断开
+    if (!m_complete || !m_cachedPath.isEmpty() || !m_clients.empty())
+        return;
+    m_part.close();
+    if (!m_cache->commit(m_key, m_suffix))
+        return;
+    m_cachedPath = m_cache->lookup(m_key);
+    emit finished(m_cachedPath);
+}
+
+void StreamLoader::onNewConnection()
+{
+    while (m_server->hasPendingConnections()) {
+        QTcpSocket *socket = m_server->nextPendingConnection();
+        auto client = std::make_unique<Client>();
+        client->socket = socket;
+        Client *raw = client.get();
+        m_clients.push_back(std::move(client));
+        connect(socket, &QTcpSocket::readyRead, this, [this, raw] { onClientData(raw); });
+        connect(socket, &QTcpSocket::bytesWritten, this, [this, raw] { pump(raw); });
+        // 断开可能在 pump() 遍历连接时同步发生，排队处理以免在遍历中删除
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket = QPointer<QTcpSocket>(socket)] {
+            if (!socket)
+                return;
+            for (const auto &client : m_clients) {
+                if (client->socket == socket) {
+                    dropClient(client.get());
+                    return;
+                }
+            }
+        }, Qt::QueuedConnection);
+    }
+}
+
+void StreamLoader::onClientData(Client *client)
+{
+    if (client->headerDone) {
+        client->socket->readAll();
+        return;
+    }
+    client->request += client->socket->readAll();
+    if (client->request.contains("\r\n\r\n")) {
+        client->headerDone = true;
+        respond(client);
+    } else if (client->request.size() > MaxRequestHeader) {
+        dropClient(client);
+    }
+}
+
+void StreamLoader::respond(Client *client)
+{
+    const QList<QByteArray> lines = client->request.split('\n');
+    const QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+    const QByteArray method = requestLine.value(0);
+    const bool head = method == "HEAD";
+    QTcpSocket *socket = client->socket;
+
+    bool found = (method == "GET" || head) && !m_key.isEmpty() && requestLine.value(1) == m_urlPath.toUtf8();
+    if (found) {
+        client->file.setFileName(m_cachedPath.isEmpty() ? m_part.fileName() : m_cachedPath);
+        found = client->file.open(QIODevice::ReadOnly);
+    }
+    if (!found) {
+        socket->write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        socket->disconnectFromHost();
+        return;
+    }
+
+    QByteArray header;
+    const QByteArray range = headerValue(lines, "range");
+    if (m_total < 0) {
+        // 总长度未知时不支持 Range，从头顺序供数直到下载结束
+        header = "HTTP/1.1 200 OK\r\n";
+    } else if (range.startsWith("bytes=")) {
+        const QList<QByteArray> bounds = range.mid(6).split(',').value(0).split('-');
+        const QByteArray first = bounds.value(0).trimmed();
+        const QByteArray last = bounds.value(1).trimmed();
+        if (first.isEmpty()) {
+            client->position = qMax<qint64>(0, m_total - last.toLongLong());
+            client->end = m_total - 1;
+        } else {
+            client->position = first.toLongLong();
+            client->end = last.isEmpty() ? m_total - 1 : qMin(last.toLongLong(), m_total - 1);
+        }
+        if (client->position >= m_total || client->end < client->position) {
+            socket->write("HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: bytes */"
+                          + QByteArray::number(m_total) + "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+            socket->disconnectFromHost();
+            return;
+        }
+        header = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes " + QByteArray::number(client->position) + "-"
+                 + QByteArray::number(client->end) + "/" + QByteArray::number(m_total) + "\r\nContent-Length: "
+                 + QByteArray::number(client->end - client->position + 1) + "\r\n";
+    } else {
+        client->end = m_total - 1;
+        header = "HTTP/1.1 200 OK\r\nContent-Length: " + QByteArray::number(m_total) + "\r\n";
+    }
+    header += "Accept-Ranges: bytes\r\nContent-Type: "
+              + (m_contentType.isEmpty() ? QByteArray("application/octet-stream") : m_contentType)
+              + "\r\nConnection: close\r\n\r\n";
+    socket->write(header);
+
+    if (head) {
+        socket->disconnectFromHost();
+        return;
+    }
+    pump(client);
+}
+
+void StreamLoader::pump(Client *client)
+{
+    if (!client->headerDone || !client->file.isOpen())
+        return;
+
+    // 尚未下载到的部分等 onReadyRead 收到数据后再写
+    const qint64 available = m_received;
+    const qint64 last = client->end >= 0 ? client->end : std::numeric_limits<qint64>::max();
+    QTcpSocket *socket = client->socket;
+    while (socket->bytesToWrite() < SocketHighWater && client->position <= last && client->position < available) {
+        const qint64 bytes = std::min({ ServeBytes, last - client->position + 1, available - client->position });
+        if (!client->file.seek(client->position))
+            break;
+        const QByteArray data = client->file.read(bytes);
+        if (data.isEmpty())
+            break;
+        socket->write(data);
+        client->position += data.size();
+    }
+
+    if (client->position > last || (m_complete && client->position >= available)) {
+        client->file.close();
+        socket->disconnectFromHost();     // 先写完缓冲区中的数据再断开
+    }
+}
+
+void StreamLoader::dropClient(Client *client)
+{
+    auto it = std::find_if(m_clients.begin(), m_clients.end(),
+                           [client](const std::unique_ptr<Client> &item) { return item.get() == client; });
+    if (it == m_clients.end())
+        return;
+    client->socket->disconnect(this);
+    client->socket->abort();
+    client->socket->deleteLater();
+    m_clients.erase(it);
+    commitIfIdle();
+}
+
+void StreamLoader::dropClients()
+{
+    for (const auto &client : m_clients) {
+        client->socket->disconnect(this);
+        client->socket->abort();
+        client->socket->deleteLater();
+    }
+    m_clients.clear();
+    commitIfIdle();
+}
@@ -0,0 +1,105 @@
+#ifndef STREAMLOADER_H
+#define STREAMLOADER_H
+
+#include <QFile>
+#include <QObject>
+#include <QPointer>
+#include <QUrl>
+#include <vector>
+#include <memory>
+#include "streamcache.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTcpServer;
+class QTcpSocket;
+
+// 在线歌曲的渐进式加载
+// 用 HTTP Range 请求按块（1 MB）顺序下载到缓存目录的临时文件里，出错时从断点重试；
+// 缓冲到 prebufferBytes 后发出 ready()，交给播放器的是本机回环地址上的一个 HTTP 地址，
+// 由加载器一边下载一边从临时文件供数（支持播放器自己的 Range 请求，尚未下载到的部分等待下载）。
+// 下载完成后转入 StreamCache，再次播放时 cachedUrl() 直接返回本地文件。
+// 同一时间只加载一首，load() 新的歌曲会取消上一首（已下载的部分保留，下次续传）。
+class StreamLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr qint64 ChunkBytes = 1024 * 1024;
+    static constexpr int MaxRetries = 3;
+
+    explicit StreamLoader(StreamCache *cache, QObject *parent = nullptr);
+    ~StreamLoader() override;
+
+    void setPrebufferBytes(qint64 bytes) { m_prebufferBytes = bytes; }
+    qint64 prebufferBytes() const { return m_prebufferBytes; }
+
+    // 已缓存时返回本地文件地址（并记为最近使用），否则返回空
+    QUrl cachedUrl(const QString &key);
+
+    void load(const QString &key, const QUrl &remote);
+    void cancel();
+
+    QString currentKey() const { return m_key; }
+    qint64 received() const { return m_received; }
+    qint64 totalSize() const { return m_total; }
+
+signals:
+    // 可以开始播放；url 为本机回环地址（下载中）或本地文件（已缓存）
+    void ready(const QUrl &url);
+    void progress(qint64 received, qint64 total);
+    // 下载完成并转入缓存
+    void finished(const QString &cachedPath);
+    void failed(const QString &message);
+
+private:
+    struct Client
+    {
+        QTcpSocket *socket = nullptr;
+        QByteArray request;
+        bool headerDone = false;
+        qint64 position = 0;
+        qint64 end = -1;        // 含；-1 表示到文件末尾
+        QFile file;
+    };
+
+    void requestChunk();
+    void onReadyRead();
+    void onChunkFinished();
+    void complete();
+    void commitIfIdle();
+    QUrl serverUrl() const;
+
+    void onNewConnection();
+    void onClientData(Client *client);
+    void respond(Client *client);
+    void pump(Client *client);
+    void dropClient(Client *client);
+    void dropClients();
+
+    StreamCache *m_cache;
+    QNetworkAccessManager *m_network;
+    QTcpServer *m_server;
+    qint64 m_prebufferBytes = 256 * 1024;
+
+    // 当前加载的歌曲
+    QString m_key;
+    QString m_suffix;
+    QString m_urlPath;          // 回环地址上的路径
+    QString m_cachedPath;       // 转入缓存后的文件，之后的连接从这里读
+    QUrl m_remote;
+    QByteArray m_contentType;
+    QFile m_part;
+    QPointer<QNetworkReply> m_reply;
+    qint64 m_requestOffset = 0;
+    qint64 m_received = 0;
+    qint64 m_total = -1;        // 未知时为 -1
+    int m_retries = 0;
+    int m_generation = 0;       // 每次 load/cancel 加一，丢弃过期的重试
+    bool m_ready = false;
+    bool m_complete = false;
+
+    std::vector<std::unique_ptr<Client>> m_clients;
+};
+
+#endif // STREAMLOADER_H
@@ -0,0 +1,146 @@
+#include "equalizerwidget.h"
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QSignalBlocker>
+#include <QVBoxLayout>
+
+namespace {
+const int SliderScale = 10;     // 滑块以 0.1 dB 为单位
+
+QString frequencyText(float frequency)
+{
+    return frequency >= 1000.0f ? QString("%1k").arg(frequency / 1000.0f) : QString::number(frequency);
+}
+}
+
+equalizerwidget::equalizerwidget(Equalizer *equalizer, EqualizerPresets *presets, QWidget *parent)
+    : QWidget{parent, Qt::Tool}
+    , m_equalizer(equalizer)
+    , m_presets(presets)
+{
+    setWindowTitle("均衡器");
+
+    m_presetBox = new QComboBox(this);
+    m_presetBox->addItems(EqualizerPresets::builtinNames());
+    m_scopeLabel = new QLabel(this);
+    QHBoxLayout *topLayout = new QHBoxLayout;
+    topLayout->addWidget(new QLabel("预设:", this));
+    topLayout->addWidget(m_presetBox);
+    topLayout->addStretch();
+    topLayout->addWidget(m_scopeLabel);
+
+    QGridLayout *bandLayout = new QGridLayout;
+    const int maxValue = int(Equalizer::MaxGainDb) * SliderScale;
+    for (int i = 0; i < Equalizer::BandCount; ++i) {
+        m_values[i] = new QLabel("0.0", this);
+        m_values[i]->setAlignment(Qt::AlignCenter);
+        m_sliders[i] = new QSlider(Qt::Vertical, this);
+        m_sliders[i]->setRange(-maxValue, maxValue);
+        m_sliders[i]->setPageStep(SliderScale);
+        m_sliders[i]->setMinimumHeight(140);
+        QLabel *frequency = new QLabel(frequencyText(m_equalizer->band(i).frequency), this);
+        frequency->setAlignment(Qt::AlignCenter);
+        bandLayout->addWidget(m_values[i], 0, i, Qt::AlignHCenter);
+        bandLayout->addWidget(m_sliders[i], 1, i, Qt::AlignHCenter);
+        bandLayout->addWidget(frequency, 2, i, Qt::AlignHCenter);
+
+        // 拖动时直接修改增益，均衡器内部平滑过渡
+        connect(m_sliders[i], &QSlider::valueChanged, this, [this, i](int value) {
+            const float gain = float(value) / SliderScale;
+            m_values[i]->setText(QString::number(gain, 'f', 1));
+            m_equalizer->setGain(i, gain);
+        });
+    }
+
+    QPushButton *saveTrack = new QPushButton("保存到本曲", this);
+    m_savePlaylist = new QPushButton("保存到歌单", this);
+    QPushButton *saveDefault = new QPushButton("设为默认", this);
+    QPushButton *clear = new QPushButton("清除本曲/歌单设置", this);
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    buttonLayout->addWidget(saveTrack);
+    buttonLayout->addWidget(m_savePlaylist);
+    buttonLayout->addWidget(saveDefault);
+    buttonLayout->addWidget(clear);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(topLayout);
+    layout->addLayout(bandLayout);
+    layout->addLayout(buttonLayout);
+    setLayout(layout);
+
+    connect(m_presetBox, &QComboBox::activated, this, [this](int index) {
+        setGains(EqualizerPresets::builtin(m_presetBox->itemText(index)));
+    });
+    connect(saveTrack, &QPushButton::clicked, this, [this] {
+        if (m_trackPath.isEmpty())
+            return;
+        m_presets->setTrackGains(m_trackPath, sliderGains());
+        updateScopeButtons();
+        emit presetsChanged();
+    });
+    connect(m_savePlaylist, &QPushButton::clicked, this, [this] {
+        if (m_playlist.isEmpty())
+            return;
+        m_presets->setPlaylistGains(m_playlist, sliderGains());
+        updateScopeButtons();
+        emit presetsChanged();
+    });
+    connect(saveDefault, &QPushButton::clicked, this, [this] {
+        m_presets->setDefaultGains(sliderGains());
+        updateScopeButtons();
+        emit presetsChanged();
+    });
+    connect(clear, &QPushButton::clicked, this, [this] {
+        m_presets->clearTrack(m_trackPath);
+        m_presets->clearPlaylist(m_playlist);
+        setGains(m_presets->gainsFor(m_trackPath, m_playlist));
+        updateScopeButtons();
+        emit presetsChanged();
+    });
+
+    refresh();
+}
+
+void equalizerwidget::setContext(const QString &trackPath, const QString &playlist)
+{
+    m_trackPath = trackPath;
+    m_playlist = playlist;
+    updateScopeButtons();
+}
+
+void equalizerwidget::refresh()
+{
+    const Equalizer::Gains gains = m_equalizer->gains();
+    for (int i = 0; i < Equalizer::BandCount; ++i) {
+        // 只同步界面，不再写回均衡器
+        const QSignalBlocker blocker(m_sliders[i]);
+        m_sliders[i]->setValue(qRound(gains[i] * SliderScale));
+        m_values[i]->setText(QString::number(gains[i], 'f', 1));
+    }
+}
+
+void equalizerwidget::setGains(const Equalizer::Gains &gains)
+{
+    m_equalizer->setGains(gains);
+    refresh();
+}
+
+Equalizer::Gains equalizerwidget::sliderGains() const
+{
+    Equalizer::Gains gains;
+    for (int i = 0; i < Equalizer::BandCount; ++i)
+        gains[i] = float(m_sliders[i]->value()) / SliderScale;
+    return gains;
+}
+
+void equalizerwidget::updateScopeButtons()
+{
+    m_savePlaylist->setEnabled(!m_playlist.isEmpty());
+
+    QString scope = "默认设置";
+    if (m_presets->hasTrack(m_trackPath))
+        scope = "本曲设置";
+    else if (!m_playlist.isEmpty() && m_presets->hasPlaylist(m_playlist))
+        scope = QString("歌单“%1”的设置").arg(m_playlist);
+    m_scopeLabel->setText(scope);
+}
@@ -0,0 +1,44 @@
+#ifndef EQUALIZERWIDGET_H
+#define EQUALIZERWIDGET_H
+
+#include <QWidget>
+#include <QComboBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QSlider>
+#include "../audio/equalizer.h"
+#include "../audio/equalizerpresets.h"
+
+// 均衡器面板：10 个滑块直接修改均衡器增益（过渡由均衡器平滑处理），
+// 可以套用内置预设，或把当前设置保存给当前歌曲/歌单/默认
+class equalizerwidget : public QWidget
+{
+    Q_OBJECT
+public:
+    equalizerwidget(Equalizer *equalizer, EqualizerPresets *presets, QWidget *parent = nullptr);
+
+    // 当前歌曲和歌单，保存预设时使用
+    void setContext(const QString &trackPath, const QString &playlist);
+    // 从均衡器重新读取增益（切歌套用预设后调用）
+    void refresh();
+
+Q_SIGNALS:
+    void presetsChanged();
+
+private:
+    void setGains(const Equalizer::Gains &gains);
+    Equalizer::Gains sliderGains() const;
+    void updateScopeButtons();
+
+    Equalizer *m_equalizer;
+    EqualizerPresets *m_presets;
+    QSlider *m_sliders[Equalizer::BandCount];
+    QLabel *m_values[Equalizer::BandCount];
+    QComboBox *m_presetBox;
+    QLabel *m_scopeLabel;
+    QPushButton *m_savePlaylist;
+    QString m_trackPath;
+    QString m_playlist;
+};
+
+#endif // EQUALIZERWIDGET_H
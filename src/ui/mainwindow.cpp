@@ -7,6 +7,26 @@
 #include <QInputDialog>
 #include "../lyrics/lrcwidget.h"
 #include "../playlist/playlist_interface.h"
+#include "../core/tracer.h"
+#include <QShortcut>
+#include <QMetaEnum>
+#include <QTimer>
+#include "../core/startupmetrics.h"
+#include "../library/libraryscanner.h"
+#include "equalizerwidget.h"
+#include <QScrollBar>
+#include <QMenu>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace {
+// 播放列表条目上除路径（Qt::UserRole）以外的排序信息
+enum QueueRole { TitleRole = Qt::UserRole + 1, ArtistRole, DurationRole };
+// 标签缓存，与 xc-cli index 使用同一个文件
+const char *const LibraryCachePath = "./data/library_cache.json";
+}
 bool MainWindow::eventFilter(QObject *watched, QEvent *event)
 {
 
@@ -31,7 +51,7 @@ bool MainWindow::eventFilter(QObject *watched, QEvent *event)
             int clickedValue = ui->sliderPosition->minimum() + ((ui->sliderPosition->maximum() - ui->sliderPosition->minimum()) * mouseEvent->pos().x() / ui->sliderPosition->width());
             qDebug() << "触发了点击事件，位置为:" << clickedValue << Qt::endl;
             ui->sliderPosition->setValue(clickedValue);
-            player->setPosition(clickedValue); // 设置播放器位置
+            seekPlayer(clickedValue); // 设置播放器位置
 
             return true;
 
@@ -43,7 +63,7 @@ bool MainWindow::eventFilter(QObject *watched, QEvent *event)
         if (mouseEvent->buttons() & Qt::LeftButton) {
             int draggedValue = ui->sliderPosition->minimum() + ((ui->sliderPosition->maximum() - ui->sliderPosition->minimum()) * mouseEvent->pos().x() / ui->sliderPosition->width());
             ui->sliderPosition->setValue(draggedValue); // 更新滑块的值
-            player->setPosition(draggedValue); // 设置播放器位置
+            seekPlayer(draggedValue); // 设置播放器位置
             return true;
         }
     }
@@ -62,44 +82,204 @@ MainWindow::MainWindow(QWidget *parent)
 
     isDragging = false;
     setWindowFlags(Qt::FramelessWindowHint);
-    loadSavedMusic();
     ui->listWidget->installEventFilter(this);
     ui->sliderPosition->installEventFilter(this);
-    player = new QMediaPlayer(this);
-    lrcWidget = new lrcwidget(this);
-    //lrcWidget->raise();
-    lrcWidget->hide();
-    QAudioOutput *audioOutput = new QAudioOutput(this);
-    player->setAudioOutput(audioOutput);
-    
-    // 初始化收藏夹和歌单功能
-    m_playlistInterface = new PlaylistInterface(this);
-    m_playlistInterface->initialize();
-    updatePlaylistList(); // 加载并显示歌单列表
-    
+    // 播放引擎：默认 QMediaPlayer，XC_AUDIO_ENGINE=stream 时使用自己的解码/DSP/输出流水线。
+    // 引擎的 audioBufferReceived 是音频分接，供频谱显示使用
+    player = AudioEngine::create(this);
+
+    // 歌词界面、搜索窗口、网络和歌单管理器都延迟到首次绘制之后（或首次使用时）再创建，
+    // 音乐目录扫描也放到空闲时进行，见 runDeferredInit()
+    lrcWidget = nullptr;
+    searchWidget = nullptr;
+    networkManager = nullptr;
+    searchClient = nullptr;
+    streamCache = nullptr;
+    streamLoader = nullptr;
+    m_playlistInterface = nullptr;
+
     // 连接添加到歌单按钮信号
     connect(ui->btnAddToPlaylist, &QPushButton::clicked, this, &MainWindow::on_actionAdd_to_Playlist_triggered);
     // 连接加载歌单按钮信号
     connect(ui->btnLoadPlaylist, &QPushButton::clicked, this, &MainWindow::on_actionLoad_Playlist_triggered);
 
-    searchWidget = new searchwidget(this);
-    searchWidget->resize(760, 405);  // 设置宽度和高度为500像素
-    searchWidget->move(11, 52);  // 将searchWidget移动到(100, 100)的位置
-    searchWidget->hide();
-    networkManager = new QNetworkAccessManager(this);
+    // 右键菜单：按标题/艺术家/时长/文件名排序
+    ui->listWidget->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(ui->listWidget, &QListWidget::customContextMenuRequested, this, &MainWindow::showQueueMenu);
+
+    // 列表滚动接近底部时加载下一页曲库
+    connect(ui->listWidget->verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value) {
+        QScrollBar *bar = ui->listWidget->verticalScrollBar();
+        if (libraryPaging && value >= bar->maximum() - bar->pageStep())
+            fetchLibraryPage();
+    });
+
+    // 歌词目录：同目录没有 .lrc 且没有内嵌歌词时在这里查找
+    lyricResolver.setLyricsDirectory(qEnvironmentVariable("XC_LYRICS_DIR", "./data/lyrics"));
+
+    // 播放时钟：歌词等按帧取样，需先于其他位置回调更新
+    playbackClock.setOutputLatency(qEnvironmentVariableIntValue("XC_OUTPUT_LATENCY_MS"));
+    connect(player, &AudioEngine::positionChanged, this, [this](qint64 position) {
+        playbackClock.update(position);
+    });
+    connect(player, &AudioEngine::playbackStateChanged, this, [this](QMediaPlayer::PlaybackState state) {
+        playbackClock.setPlaying(state == QMediaPlayer::PlayingState);
+    });
+    connect(player, &AudioEngine::playbackRateChanged, this, [this](qreal rate) {
+        playbackClock.setRate(rate);
+    });
+    connect(player, &AudioEngine::sourceChanged, this, [this] {
+        // 设置 XC_CLOCK_STATS 后每首歌输出一次报告位置与时钟外推位置的偏差
+        if (qEnvironmentVariableIsSet("XC_CLOCK_STATS")) {
+            const PlaybackClock::DriftStats stats = playbackClock.driftStats();
+            if (stats.samples > 0)
+                qDebug() << "Playback clock drift (ms): mean" << stats.meanAbsMs << "max" << stats.maxAbsMs
+                         << "over" << stats.samples << "updates";
+        }
+        playbackClock.resetDriftStats();
+        playbackClock.reset(0);
+    });
+
+    // 预读器：慢速存储（SMB/NFS）上减少切歌和跳转的卡顿
+    prefetcher = new Prefetcher;
+    prefetchThread = new QThread(this);
+    prefetcher->moveToThread(prefetchThread);
+    connect(prefetchThread, &QThread::finished, prefetcher, &QObject::deleteLater);
+    prefetchThread->start();
+    connect(player, &AudioEngine::positionChanged, this, [this](qint64 position) {
+        prefetcher->setPosition(position, player->duration());
+        if (seekTarget >= 0 && qAbs(position - seekTarget) < 1000) {
+            prefetcher->noteWait(Prefetcher::SeekWait, seekWait.elapsed());
+            seekTarget = -1;
+        }
+    });
+    connect(player, &AudioEngine::mediaStatusChanged, this, [this](QMediaPlayer::MediaStatus status) {
+        switch (status) {
+        case QMediaPlayer::StalledMedia:
+        case QMediaPlayer::BufferingMedia:
+            if (!bufferWait.isValid())
+                bufferWait.start();
+            break;
+        case QMediaPlayer::LoadedMedia:
+        case QMediaPlayer::BufferedMedia:
+        case QMediaPlayer::EndOfMedia:
+        case QMediaPlayer::InvalidMedia:
+            if (loadWait.isValid()) {
+                prefetcher->noteWait(Prefetcher::LoadWait, loadWait.elapsed());
+                loadWait.invalidate();
+            }
+            if (bufferWait.isValid()) {
+                prefetcher->noteWait(Prefetcher::BufferWait, bufferWait.elapsed());
+                bufferWait.invalidate();
+            }
+            break;
+        default:
+            break;
+        }
+    });
+
+    // 音量按钮右键打开均衡器
+    if (player->equalizer()) {
+        eqPresets.load("./data/equalizer.json");
+        ui->btnSound->setContextMenuPolicy(Qt::CustomContextMenu);
+        connect(ui->btnSound, &QWidget::customContextMenuRequested, this, &MainWindow::showEqualizer);
+    }
 
+    connect(player, &AudioEngine::positionChanged, this, &MainWindow::do_positionChanged);
+    connect(player, &AudioEngine::durationChanged, this, &MainWindow::do_durationChanged);
+    connect(player, &AudioEngine::sourceChanged, this, &MainWindow::do_sourceChanged);
+    connect(player, &AudioEngine::playbackStateChanged, this, &MainWindow::do_playbackStateChanged);
+    connect(player, &AudioEngine::metaDataChanged, this, &MainWindow::do_metaDataChanged);
+    connect(player, &AudioEngine::mediaStatusChanged, this, &MainWindow::do_mediaStatusChanged);
+
+    // 切歌追踪：第一块解码音频送达输出即视为“第一帧可听”
+    if (Tracer::instance().isEnabled()) {
+        connect(player, &AudioEngine::audioBufferReceived, this, [](const QAudioBuffer &) {
+            Tracer::instance().markFirstAudioFrame();
+        }, Qt::DirectConnection);
+        // Ctrl+Shift+T 立即导出追踪文件
+        QShortcut *dumpShortcut = new QShortcut(QKeySequence("Ctrl+Shift+T"), this);
+        connect(dumpShortcut, &QShortcut::activated, this, [] {
+            Tracer &tracer = Tracer::instance();
+            tracer.dumpChromeTrace(tracer.defaultDumpPath());
+            qDebug().noquote() << "Trace written to" << tracer.defaultDumpPath() << "\n" << tracer.summary();
+        });
+    }
+}
 
-    connect(player, &QMediaPlayer::positionChanged, this, &MainWindow::do_positionChanged);
-    connect(player, &QMediaPlayer::durationChanged, this, &MainWindow::do_durationChanged);
-    connect(player, &QMediaPlayer::sourceChanged, this, &MainWindow::do_sourceChanged);
-    connect(player, &QMediaPlayer::playbackStateChanged, this, &MainWindow::do_playbackStateChanged);
-    connect(player, &QMediaPlayer::metaDataChanged, this, &MainWindow::do_metaDataChanged);
+void MainWindow::paintEvent(QPaintEvent *event)
+{
+    QMainWindow::paintEvent(event);
 
-    //链接歌词界面
-    connect(player, &QMediaPlayer::positionChanged, lrcWidget, &lrcwidget::updateLyrics);
+    // 第一次绘制完成后，把其余初始化工作排到事件循环空闲时执行
+    if (!firstPaintDone) {
+        firstPaintDone = true;
+        StartupMetrics::markFirstPaint();
+        QTimer::singleShot(0, this, &MainWindow::runDeferredInit);
+    }
+}
+
+void MainWindow::runDeferredInit()
+{
+    // 每一步之间都让出事件循环，避免长时间阻塞界面
+    switch (deferredInitStep++) {
+    case 0: {
+        XC_TRACE_SCOPE("startup.loadSavedMusic");
+        playHistory.open("./data");
+        loadSavedMusic();
+        break;
+    }
+    case 1: {
+        XC_TRACE_SCOPE("startup.playlists");
+        playlistInterface();
+        updatePlaylistList(); // 加载并显示歌单列表
+        StartupMetrics::markInteractive();
+        break;
+    }
+    case 2: {
+        XC_TRACE_SCOPE("startup.lrcWidget");
+        ensureLrcWidget();
+        return;
+    }
+    default:
+        return;
+    }
+    QTimer::singleShot(0, this, &MainWindow::runDeferredInit);
+}
 
-    //链接网络搜索歌曲
-    connect(networkManager, &QNetworkAccessManager::finished, this, &MainWindow::onSearchFinished);
+PlaylistInterface *MainWindow::playlistInterface()
+{
+    if (!m_playlistInterface) {
+        // 初始化收藏夹和歌单功能
+        m_playlistInterface = new PlaylistInterface(this);
+        playlistInterface()->initialize();
+        connect(m_playlistInterface, &PlaylistInterface::importFinished, this, &MainWindow::do_playlistImportFinished);
+        // 智能歌单的曲库来自曲库数据库
+        if (libraryDb.isOpen())
+            m_playlistInterface->setSmartTracks(libraryDb.smartTracks());
+    }
+    return m_playlistInterface;
+}
+
+lrcwidget *MainWindow::ensureLrcWidget()
+{
+    if (lrcWidget)
+        return lrcWidget;
+
+    lrcWidget = new lrcwidget(this);
+    //lrcWidget->raise();
+    lrcWidget->hide();
+
+    connect(player, &AudioEngine::audioBufferReceived,
+            lrcWidget->getSpectrumAnalyzer(), &SpectrumAnalyzer::pushBuffer, Qt::DirectConnection);
+
+    //链接歌词界面
+    connect(player, &AudioEngine::positionChanged, lrcWidget, &lrcwidget::updateLyrics);
+    // 歌词按帧从播放时钟取位置，播放时才逐帧刷新
+    lrcWidget->setPlaybackClock(&playbackClock);
+    connect(player, &AudioEngine::playbackStateChanged, lrcWidget, [this](QMediaPlayer::PlaybackState state) {
+        lrcWidget->setPlaying(state == QMediaPlayer::PlayingState);
+    });
 
     // 链接 lrcwidget 的控件与 MainWindow 的槽函数
     connect(lrcWidget->getSlider(), &QSlider::sliderMoved, this, &MainWindow::lrcWidget_sliderMoved);
@@ -114,13 +294,95 @@ MainWindow::MainWindow(QWidget *parent)
     connect(lrcWidget, &lrcwidget::sliderMoved, this, &MainWindow::lrcWidget_sliderMoved);
     connect(lrcWidget, &lrcwidget::sliderPressed, this, &MainWindow::lrcWidget_sliderPressed);
     connect(lrcWidget, &lrcwidget::sliderReleased, this, &MainWindow::lrcWidget_sliderReleased);
+
+    // 补上创建之前已经发生的播放状态
+    lrcWidget->getSlider()->setMaximum(player->duration());
+    lrcWidget->setPlaying(player->playbackState() == QMediaPlayer::PlayingState);
+    if (!currentAudioPath.isEmpty())
+        lrcWidget->setLyrics(lyricResolver.resolve(currentAudioPath).lines);
+
+    return lrcWidget;
+}
+
+searchwidget *MainWindow::ensureSearchWidget()
+{
+    if (!searchWidget) {
+        searchWidget = new searchwidget(this);
+        searchWidget->resize(760, 405);  // 设置宽度和高度为500像素
+        searchWidget->move(11, 52);  // 将searchWidget移动到(100, 100)的位置
+        searchWidget->hide();
+        connect(searchWidget, &searchwidget::resultActivated, this, &MainWindow::playSearchResult);
+    }
+    return searchWidget;
+}
+
+QNetworkAccessManager *MainWindow::ensureNetworkManager()
+{
+    if (!networkManager) {
+        networkManager = new QNetworkAccessManager(this);
+    }
+    return networkManager;
+}
+
+SearchClient *MainWindow::ensureSearchClient()
+{
+    if (!searchClient) {
+        searchClient = new SearchClient(ensureNetworkManager(), this);
+        // 结果逐页追加；滚动接近末尾前下一页通常已经到达
+        connect(searchClient, &SearchClient::resultsAppended, this, [this](const QVector<SearchResult> &results) {
+            ensureSearchWidget()->appendSearchResults(results);
+        });
+        connect(ensureSearchWidget(), &searchwidget::scrolledTo, searchClient, &SearchClient::prefetchFor);
+        connect(searchClient, &SearchClient::failed, this, [](const QString &message) {
+            qDebug() << "Search failed:" << message;
+        });
+    }
+    return searchClient;
+}
+
+StreamLoader *MainWindow::ensureStreamLoader()
+{
+    if (!streamLoader) {
+        const qint64 cacheMb = qEnvironmentVariableIsSet("XC_STREAM_CACHE_MB") ? qEnvironmentVariableIntValue("XC_STREAM_CACHE_MB") : 1024;
+        streamCache = new StreamCache(qEnvironmentVariable("XC_STREAM_CACHE_DIR", "./data/stream_cache"), cacheMb * 1024 * 1024);
+        streamLoader = new StreamLoader(streamCache, this);
+        if (qEnvironmentVariableIsSet("XC_STREAM_PREBUFFER_KB"))
+            streamLoader->setPrebufferBytes(qint64(qEnvironmentVariableIntValue("XC_STREAM_PREBUFFER_KB")) * 1024);
+        connect(streamLoader, &StreamLoader::ready, this, &MainWindow::playStream);
+        connect(streamLoader, &StreamLoader::failed, this, [this](const QString &message) {
+            QMessageBox::information(this, "提示", "在线播放失败：" + message);
+        });
+    }
+    return streamLoader;
 }
 
 MainWindow::~MainWindow()
 {
+    // 退出前写入正在播放的这一首
+    finishHistorySession(false);
+
+    // 设置 XC_PREFETCH_STATS 后输出最后一首的预读与等待统计
+    if (qEnvironmentVariableIsSet("XC_PREFETCH_STATS"))
+        prefetcher->reportStats();
+    prefetchThread->quit();
+    prefetchThread->wait();
+
+    // 退出时导出追踪数据
+    Tracer &tracer = Tracer::instance();
+    if (tracer.isEnabled()) {
+        tracer.dumpChromeTrace(tracer.defaultDumpPath());
+        qDebug().noquote() << tracer.summary();
+    }
+
+    // 先停止在线加载（下载完的会在这里转入缓存），再释放缓存
+    delete streamLoader;
+    delete streamCache;
+
     // 保存歌单数据
-    m_playlistInterface->savePlaylists();
-    delete m_playlistInterface;
+    if (m_playlistInterface) {
+        m_playlistInterface->savePlaylists();
+        delete m_playlistInterface;
+    }
     delete ui;
 }
 
@@ -128,7 +390,7 @@ MainWindow::~MainWindow()
 void MainWindow::lrcWidget_sliderMoved(int value)
 {
     qDebug() << "Slider moved to" << value;
-    player->setPosition(value);
+    seekPlayer(value);
 }
 
 void MainWindow::lrcWidget_playPauseToggled()
@@ -166,7 +428,7 @@ void MainWindow::lrcWidget_nextClicked()
 void MainWindow::lrcWidget_volumeChanged(int value)
 {
     qDebug() << "Volume changed to" << value;
-    player->audioOutput()->setVolume(value / 100.0);
+    player->setVolume(value / 100.0);
 }
 
 void MainWindow::lrcWidget_speedChanged(double value)
@@ -220,23 +482,62 @@ QStringList MainWindow::getSavedMusicPaths()
     QString musicDirectory = appDir + "/sound";
 
     qDebug() << "Music directory:" << musicDirectory;
-    // 使用 QDir 类来获取指定路径下的所有音乐文件
-    QDir directory(musicDirectory);
-    QStringList musicFiles = directory.entryList(QStringList() << "*.mp3" << "*.wav" << "*.wma" << "*.flac", QDir::Files);
 
-    // 将文件名转换成完整路径
-    QStringList musicPaths;
-    foreach (const QString& fileName, musicFiles) {
-        QString filePath = musicDirectory + "/" + fileName;
-        musicPaths.append(filePath);
+    // xc-cli index 预先生成的缓存仍然有效时直接使用，避免启动时遍历目录。
+    // 缓存文件比目录旧时一定已过期，不去解析它
+    const QFileInfo rootInfo(musicDirectory);
+    const QFileInfo cacheInfo(LibraryCachePath);
+    QString cachedRoot;
+    qint64 cachedModified = -1;
+    QVector<LibraryTrack> cached;
+    if (cacheInfo.exists() && cacheInfo.lastModified() >= rootInfo.lastModified())
+        cached = LibraryScanner::loadCache(LibraryCachePath, &cachedRoot, &cachedModified);
+    if (!cached.isEmpty() && QFileInfo(cachedRoot) == rootInfo
+        && cachedModified == rootInfo.lastModified().toMSecsSinceEpoch()) {
+        QStringList musicPaths;
+        musicPaths.reserve(cached.size());
+        for (const LibraryTrack &track : cached)
+            musicPaths.append(track.filePath);
+        return musicPaths;
     }
 
+    QStringList musicPaths = LibraryScanner::listAudioFiles(musicDirectory);
+
     return musicPaths;
 }
 
 
 void MainWindow::loadSavedMusic()
 {
+    const QString musicDirectory = QCoreApplication::applicationDirPath() + "/sound";
+
+    // 有曲库数据库时只在目录变化后同步一次，列表按页从数据库读取
+    if (libraryDb.isOpen() || libraryDb.open("./data/library.db")) {
+        if (!libraryDb.isDirectoryFresh(musicDirectory)) {
+            XC_TRACE_SCOPE("library.sync");
+            libraryDb.syncPaths(musicDirectory, getSavedMusicPaths());
+        }
+        // syncPaths 只写入文件名，标签在后台补齐（与 xc-cli index 共用缓存，未变化的文件不重复读取）。
+        // 缓存是否仍然有效也在后台判断，大曲库的缓存文件有数 MB，不在启动路径上解析
+        syncLibraryTags(musicDirectory);
+        libraryQuery = TrackQuery();
+        libraryQuery.rootDirectory = musicDirectory;
+        libraryTotal = libraryDb.countTracks(libraryQuery);
+        libraryLoaded = 0;
+        libraryPaging = true;
+        libraryQueuePaths.clear();
+        queueSorter.clearCache();
+        fetchLibraryPage();
+
+        // 之后目录中的增删由监视器增量处理
+        if (!libraryWatcher) {
+            libraryWatcher = new LibraryWatcher(this);
+            libraryWatcher->setDatabasePath("./data/library.db");
+            connect(libraryWatcher, &LibraryWatcher::changed, this, &MainWindow::applyLibraryChanges);
+            libraryWatcher->watch(musicDirectory);
+        }
+        return;
+    }
 
     QStringList savedMusicPaths = getSavedMusicPaths();
 
@@ -252,8 +553,124 @@ void MainWindow::loadSavedMusic()
     }
 }
 
+void MainWindow::syncLibraryTags(const QString &musicDirectory)
+{
+    auto *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher] {
+        watcher->deleteLater();
+        // 智能歌单的艺术家/专辑/时长规则依赖标签，补齐后重新计算
+        if (watcher->result() && m_playlistInterface)
+            m_playlistInterface->setSmartTracks(libraryDb.smartTracks());
+    });
+    watcher->setFuture(QtConcurrent::run([musicDirectory] {
+        if (LibraryScanner::isCacheFresh(LibraryCachePath, musicDirectory))
+            return false;   // 目录自上次建立索引后没有变化，数据库中的标签已是最新
+        QHash<QString, LibraryTrack> cache;
+        for (const LibraryTrack &track : LibraryScanner::loadCache(LibraryCachePath))
+            cache.insert(track.filePath, track);
+        const QVector<LibraryTrack> tracks = LibraryScanner::index(LibraryScanner::listAudioFiles(musicDirectory), cache);
+        LibraryScanner::saveCache(LibraryCachePath, musicDirectory, tracks);
+        // 数据库连接只能在创建它的线程使用，这里单独打开一个
+        LibraryDatabase database;
+        return database.open("./data/library.db") && database.syncTracks(musicDirectory, tracks);
+    }));
+}
+
+bool MainWindow::fetchLibraryPage()
+{
+    const int pageSize = 500;
+    if (!libraryPaging || libraryLoaded >= libraryTotal)
+        return false;
+
+    const QVector<LibraryTrack> page = libraryDb.tracks(libraryQuery, libraryLoaded, pageSize);
+    if (page.isEmpty()) {
+        libraryPaging = false;
+        return false;
+    }
+
+    for (const LibraryTrack &track : page) {
+        // 监视器已经加入的歌曲不再重复添加
+        if (!libraryQueuePaths.contains(track.filePath))
+            ui->listWidget->addItem(createLibraryItem(track));
+    }
+    libraryLoaded += page.size();
+    return true;
+}
+
+QListWidgetItem *MainWindow::createLibraryItem(const LibraryTrack &track)
+{
+    static const QIcon icon(":/images/images/musicFile.png");
+    QString displayText = track.meta.artist.isEmpty() || track.meta.title.isEmpty()
+                              ? QFileInfo(track.filePath).fileName()
+                              : QString("%1 - %2").arg(track.meta.artist, track.meta.title);
+    QListWidgetItem *aItem = new QListWidgetItem(icon, displayText);
+    aItem->setData(Qt::UserRole, QUrl::fromLocalFile(track.filePath));
+    aItem->setData(TitleRole, track.meta.title);
+    aItem->setData(ArtistRole, track.meta.artist);
+    aItem->setData(DurationRole, track.meta.durationMs);
+    libraryQueuePaths.insert(track.filePath);
+    return aItem;
+}
+
+void MainWindow::applyLibraryChanges(const QVector<LibraryTrack> &added, const QStringList &removed)
+{
+    XC_TRACE_SCOPE("library.delta");
+
+    // 增删过的歌曲重新查找歌词
+    for (const LibraryTrack &track : added)
+        lyricResolver.invalidate(track.filePath);
+    for (const QString &path : removed)
+        lyricResolver.invalidate(path);
+
+    // 智能歌单同样只处理增量
+    if (m_playlistInterface) {
+        for (const LibraryTrack &track : added) {
+            SmartTrack smart;
+            smart.filePath = track.filePath;
+            smart.title = track.meta.title;
+            smart.artist = track.meta.artist;
+            smart.album = track.meta.album;
+            smart.duration = int(track.meta.durationMs / 1000);
+            smart.addedAt = QDateTime::currentMSecsSinceEpoch();
+            m_playlistInterface->updateSmartTrack(smart);
+        }
+        for (const QString &path : removed)
+            m_playlistInterface->removeSmartTrack(path);
+    }
+
+    // 列表当前显示的不是曲库时不改动
+    if (!libraryPaging)
+        return;
+
+    ui->listWidget->setUpdatesEnabled(false);
+    if (!removed.isEmpty()) {
+        const QSet<QString> removedSet(removed.cbegin(), removed.cend());
+        for (int row = ui->listWidget->count() - 1; row >= 0; --row) {
+            const QString path = ui->listWidget->item(row)->data(Qt::UserRole).toUrl().toLocalFile();
+            if (removedSet.contains(path) && libraryQueuePaths.remove(path)) {
+                delete ui->listWidget->takeItem(row);
+                --libraryLoaded;    // 已读过的行少了一行，分页偏移随之前移
+            }
+        }
+    }
+    for (const LibraryTrack &track : added) {
+        if (!libraryQueuePaths.contains(track.filePath))
+            ui->listWidget->addItem(createLibraryItem(track));
+    }
+    ui->listWidget->setUpdatesEnabled(true);
+    libraryTotal = libraryDb.countTracks(libraryQuery);
+}
+
 void MainWindow::do_positionChanged(qint64 position)
 {
+    // 只累计连续播放的部分，拖动进度条造成的跳变不计入收听时长
+    if (!historyTrack.isEmpty() && player->playbackState() == QMediaPlayer::PlayingState) {
+        const qint64 delta = position - historyLastPosition;
+        if (historyLastPosition >= 0 && delta > 0 && delta < 3000)
+            historyListened += delta;
+        historyLastPosition = position;
+    }
+
     if(ui->sliderPosition->isSliderDown())
         return;
     ui->sliderPosition->setSliderPosition(position);
@@ -264,6 +681,10 @@ void MainWindow::do_positionChanged(qint64 position)
     ui->labRatio->setText(positionTime + "/" + durationTime);
 
 
+    // 歌词界面尚未创建时无需更新
+    if (!lrcWidget)
+        return;
+
     // 更新歌词界面的进度条
     lrcWidget->getSlider()->setValue(position);
 
@@ -281,8 +702,82 @@ void MainWindow::do_positionChanged(qint64 position)
 
 }
 
+void MainWindow::finishHistorySession(bool finished)
+{
+    if (historyTrack.isEmpty())
+        return;
+
+    if (historyListened > 0 || finished) {
+        // 没有播完且听了不到一半（最多按 30 秒算）记为跳过
+        const qint64 duration = player->duration();
+        const qint64 threshold = duration > 0 ? qMin<qint64>(duration / 2, 30000) : 30000;
+        PlayEvent event;
+        event.filePath = historyTrack;
+        event.timestamp = QDateTime::currentMSecsSinceEpoch();
+        event.listenedMs = historyListened;
+        event.durationMs = duration;
+        event.skipped = !finished && historyListened < threshold;
+        playHistory.append(event);
+    }
+
+    historyTrack.clear();
+    historyListened = 0;
+    historyLastPosition = -1;
+}
+
+void MainWindow::setPlayerSource(const QUrl &source, bool recordPlay)
+{
+    Tracer::instance().markSwitch("setSource");
+    XC_TRACE_SCOPE("setSource");
+    finishHistorySession(false);
+    // 设置 XC_PREFETCH_STATS 后每首歌输出一次预读与等待统计
+    if (qEnvironmentVariableIsSet("XC_PREFETCH_STATS"))
+        prefetcher->reportStats();
+    seekTarget = -1;
+    bufferWait.invalidate();
+    loadWait.start();
+    prefetcher->setCurrent(source.toLocalFile());
+    player->setSource(source);
+    prefetchNextTrack();
+    if (!recordPlay)
+        return;
+    if (libraryDb.isOpen() && source.isLocalFile())
+        libraryDb.recordPlay(source.toLocalFile());
+    if (m_playlistInterface && source.isLocalFile())
+        m_playlistInterface->recordSmartPlay(source.toLocalFile());
+}
+
+void MainWindow::seekPlayer(qint64 position)
+{
+    // 进度条跟随播放时也会触发 valueChanged，与当前位置相差不到 1 秒的不算跳转
+    if (qAbs(position - player->position()) >= 1000) {
+        seekTarget = position;
+        seekWait.start();
+    }
+    player->setPosition(position);
+}
+
+void MainWindow::prefetchNextTrack()
+{
+    // 预读列表中的下一首（到末尾时为第一首，与自动下一首一致）
+    const int count = ui->listWidget->count();
+    if (count < 2)
+        return;
+    const int row = ui->listWidget->currentRow() + 1;
+    QListWidgetItem *item = ui->listWidget->item(row < count ? row : 0);
+    if (item)
+        prefetcher->setNext(item->data(Qt::UserRole).value<QUrl>().toLocalFile());
+}
+
+void MainWindow::do_mediaStatusChanged(QMediaPlayer::MediaStatus status)
+{
+    Tracer::instance().markSwitch(QByteArray("mediaStatus.")
+                                  + QMetaEnum::fromType<QMediaPlayer::MediaStatus>().valueToKey(status));
+}
+
 void MainWindow::do_durationChanged(qint64 duration)
 {
+    Tracer::instance().markSwitch("durationChanged");
     ui->sliderPosition->setMaximum(duration);
     int secs = duration / 1000;
     int mins = secs/60;
@@ -291,24 +786,31 @@ void MainWindow::do_durationChanged(qint64 duration)
     ui->labRatio->setText(positionTime + "/" + durationTime);
 
     // 更新歌词界面的进度条最大值
-    lrcWidget->getSlider()->setMaximum(duration);
+    if (lrcWidget)
+        lrcWidget->getSlider()->setMaximum(duration);
 }
 
 void MainWindow::do_sourceChanged(const QUrl &media)
 {
     ui->labCurMedia->setText(media.fileName());
 
+    currentAudioPath = media.toLocalFile();
+    applyEqualizerPreset();
+
+    // 歌词界面尚未创建时只记录歌词路径，创建时再加载
+    if (!lrcWidget)
+        return;
+
     // 重置封面为默认封面
     lrcWidget->resetCoverImage();
 
     // 清空当前歌词
     lrcWidget->clearLyrics();
 
-    QString musicPath = media.toLocalFile();
-    QFileInfo fileInfo(musicPath);
-    QString lyricsPath = fileInfo.path() + "/" + fileInfo.completeBaseName() + ".lrc";
-
-    lrcWidget->loadLyrics(lyricsPath);
+    Tracer::instance().markSwitch("lyricLoad");
+    XC_TRACE_SCOPE("lyricLoad");
+    if (!currentAudioPath.isEmpty())
+        lrcWidget->setLyrics(lyricResolver.resolve(currentAudioPath).lines);
 }
 
 void MainWindow::do_playbackStateChanged(QMediaPlayer::PlaybackState newState)
@@ -317,6 +819,17 @@ void MainWindow::do_playbackStateChanged(QMediaPlayer::PlaybackState newState)
     ui->btnPause->setEnabled(newState == QMediaPlayer::PlayingState);
     ui->btnStop->setEnabled(newState == QMediaPlayer::PlayingState);
 
+    if (newState == QMediaPlayer::PlayingState)
+        Tracer::instance().markSwitch("playing");
+
+    // 开始播放时建立收听记录，停止时写入（播放到结尾视为完整收听）
+    if (newState == QMediaPlayer::PlayingState && historyTrack.isEmpty() && player->source().isLocalFile()) {
+        historyTrack = player->source().toLocalFile();
+        historyListened = 0;
+        historyLastPosition = player->position();
+    } else if (newState == QMediaPlayer::StoppedState) {
+        finishHistorySession(player->mediaStatus() == QMediaPlayer::EndOfMedia);
+    }
 
     if((newState == QMediaPlayer::StoppedState) && loopPay)
     {
@@ -324,9 +837,12 @@ void MainWindow::do_playbackStateChanged(QMediaPlayer::PlaybackState newState)
         int count = ui->listWidget->count();
         int curRow = ui->listWidget->currentRow();
         ++curRow;
+        if (curRow >= count && fetchLibraryPage())
+            count = ui->listWidget->count();
         curRow = curRow >= count ? 0 : curRow;
         ui->listWidget->setCurrentRow(curRow);
-        player->setSource(ui->listWidget->currentItem()->data(Qt::UserRole).value<QUrl>());
+        Tracer::instance().beginSwitch("autoAdvance");
+        setPlayerSource(ui->listWidget->currentItem()->data(Qt::UserRole).value<QUrl>());
         player->play();
     }
     //如果不是循环播放,播完一首就暂停
@@ -344,6 +860,7 @@ void MainWindow::do_metaDataChanged()
 {
 
     //元数据发生变化，修改显示的图片
+    Tracer::instance().markSwitch("metaDataChanged");
 
     QMediaMetaData metaData = player->metaData();
     qDebug() << metaData.value(QMediaMetaData::ThumbnailImage) << Qt::endl;
@@ -382,6 +899,7 @@ void MainWindow::do_metaDataChanged()
 
 void MainWindow:: updateCoverArtSize()
 {
+    XC_TRACE_SCOPE("coverScale");
     // 获取当前窗口大小
     QSize newSize = ui->scrollArea->size();
 
@@ -403,27 +921,59 @@ void MainWindow::on_btnAdd_clicked()
     QString filter = "音频文件(*.mp3 *.wav *.wma);;所有文件(*.*)";
 
     QStringList fileList = QFileDialog::getOpenFileNames(this, dlgTitle, curPath, filter);
-    if(fileList.isEmpty())
+    if(appendFiles(fileList) < 0)
         return;
 
-    foreach (const auto& item, fileList) {
-        QFileInfo fileInfo(item);
-        QListWidgetItem *aItem = new QListWidgetItem(fileInfo.fileName());
-        aItem->setIcon(QIcon(":/images/images/musicFile.png"));
-        aItem->setData(Qt::UserRole, QUrl::fromLocalFile(item));
-        ui->listWidget->addItem(aItem);
-    }
-
     //如果现在没有正在播放，就开始播放第一个文件
     if(player->playbackState() != QMediaPlayer::PlayingState){
         ui->listWidget->setCurrentRow(0);
         QUrl source = ui->listWidget->currentItem()->data(Qt::UserRole).value<QUrl>();
-        player->setSource(source);
+        setPlayerSource(source);
         player->play();
     }
 }
 
 
+int MainWindow::appendFiles(const QStringList &files)
+{
+    // 整批加入：暂停重绘，所有条目添加完后只刷新一次
+    const int first = ui->listWidget->count();
+    const QIcon icon(":/images/images/musicFile.png");
+    ui->listWidget->setUpdatesEnabled(false);
+    foreach (const auto& item, files) {
+        QFileInfo fileInfo(item);
+        if (!fileInfo.isFile())
+            continue;
+        QListWidgetItem *aItem = new QListWidgetItem(icon, fileInfo.fileName());
+        aItem->setData(Qt::UserRole, QUrl::fromLocalFile(item));
+        ui->listWidget->addItem(aItem);
+    }
+    ui->listWidget->setUpdatesEnabled(true);
+    return ui->listWidget->count() > first ? first : -1;
+}
+
+void MainWindow::handleInstanceMessage(const InstanceMessage &message)
+{
+    // 从文件管理器再次打开时把已有窗口调到前台
+    if (isMinimized())
+        showNormal();
+    raise();
+    activateWindow();
+
+    const int first = appendFiles(message.paths);
+    if (first < 0 || message.command != InstanceMessage::Play)
+        return;
+
+    // 从这一批的第一首开始播放
+    loopPay = false;
+    Tracer::instance().beginSwitch("openFiles");
+    ui->listWidget->setCurrentRow(first);
+    setPlayerSource(ui->listWidget->item(first)->data(Qt::UserRole).value<QUrl>());
+    player->play();
+    loopPay = true;
+}
+
+
 void MainWindow::on_btnRemove_clicked()
 {
     //只是从Widget移除
@@ -440,7 +990,10 @@ void MainWindow::on_btnRemove_clicked()
 void MainWindow::on_btnClear_clicked()
 {
     loopPay = false;
+    libraryPaging = false;
+    currentPlaylistName.clear();
     ui->listWidget->clear();
+    queueSorter.clearCache();
     player->stop();
 
 }
@@ -457,7 +1010,7 @@ void MainWindow::on_btnPlay_clicked()
         return;
     if(ui->listWidget->currentRow() < 0)
         ui->listWidget->setCurrentRow(0);
-    player->setSource(ui->listWidget->currentItem()->data(Qt::UserRole).value<QUrl>());
+    setPlayerSource(ui->listWidget->currentItem()->data(Qt::UserRole).value<QUrl>());
 
     player->play();
 }
@@ -484,7 +1037,8 @@ void MainWindow::on_btnPrevious_clicked()
     curRow = curRow < 0 ? ui->listWidget->count()-1 : curRow;
     ui->listWidget->setCurrentRow(curRow);
     loopPay = false;
-    player->setSource(ui->listWidget->currentItem()->data(Qt::UserRole).value<QUrl>());
+    Tracer::instance().beginSwitch("userSkip");
+    setPlayerSource(ui->listWidget->currentItem()->data(Qt::UserRole).value<QUrl>());
     player->play();
     loopPay = ui->btnLoop->isChecked();
 }
@@ -495,10 +1049,13 @@ void MainWindow::on_btnNext_clicked()
     int count = ui->listWidget->count();
     int curRow = ui->listWidget->currentRow();
     ++curRow;
+    if (curRow >= count && fetchLibraryPage())
+        count = ui->listWidget->count();
     curRow = curRow >= count ? 0 : curRow;
     ui->listWidget->setCurrentRow(curRow);
     loopPay = false;
-    player->setSource(ui->listWidget->currentItem()->data(Qt::UserRole).value<QUrl>());
+    Tracer::instance().beginSwitch("userSkip");
+    setPlayerSource(ui->listWidget->currentItem()->data(Qt::UserRole).value<QUrl>());
     player->play();
     loopPay = ui->btnLoop->isChecked();
 }
@@ -506,7 +1063,12 @@ void MainWindow::on_btnNext_clicked()
 
 void MainWindow::on_doubleSpinBox_valueChanged(double arg1)
 {
-    //player->setPlaybackRate(arg1);
+    // 引擎可以无缝变速时直接设置
+    if (player->seamlessRateChange()) {
+        player->setPlaybackRate(arg1);
+        return;
+    }
+
     // 先暂停播放
     if (player->playbackState() == QMediaPlayer::PlayingState)
         player->pause();
@@ -528,8 +1090,8 @@ void MainWindow::on_btnLoop_clicked(bool checked)
 
 void MainWindow::on_btnSound_clicked()
 {
-    bool mute = player->audioOutput()->isMuted();
-    player->audioOutput()->setMuted(!mute);
+    bool mute = player->isMuted();
+    player->setMuted(!mute);
     if(mute)
         ui->btnSound->setIcon(QIcon(":/images/images/volumn.bmp"));
     else
@@ -540,13 +1102,13 @@ void MainWindow::on_btnSound_clicked()
 
 void MainWindow::on_sliderVolumn_valueChanged(int value)
 {
-    player->audioOutput()->setVolume(value/100.0);
+    player->setVolume(value/100.0);
 }
 
 
 void MainWindow::on_sliderPosition_valueChanged(int value)
 {
-    player->setPosition(value);
+    seekPlayer(value);
 }
 
 
@@ -554,7 +1116,8 @@ void MainWindow::on_listWidget_doubleClicked(const QModelIndex &index)
 {
     Q_UNUSED(index);
     loopPay = false;
-    player->setSource(ui->listWidget->currentItem()->data(Qt::UserRole).value<QUrl>());
+    Tracer::instance().beginSwitch("doubleClick");
+    setPlayerSource(ui->listWidget->currentItem()->data(Qt::UserRole).value<QUrl>());
     player->play();
     loopPay = true;
 }
@@ -564,9 +1127,10 @@ void MainWindow::on_btnCover_clicked()
 {
     qDebug() << 1 << Qt::endl;
     //lrcwidget *lrc_widget = new lrcwidget(this);
+    ensureLrcWidget();
 
     qDebug() << 2 << Qt::endl;
-    lrcWidget->setAttribute(Qt::WA_DeleteOnClose);
+    // 歌词界面只创建一次并一直保留（lrcWidget 在多处使用），关闭时只是隐藏，不能设置 WA_DeleteOnClose
     qDebug() << 3 << Qt::endl;
     lrcWidget->setWindowTitle("歌词窗口");
     QMediaMetaData metaData = player->metaData();
@@ -590,92 +1154,65 @@ void MainWindow::on_btnCover_clicked()
 
 void MainWindow::on_btnSearch_clicked()
 {
-    qDebug() << "s1" << Qt::endl;
-    QUrl url("http://mobilecdn.kugou.com/api/v3/search/song?format=json&keyword=" + ui->editSerch->text() + "&page=1&pagesize=20&showtype=1");
-    qDebug() << "s2" << Qt::endl;
-
-    QNetworkRequest request(url);
-    qDebug() << "s3" << Qt::endl;
-    request.setHeader(QNetworkRequest::UserAgentHeader, "Mozilla/5.0 ...");
-    qDebug() << "s4" << Qt::endl;
-    request.setRawHeader("Referer", "http://www.kuwo.cn/");
-    qDebug() << "s5" << Qt::endl;
-    networkManager->get(request);
-    qDebug() << "s6" << Qt::endl;
-
-
-//    QNetworkRequest request(url);
-//    qDebug() << "s3" << Qt::endl;
-//    networkManager->get(request);
-//    qDebug() << "s4" << Qt::endl;
+    // 关键字与正在进行的搜索相同时保留现有结果
+    const QString keyword = ui->editSerch->text().trimmed();
+    if (keyword.isEmpty())
+        return;
+    if (ensureSearchClient()->search(keyword))
+        ensureSearchWidget()->clearResults();
+    searchWidget->show();
 }
 
-void MainWindow::onSearchFinished(QNetworkReply *reply)
+void MainWindow::playSearchResult(const SearchResult &result)
 {
-    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-    qDebug() << "HTTP Status Code:" << statusCode;
-    if(reply->error() == QNetworkReply::NoError)
-    {
-        qDebug() << "Network success:";
-        QByteArray response_data = reply->readAll();
-        qDebug() << "Response data:" << response_data;
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(response_data);
-        if (!jsonDoc.isObject()) {
-            qDebug() << "Error: JSON document is not an object.";
-            return;
-        }
-        QJsonObject jsonObj = jsonDoc.object();
-        if (!jsonObj.contains("data") || !jsonObj["data"].isObject()) {
-            qDebug() << "Error: JSON 'data' is not an object or not exist.";
-            return;
-        }
-        QJsonObject dataObj = jsonObj["data"].toObject();
-        if (!dataObj.contains("info") || !dataObj["info"].isArray()) {
-            qDebug() << "Error: JSON 'info' is not an array or not exist.";
-            return;
-        }
-        QJsonArray results = dataObj["info"].toArray();
+    if (result.hash.isEmpty())
+        return;
+    StreamLoader *loader = ensureStreamLoader();
+    streamingResult = result;
 
-        QStringList songInfoList;
-        for(const QJsonValue &value : results)
-        {
-            if (!value.isObject()) {
-                qDebug() << "Error: JSON element is not an object.";
-                continue;
-            }
-            QJsonObject songObj = value.toObject();
-            QString songInfo;
-            if (songObj.contains("songname") && songObj["songname"].isString()) {
-                songInfo +=  songObj["songname"].toString() + ",";
-            }
-            if (songObj.contains("singername") && songObj["singername"].isString()) {
-                songInfo += songObj["singername"].toString() + ",";
-            }
-            if (songObj.contains("duration") && songObj["duration"].isDouble()) {
-                int duration = songObj["duration"].toInt();
-                songInfo +=  QString::number(duration / 60) + "分" + QString::number(duration % 60) + "秒";
-            }
-            songInfoList.append(songInfo);
-        }
-        if (searchWidget) {
-            searchWidget->displaySearchResults(songInfoList);
-            searchWidget->show();
-        } else {
-            qDebug() << "Error: searchWidget is null.";
-        }
-    } else {
-        qDebug() << "Network error:" << reply->errorString();
+    // 已缓存的直接播放本地文件，不必再请求播放地址
+    const QUrl cached = loader->cachedUrl(result.hash);
+    if (!cached.isEmpty()) {
+        playStream(cached);
+        return;
     }
-    reply->deleteLater();
 
+    // 用曲目标识换取播放地址（XC_STREAM_RESOLVE_URL 中的 %1 替换为 hash）
+    const QString resolveUrl = qEnvironmentVariable("XC_STREAM_RESOLVE_URL",
+                                                    "http://m.kugou.com/app/i/getSongInfo.php?cmd=playInfo&hash=%1");
+    QNetworkRequest request(QUrl(resolveUrl.arg(result.hash)));
+    request.setHeader(QNetworkRequest::UserAgentHeader, "Mozilla/5.0 ...");
+    QNetworkReply *reply = ensureNetworkManager()->get(request);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, hash = result.hash] {
+        reply->deleteLater();
+        // 等待期间又选了别的歌
+        if (hash != streamingResult.hash)
+            return;
+        const QJsonObject info = QJsonDocument::fromJson(reply->readAll()).object();
+        const QUrl url(info.value("url").toString());
+        if (reply->error() != QNetworkReply::NoError || url.isEmpty()) {
+            qDebug() << "Failed to resolve stream url:" << hash << reply->errorString();
+            QMessageBox::information(this, "提示", "该歌曲暂时无法在线播放");
+            return;
+        }
+        streamLoader->load(hash, url);
+    });
 }
 
-
-
+void MainWindow::playStream(const QUrl &url)
+{
+    // 在线歌曲不在播放列表中，播完不自动切到列表的下一首；也不计入曲库播放次数
+    loopPay = false;
+    Tracer::instance().beginSwitch("searchResult");
+    setPlayerSource(url, false);
+    player->play();
+    ui->labCurMedia->setText(streamingResult.title + " - " + streamingResult.artist);
+}
 
 void MainWindow::on_pushButton_clicked()
 {
-    searchWidget->hide();
+    if (searchWidget)
+        searchWidget->hide();
 }
 
 // 添加到收藏夹
@@ -689,13 +1226,13 @@ void MainWindow::on_actionAdd_to_Favorites_triggered()
     }
     
     // 检查是否已在收藏夹中
-    if (m_playlistInterface->isInFavorites(currentFilePath)) {
+    if (playlistInterface()->isInFavorites(currentFilePath)) {
         QMessageBox::information(this, "提示", "该歌曲已在收藏夹中");
         return;
     }
     
     // 添加到收藏夹
-    if (m_playlistInterface->addCurrentSongToFavorites(currentFilePath, player)) {
+    if (playlistInterface()->addCurrentSongToFavorites(currentFilePath, int(player->duration() / 1000))) {
         QMessageBox::information(this, "成功", "歌曲已添加到收藏夹");
     } else {
         QMessageBox::warning(this, "失败", "添加到收藏夹失败");
@@ -705,9 +1242,12 @@ void MainWindow::on_actionAdd_to_Favorites_triggered()
 // 显示收藏夹
 void MainWindow::on_actionShow_Favorites_triggered()
 {
-    QStringList songs = m_playlistInterface->getFavoritesSongs();
+    QStringList songs = playlistInterface()->getFavoritesSongs();
     
+    libraryPaging = false;
+    currentPlaylistName.clear();
     ui->listWidget->clear();
+    queueSorter.clearCache();
     foreach (const QString &songInfo, songs) {
         QStringList parts = songInfo.split('|');
         if (parts.size() >= 4) {
@@ -728,19 +1268,19 @@ void MainWindow::on_actionCreate_Playlist_triggered()
         return;
     }
     
-    if (m_playlistInterface->createPlaylist(playlistName)) {
+    if (playlistInterface()->createPlaylist(playlistName)) {
         QMessageBox::information(this, "成功", "歌单创建成功");
         // 更新歌单列表
         updatePlaylistList();
     } else {
-        QMessageBox::warning(this, "失败", "歌单创建失败，可能已存在同名歌单");
+        QMessageBox::warning(this, "失败", "歌单创建失败：已存在同名歌单（包括智能歌单），或使用了保留名称 favorites、playlists、smart_playlists");
     }
 }
 
 // 更新歌单列表
 void MainWindow::updatePlaylistList()
 {
-    QStringList playlists = m_playlistInterface->getAllPlaylistNames();
+    QStringList playlists = playlistInterface()->getAllPlaylistNames();
     // 可以在这里更新UI中的歌单列表
     qDebug() << "所有歌单:" << playlists;
 }
@@ -748,15 +1288,28 @@ void MainWindow::updatePlaylistList()
 // 添加到指定歌单
 void MainWindow::on_actionAdd_to_Playlist_triggered()
 {
+    // 列表中选中多首时整批添加，否则添加当前播放的歌曲
+    QStringList selectedPaths;
+    const QList<QListWidgetItem *> selectedItems = ui->listWidget->selectedItems();
+    if (selectedItems.size() > 1) {
+        for (QListWidgetItem *item : selectedItems) {
+            const QVariant data = item->data(Qt::UserRole);
+            const QString path = data.typeId() == QMetaType::QUrl ? data.toUrl().toLocalFile() : data.toString();
+            if (!path.isEmpty())
+                selectedPaths.append(path);
+        }
+    }
+
     // 获取当前播放的歌曲路径
     QString filePath = player->source().toLocalFile();
-    if (filePath.isEmpty()) {
+    if (filePath.isEmpty() && selectedPaths.isEmpty()) {
         QMessageBox::warning(this, "提示", "当前没有播放歌曲，无法添加到歌单。");
         return;
     }
 
-    // 获取所有歌单名称
-    QStringList playlistNames = m_playlistInterface->getAllPlaylistNames();
+    // 获取所有歌单名称；智能歌单的内容由规则决定，不能手动添加
+    QStringList playlistNames = playlistInterface()->getAllPlaylistNames();
+    playlistNames.removeIf([this](const QString &name) { return playlistInterface()->isSmartPlaylist(name); });
     if (playlistNames.isEmpty()) {
         QMessageBox::warning(this, "提示", "请先创建歌单。");
         return;
@@ -768,14 +1321,18 @@ void MainWindow::on_actionAdd_to_Playlist_triggered()
         this, "选择歌单", "请选择要添加到的歌单:",
         playlistNames, 0, false, &ok);
 
-    if (ok && !selectedPlaylist.isEmpty()) {
+    if (ok && !selectedPlaylist.isEmpty() && !selectedPaths.isEmpty()) {
+        const int added = playlistInterface()->addSongsToPlaylist(selectedPlaylist, selectedPaths);
+        QMessageBox::information(this, "完成", QString("已添加 %1 首歌曲，跳过 %2 首重复歌曲。")
+                                                   .arg(added).arg(selectedPaths.size() - added));
+    } else if (ok && !selectedPlaylist.isEmpty()) {
         // 获取歌曲信息（简化版）
         QFileInfo fileInfo(filePath);
         QString title = fileInfo.baseName();
         int duration = player->duration() / 1000; // 转换为秒
 
         // 添加到歌单
-        if (m_playlistInterface->addToPlaylist(selectedPlaylist, title, "", "", filePath, "", "", duration)) {
+        if (playlistInterface()->addToPlaylist(selectedPlaylist, title, "", "", filePath, "", "", duration)) {
             QMessageBox::information(this, "成功", "歌曲已成功添加到歌单！");
         } else {
             QMessageBox::warning(this, "失败", "添加到歌单失败！");
@@ -787,7 +1344,7 @@ void MainWindow::on_actionAdd_to_Playlist_triggered()
 void MainWindow::on_actionLoad_Playlist_triggered()
 {
     // 获取所有歌单名称
-    QStringList playlistNames = m_playlistInterface->getAllPlaylistNames();
+    QStringList playlistNames = playlistInterface()->getAllPlaylistNames();
     if (playlistNames.isEmpty()) {
         QMessageBox::warning(this, "提示", "没有找到任何歌单。");
         return;
@@ -801,7 +1358,7 @@ void MainWindow::on_actionLoad_Playlist_triggered()
 
     if (ok && !selectedPlaylist.isEmpty()) {
         // 获取歌单中的所有歌曲
-        QStringList songs = m_playlistInterface->getPlaylistSongs(selectedPlaylist);
+        QStringList songs = playlistInterface()->getPlaylistSongs(selectedPlaylist);
         
         if (songs.isEmpty()) {
             QMessageBox::information(this, "提示", "选中的歌单中没有歌曲。");
@@ -809,7 +1366,10 @@ void MainWindow::on_actionLoad_Playlist_triggered()
         }
 
         // 清空当前播放列表
+        libraryPaging = false;
+        currentPlaylistName = selectedPlaylist;
         ui->listWidget->clear();
+        queueSorter.clearCache();
         
         // 添加歌单中的歌曲到播放列表
         foreach (const QString &songInfo, songs) {
@@ -819,6 +1379,10 @@ void MainWindow::on_actionLoad_Playlist_triggered()
                 QListWidgetItem *item = new QListWidgetItem(displayText);
                 item->setIcon(QIcon(":/images/images/musicFile.png"));
                 item->setData(Qt::UserRole, QUrl::fromLocalFile(parts[3]));
+                item->setData(TitleRole, parts[0]);
+                item->setData(ArtistRole, parts[1]);
+                if (parts.size() >= 5)
+                    item->setData(DurationRole, parts[4].toLongLong() * 1000);
                 ui->listWidget->addItem(item);
             }
         }
@@ -828,8 +1392,293 @@ void MainWindow::on_actionLoad_Playlist_triggered()
         // 可选：自动播放第一首歌曲
         if (ui->listWidget->count() > 0) {
             ui->listWidget->setCurrentRow(0);
-            player->setSource(ui->listWidget->currentItem()->data(Qt::UserRole).value<QUrl>());
+            setPlayerSource(ui->listWidget->currentItem()->data(Qt::UserRole).value<QUrl>());
             player->play();
         }
     }
-}
\ No newline at end of file
+}
+
+// 导入外部歌单（后台解析，界面不卡顿）
+void MainWindow::on_btnImportPlaylist_clicked()
+{
+    if (playlistInterface()->isImporting()) {
+        QMessageBox::information(this, "提示", "正在导入歌单，请稍候。");
+        return;
+    }
+
+    QString filePath = QFileDialog::getOpenFileName(this, "导入歌单", QDir::homePath(),
+                                                    "歌单文件(*.m3u *.m3u8 *.pls *.json);;所有文件(*.*)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    bool ok;
+    QString playlistName = QInputDialog::getText(this, "导入歌单", "导入到歌单：", QLineEdit::Normal,
+                                                 QFileInfo(filePath).completeBaseName(), &ok);
+    if (!ok || playlistName.isEmpty()) {
+        return;
+    }
+    if (playlistInterface()->isSmartPlaylist(playlistName)) {
+        QMessageBox::warning(this, "失败", "智能歌单的内容由规则决定，不能导入歌曲，请换一个歌单名称。");
+        return;
+    }
+
+    if (!playlistInterface()->importPlaylistAsync(playlistName, filePath)) {
+        QMessageBox::warning(this, "失败", "无法导入该歌单文件");
+    }
+}
+
+void MainWindow::do_playlistImportFinished(const QString &playlistName, bool ok, int added, int missing)
+{
+    if (!ok) {
+        QMessageBox::warning(this, "失败", QString("导入歌单 '%1' 失败").arg(playlistName));
+        return;
+    }
+    updatePlaylistList();
+    QString message = QString("已导入 %1 首歌曲到 '%2'").arg(added).arg(playlistName);
+    if (missing > 0) {
+        message += QString("，%1 个文件不存在已跳过").arg(missing);
+    }
+    QMessageBox::information(this, "成功", message);
+}
+
+// 导出歌单为 M3U8/PLS/JSON
+void MainWindow::on_btnExportPlaylist_clicked()
+{
+    QStringList playlistNames = playlistInterface()->getAllPlaylistNames();
+    bool ok;
+    QString selectedPlaylist = QInputDialog::getItem(
+        this, "导出歌单", "请选择要导出的歌单:",
+        playlistNames, 0, false, &ok);
+    if (!ok || selectedPlaylist.isEmpty()) {
+        return;
+    }
+
+    QString filePath = QFileDialog::getSaveFileName(this, "导出歌单", QDir::homePath() + "/" + selectedPlaylist + ".m3u8",
+                                                    "M3U8 歌单(*.m3u8);;M3U 歌单(*.m3u);;PLS 歌单(*.pls);;JSON 歌单(*.json)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    if (playlistInterface()->exportPlaylist(selectedPlaylist, filePath)) {
+        QMessageBox::information(this, "成功", "歌单已导出");
+    } else {
+        QMessageBox::warning(this, "失败", "导出歌单失败");
+    }
+}
+
+void MainWindow::on_btnSmartPlaylist_clicked()
+{
+    bool ok;
+    const QString name = QInputDialog::getText(this, "新建智能歌单", "请输入歌单名称：", QLineEdit::Normal, "", &ok);
+    if (!ok || name.isEmpty())
+        return;
+
+    // 界面上每次创建一条规则，多条规则可直接编辑 smart_playlists.json
+    const QStringList kinds = {"艺术家包含", "专辑包含", "时长不少于（秒）", "时长不超过（秒）",
+                               "播放次数不少于", "最近若干天添加", "收藏夹中的歌曲"};
+    const QString kind = QInputDialog::getItem(this, "新建智能歌单", "规则：", kinds, 0, false, &ok);
+    if (!ok)
+        return;
+
+    SmartRule rule;
+    switch (kinds.indexOf(kind)) {
+    case 0:
+    case 1:
+        rule.field = kind == kinds[0] ? SmartRule::Artist : SmartRule::Album;
+        rule.op = SmartRule::Contains;
+        rule.text = QInputDialog::getText(this, "新建智能歌单", kind + "：", QLineEdit::Normal, "", &ok);
+        if (!ok || rule.text.isEmpty())
+            return;
+        break;
+    case 6:
+        rule.field = SmartRule::Favorite;
+        rule.number = 1;
+        break;
+    default: {
+        const int index = kinds.indexOf(kind);
+        rule.field = index <= 3 ? SmartRule::Duration : index == 4 ? SmartRule::PlayCount : SmartRule::AddedWithinDays;
+        rule.op = index == 3 ? SmartRule::AtMost : SmartRule::AtLeast;
+        rule.number = QInputDialog::getInt(this, "新建智能歌单", kind + "：", index == 5 ? 30 : 1, 0, 1000000, 1, &ok);
+        if (!ok)
+            return;
+        break;
+    }
+    }
+
+    SmartPlaylistDefinition definition;
+    definition.name = name;
+    definition.rules.append(rule);
+    if (playlistInterface()->createSmartPlaylist(definition)) {
+        QMessageBox::information(this, "成功", QString("智能歌单 '%1' 创建成功，当前 %2 首歌曲")
+                                                   .arg(name).arg(playlistInterface()->getPlaylistSongs(name).size()));
+        updatePlaylistList();
+    } else {
+        QMessageBox::warning(this, "失败", "智能歌单创建失败，可能已存在同名歌单");
+    }
+}
+
+void MainWindow::applyEqualizerPreset()
+{
+    Equalizer *equalizer = player->equalizer();
+    if (!equalizer)
+        return;
+    equalizer->setGains(eqPresets.gainsFor(currentAudioPath, currentPlaylistName));
+    if (eqWidget) {
+        eqWidget->setContext(currentAudioPath, currentPlaylistName);
+        eqWidget->refresh();
+    }
+}
+
+void MainWindow::showEqualizer()
+{
+    if (!eqWidget) {
+        eqWidget = new equalizerwidget(player->equalizer(), &eqPresets, this);
+        connect(eqWidget, &equalizerwidget::presetsChanged, this, [this] {
+            if (!eqPresets.save("./data/equalizer.json"))
+                qWarning() << "Failed to save equalizer presets";
+        });
+    }
+    eqWidget->setContext(currentAudioPath, currentPlaylistName);
+    eqWidget->refresh();
+    eqWidget->show();
+    eqWidget->raise();
+}
+
+void MainWindow::showQueueMenu(const QPoint &pos)
+{
+    if (ui->listWidget->count() < 2)
+        return;
+
+    QMenu menu(this);
+    QMenu *sortMenu = menu.addMenu("排序");
+    const QList<QPair<QString, QueueSorter::Key>> keys = {
+        {"按标题", QueueSorter::Title}, {"按艺术家", QueueSorter::Artist},
+        {"按时长", QueueSorter::Duration}, {"按文件名", QueueSorter::FileName},
+    };
+    for (const auto &key : keys) {
+        sortMenu->addAction(key.first, this, [this, key] { sortQueue(key.second, false); });
+        sortMenu->addAction(key.first + "（倒序）", this, [this, key] { sortQueue(key.second, true); });
+    }
+    menu.exec(ui->listWidget->viewport()->mapToGlobal(pos));
+}
+
+void MainWindow::sortQueue(QueueSorter::Key key, bool descending)
+{
+    XC_TRACE_SCOPE("queue.sort");
+    QElapsedTimer timer;
+    timer.start();
+
+    // 曲库分页尚未加载完时不把剩下的页全部读进来，改由数据库按新顺序重新分页
+    if (libraryPaging) {
+        sortLibraryQueue(key, descending);
+        if (qEnvironmentVariableIsSet("XC_QUEUE_STATS"))
+            qDebug() << "Sorted library queue by database query in" << timer.elapsed() << "ms,"
+                     << ui->listWidget->count() << "of" << libraryTotal << "rows loaded";
+        return;
+    }
+
+    const int count = ui->listWidget->count();
+    const QVector<int> order = queueSorter.order(queueEntries(0, count), key, descending);
+
+    // 从末尾取出所有条目（每次都是常数时间），再按新顺序放回；当前歌曲保持选中
+    QListWidgetItem *current = ui->listWidget->currentItem();
+    ui->listWidget->setUpdatesEnabled(false);
+    QVector<QListWidgetItem *> items(count);
+    for (int i = count - 1; i >= 0; --i)
+        items[i] = ui->listWidget->takeItem(i);
+    for (int index : order)
+        ui->listWidget->addItem(items[index]);
+    if (current)
+        ui->listWidget->setCurrentItem(current);
+    ui->listWidget->setUpdatesEnabled(true);
+    if (current)
+        ui->listWidget->scrollToItem(current);
+
+    if (qEnvironmentVariableIsSet("XC_QUEUE_STATS"))
+        qDebug() << "Sorted" << count << "queue items in" << timer.elapsed() << "ms,"
+                 << queueSorter.cachedKeys() << "collation keys cached";
+}
+
+QVector<QueueSorter::Entry> MainWindow::queueEntries(int first, int count) const
+{
+    QVector<QueueSorter::Entry> entries(count);
+    for (int i = 0; i < count; ++i) {
+        const QListWidgetItem *item = ui->listWidget->item(first + i);
+        const QVariant path = item->data(Qt::UserRole);
+        QueueSorter::Entry &entry = entries[i];
+        entry.fileName = path.typeId() == QMetaType::QUrl ? path.toUrl().fileName() : QFileInfo(path.toString()).fileName();
+        entry.title = item->data(TitleRole).toString();
+        if (entry.title.isEmpty())
+            entry.title = item->text();
+        entry.artist = item->data(ArtistRole).toString();
+        entry.durationMs = item->data(DurationRole).toLongLong();
+    }
+    return entries;
+}
+
+void MainWindow::sortLibraryQueue(QueueSorter::Key key, bool descending)
+{
+    // 标题/艺术家按数据库里预先算好的排序名次排序，规则与 QueueSorter 相同（汉字按拼音）。
+    // 按文件名排序用路径代替（曲库只有 sound 目录一层）
+    switch (key) {
+    case QueueSorter::Title:
+        libraryQuery.sort = TrackQuery::ByTitle;
+        break;
+    case QueueSorter::Artist:
+        libraryQuery.sort = TrackQuery::ByArtist;
+        break;
+    case QueueSorter::Duration:
+        libraryQuery.sort = TrackQuery::ByDuration;
+        break;
+    case QueueSorter::FileName:
+        libraryQuery.sort = TrackQuery::ByPath;
+        break;
+    }
+    libraryQuery.descending = descending;
+
+    const QListWidgetItem *currentItem = ui->listWidget->currentItem();
+    const QUrl current = currentItem ? currentItem->data(Qt::UserRole).toUrl() : QUrl();
+    const bool currentInLibrary = !current.isEmpty() && libraryQueuePaths.contains(current.toLocalFile());
+    const int loaded = libraryLoaded;
+
+    // 丢弃已读入的曲库条目；手动加入的歌曲留在列表开头，彼此之间在内存中排序
+    ui->listWidget->setUpdatesEnabled(false);
+    QVector<QListWidgetItem *> extras;
+    for (int row = ui->listWidget->count() - 1; row >= 0; --row) {
+        QListWidgetItem *item = ui->listWidget->takeItem(row);
+        if (libraryQueuePaths.contains(item->data(Qt::UserRole).toUrl().toLocalFile()))
+            delete item;
+        else
+            extras.append(item);
+    }
+    std::reverse(extras.begin(), extras.end());
+    for (QListWidgetItem *item : std::as_const(extras))
+        ui->listWidget->addItem(item);
+    if (extras.size() > 1) {
+        const QVector<int> order = queueSorter.order(queueEntries(0, int(extras.size())), key, descending);
+        for (int row = int(extras.size()) - 1; row >= 0; --row)
+            ui->listWidget->takeItem(row);
+        for (int index : order)
+            ui->listWidget->addItem(extras[index]);
+    }
+
+    // 重新读到原来已加载的行数；当前歌曲排到了更后面时继续读，直到它出现在列表中
+    libraryQueuePaths.clear();
+    libraryLoaded = 0;
+    while ((libraryLoaded == 0 || libraryLoaded < loaded
+            || (currentInLibrary && !libraryQueuePaths.contains(current.toLocalFile())))
+           && fetchLibraryPage()) {
+    }
+    if (!current.isEmpty()) {
+        for (int row = 0; row < ui->listWidget->count(); ++row) {
+            if (ui->listWidget->item(row)->data(Qt::UserRole).toUrl() == current) {
+                ui->listWidget->setCurrentRow(row);
+                break;
+            }
+        }
+    }
+    ui->listWidget->setUpdatesEnabled(true);
+    if (ui->listWidget->currentItem())
+        ui->listWidget->scrollToItem(ui->listWidget->currentItem());
+}
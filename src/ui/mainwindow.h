@@ -2,10 +2,27 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QElapsedTimer>
+#include <QThread>
 #include <QtMultimedia>
 #include "../lyrics/lrcwidget.h"
 #include "../search/searchwidget.h"
+#include "../search/searchclient.h"
+#include "../search/streamloader.h"
 #include "../playlist/playlist_interface.h"
+#include "../library/librarydatabase.h"
+#include "../library/playhistory.h"
+#include "../library/queuesorter.h"
+#include "../library/librarywatcher.h"
+#include "../audio/audioengine.h"
+#include "../audio/playbackclock.h"
+#include "../audio/equalizerpresets.h"
+#include "../audio/prefetcher.h"
+#include "../lyrics/lyricresolver.h"
+#include "../core/singleinstance.h"
+
+class equalizerwidget;
+
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
@@ -14,7 +31,7 @@ class MainWindow : public QMainWindow
 {
     Q_OBJECT
 private:
-    QMediaPlayer *player;
+    AudioEngine *player;
     lrcwidget *lrcWidget;
     bool loopPay = true;
     QString positionTime;
@@ -23,18 +40,95 @@ private:
     QPoint lastMousePosition;
     PlaylistInterface *m_playlistInterface;
 
+    void setPlayerSource(const QUrl &source, bool recordPlay = true); // 设置播放源（带切歌追踪）
+    int appendFiles(const QStringList &files);  // 整批加入播放列表，返回第一首所在行（没有加入时为 -1）
+
+    // 延迟初始化：首次绘制后分步完成，或在首次使用时按需创建
+    bool firstPaintDone = false;
+    int deferredInitStep = 0;
+    QString currentAudioPath; // 当前歌曲，歌词界面创建前只记录，创建时再查找歌词
+    LyricResolver lyricResolver; // 歌词来源查找（结果按歌曲缓存）
+    PlaylistInterface *playlistInterface();
+    lrcwidget *ensureLrcWidget();
+    searchwidget *ensureSearchWidget();
+    QNetworkAccessManager *ensureNetworkManager();
+    SearchClient *searchClient;
+    SearchClient *ensureSearchClient();     // 分页搜索，见 searchclient.h
+
+    // 在线播放：搜索结果用曲目标识换取地址，经 StreamLoader 边下边播，下载完的歌曲缓存在 data/stream_cache
+    StreamCache *streamCache;
+    StreamLoader *streamLoader;
+    SearchResult streamingResult;       // 正在加载/播放的搜索结果
+    StreamLoader *ensureStreamLoader();
+    void playSearchResult(const SearchResult &result);
+    void playStream(const QUrl &url);
+
+    // 曲库数据库：音乐目录按页加载到列表，滚动到底部时再取下一页
+    LibraryDatabase libraryDb;
+    TrackQuery libraryQuery;
+    int libraryLoaded = 0;
+    int libraryTotal = 0;
+    bool libraryPaging = false;
+    QSet<QString> libraryQueuePaths;    // 已放入列表的曲库歌曲
+    bool fetchLibraryPage();
+    void syncLibraryTags(const QString &musicDirectory);   // 后台读取标签写入曲库（智能歌单规则需要）
+    QListWidgetItem *createLibraryItem(const LibraryTrack &track);
+
+    // 音乐目录监视：变化合并后只把增量应用到曲库和列表
+    LibraryWatcher *libraryWatcher = nullptr;
+    void applyLibraryChanges(const QVector<LibraryTrack> &added, const QStringList &removed);
+
+    // 播放历史：记录当前这首的实际收听时长，切歌或停止时写入一条事件
+    PlayHistory playHistory;
+    QString historyTrack;
+    qint64 historyListened = 0;
+    qint64 historyLastPosition = -1;
+    void finishHistorySession(bool finished);
+
+    // 播放队列排序（排序键按字符串缓存）
+    QueueSorter queueSorter;
+    void sortQueue(QueueSorter::Key key, bool descending);
+    void sortLibraryQueue(QueueSorter::Key key, bool descending);
+    QVector<QueueSorter::Entry> queueEntries(int first, int count) const;
+    void showQueueMenu(const QPoint &pos);
+
+    // 播放时钟：在位置通知之间插值并扣除输出延迟（XC_OUTPUT_LATENCY_MS）
+    PlaybackClock playbackClock;
+
+    // 均衡器（仅 stream 引擎）：切歌时按 歌曲 → 歌单 → 默认 套用预设
+    EqualizerPresets eqPresets;
+    equalizerwidget *eqWidget = nullptr;
+    QString currentPlaylistName;        // 列表来自某个歌单时为歌单名
+    void applyEqualizerPreset();
+    void showEqualizer();
+
+    // 预读：在工作线程中把当前歌曲播放位置之后和下一首的开头读进页缓存，并统计加载/跳转/缓冲等待
+    Prefetcher *prefetcher;
+    QThread *prefetchThread;
+    QElapsedTimer loadWait;             // setSource 到媒体加载完成
+    QElapsedTimer seekWait;             // 跳转到位置通知到达目标
+    QElapsedTimer bufferWait;           // 播放中缓冲不足
+    qint64 seekTarget = -1;
+    void seekPlayer(qint64 position);   // 用户跳转（带等待统计）
+    void prefetchNextTrack();
+
 protected:
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
     void mouseReleaseEvent(QMouseEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
 
 public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // 命令行打开的文件，或另一次启动经单实例转发来的命令
+    void handleInstanceMessage(const InstanceMessage &message);
+
 
 private slots:
+    void runDeferredInit();
     void updateCoverArtSize();
     QStringList getSavedMusicPaths();
     void loadSavedMusic();
@@ -43,6 +137,7 @@ private slots:
     void do_sourceChanged(const QUrl &media);
     void do_playbackStateChanged(QMediaPlayer::PlaybackState newState);
     void do_metaDataChanged();
+    void do_mediaStatusChanged(QMediaPlayer::MediaStatus status);
     
     // 收藏夹和歌单相关槽函数
     void on_actionAdd_to_Favorites_triggered();
@@ -50,6 +145,10 @@ private slots:
     void on_actionCreate_Playlist_triggered();
     void on_actionAdd_to_Playlist_triggered(); // 添加到指定歌单
     void on_actionLoad_Playlist_triggered();    // 加载歌单
+    void on_btnImportPlaylist_clicked();        // 导入 M3U/PLS 歌单
+    void on_btnExportPlaylist_clicked();        // 导出歌单
+    void on_btnSmartPlaylist_clicked();         // 新建智能歌单
+    void do_playlistImportFinished(const QString &playlistName, bool ok, int added, int missing);
     void updatePlaylistList();
 
 
@@ -85,7 +184,6 @@ private slots:
 
     //网络搜索歌曲
     void on_btnSearch_clicked();
-    void onSearchFinished(QNetworkReply *reply);
 
     void on_pushButton_clicked();
 